@@ -0,0 +1,81 @@
+/**
+ * @file app_console.c
+ * @brief Serial Console Implementation
+ */
+
+#include "app_console.h"
+#include "latency.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <string.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include <unistd.h>
+#endif
+
+static const char *TAG = "CONSOLE";
+
+// ==================== COMMANDS ====================
+
+/**
+ * @brief latency [reset] - In (hoặc xóa) histogram độ trễ của pipeline
+ */
+static int cmd_latency(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        latency_reset();
+        printf("Latency histograms cleared\n");
+        return 0;
+    }
+    latency_print();
+    return 0;
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t app_console_init(void) {
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = APP_CONSOLE_PROMPT;
+    repl_config.task_stack_size = APP_CONSOLE_TASK_STACK;
+
+#if CONFIG_IDF_TARGET_LINUX
+    // Host simulation: chỉ mở REPL khi stdin là terminal (replay/CI chạy với stdin chuyển hướng).
+    // Kiểm tra trước: sdkconfig của target linux vẫn có thể giữ CONFIG_ESP_CONSOLE_UART_DEFAULT,
+    // nhưng esp_console trên linux chỉ có REPL stdio
+    if (!isatty(STDIN_FILENO)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    esp_err_t err = esp_console_new_repl_stdio(&repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#else
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#endif
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Console REPL create failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    esp_console_register_help_command();
+
+    const esp_console_cmd_t latency_cmd = {
+        .command = "latency",
+        .help = "Print sensor pipeline latency histograms (p50/p99/max). 'latency reset' clears them",
+        .hint = "[reset]",
+        .func = &cmd_latency,
+    };
+    esp_console_cmd_register(&latency_cmd);
+
+    err = esp_console_start_repl(repl);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Console REPL start failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Console ready (type 'help')");
+    return ESP_OK;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file app_console.h
+ * @brief Serial Console - Lệnh chẩn đoán qua UART (esp_console REPL)
+ * @features latency [reset]
+ */
+
+#ifndef APP_CONSOLE_H
+#define APP_CONSOLE_H
+
+#include "config.h"
+
+// ==================== CONSOLE CONFIGURATION ====================
+
+#define APP_CONSOLE_PROMPT          "monitor> "
+#define APP_CONSOLE_TASK_STACK      4096
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Đăng ký các lệnh và khởi động REPL trên console mặc định
+ * @return ESP_OK nếu thành công
+ */
+esp_err_t app_console_init(void);
+
+#endif // APP_CONSOLE_H
@@ -15,7 +15,6 @@
 #include "esp_system.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
-#include "driver/i2c.h"
 
 // ==================== TAG for logging ====================
 #define TAG_MAIN    "MAIN"
@@ -33,8 +32,6 @@
 #define I2C_MASTER_SDA_IO       GPIO_NUM_6      // SDA - GPIO 6
 #define I2C_MASTER_SCL_IO       GPIO_NUM_7      // SCL - GPIO 7
 #define I2C_MASTER_FREQ_HZ      400000          // 400kHz cho I2C
-#define I2C_MASTER_TX_BUF_LEN   0               // Disable buffer
-#define I2C_MASTER_RX_BUF_LEN   0               // Disable buffer
 #define I2C_MASTER_TIMEOUT_MS   1000
 
 // OLED Configuration (SSD1306 128x64)
@@ -50,7 +47,11 @@
 #define WIFI_FAIL_BIT           BIT1
 
 // ==================== HTTP SERVER CONFIGURATION ====================
+#if CONFIG_IDF_TARGET_LINUX
+#define HTTP_SERVER_PORT        8080                 // Host simulation: port < 1024 cần quyền root
+#else
 #define HTTP_SERVER_PORT        80                   // Port HTTP (80)
+#endif
 #define ENABLE_WEBSERVER        1                    // Bật/tắt webserver (1=ON, 0=OFF)
 
 // ==================== SYSTEM THRESHOLDS ====================
@@ -62,7 +63,7 @@
 #define HUMIDITY_MAX    80.0f   // Độ ẩm tối đa (%)
 
 // ==================== TIMING CONFIGURATION ====================
-#define SENSOR_READ_PERIOD_MS   1000    // Đọc cảm biến mỗi 1 giây
+#define SENSOR_READ_PERIOD_MS   2000    // Chu kỳ đọc mặc định (>= DHT22_MIN_PERIOD_MS)
 #define DISPLAY_UPDATE_DELAY_MS 500     // Delay display task
 #define BUZZER_DURATION_MS      5000    // Thời gian buzzer kêu
 #define DHT22_READ_DELAY_MS     2000    // Delay giữa các lần đọc DHT22
@@ -82,12 +83,6 @@
 #define QUEUE_SIZE_SENSOR_DATA  5
 #define QUEUE_SIZE_ALERT        3
 
-// ==================== EVENT GROUP BITS ====================
-#define EVENT_STATE_NORMAL      (1 << 0)
-#define EVENT_STATE_WARNING     (1 << 1)
-#define EVENT_STATE_OVERHEAT    (1 << 2)
-#define EVENT_NEW_DATA          (1 << 3)
-
 // ==================== DATA STRUCTURES ====================
 
 /**
@@ -127,11 +122,6 @@ extern TaskHandle_t alert_task_handle;
 extern QueueHandle_t sensor_data_queue;
 extern QueueHandle_t alert_queue;
 
-extern SemaphoreHandle_t i2c_mutex;
-extern SemaphoreHandle_t data_ready_semaphore;
-
-extern EventGroupHandle_t system_event_group;
-
 extern TimerHandle_t sensor_timer_handle;
 extern TimerHandle_t buzzer_timer_handle;
 
@@ -170,9 +160,6 @@ esp_err_t ssd1306_draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
 esp_err_t ssd1306_update_display(sensor_data_t *data, system_state_t state);
 esp_err_t ssd1306_show_welcome_screen(void);
 
-// I2C Functions
-esp_err_t i2c_master_init(void);
-
 // Debug Functions
 void print_system_info(void);
 void print_sensor_data(sensor_data_t *data);
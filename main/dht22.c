@@ -1,50 +1,86 @@
-
-
 #include "dht22.h"
-#include "esp_timer.h"
-#include "rom/ets_sys.h"
+#include "dht22_decode.h"
+#include "driver/rmt_rx.h"
 #include <math.h>
+#include <stdatomic.h>
 
 static const char *TAG = TAG_SENSOR;
 static gpio_num_t dht_pin = DHT_PIN;
 
+// RMT RX: phần cứng ghi timestamp mọi cạnh, CPU chỉ chờ trên queue
+static rmt_channel_handle_t rx_channel = NULL;
+static QueueHandle_t rx_queue = NULL;
+static rmt_symbol_word_t rx_symbols[DHT22_RMT_SYMBOLS];
+
+// Bộ đếm kết quả đọc (chỉ tăng, không định dạng chuỗi trên đường nóng)
+static atomic_uint stat_ok, stat_timeout, stat_crc, stat_invalid, stat_other;
+
+/**
+ * @brief ISR callback: RMT đã nhận xong 1 khung (line idle > DHT22_RMT_IDLE_US)
+ */
+static bool IRAM_ATTR dht22_rx_done_callback(rmt_channel_handle_t channel,
+                                             const rmt_rx_done_event_data_t *edata, void *user_ctx) {
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(rx_queue, edata, &woken);
+    return woken == pdTRUE;
+}
+
 /**
- * @brief Đợi cho đến khi GPIO đạt trạng thái mong muốn hoặc timeout
+ * @brief Chuyển các symbol RMT thành chuỗi xung cho bộ giải mã
+ * @return Số xung (dừng ở symbol có duration = 0, tức điểm idle kết thúc khung)
  */
-static int wait_for_state(uint8_t state, uint32_t timeout_us) {
-    int elapsed = 0;
-    while (gpio_get_level(dht_pin) != state) {
-        if (elapsed > timeout_us) {
-            return -1;
-        }
-        ets_delay_us(1);
-        elapsed++;
+static size_t dht22_symbols_to_pulses(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                                      dht22_pulse_t *pulses, size_t max_pulses) {
+    size_t n = 0;
+    for (size_t i = 0; i < num_symbols && n + 2 <= max_pulses; i++) {
+        if (symbols[i].duration0 == 0) break;
+        pulses[n].level = symbols[i].level0;
+        pulses[n].duration_us = symbols[i].duration0;
+        n++;
+        
+        if (symbols[i].duration1 == 0) break;
+        pulses[n].level = symbols[i].level1;
+        pulses[n].duration_us = symbols[i].duration1;
+        n++;
     }
-    return elapsed;
+    return n;
 }
 
 /**
  * @brief Khởi tạo DHT22
  */
 esp_err_t dht22_init(void) {
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << dht_pin),
-        .mode = GPIO_MODE_OUTPUT_OD,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
+    rmt_rx_channel_config_t rx_config = {
+        .gpio_num = dht_pin,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DHT22_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = DHT22_RMT_SYMBOLS,
     };
     
-    esp_err_t ret = gpio_config(&io_conf);
+    esp_err_t ret = rmt_new_rx_channel(&rx_config, &rx_channel);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "DHT22 GPIO config failed");
+        ESP_LOGE(TAG, "DHT22 RMT channel create failed");
         return ret;
     }
     
+    rx_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    if (rx_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = dht22_rx_done_callback,
+    };
+    ESP_ERROR_CHECK(rmt_rx_register_event_callbacks(rx_channel, &cbs, NULL));
+    ESP_ERROR_CHECK(rmt_enable(rx_channel));
+    
+    // Open-drain vào/ra: MCU kéo LOW để gửi start signal, RMT vẫn đọc được pad
+    gpio_set_direction(dht_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode(dht_pin, GPIO_PULLUP_ONLY);
     gpio_set_level(dht_pin, 1);
     vTaskDelay(pdMS_TO_TICKS(1000));
     
-    ESP_LOGI(TAG, "DHT22 initialized on GPIO %d", dht_pin);
+    ESP_LOGI(TAG, "DHT22 initialized on GPIO %d (RMT capture)", dht_pin);
     return ESP_OK;
 }
 
@@ -70,98 +106,57 @@ bool dht22_is_valid_data(float temp, float hum) {
 }
 
 /**
- * @brief Đọc dữ liệu từ DHT22
+ * @brief Đọc 1 khung từ DHT22
+ * 
+ * Gửi start signal, để RMT ghi lại toàn bộ khung (83 cạnh) bằng phần cứng,
+ * rồi giải mã độ rộng xung. CPU không busy-poll trong lúc đo.
  */
-esp_err_t dht22_read(float *temperature, float *humidity) {
-    uint8_t data[5] = {0};
+static esp_err_t dht22_read_frame(float *temperature, float *humidity) {
+    static const rmt_receive_config_t rx_config = {
+        .signal_range_min_ns = DHT22_RMT_GLITCH_NS,
+        .signal_range_max_ns = DHT22_RMT_IDLE_US * 1000,
+    };
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_pulse_t pulses[DHT22_RMT_SYMBOLS * 2];
+    rmt_rx_done_event_data_t rx_data;
+    
+    xQueueReset(rx_queue);
     
     // Send start signal
-    gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT);
     gpio_set_level(dht_pin, 0);
     vTaskDelay(pdMS_TO_TICKS(DHT22_START_SIGNAL_MS));
-    
     gpio_set_level(dht_pin, 1);
-    ets_delay_us(30);
-    
-    // Switch to input mode
-    gpio_set_direction(dht_pin, GPIO_MODE_INPUT);
     
-    // Wait for sensor response
-    if (wait_for_state(0, 100) < 0) {
-        ESP_LOGW(TAG, "DHT22 no response (1)");
-        gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT_OD);
-        gpio_set_level(dht_pin, 1);
-        return ESP_ERR_TIMEOUT;
-    }
-    
-    if (wait_for_state(1, 100) < 0) {
-        ESP_LOGW(TAG, "DHT22 no response (2)");
-        gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT_OD);
-        gpio_set_level(dht_pin, 1);
-        return ESP_ERR_TIMEOUT;
+    // Bắt đầu đo ngay khi nhả line (sensor phản hồi sau 20-40us)
+    esp_err_t ret = rmt_receive(rx_channel, rx_symbols, sizeof(rx_symbols), &rx_config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "DHT22 RMT receive failed: %s", esp_err_to_name(ret));
+        return ret;
     }
     
-    if (wait_for_state(0, 100) < 0) {
-        ESP_LOGW(TAG, "DHT22 no response (3)");
-        gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT_OD);
-        gpio_set_level(dht_pin, 1);
+    if (xQueueReceive(rx_queue, &rx_data, pdMS_TO_TICKS(DHT22_RX_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "DHT22 no response");
+        // Hủy lần nhận đang treo
+        rmt_disable(rx_channel);
+        rmt_enable(rx_channel);
         return ESP_ERR_TIMEOUT;
     }
     
-    // Read 40 bits (5 bytes)
-    for (int i = 0; i < 40; i++) {
-        // Wait for start of bit
-        if (wait_for_state(1, 100) < 0) {
-            ESP_LOGW(TAG, "DHT22 timeout waiting for bit %d start", i);
-            gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT_OD);
-            gpio_set_level(dht_pin, 1);
-            return ESP_ERR_TIMEOUT;
-        }
-        
-        // Measure high pulse duration
-        int duration = wait_for_state(0, 100);
-        if (duration < 0) {
-            ESP_LOGW(TAG, "DHT22 timeout reading bit %d", i);
-            gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT_OD);
-            gpio_set_level(dht_pin, 1);
-            return ESP_ERR_TIMEOUT;
-        }
-        
-        // Determine bit value
-        int byte_idx = i / 8;
-        int bit_idx = 7 - (i % 8);
-        
-        if (duration > DHT22_THRESHOLD_US) {
-            data[byte_idx] |= (1 << bit_idx);  // Bit 1
-        }
-        // else: Bit 0 (already 0)
-    }
+    size_t count = dht22_symbols_to_pulses(rx_data.received_symbols, rx_data.num_symbols,
+                                           pulses, sizeof(pulses) / sizeof(pulses[0]));
     
-    // Return to output mode
-    gpio_set_direction(dht_pin, GPIO_MODE_OUTPUT_OD);
-    gpio_set_level(dht_pin, 1);
-    
-    // Verify checksum
-    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
-    if (checksum != data[4]) {
+    ret = dht22_decode_pulses(pulses, count, data);
+    if (ret == ESP_ERR_INVALID_CRC) {
         ESP_LOGW(TAG, "DHT22 checksum error: calculated=%02X, received=%02X", 
-                 checksum, data[4]);
-        return ESP_ERR_INVALID_CRC;
+                 (uint8_t)(data[0] + data[1] + data[2] + data[3]), data[4]);
+        return ret;
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "DHT22 bad frame (%u pulses): %s", (unsigned)count, esp_err_to_name(ret));
+        return ret;
     }
     
     // Convert to temperature and humidity
-    uint16_t hum_raw = (data[0] << 8) | data[1];
-    uint16_t temp_raw = (data[2] << 8) | data[3];
-    
-    *humidity = hum_raw / 10.0f;
-    
-    if (temp_raw & 0x8000) {
-        // Negative temperature
-        temp_raw &= 0x7FFF;
-        *temperature = -(temp_raw / 10.0f);
-    } else {
-        *temperature = temp_raw / 10.0f;
-    }
+    dht22_decode_values(data, temperature, humidity);
     
     // Validate data
     if (!dht22_is_valid_data(*temperature, *humidity)) {
@@ -173,3 +168,30 @@ esp_err_t dht22_read(float *temperature, float *humidity) {
     
     return ESP_OK;
 }
+
+/**
+ * @brief Đọc dữ liệu từ DHT22 và cập nhật bộ đếm kết quả
+ */
+esp_err_t dht22_read(float *temperature, float *humidity) {
+    esp_err_t ret = dht22_read_frame(temperature, humidity);
+    
+    switch (ret) {
+        case ESP_OK:                    atomic_fetch_add_explicit(&stat_ok, 1, memory_order_relaxed); break;
+        case ESP_ERR_TIMEOUT:           atomic_fetch_add_explicit(&stat_timeout, 1, memory_order_relaxed); break;
+        case ESP_ERR_INVALID_CRC:       atomic_fetch_add_explicit(&stat_crc, 1, memory_order_relaxed); break;
+        case ESP_ERR_INVALID_RESPONSE:  atomic_fetch_add_explicit(&stat_invalid, 1, memory_order_relaxed); break;
+        default:                        atomic_fetch_add_explicit(&stat_other, 1, memory_order_relaxed); break;
+    }
+    return ret;
+}
+
+/**
+ * @brief Lấy bộ đếm kết quả đọc
+ */
+void dht22_get_stats(dht22_stats_t *stats) {
+    stats->ok = atomic_load_explicit(&stat_ok, memory_order_relaxed);
+    stats->timeout = atomic_load_explicit(&stat_timeout, memory_order_relaxed);
+    stats->crc_error = atomic_load_explicit(&stat_crc, memory_order_relaxed);
+    stats->invalid = atomic_load_explicit(&stat_invalid, memory_order_relaxed);
+    stats->other = atomic_load_explicit(&stat_other, memory_order_relaxed);
+}
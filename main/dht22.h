@@ -5,19 +5,31 @@
 
 #include "config.h"
 
-// DHT22 timing constants (microseconds)
+// DHT22 timing constants
 #define DHT22_START_SIGNAL_MS   20      // Start signal duration (ms)
-#define DHT22_RESPONSE_WAIT_US  40      // Wait for sensor response
 #define DHT22_DATA_BITS         40      // Total bits to read
+#define DHT22_RX_TIMEOUT_MS     20      // Thời gian chờ tối đa cho 1 khung (~5ms thực tế)
+#define DHT22_MIN_PERIOD_MS     DHT22_READ_DELAY_MS // Chu kỳ chuyển đổi tối thiểu (datasheet: 2s)
 
-// DHT22 timing thresholds
-#define DHT22_BIT_0_US          28      // Bit 0 pulse duration (~26-28us)
-#define DHT22_BIT_1_US          70      // Bit 1 pulse duration (~70us)
-#define DHT22_THRESHOLD_US      40      // Threshold to distinguish 0 and 1
+// RMT capture
+#define DHT22_RMT_RESOLUTION_HZ 1000000 // 1 tick = 1us
+#define DHT22_RMT_SYMBOLS       48      // 1 block RMT RX (~43 symbol cho 1 khung)
+#define DHT22_RMT_GLITCH_NS     1000    // Lọc xung nhiễu < 1us
+#define DHT22_RMT_IDLE_US       200     // Line HIGH lâu hơn => hết khung
+
+// Bộ đếm kết quả đọc (atomic, luôn bật)
+typedef struct {
+    uint32_t ok;
+    uint32_t timeout;       // Sensor không phản hồi
+    uint32_t crc_error;     // Sai checksum
+    uint32_t invalid;       // Khung lỗi hoặc giá trị ngoài phạm vi
+    uint32_t other;         // Lỗi RMT
+} dht22_stats_t;
 
 // Function prototypes
 esp_err_t dht22_init(void);
 esp_err_t dht22_read(float *temperature, float *humidity);
 bool dht22_is_valid_data(float temp, float hum);
+void dht22_get_stats(dht22_stats_t *stats);
 
 #endif // DHT22_H
@@ -0,0 +1,54 @@
+/**
+ * @file dht22_decode.c
+ * @brief Bộ giải mã DHT22 thuần (không phụ thuộc phần cứng)
+ */
+
+#include "dht22_decode.h"
+#include <string.h>
+
+esp_err_t dht22_decode_pulses(const dht22_pulse_t *pulses, size_t count, uint8_t data[DHT22_DATA_BYTES]) {
+    const int total_bits = DHT22_DATA_BYTES * 8;
+    int bit = total_bits - 1;
+    
+    memset(data, 0, DHT22_DATA_BYTES);
+    
+    // Duyệt ngược: 40 xung HIGH cuối cùng là 40 bit dữ liệu (MSB trước)
+    for (int i = (int)count - 1; i >= 0 && bit >= 0; i--) {
+        if (pulses[i].level == 0 || pulses[i].duration_us == 0) {
+            continue;
+        }
+        if (pulses[i].duration_us > DHT22_BIT_HIGH_MAX_US) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (pulses[i].duration_us > DHT22_BIT_THRESHOLD_US) {
+            data[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+        }
+        bit--;
+    }
+    
+    if (bit >= 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
+    if (checksum != data[4]) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    
+    return ESP_OK;
+}
+
+void dht22_decode_values(const uint8_t data[DHT22_DATA_BYTES], float *temperature, float *humidity) {
+    uint16_t hum_raw = (data[0] << 8) | data[1];
+    uint16_t temp_raw = (data[2] << 8) | data[3];
+    
+    *humidity = hum_raw / 10.0f;
+    
+    if (temp_raw & 0x8000) {
+        // Negative temperature
+        temp_raw &= 0x7FFF;
+        *temperature = -(temp_raw / 10.0f);
+    } else {
+        *temperature = temp_raw / 10.0f;
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file dht22_decode.h
+ * @brief Bộ giải mã DHT22 thuần (không phụ thuộc phần cứng)
+ * 
+ * Nhận chuỗi độ rộng xung (level + µs) do RMT đo được và trả về 5 byte dữ liệu.
+ * Không gọi driver nào nên có thể biên dịch và chạy trên host.
+ */
+
+#ifndef DHT22_DECODE_H
+#define DHT22_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#define DHT22_DATA_BYTES        5
+
+// Ngưỡng giải mã (µs) - dựa trên timestamp phần cứng, không còn là số vòng lặp
+#define DHT22_BIT_THRESHOLD_US  48      // Giữa bit 0 (~26-28us) và bit 1 (~70us)
+#define DHT22_BIT_HIGH_MAX_US   100     // Xung HIGH dài hơn => nhiễu/khung lỗi
+
+/**
+ * @brief Một mức tín hiệu với độ rộng tính bằng µs
+ */
+typedef struct {
+    uint16_t duration_us;
+    uint8_t level;          // 0 = LOW, 1 = HIGH
+} dht22_pulse_t;
+
+/**
+ * @brief Giải mã chuỗi xung thành 5 byte dữ liệu (đã kiểm tra checksum)
+ * 
+ * 40 bit được lấy từ 40 xung HIGH cuối cùng của khung, nên việc bắt đầu đo
+ * trễ vài µs (mất một phần xung phản hồi) không làm hỏng dữ liệu.
+ * 
+ * @return ESP_OK, ESP_ERR_TIMEOUT (thiếu bit), ESP_ERR_INVALID_RESPONSE (xung sai),
+ *         ESP_ERR_INVALID_CRC (sai checksum)
+ */
+esp_err_t dht22_decode_pulses(const dht22_pulse_t *pulses, size_t count, uint8_t data[DHT22_DATA_BYTES]);
+
+/**
+ * @brief Chuyển 5 byte dữ liệu sang nhiệt độ (°C) và độ ẩm (%)
+ */
+void dht22_decode_values(const uint8_t data[DHT22_DATA_BYTES], float *temperature, float *humidity);
+
+#endif // DHT22_DECODE_H
@@ -0,0 +1,680 @@
+/**
+ * @file history.c
+ * @brief History Store Implementation
+ *
+ * Mẫu thô được nén theo khối 256 byte (history_codec): khối cuối cùng đang mở,
+ * đầy thì bắt đầu khối mới, ghi đè khối cũ nhất trong ring s_blocks.
+ *
+ * Ring single-producer, reader không khóa:
+ * - s_head = tổng số mẫu đã ghi (vị trí tuyệt đối), s_block_head = tổng số khối đã mở
+ * - Khối thứ b nằm ở s_blocks[b % HISTORY_BLOCKS], header ghi vị trí mẫu đầu (start_pos)
+ * - Reader chép cả khối rồi kiểm tra lại s_block_head để biết khối có bị ghi đè không,
+ *   sau đó giải nén trên bản chép (writer chỉ OR thêm bit phía sau các mẫu đã công bố)
+ *
+ * Mỗi mẫu đồng thời được cộng dồn vào bucket 1 phút đang mở. Khi sang phút mới,
+ * bucket được đóng (ghi vào ring tầng MINUTE) và cộng dồn tiếp vào bucket 1 giờ.
+ * Các ring tầng dùng cùng cơ chế head/kiểm tra ghi đè như ring khối.
+ */
+
+#include "history.h"
+#include <string.h>
+#include <stdatomic.h>
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Bucket đã đóng (20 byte, giá trị deci-unit)
+ */
+typedef struct {
+    uint32_t index;             // start_us / period
+    uint16_t count;
+    int16_t temp_min, temp_max, temp_mean;
+    uint16_t hum_min, hum_max, hum_mean;
+    uint8_t worst_state;
+} bucket_entry_t;
+
+/**
+ * @brief Bucket đang tích lũy (tổng chính xác, chưa chia)
+ */
+typedef struct {
+    bool active;
+    uint32_t index;
+    uint32_t count;
+    int16_t temp_min, temp_max;
+    int32_t temp_sum;
+    uint16_t hum_min, hum_max;
+    uint32_t hum_sum;
+    uint8_t worst_state;
+} bucket_accum_t;
+
+/**
+ * @brief 1 tầng tổng hợp
+ */
+typedef struct {
+    bucket_entry_t *slots;
+    uint32_t capacity;
+    uint32_t period_s;
+    atomic_uint head;
+    bucket_accum_t accum;       // Chỉ writer truy cập
+} history_tier_store_t;
+
+// ==================== GLOBAL STATE ====================
+
+static history_block_t s_blocks[HISTORY_BLOCKS];
+static atomic_uint s_block_head = 0;    // Khối đang mở = s_block_head - 1
+static atomic_uint s_head = 0;          // Tổng số mẫu đã ghi
+static history_codec_t s_encoder;       // Chỉ writer truy cập
+
+static bucket_entry_t s_minute_slots[HISTORY_MINUTE_BUCKETS];
+static bucket_entry_t s_hour_slots[HISTORY_HOUR_BUCKETS];
+
+static history_tier_store_t s_tiers[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_MINUTE] = { .slots = s_minute_slots, .capacity = HISTORY_MINUTE_BUCKETS, .period_s = 60 },
+    [HISTORY_TIER_HOUR]   = { .slots = s_hour_slots,   .capacity = HISTORY_HOUR_BUCKETS,   .period_s = 3600 },
+};
+
+static const char *const s_tier_names[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_RAW]    = "raw",
+    [HISTORY_TIER_MINUTE] = "1m",
+    [HISTORY_TIER_HOUR]   = "1h",
+};
+
+// Mức độ nghiêm trọng để chọn trạng thái xấu nhất (theo system_state_t)
+static const uint8_t s_severity[] = {
+    [STATE_NORMAL]   = 0,
+    [STATE_ERROR]    = 1,
+    [STATE_WARNING]  = 2,
+    [STATE_OVERHEAT] = 3,
+};
+
+// ==================== HELPER FUNCTIONS ====================
+
+static int32_t to_deci(float value) {
+    return (int32_t)(value * 10.0f + (value >= 0 ? 0.5f : -0.5f));
+}
+
+/**
+ * @brief Chia làm tròn (half away from zero), giống div_round() trong history_query.c
+ */
+static int32_t div_round(int64_t sum, uint32_t count) {
+    int64_t half = count / 2;
+    return (int32_t)((sum >= 0) ? (sum + half) / count : (sum - half) / count);
+}
+
+/**
+ * @brief Khối cũ nhất còn hợp lệ (khối đang bị ghi đè không tính)
+ */
+static uint32_t oldest_block(unsigned block_head) {
+    return (block_head >= HISTORY_BLOCKS) ? block_head - (HISTORY_BLOCKS - 1) : 0;
+}
+
+/**
+ * @brief Đọc header của khối b (false nếu chưa có / đã bị ghi đè)
+ */
+static bool read_block_header(uint32_t b, uint32_t *start_pos, history_sample_t *first) {
+    unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_acquire);
+    if (b >= block_head || block_head - b >= HISTORY_BLOCKS) {
+        return false;
+    }
+
+    const history_block_t *blk = &s_blocks[b % HISTORY_BLOCKS];
+    *start_pos = blk->start_pos;
+    *first = blk->first;
+    atomic_thread_fence(memory_order_acquire);
+
+    // Writer bắt đầu ghi đè khối b khi mở khối b + HISTORY_BLOCKS
+    block_head = atomic_load_explicit(&s_block_head, memory_order_relaxed);
+    return (block_head - b) < HISTORY_BLOCKS;
+}
+
+/**
+ * @brief Chép khối b, avail = số mẫu đã công bố trong bản chép
+ */
+static bool load_block(uint32_t b, history_block_t *out, uint32_t *avail) {
+    // Đọc s_head trước: mọi bit của các mẫu < head đã nằm trong khối
+    unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+    unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_acquire);
+    if (b >= block_head || block_head - b >= HISTORY_BLOCKS) {
+        return false;
+    }
+
+    memcpy(out, &s_blocks[b % HISTORY_BLOCKS], sizeof(*out));
+    atomic_thread_fence(memory_order_acquire);
+
+    block_head = atomic_load_explicit(&s_block_head, memory_order_relaxed);
+    if ((block_head - b) >= HISTORY_BLOCKS) {
+        return false;
+    }
+
+    uint32_t published = (head > out->start_pos) ? head - out->start_pos : 0;
+    *avail = (out->count < published) ? out->count : published;
+    return true;
+}
+
+/**
+ * @brief Điều kiện tìm kiếm: mẫu ở vị trí pos nằm "trước" key (đơn điệu theo vị trí)
+ */
+typedef bool (*sample_before_t)(uint32_t pos, const history_sample_t *s, const void *key);
+
+static bool at_or_before_pos(uint32_t pos, const history_sample_t *s, const void *key) {
+    (void)s;
+    return pos <= *(const uint32_t *)key;
+}
+
+static bool before_time(uint32_t pos, const history_sample_t *s, const void *key) {
+    (void)pos;
+    return s->timestamp_ms * 1000 < *(const int64_t *)key;
+}
+
+static bool at_or_before_seq(uint32_t pos, const history_sample_t *s, const void *key) {
+    (void)pos;
+    return s->seq <= *(const uint32_t *)key;
+}
+
+/**
+ * @brief Khối cuối cùng có mẫu đầu thỏa before(first, key) (O(log n))
+ * @return false nếu mọi khối còn giữ đều không thỏa
+ */
+static bool find_block(sample_before_t before, const void *key, uint32_t *out) {
+    unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_acquire);
+    uint32_t lo = oldest_block(block_head), hi = block_head;
+
+    // Tìm khối đầu tiên không thỏa, kết quả là khối ngay trước nó
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t start_pos;
+        history_sample_t first;
+        // Bị ghi đè trong lúc tìm => khối rất cũ => coi như thỏa
+        if (!read_block_header(mid, &start_pos, &first) || before(start_pos, &first, key)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == oldest_block(block_head)) {
+        return false;
+    }
+    *out = lo - 1;
+    return true;
+}
+
+/**
+ * @brief Vị trí đầu tiên trong span có mẫu không thỏa before (O(log n) khối + giải nén 1 khối)
+ */
+static uint32_t find_first(history_span_t span, sample_before_t before, const void *key) {
+    uint32_t b, avail, result = span.begin;
+    history_block_t blk;
+
+    if (find_block(before, key, &b) && load_block(b, &blk, &avail)) {
+        history_codec_t dec;
+        history_sample_t s;
+        history_decoder_init(&dec, &blk);
+        result = blk.start_pos;
+        while (result - blk.start_pos < avail && history_decoder_next(&dec, &blk, &s) && before(result, &s, key)) {
+            result++;
+        }
+    }
+
+    if (result < span.begin) result = span.begin;
+    if (result > span.end) result = span.end;
+    return result;
+}
+
+static void sample_to_record(const history_sample_t *s, history_record_t *out) {
+    out->data.temperature = s->temp_deci / 10.0f;
+    out->data.humidity = s->hum_deci / 10.0f;
+    out->data.timestamp = s->timestamp_ms * 1000;
+    out->data.is_valid = s->is_valid;
+    out->state = (system_state_t)s->state;
+    out->seq = s->seq;
+}
+
+static uint8_t worse_state(uint8_t a, uint8_t b) {
+    return (s_severity[b] > s_severity[a]) ? b : a;
+}
+
+/**
+ * @brief Cộng 1 bucket (hoặc 1 mẫu, count <= 1) vào bucket đang tích lũy
+ */
+static void accum_add(bucket_accum_t *acc, uint32_t count, int16_t tmin, int16_t tmax, int32_t tsum,
+                      uint16_t hmin, uint16_t hmax, uint32_t hsum, uint8_t state) {
+    if (count > 0) {
+        if (acc->count == 0 || tmin < acc->temp_min) acc->temp_min = tmin;
+        if (acc->count == 0 || tmax > acc->temp_max) acc->temp_max = tmax;
+        if (acc->count == 0 || hmin < acc->hum_min) acc->hum_min = hmin;
+        if (acc->count == 0 || hmax > acc->hum_max) acc->hum_max = hmax;
+        acc->temp_sum += tsum;
+        acc->hum_sum += hsum;
+        acc->count += count;
+    }
+    acc->worst_state = worse_state(acc->worst_state, state);
+}
+
+static void accum_reset(bucket_accum_t *acc, uint32_t index) {
+    memset(acc, 0, sizeof(*acc));
+    acc->active = true;
+    acc->index = index;
+    acc->worst_state = STATE_NORMAL;
+}
+
+/**
+ * @brief Ghi bucket đang tích lũy vào ring của tầng rồi cộng nó lên tầng kế tiếp
+ */
+static void tier_close(history_tier_t tier) {
+    history_tier_store_t *t = &s_tiers[tier];
+    bucket_accum_t *acc = &t->accum;
+    unsigned head = atomic_load_explicit(&t->head, memory_order_relaxed);
+    bucket_entry_t *e = &t->slots[head % t->capacity];
+    uint32_t n = (acc->count > 0) ? acc->count : 1;
+
+    atomic_thread_fence(memory_order_release);
+    e->index = acc->index;
+    e->count = (acc->count > UINT16_MAX) ? UINT16_MAX : (uint16_t)acc->count;
+    e->temp_min = acc->temp_min;
+    e->temp_max = acc->temp_max;
+    e->temp_mean = (int16_t)div_round(acc->temp_sum, n);
+    e->hum_min = acc->hum_min;
+    e->hum_max = acc->hum_max;
+    e->hum_mean = (uint16_t)div_round(acc->hum_sum, n);
+    e->worst_state = acc->worst_state;
+    atomic_store_explicit(&t->head, head + 1, memory_order_release);
+
+    if (tier + 1 < HISTORY_TIER_MAX) {
+        history_tier_store_t *up = &s_tiers[tier + 1];
+        uint32_t up_index = (uint32_t)((uint64_t)acc->index * t->period_s / up->period_s);
+        if (up->accum.active && up->accum.index != up_index) {
+            tier_close(tier + 1);
+        }
+        if (!up->accum.active) {
+            accum_reset(&up->accum, up_index);
+        }
+        accum_add(&up->accum, acc->count, acc->temp_min, acc->temp_max, acc->temp_sum,
+                  acc->hum_min, acc->hum_max, acc->hum_sum, acc->worst_state);
+    }
+    acc->active = false;
+}
+
+/**
+ * @brief Cộng 1 mẫu thô (mẫu lỗi chỉ góp trạng thái)
+ */
+static void accum_add_sample(bucket_accum_t *acc, const history_sample_t *e) {
+    if (e->is_valid) {
+        accum_add(acc, 1, e->temp_deci, e->temp_deci, e->temp_deci,
+                  e->hum_deci, e->hum_deci, e->hum_deci, e->state);
+    } else {
+        accum_add(acc, 0, 0, 0, 0, 0, 0, 0, e->state);
+    }
+}
+
+/**
+ * @brief Bucket đang tích lũy => history_bucket_t (mean làm tròn như khi đóng bucket)
+ */
+static void accum_to_bucket(const bucket_accum_t *acc, uint32_t period_s, history_bucket_t *out) {
+    uint32_t n = (acc->count > 0) ? acc->count : 1;
+
+    out->start_us = (int64_t)acc->index * period_s * 1000000;
+    out->count = acc->count;
+    out->temp_min = acc->temp_min / 10.0f;
+    out->temp_max = acc->temp_max / 10.0f;
+    out->temp_mean = div_round(acc->temp_sum, n) / 10.0f;
+    out->hum_min = acc->hum_min / 10.0f;
+    out->hum_max = acc->hum_max / 10.0f;
+    out->hum_mean = div_round(acc->hum_sum, n) / 10.0f;
+    out->worst_state = (system_state_t)acc->worst_state;
+}
+
+/**
+ * @brief Cộng 1 mẫu thô vào bucket 1 phút (đóng bucket cũ khi sang phút mới)
+ */
+static void tiers_add_sample(const history_sample_t *e) {
+    history_tier_store_t *t = &s_tiers[HISTORY_TIER_MINUTE];
+    uint32_t index = (uint32_t)(e->timestamp_ms / ((int64_t)t->period_s * 1000));
+
+    if (t->accum.active && t->accum.index != index) {
+        tier_close(HISTORY_TIER_MINUTE);
+    }
+    if (!t->accum.active) {
+        accum_reset(&t->accum, index);
+    }
+    accum_add_sample(&t->accum, e);
+}
+
+/**
+ * @brief Đọc thô 1 bucket của tầng (false nếu chưa có / đã bị ghi đè)
+ */
+static bool read_bucket_entry(const history_tier_store_t *t, uint32_t pos, bucket_entry_t *out) {
+    unsigned head = atomic_load_explicit(&t->head, memory_order_acquire);
+    if (pos >= head || head - pos > t->capacity) {
+        return false;
+    }
+
+    *out = t->slots[pos % t->capacity];
+    atomic_thread_fence(memory_order_acquire);
+
+    head = atomic_load_explicit(&t->head, memory_order_relaxed);
+    return (head - pos) < t->capacity;
+}
+
+static history_span_t tier_span(const history_tier_store_t *t) {
+    unsigned head = atomic_load_explicit(&t->head, memory_order_acquire);
+    // Slot cũ nhất (head - capacity) là slot writer ghi tiếp => read_bucket_entry() từ chối nó
+    history_span_t span = {
+        .begin = (head >= t->capacity) ? head - t->capacity + 1 : 0,
+        .end = head,
+    };
+    return span;
+}
+
+/**
+ * @brief Vị trí đầu tiên trong span có index >= index (O(log n))
+ */
+static uint32_t tier_find_index(const history_tier_store_t *t, history_span_t span, uint32_t index) {
+    uint32_t lo = span.begin, hi = span.end;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        bucket_entry_t e;
+        if (!read_bucket_entry(t, mid, &e) || e.index < index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Timestamp cũ nhất còn giữ ở 1 tầng (INT64_MAX nếu tầng rỗng)
+ */
+static int64_t tier_oldest_us(history_tier_t tier) {
+    if (tier == HISTORY_TIER_RAW) {
+        unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_acquire);
+        uint32_t start_pos;
+        history_sample_t first;
+        // Khối cũ nhất có thể vừa bị ghi đè => thử khối kế tiếp
+        for (uint32_t b = oldest_block(block_head); b < block_head; b++) {
+            if (read_block_header(b, &start_pos, &first)) {
+                return first.timestamp_ms * 1000;
+            }
+        }
+        return INT64_MAX;
+    }
+
+    const history_tier_store_t *t = &s_tiers[tier];
+    history_span_t span = tier_span(t);
+    bucket_entry_t e;
+    for (uint32_t pos = span.begin; pos < span.end; pos++) {
+        if (read_bucket_entry(t, pos, &e)) {
+            return (int64_t)e.index * t->period_s * 1000000;
+        }
+    }
+    return INT64_MAX;
+}
+
+// ==================== PUBLIC API ====================
+
+void history_append(const sample_t *sample) {
+    history_sample_t s = {
+        .timestamp_ms = sample->data.timestamp / 1000,
+        .seq = sample->seq,
+        .temp_deci = (int16_t)to_deci(sample->data.temperature),
+        .hum_deci = (uint16_t)to_deci(sample->data.humidity),
+        .state = (uint8_t)sample->state,
+        .is_valid = sample->data.is_valid,
+    };
+    unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_relaxed);
+
+    // Khối đang mở đầy (hoặc chưa có) => mở khối mới, ghi đè khối cũ nhất
+    if (block_head == 0 || !history_block_append(&s_blocks[(block_head - 1) % HISTORY_BLOCKS], &s_encoder, &s)) {
+        // Reader phải thấy s_block_head mới trước khi khối cũ bị ghi đè (fence rw,w)
+        atomic_thread_fence(memory_order_release);
+        history_block_init(&s_blocks[block_head % HISTORY_BLOCKS], &s_encoder, head, &s);
+        atomic_store_explicit(&s_block_head, block_head + 1, memory_order_release);
+    }
+    atomic_store_explicit(&s_head, head + 1, memory_order_release);
+
+    tiers_add_sample(&s);
+}
+
+history_span_t history_get_span(void) {
+    unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_acquire);
+    history_span_t span = { 0, 0 };
+    uint32_t start_pos;
+    history_sample_t first;
+
+    for (uint32_t b = oldest_block(block_head); b < block_head; b++) {
+        if (read_block_header(b, &start_pos, &first)) {
+            span.begin = start_pos;
+            break;
+        }
+    }
+    span.end = atomic_load_explicit(&s_head, memory_order_acquire);
+    if (span.begin > span.end) {
+        span.begin = span.end;
+    }
+    return span;
+}
+
+void history_iter_begin(history_iter_t *it, history_span_t span) {
+    it->pos = span.begin;
+    it->end = span.end;
+    it->avail = 0;
+    it->block.start_pos = 0;
+}
+
+bool history_iter_next_sample(history_iter_t *it, history_sample_t *out) {
+    history_sample_t s;
+
+    while (it->pos < it->end) {
+        // Hết khối đã chép => chép khối chứa pos rồi giải nén tới pos
+        if (it->avail == 0 || it->pos < it->block.start_pos || it->pos - it->block.start_pos >= it->avail) {
+            uint32_t b;
+            if (!find_block(at_or_before_pos, &it->pos, &b) || !load_block(b, &it->block, &it->avail)) {
+                // pos đã bị ghi đè => nhảy tới mẫu cũ nhất còn giữ
+                history_span_t span = history_get_span();
+                if (span.begin <= it->pos || span.begin == span.end) {
+                    return false;
+                }
+                it->pos = span.begin;
+                it->avail = 0;
+                continue;
+            }
+            if (it->pos < it->block.start_pos) {
+                it->pos = it->block.start_pos;  // Các mẫu trước khối này đã bị ghi đè
+            }
+            if (it->pos - it->block.start_pos >= it->avail) {
+                return false;  // Chưa được công bố
+            }
+            history_decoder_init(&it->dec, &it->block);
+            while (it->dec.index < it->pos - it->block.start_pos) {
+                if (!history_decoder_next(&it->dec, &it->block, &s)) {
+                    return false;
+                }
+            }
+        }
+
+        if (!history_decoder_next(&it->dec, &it->block, out)) {
+            return false;
+        }
+        it->pos++;
+        return true;
+    }
+    return false;
+}
+
+bool history_iter_next(history_iter_t *it, history_record_t *out) {
+    history_sample_t s;
+    if (!history_iter_next_sample(it, &s)) {
+        return false;
+    }
+    sample_to_record(&s, out);
+    return true;
+}
+
+bool history_read(uint32_t pos, history_record_t *out) {
+    history_iter_t it;
+    history_span_t span = { pos, pos + 1 };
+
+    history_iter_begin(&it, span);
+    return history_iter_next(&it, out);
+}
+
+uint32_t history_find_time(history_span_t span, int64_t ts_us) {
+    return find_first(span, before_time, &ts_us);
+}
+
+uint32_t history_find_after_seq(history_span_t span, uint32_t seq) {
+    return find_first(span, at_or_before_seq, &seq);
+}
+
+void history_get_stats(history_stats_t *stats) {
+    unsigned block_head = atomic_load_explicit(&s_block_head, memory_order_acquire);
+    history_span_t span = history_get_span();
+
+    stats->samples = span.end - span.begin;
+    stats->blocks = block_head - oldest_block(block_head);
+    stats->capacity_bytes = sizeof(s_blocks);
+    stats->used_bytes = 0;
+    for (uint32_t b = oldest_block(block_head); b < block_head; b++) {
+        stats->used_bytes += HISTORY_BLOCK_HEADER_BYTES + (s_blocks[b % HISTORY_BLOCKS].bits + 7) / 8;
+    }
+}
+
+history_span_t history_range(int64_t from_us, int64_t to_us) {
+    history_span_t span = history_get_span();
+    history_span_t result;
+
+    result.begin = history_find_time(span, from_us);
+    result.end = (to_us == INT64_MAX) ? span.end : history_find_time(span, to_us + 1);
+    if (result.end < result.begin) {
+        result.end = result.begin;
+    }
+    return result;
+}
+
+history_span_t history_tier_range(history_tier_t tier, int64_t from_us, int64_t to_us) {
+    if (tier == HISTORY_TIER_RAW || tier >= HISTORY_TIER_MAX) {
+        return history_range(from_us, to_us);
+    }
+
+    const history_tier_store_t *t = &s_tiers[tier];
+    int64_t period_us = (int64_t)t->period_s * 1000000;
+    history_span_t span = tier_span(t);
+    history_span_t result = span;
+
+    // Bucket giao với [from, to]: index trong [from / period, to / period]
+    if (from_us > 0) {
+        result.begin = tier_find_index(t, span, (uint32_t)(from_us / period_us));
+    }
+    if (to_us < INT64_MAX && to_us >= 0) {
+        result.end = tier_find_index(t, span, (uint32_t)(to_us / period_us) + 1);
+    } else if (to_us < 0) {
+        result.end = span.begin;
+    }
+    if (result.end < result.begin) {
+        result.end = result.begin;
+    }
+    return result;
+}
+
+bool history_read_bucket(history_tier_t tier, uint32_t pos, history_bucket_t *out) {
+    if (tier == HISTORY_TIER_RAW || tier >= HISTORY_TIER_MAX) {
+        return false;
+    }
+
+    const history_tier_store_t *t = &s_tiers[tier];
+    bucket_entry_t e;
+    if (!read_bucket_entry(t, pos, &e)) {
+        return false;
+    }
+
+    out->start_us = (int64_t)e.index * t->period_s * 1000000;
+    out->count = e.count;
+    out->temp_min = e.temp_min / 10.0f;
+    out->temp_max = e.temp_max / 10.0f;
+    out->temp_mean = e.temp_mean / 10.0f;
+    out->hum_min = e.hum_min / 10.0f;
+    out->hum_max = e.hum_max / 10.0f;
+    out->hum_mean = e.hum_mean / 10.0f;
+    out->worst_state = (system_state_t)e.worst_state;
+    return true;
+}
+
+int64_t history_tier_end_us(history_tier_t tier) {
+    if (tier == HISTORY_TIER_RAW || tier >= HISTORY_TIER_MAX) {
+        return INT64_MIN;
+    }
+
+    const history_tier_store_t *t = &s_tiers[tier];
+    unsigned head = atomic_load_explicit(&t->head, memory_order_acquire);
+    bucket_entry_t e;
+    if (head == 0 || !read_bucket_entry(t, head - 1, &e)) {
+        return INT64_MIN;
+    }
+    return ((int64_t)e.index + 1) * t->period_s * 1000000;
+}
+
+uint32_t history_tier_tail(history_tier_t tier, int64_t from_us, int64_t to_us,
+                           history_bucket_t *out, uint32_t max) {
+    if (tier == HISTORY_TIER_RAW || tier >= HISTORY_TIER_MAX || max == 0) {
+        return 0;
+    }
+
+    // Accum của writer không đọc được từ task khác => tổng hợp lại từ ring thô
+    const history_tier_store_t *t = &s_tiers[tier];
+    int64_t period_ms = (int64_t)t->period_s * 1000;
+    if (from_us > 0) {
+        from_us = from_us / (period_ms * 1000) * (period_ms * 1000);
+    }
+
+    history_iter_t it;
+    history_sample_t s;
+    bucket_accum_t acc = { .active = false };
+    uint32_t n = 0;
+
+    history_iter_begin(&it, history_range(from_us, to_us));
+    while (history_iter_next_sample(&it, &s)) {
+        uint32_t index = (uint32_t)(s.timestamp_ms / period_ms);
+        if (acc.active && acc.index != index) {
+            accum_to_bucket(&acc, t->period_s, &out[n++]);
+            acc.active = false;
+            if (n == max) {
+                return n;
+            }
+        }
+        if (!acc.active) {
+            accum_reset(&acc, index);
+        }
+        accum_add_sample(&acc, &s);
+    }
+    if (acc.active) {
+        accum_to_bucket(&acc, t->period_s, &out[n++]);
+    }
+    return n;
+}
+
+history_tier_t history_pick_tier(int64_t from_us) {
+    history_tier_t oldest_tier = HISTORY_TIER_RAW;
+    int64_t oldest_us = INT64_MAX;
+
+    for (int tier = 0; tier < HISTORY_TIER_MAX; tier++) {
+        int64_t tier_oldest = tier_oldest_us((history_tier_t)tier);
+        if (tier_oldest <= from_us) {
+            return (history_tier_t)tier;
+        }
+        if (tier_oldest < oldest_us) {
+            oldest_us = tier_oldest;
+            oldest_tier = (history_tier_t)tier;
+        }
+    }
+    return oldest_tier;
+}
+
+const char *history_tier_name(history_tier_t tier) {
+    return (tier < HISTORY_TIER_MAX) ? s_tier_names[tier] : "unknown";
+}
+
+uint32_t history_tier_period_s(history_tier_t tier) {
+    return (tier < HISTORY_TIER_MAX) ? s_tiers[tier].period_s : 0;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file history.h
+ * @brief History Store - Ring lịch sử mẫu theo thứ tự thời gian, truy vấn theo khoảng
+ * @features Vị trí logic cũ nhất -> mới nhất, tìm nhị phân theo timestamp/seq, dung lượng Kconfig,
+ *           mẫu thô nén theo khối (history_codec, giải nén khi đọc),
+ *           tầng tổng hợp 1 phút / 1 giờ (min/max/mean/count, trạng thái xấu nhất) kiểu RRD
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "config.h"
+#include "sample_bus.h"
+#include "history_codec.h"
+
+// ==================== HISTORY CONFIGURATION ====================
+
+#ifdef CONFIG_HISTORY_BLOCKS
+#define HISTORY_BLOCKS          CONFIG_HISTORY_BLOCKS
+#else
+#define HISTORY_BLOCKS          112     // menuconfig: Temperature Monitor Configuration (x256 byte)
+#endif
+
+// Cận trên số mẫu thô giữ được (thực tế phụ thuộc mức nén)
+#define HISTORY_MAX_SAMPLES     (HISTORY_BLOCKS * HISTORY_BLOCK_MAX_SAMPLES)
+
+#ifdef CONFIG_HISTORY_MINUTE_BUCKETS
+#define HISTORY_MINUTE_BUCKETS  CONFIG_HISTORY_MINUTE_BUCKETS
+#else
+#define HISTORY_MINUTE_BUCKETS  360     // 6 giờ
+#endif
+
+#ifdef CONFIG_HISTORY_HOUR_BUCKETS
+#define HISTORY_HOUR_BUCKETS    CONFIG_HISTORY_HOUR_BUCKETS
+#else
+#define HISTORY_HOUR_BUCKETS    168     // 7 ngày
+#endif
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Lịch sử dữ liệu sensor
+ */
+typedef struct {
+    sensor_data_t data;
+    system_state_t state;
+    uint32_t seq;            // Seq của mẫu trên sample bus
+} history_record_t;
+
+/**
+ * @brief Tầng lưu trữ (độ phân giải giảm dần, thời gian lưu tăng dần)
+ */
+typedef enum {
+    HISTORY_TIER_RAW = 0,       // Từng mẫu (history_record_t)
+    HISTORY_TIER_MINUTE,        // Bucket 1 phút (history_bucket_t)
+    HISTORY_TIER_HOUR,          // Bucket 1 giờ
+    HISTORY_TIER_MAX
+} history_tier_t;
+
+/**
+ * @brief 1 bucket đã tổng hợp (bucket đang tích lũy: history_tier_tail())
+ */
+typedef struct {
+    int64_t start_us;           // Đầu bucket (cùng đồng hồ với timestamp)
+    uint32_t count;             // Số mẫu hợp lệ (0 => min/max/mean không có nghĩa)
+    float temp_min, temp_max, temp_mean;
+    float hum_min, hum_max, hum_mean;
+    system_state_t worst_state; // Trạng thái xấu nhất trong bucket (OVERHEAT > WARNING > ERROR > NORMAL)
+} history_bucket_t;
+
+/**
+ * @brief Khoảng vị trí [begin, end) trong ring
+ *
+ * Vị trí tuyệt đối: bản ghi thứ n kể từ khi khởi động, tăng dần theo thời gian.
+ * Bản ghi trước begin đã bị ghi đè (cả khối nén một lúc).
+ */
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+} history_span_t;
+
+/**
+ * @brief Đọc tuần tự các bản ghi thô (giữ bản chép của khối đang giải nén)
+ */
+typedef struct {
+    uint32_t pos;               // Vị trí sẽ trả về tiếp theo
+    uint32_t end;
+    uint32_t avail;             // Số mẫu đã công bố trong bản chép
+    history_codec_t dec;
+    history_block_t block;
+} history_iter_t;
+
+/**
+ * @brief Thống kê bộ nhớ của tầng thô
+ */
+typedef struct {
+    uint32_t samples;           // Số mẫu đang giữ
+    uint32_t blocks;            // Số khối đang dùng
+    uint32_t used_bytes;        // Header + phần bit đã dùng của các khối
+    uint32_t capacity_bytes;    // RAM cấp cho ring khối
+} history_stats_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Thêm mẫu mới nhất (chỉ gọi từ 1 task - single writer, không khóa)
+ */
+void history_append(const sample_t *sample);
+
+/**
+ * @brief Khoảng các bản ghi đang có (cũ nhất -> mới nhất)
+ */
+history_span_t history_get_span(void);
+
+/**
+ * @brief Bắt đầu đọc tuần tự span (mỗi khối chỉ chép và giải nén 1 lần)
+ */
+void history_iter_begin(history_iter_t *it, history_span_t span);
+
+/**
+ * @brief Bản ghi kế tiếp (bỏ qua các bản ghi bị ghi đè trong lúc đọc)
+ * @return false khi hết span
+ */
+bool history_iter_next(history_iter_t *it, history_record_t *out);
+
+/**
+ * @brief Như history_iter_next nhưng trả mẫu dạng số nguyên (deci-unit, ms), không đổi sang float
+ */
+bool history_iter_next_sample(history_iter_t *it, history_sample_t *out);
+
+/**
+ * @brief Đọc bản ghi ở vị trí pos (giải nén từ đầu khối, đọc nhiều bản ghi => history_iter_*)
+ * @return false nếu bản ghi chưa có hoặc đã bị ghi đè trong lúc đọc
+ */
+bool history_read(uint32_t pos, history_record_t *out);
+
+/**
+ * @brief Vị trí đầu tiên trong span có timestamp >= ts_us (O(log n))
+ * @return span.end nếu không có
+ */
+uint32_t history_find_time(history_span_t span, int64_t ts_us);
+
+/**
+ * @brief Vị trí đầu tiên trong span có seq > seq (O(log n))
+ * @return span.end nếu không có
+ */
+uint32_t history_find_after_seq(history_span_t span, uint32_t seq);
+
+/**
+ * @brief Các bản ghi có from_us <= timestamp <= to_us (timestamp lưu theo ms)
+ */
+history_span_t history_range(int64_t from_us, int64_t to_us);
+
+/**
+ * @brief Các bucket của tầng tier giao với [from_us, to_us] (tier RAW => history_range)
+ */
+history_span_t history_tier_range(history_tier_t tier, int64_t from_us, int64_t to_us);
+
+/**
+ * @brief Đọc bucket ở vị trí pos của tầng MINUTE/HOUR
+ * @return false nếu chưa có hoặc đã bị ghi đè
+ */
+bool history_read_bucket(history_tier_t tier, uint32_t pos, history_bucket_t *out);
+
+/**
+ * @brief Thời điểm kết thúc bucket đã đóng mới nhất của tầng MINUTE/HOUR
+ *
+ * Mẫu từ thời điểm này trở đi chưa có ở tầng (bucket đang tích lũy) => đọc từ tầng thô.
+ * @return INT64_MIN nếu tầng chưa có bucket nào
+ */
+int64_t history_tier_end_us(history_tier_t tier);
+
+/**
+ * @brief Tổng hợp mẫu thô thành bucket theo độ dài của tầng MINUTE/HOUR
+ *
+ * Dùng cho phần chưa đóng của tầng: gọi với from_us = history_tier_end_us(tier).
+ * Lấy trọn các bucket giao với [from_us, to_us] (mẫu lỗi chỉ góp worst_state).
+ * @return Số bucket ghi vào out (tối đa max, cũ -> mới)
+ */
+uint32_t history_tier_tail(history_tier_t tier, int64_t from_us, int64_t to_us,
+                           history_bucket_t *out, uint32_t max);
+
+/**
+ * @brief Chọn tầng mịn nhất còn giữ dữ liệu từ from_us trở đi
+ *
+ * Không tầng nào đủ xa => tầng có dữ liệu cũ nhất.
+ */
+history_tier_t history_pick_tier(int64_t from_us);
+
+/**
+ * @brief Tên tầng ("raw", "1m", "1h") và độ dài bucket (giây, RAW = 0)
+ */
+const char *history_tier_name(history_tier_t tier);
+uint32_t history_tier_period_s(history_tier_t tier);
+
+/**
+ * @brief Mức dùng RAM của tầng thô
+ */
+void history_get_stats(history_stats_t *stats);
+
+#endif // HISTORY_H
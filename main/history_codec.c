@@ -0,0 +1,222 @@
+/**
+ * @file history_codec.c
+ * @brief History Codec Implementation
+ *
+ * Mỗi mẫu sau mẫu đầu được ghi thành chuỗi bit (MSB trước):
+ *
+ *   timestamp  delta-of-delta (ms), zig-zag:  '0' = 0 | '10' + 4 bit | '110' + 12 bit
+ *                                             | '1110' + 24 bit | '1111' + 64 bit
+ *   seq        '0' = seq trước + 1 | '1' + 32 bit seq
+ *   state      '0' = không đổi | '1' + 2 bit state + 1 bit is_valid
+ *   temp, hum  delta deci zig-zag:  '0' = 0 | '10' + 3 bit | '110' + 8 bit | '111' + 17 bit
+ *
+ * Chu kỳ lấy mẫu cố định và DHT22 đổi chậm nên mẫu thường chỉ tốn 6-15 bit
+ * (so với 24 byte/mẫu khi lưu nguyên).
+ */
+
+#include "history_codec.h"
+#include <string.h>
+
+// ==================== HELPER FUNCTIONS ====================
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/**
+ * @brief Ghi n bit thấp của value (n <= 64), false nếu vượt quá khối
+ *
+ * Chỉ OR vào các byte phía sau bit đã công bố => reader đang chép khối không bị ảnh hưởng.
+ */
+static bool put_bits(uint8_t *data, uint32_t *bit, uint64_t value, int n) {
+    if (*bit + n > HISTORY_BLOCK_DATA_BYTES * 8) {
+        return false;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        if ((value >> i) & 1) {
+            data[*bit >> 3] |= (uint8_t)(0x80 >> (*bit & 7));
+        }
+        (*bit)++;
+    }
+    return true;
+}
+
+static bool get_bits(const uint8_t *data, uint32_t *bit, int n, uint64_t *out) {
+    if (*bit + n > HISTORY_BLOCK_DATA_BYTES * 8) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < n; i++) {
+        value = (value << 1) | ((data[*bit >> 3] >> (7 - (*bit & 7))) & 1);
+        (*bit)++;
+    }
+    *out = value;
+    return true;
+}
+
+/**
+ * @brief Đọc prefix '1...10' (tối đa max bit 1), trả về số bit 1
+ */
+static bool get_prefix(const uint8_t *data, uint32_t *bit, int max, int *ones) {
+    uint64_t b;
+    *ones = 0;
+    while (*ones < max) {
+        if (!get_bits(data, bit, 1, &b)) {
+            return false;
+        }
+        if (b == 0) {
+            break;
+        }
+        (*ones)++;
+    }
+    return true;
+}
+
+// Bảng độ rộng theo prefix (prefix i = i bit 1, rồi bit 0 nếu i < max)
+static const uint8_t s_dod_width[] = { 0, 4, 12, 24, 64 };
+static const uint8_t s_val_width[] = { 0, 3, 8, 17 };   // 17 bit: mọi delta của int16/uint16
+
+/**
+ * @brief Ghi số zig-zag vào nhóm nhỏ nhất chứa được
+ */
+static bool put_varwidth(uint8_t *data, uint32_t *bit, uint64_t zz, const uint8_t *width, int max) {
+    int i = 0;
+    while (i < max && (width[i] == 0 ? zz != 0 : (width[i] < 64 && zz >> width[i] != 0))) {
+        i++;
+    }
+    // Prefix: i bit 1, thêm bit 0 kết thúc nếu chưa phải nhóm cuối
+    if (!put_bits(data, bit, (i < max) ? ((1ull << (i + 1)) - 2) : ((1ull << i) - 1), (i < max) ? i + 1 : i)) {
+        return false;
+    }
+    return put_bits(data, bit, zz, width[i]);
+}
+
+static bool get_varwidth(const uint8_t *data, uint32_t *bit, const uint8_t *width, int max, uint64_t *zz) {
+    int i;
+    if (!get_prefix(data, bit, max, &i)) {
+        return false;
+    }
+    *zz = 0;
+    return width[i] == 0 || get_bits(data, bit, width[i], zz);
+}
+
+// ==================== PUBLIC API ====================
+
+void history_block_init(history_block_t *block, history_codec_t *enc,
+                        uint32_t start_pos, const history_sample_t *first) {
+    memset(block->data, 0, sizeof(block->data));
+    block->start_pos = start_pos;
+    block->first = *first;
+    block->bits = 0;
+    block->count = 1;
+
+    enc->prev = *first;
+    enc->prev_delta_ms = 0;
+    enc->bit = 0;
+    enc->index = 1;
+}
+
+bool history_block_append(history_block_t *block, history_codec_t *enc, const history_sample_t *sample) {
+    const history_sample_t *prev = &enc->prev;
+    uint32_t bit = enc->bit;
+    int64_t delta = sample->timestamp_ms - prev->timestamp_ms;
+    bool state_same = (sample->state == prev->state && sample->is_valid == prev->is_valid);
+    bool ok;
+
+    if (block->count >= HISTORY_BLOCK_MAX_SAMPLES) {
+        return false;
+    }
+
+    ok = put_varwidth(block->data, &bit, zigzag(delta - enc->prev_delta_ms), s_dod_width, 4);
+    if (sample->seq == prev->seq + 1) {
+        ok = ok && put_bits(block->data, &bit, 0, 1);
+    } else {
+        ok = ok && put_bits(block->data, &bit, 1, 1) && put_bits(block->data, &bit, sample->seq, 32);
+    }
+    if (state_same) {
+        ok = ok && put_bits(block->data, &bit, 0, 1);
+    } else {
+        ok = ok && put_bits(block->data, &bit, 0x8 | ((sample->state & 0x3) << 1) | (sample->is_valid ? 1 : 0), 4);
+    }
+    ok = ok && put_varwidth(block->data, &bit, zigzag((int64_t)sample->temp_deci - prev->temp_deci), s_val_width, 3);
+    ok = ok && put_varwidth(block->data, &bit, zigzag((int64_t)sample->hum_deci - prev->hum_deci), s_val_width, 3);
+    if (!ok) {
+        return false;  // Các bit đã OR nằm sau block->bits, reader không đọc tới
+    }
+
+    enc->prev = *sample;
+    enc->prev_delta_ms = delta;
+    enc->bit = bit;
+    enc->index++;
+    block->bits = (uint16_t)bit;
+    block->count = enc->index;
+    return true;
+}
+
+void history_decoder_init(history_codec_t *dec, const history_block_t *block) {
+    dec->prev = block->first;
+    dec->prev_delta_ms = 0;
+    dec->bit = 0;
+    dec->index = 0;
+}
+
+bool history_decoder_next(history_codec_t *dec, const history_block_t *block, history_sample_t *out) {
+    uint64_t v;
+
+    if (dec->index == 0) {
+        dec->index = 1;
+        *out = dec->prev;
+        return true;
+    }
+
+    history_sample_t s = dec->prev;
+    uint32_t bit = dec->bit;
+
+    if (!get_varwidth(block->data, &bit, s_dod_width, 4, &v)) {
+        return false;
+    }
+    int64_t delta = dec->prev_delta_ms + unzigzag(v);
+    s.timestamp_ms += delta;
+
+    if (!get_bits(block->data, &bit, 1, &v)) {
+        return false;
+    }
+    if (v == 0) {
+        s.seq++;
+    } else if (get_bits(block->data, &bit, 32, &v)) {
+        s.seq = (uint32_t)v;
+    } else {
+        return false;
+    }
+
+    if (!get_bits(block->data, &bit, 1, &v)) {
+        return false;
+    }
+    if (v != 0) {
+        if (!get_bits(block->data, &bit, 3, &v)) {
+            return false;
+        }
+        s.state = (uint8_t)(v >> 1);
+        s.is_valid = (v & 1) != 0;
+    }
+
+    if (!get_varwidth(block->data, &bit, s_val_width, 3, &v)) {
+        return false;
+    }
+    s.temp_deci = (int16_t)(s.temp_deci + unzigzag(v));
+    if (!get_varwidth(block->data, &bit, s_val_width, 3, &v)) {
+        return false;
+    }
+    s.hum_deci = (uint16_t)(s.hum_deci + unzigzag(v));
+
+    dec->prev = s;
+    dec->prev_delta_ms = delta;
+    dec->bit = bit;
+    dec->index++;
+    *out = s;
+    return true;
+}
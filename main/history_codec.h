@@ -0,0 +1,86 @@
+/**
+ * @file history_codec.h
+ * @brief History Codec - Nén khối mẫu kiểu Gorilla (delta-of-delta timestamp, delta zig-zag, bit-pack)
+ * @features Khối kích thước cố định, giải nén tuần tự tại chỗ, không cấp phát động
+ *
+ * Không gọi driver nào nên có thể biên dịch và benchmark trên host.
+ */
+
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ==================== HISTORY CODEC CONFIGURATION ====================
+
+#define HISTORY_BLOCK_BYTES         256     // Kích thước 1 khối (header + dữ liệu bit)
+#define HISTORY_BLOCK_HEADER_BYTES  32
+#define HISTORY_BLOCK_DATA_BYTES    (HISTORY_BLOCK_BYTES - HISTORY_BLOCK_HEADER_BYTES)
+
+// Mẫu nhỏ nhất tốn 5 bit (mọi trường không đổi) + mẫu đầu nằm trong header
+#define HISTORY_BLOCK_MAX_SAMPLES   (HISTORY_BLOCK_DATA_BYTES * 8 / 5 + 1)
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief 1 mẫu dạng số nguyên (đơn vị DHT22: 0.1 °C, 0.1 %)
+ */
+typedef struct {
+    int64_t timestamp_ms;       // esp_timer làm tròn xuống ms
+    uint32_t seq;
+    int16_t temp_deci;
+    uint16_t hum_deci;
+    uint8_t state;              // system_state_t (2 bit)
+    bool is_valid;
+} history_sample_t;
+
+/**
+ * @brief 1 khối nén: mẫu đầu lưu nguyên, các mẫu sau là chuỗi bit so với mẫu trước
+ */
+typedef struct {
+    uint32_t start_pos;         // Vị trí tuyệt đối của mẫu đầu
+    uint16_t count;             // Số mẫu trong khối (writer tăng sau khi ghi xong bit)
+    uint16_t bits;              // Số bit dữ liệu đã dùng
+    history_sample_t first;
+    uint8_t data[HISTORY_BLOCK_DATA_BYTES];
+} history_block_t;
+
+_Static_assert(sizeof(history_block_t) == HISTORY_BLOCK_BYTES, "history_block_t layout");
+
+/**
+ * @brief Trạng thái encoder/decoder (mẫu trước, delta trước, vị trí bit)
+ */
+typedef struct {
+    history_sample_t prev;
+    int64_t prev_delta_ms;
+    uint32_t bit;
+    uint16_t index;             // Số mẫu đã ghi/đọc trong khối
+} history_codec_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Bắt đầu khối mới với mẫu đầu tiên
+ */
+void history_block_init(history_block_t *block, history_codec_t *enc,
+                        uint32_t start_pos, const history_sample_t *first);
+
+/**
+ * @brief Nối 1 mẫu vào cuối khối
+ * @return false nếu khối đã đầy (khối không thay đổi, cần bắt đầu khối mới)
+ */
+bool history_block_append(history_block_t *block, history_codec_t *enc, const history_sample_t *sample);
+
+/**
+ * @brief Đặt decoder về mẫu đầu của khối
+ */
+void history_decoder_init(history_codec_t *dec, const history_block_t *block);
+
+/**
+ * @brief Giải nén mẫu kế tiếp (caller gọi tối đa block->count lần sau history_decoder_init)
+ * @return false nếu chuỗi bit vượt quá khối (dữ liệu hỏng)
+ */
+bool history_decoder_next(history_codec_t *dec, const history_block_t *block, history_sample_t *out);
+
+#endif // HISTORY_CODEC_H
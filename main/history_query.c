@@ -0,0 +1,257 @@
+/**
+ * @file history_query.c
+ * @brief History Query Implementation
+ *
+ * Mỗi chunk cột được chia thành các đoạn liền nhau cùng bucket (timestamp tăng dần),
+ * rồi mỗi đoạn được rút gọn bằng 1 vòng lặp riêng cho hàm tổng hợp đã chọn
+ * (không rẽ nhánh theo agg trong vòng lặp, chỉ đọc 1 mảng int16).
+ *
+ * LTTB chỉ giữ trạng thái của bucket đang xét; caller đọc khoảng bằng 2 con trỏ
+ * (1 đi trước 1 bucket để tính trung bình C) nên RAM không phụ thuộc độ dài khoảng.
+ */
+
+#include "history_query.h"
+#include <string.h>
+
+static const char *const s_agg_names[HISTORY_AGG_COUNT] = { "avg", "min", "max", "p95" };
+static const char *const s_metric_names[HISTORY_METRIC_COUNT] = { "temperature", "humidity" };
+
+// ==================== HELPER FUNCTIONS ====================
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+/**
+ * @brief Chia làm tròn nửa ra xa 0 (count > 0)
+ */
+static int32_t div_round(int64_t sum, uint32_t count) {
+    int64_t half = count / 2;
+    return (int32_t)((sum >= 0) ? (sum + half) / count : (sum - half) / count);
+}
+
+static int clamp_bin(int32_t deci) {
+    if (deci < HISTORY_QUERY_DECI_MIN) return 0;
+    if (deci > HISTORY_QUERY_DECI_MAX) return HISTORY_QUERY_HIST_BINS - 1;
+    return deci - HISTORY_QUERY_DECI_MIN;
+}
+
+/**
+ * @brief Phân vị 95 theo nearest-rank, rồi xóa đoạn histogram đã dùng
+ */
+static int32_t hist_p95(history_reducer_t *r) {
+    uint32_t rank = (r->count * 95 + 99) / 100;
+    uint32_t seen = 0;
+    int lo = clamp_bin(r->min);
+    int hi = clamp_bin(r->max);
+    int bin = lo;
+
+    for (; bin < hi; bin++) {
+        seen += r->hist[bin];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    memset(&r->hist[lo], 0, (size_t)(hi - lo + 1) * sizeof(r->hist[0]));
+    return bin + HISTORY_QUERY_DECI_MIN;
+}
+
+static void bucket_open(history_reducer_t *r, int64_t start_ms) {
+    r->active = true;
+    r->start_ms = start_ms;
+    r->count = 0;
+    r->sum = 0;
+    r->min = INT16_MAX;
+    r->max = INT16_MIN;
+}
+
+static void bucket_close(history_reducer_t *r) {
+    history_query_bucket_t b = { .start_ms = r->start_ms, .count = r->count };
+
+    r->active = false;
+    if (r->count == 0) {
+        return;
+    }
+    switch (r->agg) {
+        case HISTORY_AGG_AVG: b.value_deci = div_round(r->sum, r->count); break;
+        case HISTORY_AGG_MIN: b.value_deci = r->min; break;
+        case HISTORY_AGG_MAX: b.value_deci = r->max; break;
+        default:              b.value_deci = hist_p95(r); break;
+    }
+    r->emit(r->ctx, &b);
+}
+
+/**
+ * @brief Chuyển sang bucket chứa ts_ms (đóng bucket cũ nếu khác)
+ */
+static int64_t bucket_enter(history_reducer_t *r, int64_t ts_ms) {
+    int64_t start_ms = floor_div(ts_ms, r->period_ms) * r->period_ms;
+
+    if (r->active && r->start_ms != start_ms) {
+        bucket_close(r);
+    }
+    if (!r->active) {
+        bucket_open(r, start_ms);
+    }
+    return start_ms + r->period_ms;
+}
+
+/**
+ * @brief Rút gọn đoạn v[0..n) cùng bucket
+ */
+static void reduce_run(history_reducer_t *r, const int16_t *v, uint32_t n) {
+    int16_t lo = r->min;
+    int16_t hi = r->max;
+    int32_t sum = 0;
+
+    switch (r->agg) {
+        case HISTORY_AGG_AVG:
+            for (uint32_t i = 0; i < n; i++) {
+                sum += v[i];
+            }
+            r->sum += sum;
+            break;
+        case HISTORY_AGG_MIN:
+            for (uint32_t i = 0; i < n; i++) {
+                lo = (v[i] < lo) ? v[i] : lo;
+            }
+            break;
+        case HISTORY_AGG_MAX:
+            for (uint32_t i = 0; i < n; i++) {
+                hi = (v[i] > hi) ? v[i] : hi;
+            }
+            break;
+        default:
+            for (uint32_t i = 0; i < n; i++) {
+                lo = (v[i] < lo) ? v[i] : lo;
+                hi = (v[i] > hi) ? v[i] : hi;
+                r->hist[clamp_bin(v[i])]++;
+            }
+            break;
+    }
+    r->min = lo;
+    r->max = hi;
+    r->count += n;
+}
+
+// ==================== PUBLIC API ====================
+
+void history_reducer_init(history_reducer_t *r, history_agg_t agg, int64_t period_ms,
+                          history_query_emit_t emit, void *ctx) {
+    memset(r->hist, 0, sizeof(r->hist));
+    r->agg = agg;
+    r->period_ms = (period_ms > 0) ? period_ms : 1;
+    r->emit = emit;
+    r->ctx = ctx;
+    r->active = false;
+}
+
+void history_reducer_add_column(history_reducer_t *r, const int64_t *ts_ms, const int16_t *value, uint32_t n) {
+    uint32_t i = 0;
+
+    while (i < n) {
+        int64_t end_ms = bucket_enter(r, ts_ms[i]);
+        uint32_t j = i + 1;
+        while (j < n && ts_ms[j] < end_ms) {
+            j++;
+        }
+        reduce_run(r, value + i, j - i);
+        i = j;
+    }
+}
+
+void history_reducer_add_summary(history_reducer_t *r, int64_t ts_ms, uint32_t count,
+                                 int64_t sum, int16_t min, int16_t max) {
+    if (count == 0 || r->agg == HISTORY_AGG_P95) {
+        return;
+    }
+    bucket_enter(r, ts_ms);
+    r->count += count;
+    r->sum += sum;
+    r->min = (min < r->min) ? min : r->min;
+    r->max = (max > r->max) ? max : r->max;
+}
+
+void history_reducer_finish(history_reducer_t *r) {
+    if (r->active) {
+        bucket_close(r);
+    }
+}
+
+void history_lttb_begin(history_lttb_t *l, const history_sample_t *a, int64_t c_ts_ms, int64_t c_temp,
+                        uint8_t spike_state) {
+    l->ax_ms = a->timestamp_ms;
+    l->ay = (int64_t)a->temp_deci * HISTORY_LTTB_Y_SCALE;
+    l->cx_ms = c_ts_ms;
+    l->cy = c_temp;
+    l->spike_state = spike_state;
+    l->found = false;
+    l->spike = false;
+    l->best_area = 0;
+}
+
+void history_lttb_offer(history_lttb_t *l, const history_sample_t *s) {
+    if (!s->is_valid) {
+        return;
+    }
+
+    // Quá nhiệt: giữ đỉnh thay vì điểm có diện tích lớn nhất (đỉnh ngắn có thể bị tam giác bỏ qua)
+    if (s->state == l->spike_state) {
+        if (!l->spike || s->temp_deci > l->best.temp_deci) {
+            l->best = *s;
+            l->spike = true;
+            l->found = true;
+        }
+        return;
+    }
+    if (l->spike) {
+        return;
+    }
+
+    // 2 lần diện tích tam giác ABC
+    int64_t by = (int64_t)s->temp_deci * HISTORY_LTTB_Y_SCALE;
+    int64_t cross = (l->ax_ms - l->cx_ms) * (by - l->ay) - (l->ax_ms - s->timestamp_ms) * (l->cy - l->ay);
+    uint64_t area = (cross < 0) ? (uint64_t)0 - (uint64_t)cross : (uint64_t)cross;
+
+    if (!l->found || area > l->best_area) {
+        l->best = *s;
+        l->best_area = area;
+        l->found = true;
+    }
+}
+
+bool history_lttb_end(const history_lttb_t *l, history_sample_t *out) {
+    if (l->found) {
+        *out = l->best;
+    }
+    return l->found;
+}
+
+const char *history_agg_name(history_agg_t agg) {
+    return (agg < HISTORY_AGG_COUNT) ? s_agg_names[agg] : "unknown";
+}
+
+bool history_agg_parse(const char *name, history_agg_t *out) {
+    for (int i = 0; i < HISTORY_AGG_COUNT; i++) {
+        if (strcmp(name, s_agg_names[i]) == 0) {
+            *out = (history_agg_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *history_metric_name(history_metric_t metric) {
+    return (metric < HISTORY_METRIC_COUNT) ? s_metric_names[metric] : "unknown";
+}
+
+bool history_metric_parse(const char *name, history_metric_t *out) {
+    for (int i = 0; i < HISTORY_METRIC_COUNT; i++) {
+        if (strcmp(name, s_metric_names[i]) == 0) {
+            *out = (history_metric_t)i;
+            return true;
+        }
+    }
+    return false;
+}
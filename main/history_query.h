@@ -0,0 +1,165 @@
+/**
+ * @file history_query.h
+ * @brief History Query - Tổng hợp theo bucket thời gian (avg/min/max/p95) trên dữ liệu dạng cột,
+ *        giảm mẫu LTTB cho biểu đồ
+ * @features Chunk struct-of-arrays (timestamp, nhiệt độ, độ ẩm), vòng rút gọn trên mảng int16 liền nhau,
+ *           p95 chính xác bằng histogram 0.1 đơn vị, bucket đóng được đẩy ra callback ngay (stream),
+ *           LTTB số nguyên giữ mẫu nóng nhất của bucket có trạng thái quá nhiệt
+ *
+ * Không gọi driver nào nên có thể biên dịch và benchmark trên host.
+ */
+
+#ifndef HISTORY_QUERY_H
+#define HISTORY_QUERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "history_codec.h"
+
+// ==================== HISTORY QUERY CONFIGURATION ====================
+
+#define HISTORY_QUERY_CHUNK         64      // Số mẫu mỗi chunk cột
+
+// Miền giá trị của histogram p95 (deci): -40.0 °C .. 100.0 % (dải đo của DHT22)
+#define HISTORY_QUERY_DECI_MIN      (-400)
+#define HISTORY_QUERY_DECI_MAX      1000
+#define HISTORY_QUERY_HIST_BINS     (HISTORY_QUERY_DECI_MAX - HISTORY_QUERY_DECI_MIN + 1)
+
+#define HISTORY_LTTB_Y_SCALE        16      // Trung bình nhiệt độ giữ thêm 4 bit lẻ
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Hàm tổng hợp
+ */
+typedef enum {
+    HISTORY_AGG_AVG = 0,
+    HISTORY_AGG_MIN,
+    HISTORY_AGG_MAX,
+    HISTORY_AGG_P95,
+    HISTORY_AGG_COUNT
+} history_agg_t;
+
+/**
+ * @brief Đại lượng được tổng hợp
+ */
+typedef enum {
+    HISTORY_METRIC_TEMPERATURE = 0,
+    HISTORY_METRIC_HUMIDITY,
+    HISTORY_METRIC_COUNT
+} history_metric_t;
+
+/**
+ * @brief 1 chunk mẫu hợp lệ dạng cột (struct-of-arrays), timestamp tăng dần
+ */
+typedef struct {
+    uint32_t count;
+    int64_t ts_ms[HISTORY_QUERY_CHUNK];
+    int16_t value[HISTORY_METRIC_COUNT][HISTORY_QUERY_CHUNK];   // 0.1 °C / 0.1 %
+} history_columns_t;
+
+/**
+ * @brief 1 bucket kết quả
+ */
+typedef struct {
+    int64_t start_ms;           // Đầu bucket (bội của period_ms, cùng đồng hồ với timestamp)
+    uint32_t count;             // Số mẫu trong bucket (> 0)
+    int32_t value_deci;         // Kết quả (avg làm tròn tới 0.1)
+} history_query_bucket_t;
+
+/**
+ * @brief Nhận bucket vừa đóng (theo thứ tự thời gian)
+ */
+typedef void (*history_query_emit_t)(void *ctx, const history_query_bucket_t *bucket);
+
+/**
+ * @brief Trạng thái rút gọn của bucket đang mở (~6 KB do histogram => không đặt trên stack httpd)
+ */
+typedef struct {
+    history_agg_t agg;
+    int64_t period_ms;
+    history_query_emit_t emit;
+    void *ctx;
+    bool active;                // Có bucket đang mở
+    int64_t start_ms;
+    uint32_t count;
+    int64_t sum;
+    int16_t min;
+    int16_t max;
+    uint32_t hist[HISTORY_QUERY_HIST_BINS];   // Chỉ dùng cho p95, chỉ xóa đoạn [min, max]
+} history_reducer_t;
+
+/**
+ * @brief Chọn 1 mẫu của 1 bucket LTTB (Largest-Triangle-Three-Buckets)
+ *
+ * Tam giác: A = mẫu đã chọn của bucket trước, B = ứng viên, C = trung bình bucket sau.
+ * Trục x = timestamp (ms), trục y = nhiệt độ; tính bằng int64, không dùng float.
+ */
+typedef struct {
+    int64_t ax_ms;
+    int64_t ay;                 // deci * HISTORY_LTTB_Y_SCALE
+    int64_t cx_ms;
+    int64_t cy;
+    uint8_t spike_state;        // Bucket có mẫu ở trạng thái này => giữ mẫu nóng nhất
+    bool found;
+    bool spike;
+    uint64_t best_area;
+    history_sample_t best;
+} history_lttb_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Khởi tạo bộ rút gọn
+ * @param period_ms Độ dài bucket (> 0)
+ */
+void history_reducer_init(history_reducer_t *r, history_agg_t agg, int64_t period_ms,
+                          history_query_emit_t emit, void *ctx);
+
+/**
+ * @brief Cộng n giá trị của 1 cột (ts tăng dần), bucket đóng được emit ngay
+ */
+void history_reducer_add_column(history_reducer_t *r, const int64_t *ts_ms, const int16_t *value, uint32_t n);
+
+/**
+ * @brief Cộng 1 bucket đã tổng hợp sẵn (tầng 1m/1h) nằm trọn trong 1 bucket kết quả
+ *
+ * Không dùng được cho p95 (phân vị không cộng dồn được).
+ */
+void history_reducer_add_summary(history_reducer_t *r, int64_t ts_ms, uint32_t count,
+                                 int64_t sum, int16_t min, int16_t max);
+
+/**
+ * @brief Đóng bucket cuối (nếu có)
+ */
+void history_reducer_finish(history_reducer_t *r);
+
+/**
+ * @brief Bắt đầu bucket LTTB
+ * @param a Mẫu đã chọn của bucket trước (bucket đầu: mẫu đầu tiên của khoảng)
+ * @param c_ts_ms, c_temp Trung bình bucket sau (nhiệt độ theo deci * HISTORY_LTTB_Y_SCALE)
+ */
+void history_lttb_begin(history_lttb_t *l, const history_sample_t *a, int64_t c_ts_ms, int64_t c_temp,
+                        uint8_t spike_state);
+
+/**
+ * @brief Xét 1 mẫu của bucket (mẫu không hợp lệ bị bỏ qua)
+ */
+void history_lttb_offer(history_lttb_t *l, const history_sample_t *s);
+
+/**
+ * @brief Mẫu được chọn
+ * @return false nếu bucket không có mẫu hợp lệ
+ */
+bool history_lttb_end(const history_lttb_t *l, history_sample_t *out);
+
+/**
+ * @brief Tên ("avg", "min", "max", "p95"; "temperature", "humidity") và phép ngược lại
+ * @return false nếu không có tên tương ứng
+ */
+const char *history_agg_name(history_agg_t agg);
+bool history_agg_parse(const char *name, history_agg_t *out);
+const char *history_metric_name(history_metric_t metric);
+bool history_metric_parse(const char *name, history_metric_t *out);
+
+#endif // HISTORY_QUERY_H
@@ -0,0 +1,239 @@
+/**
+ * @file i2c_bus.c
+ * @brief I2C Bus Manager Implementation
+ *
+ * Bus task là chủ sở hữu duy nhất của I2C_MASTER_NUM. Các task khác chỉ đưa
+ * transaction vào hàng đợi theo mức ưu tiên và nhận kết quả qua callback,
+ * nên không task ứng dụng nào phải giữ mutex hay chờ bus.
+ */
+
+#include "i2c_bus.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "I2C_BUS";
+
+// ==================== GLOBAL STATE ====================
+
+static i2c_master_bus_handle_t s_bus = NULL;
+static TaskHandle_t s_bus_task = NULL;
+static QueueHandle_t s_queue[I2C_BUS_PRIO_MAX] = {NULL};
+
+// Đồng bộ với ISR on_trans_done của driver (chế độ async)
+static SemaphoreHandle_t s_done_sem = NULL;
+static volatile esp_err_t s_done_result = ESP_OK;
+
+static i2c_bus_stats_t s_stats = {0};
+static uint64_t s_latency_total_us = 0;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Context cho i2c_bus_transmit_sync()
+ */
+typedef struct {
+    TaskHandle_t waiter;
+    esp_err_t result;
+} sync_ctx_t;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief ISR callback của driver khi transaction bất đồng bộ kết thúc
+ */
+static bool IRAM_ATTR on_trans_done(i2c_master_dev_handle_t dev,
+                                    const i2c_master_event_data_t *evt_data, void *arg) {
+    BaseType_t woken = pdFALSE;
+
+    switch (evt_data->event) {
+        case I2C_EVENT_DONE:    s_done_result = ESP_OK; break;
+        case I2C_EVENT_NACK:    s_done_result = ESP_ERR_INVALID_RESPONSE; break;
+        default:                s_done_result = ESP_ERR_TIMEOUT; break;
+    }
+
+    xSemaphoreGiveFromISR(s_done_sem, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief Thực hiện 1 transaction (chỉ gọi từ bus task)
+ */
+static void execute_xfer(const i2c_bus_xfer_t *xfer) {
+    int64_t start_us = esp_timer_get_time();
+    uint32_t latency_us = (uint32_t)(start_us - xfer->enqueue_us);
+
+    // Xóa tín hiệu cũ (nếu transaction trước bị timeout muộn)
+    xSemaphoreTake(s_done_sem, 0);
+
+    // Ở chế độ async, i2c_master_transmit() chỉ nạp transaction vào driver và trả về ngay
+    esp_err_t ret = i2c_master_transmit(xfer->dev, xfer->tx, xfer->tx_len, I2C_MASTER_TIMEOUT_MS);
+    if (ret == ESP_OK) {
+        if (xSemaphoreTake(s_done_sem, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS)) == pdTRUE) {
+            ret = s_done_result;
+        } else {
+            ret = ESP_ERR_TIMEOUT;
+        }
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    if (ret == ESP_OK) {
+        s_stats.completed++;
+        s_stats.bytes += xfer->tx_len;
+    } else {
+        s_stats.failed++;
+    }
+    s_latency_total_us += latency_us;
+    if (latency_us > s_stats.latency_max_us) {
+        s_stats.latency_max_us = latency_us;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Transaction failed: %s", esp_err_to_name(ret));
+    }
+
+    if (xfer->done_cb) {
+        xfer->done_cb(ret, xfer->arg);
+    }
+}
+
+/**
+ * @brief Bus task: luôn lấy hàng đợi HIGH trước, sau đó NORMAL
+ */
+static void i2c_bus_task(void *pvParameters) {
+    i2c_bus_xfer_t xfer;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (xQueueReceive(s_queue[I2C_BUS_PRIO_HIGH], &xfer, 0) == pdTRUE ||
+               xQueueReceive(s_queue[I2C_BUS_PRIO_NORMAL], &xfer, 0) == pdTRUE) {
+            execute_xfer(&xfer);
+        }
+    }
+}
+
+/**
+ * @brief Callback cho i2c_bus_transmit_sync()
+ */
+static void sync_done_cb(esp_err_t result, void *arg) {
+    sync_ctx_t *ctx = (sync_ctx_t *)arg;
+    ctx->result = result;
+    xTaskNotifyGive(ctx->waiter);
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t i2c_bus_init(void) {
+    i2c_master_bus_config_t bus_config = {
+        .i2c_port = I2C_MASTER_NUM,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .trans_queue_depth = 1,     // Bật chế độ async; bus task chỉ nạp 1 transaction mỗi lần
+        .flags.enable_internal_pullup = true,
+    };
+
+    esp_err_t err = i2c_new_master_bus(&bus_config, &s_bus);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "I2C bus create failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_done_sem = xSemaphoreCreateBinary();
+    for (int i = 0; i < I2C_BUS_PRIO_MAX; i++) {
+        s_queue[i] = xQueueCreate(I2C_BUS_QUEUE_LEN, sizeof(i2c_bus_xfer_t));
+    }
+    if (s_done_sem == NULL || s_queue[I2C_BUS_PRIO_HIGH] == NULL || s_queue[I2C_BUS_PRIO_NORMAL] == NULL) {
+        ESP_LOGE(TAG, "Failed to create bus queues");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(i2c_bus_task, "i2c_bus_task", I2C_BUS_TASK_STACK, NULL,
+                    I2C_BUS_TASK_PRIORITY, &s_bus_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create bus task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "I2C bus manager initialized (SDA=%d, SCL=%d)",
+             I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_add_device(uint16_t addr, uint32_t scl_hz, i2c_master_dev_handle_t *out_dev) {
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = addr,
+        .scl_speed_hz = scl_hz,
+    };
+
+    esp_err_t err = i2c_master_bus_add_device(s_bus, &dev_config, out_dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Add device 0x%02X failed: %s", addr, esp_err_to_name(err));
+        return err;
+    }
+
+    // Đăng ký callback => mọi transaction của thiết bị trở thành bất đồng bộ
+    const i2c_master_event_callbacks_t cbs = {
+        .on_trans_done = on_trans_done,
+    };
+    return i2c_master_register_event_callbacks(*out_dev, &cbs, NULL);
+}
+
+esp_err_t i2c_bus_submit(const i2c_bus_xfer_t *xfer, i2c_bus_prio_t prio) {
+    if (xfer == NULL || xfer->dev == NULL || prio >= I2C_BUS_PRIO_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    i2c_bus_xfer_t item = *xfer;
+    item.enqueue_us = esp_timer_get_time();
+
+    if (xQueueSend(s_queue[prio], &item, 0) != pdTRUE) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.rejected++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t depth = uxQueueMessagesWaiting(s_queue[prio]);
+    taskENTER_CRITICAL(&s_stats_lock);
+    if (depth > s_stats.queue_high_watermark) {
+        s_stats.queue_high_watermark = depth;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    xTaskNotifyGive(s_bus_task);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_transmit_sync(i2c_master_dev_handle_t dev, const uint8_t *tx, size_t tx_len) {
+    sync_ctx_t ctx = {
+        .waiter = xTaskGetCurrentTaskHandle(),
+        .result = ESP_ERR_TIMEOUT,
+    };
+    i2c_bus_xfer_t xfer = {
+        .dev = dev,
+        .tx = tx,
+        .tx_len = tx_len,
+        .done_cb = sync_done_cb,
+        .arg = &ctx,
+    };
+
+    esp_err_t err = i2c_bus_submit(&xfer, I2C_BUS_PRIO_HIGH);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // ctx nằm trên stack => phải chờ tới khi callback chạy xong
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return ctx.result;
+}
+
+void i2c_bus_get_stats(i2c_bus_stats_t *stats) {
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    uint32_t executed = s_stats.completed + s_stats.failed;
+    stats->latency_avg_us = executed ? (uint32_t)(s_latency_total_us / executed) : 0;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file i2c_bus.h
+ * @brief I2C Bus Manager - Hàng đợi transaction bất đồng bộ cho I2C_MASTER_NUM
+ * @features Ưu tiên HIGH/NORMAL, callback hoàn thành, không task nào phải chờ bus
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "config.h"
+#include "driver/i2c_master.h"
+
+// ==================== I2C BUS CONFIGURATION ====================
+
+#define I2C_BUS_QUEUE_LEN           16      // Số transaction chờ tối đa mỗi mức ưu tiên
+#define I2C_BUS_TASK_STACK          3072
+#define I2C_BUS_TASK_PRIORITY       6       // Cao hơn mọi task ứng dụng
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Mức ưu tiên của transaction (HIGH luôn được phục vụ trước)
+ */
+typedef enum {
+    I2C_BUS_PRIO_HIGH = 0,
+    I2C_BUS_PRIO_NORMAL,
+    I2C_BUS_PRIO_MAX
+} i2c_bus_prio_t;
+
+/**
+ * @brief Callback khi transaction hoàn thành (chạy trong context của bus task)
+ */
+typedef void (*i2c_bus_done_cb_t)(esp_err_t result, void *arg);
+
+/**
+ * @brief Một transaction ghi I2C
+ *
+ * Buffer tx phải còn hợp lệ cho tới khi done_cb được gọi.
+ */
+typedef struct {
+    i2c_master_dev_handle_t dev;    // Thiết bị đích (từ i2c_bus_add_device)
+    const uint8_t *tx;              // Dữ liệu gửi (gồm cả control byte nếu có)
+    size_t tx_len;
+    i2c_bus_done_cb_t done_cb;      // Có thể NULL
+    void *arg;
+    int64_t enqueue_us;             // Nội bộ: thời điểm vào hàng đợi
+} i2c_bus_xfer_t;
+
+/**
+ * @brief Thống kê bus manager
+ */
+typedef struct {
+    uint32_t completed;             // Số transaction thành công
+    uint32_t failed;                // Số transaction lỗi (NACK/timeout)
+    uint32_t rejected;              // Số lần submit khi hàng đợi đầy
+    uint32_t bytes;                 // Tổng số byte payload đã gửi
+    uint32_t queue_high_watermark;  // Độ sâu hàng đợi lớn nhất quan sát được
+    uint32_t latency_avg_us;        // Độ trễ xếp hàng trung bình (submit -> bắt đầu)
+    uint32_t latency_max_us;        // Độ trễ xếp hàng lớn nhất
+} i2c_bus_stats_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Khởi tạo bus I2C (driver/i2c_master.h) và bus task
+ * @return ESP_OK nếu thành công
+ */
+esp_err_t i2c_bus_init(void);
+
+/**
+ * @brief Thêm thiết bị 7-bit vào bus, chuyển thiết bị sang chế độ bất đồng bộ
+ */
+esp_err_t i2c_bus_add_device(uint16_t addr, uint32_t scl_hz, i2c_master_dev_handle_t *out_dev);
+
+/**
+ * @brief Đưa transaction vào hàng đợi (không bao giờ chờ bus)
+ * @return ESP_OK, hoặc ESP_ERR_NO_MEM nếu hàng đợi đầy
+ */
+esp_err_t i2c_bus_submit(const i2c_bus_xfer_t *xfer, i2c_bus_prio_t prio);
+
+/**
+ * @brief Gửi và chờ kết quả (chỉ dùng lúc khởi tạo)
+ *
+ * Luôn trả về sau tối đa I2C_MASTER_TIMEOUT_MS cho mỗi transaction đang xếp hàng,
+ * vì bus task giới hạn thời gian chờ của từng transaction.
+ */
+esp_err_t i2c_bus_transmit_sync(i2c_master_dev_handle_t dev, const uint8_t *tx, size_t tx_len);
+
+/**
+ * @brief Lấy thống kê bus manager
+ */
+void i2c_bus_get_stats(i2c_bus_stats_t *stats);
+
+#endif // I2C_BUS_H
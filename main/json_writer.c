@@ -0,0 +1,252 @@
+/**
+ * @file json_writer.c
+ * @brief JSON Writer Implementation
+ *
+ * Số được định dạng bằng phép chia nguyên vào buffer tạm rồi chép 1 lần,
+ * tránh vfprintf và float mềm (soft-float) của newlib trên ESP32-C3.
+ */
+
+#include "json_writer.h"
+#include <string.h>
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Gửi buf ra sink và làm rỗng buf
+ */
+static void flush_block(json_writer_t *w) {
+    if (w->len == 0 || w->err != ESP_OK) {
+        return;
+    }
+    if (w->sink == NULL) {
+        w->err = ESP_ERR_NO_MEM;
+        return;
+    }
+    w->err = w->sink(w->ctx, w->buf, w->len);
+    w->flushed = true;
+    w->len = 0;
+}
+
+static void put(json_writer_t *w, const char *data, size_t len) {
+    while (len > 0 && w->err == ESP_OK) {
+        if (w->len == JSON_WRITER_CHUNK) {
+            flush_block(w);
+            continue;
+        }
+        size_t n = JSON_WRITER_CHUNK - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void put_char(json_writer_t *w, char c) {
+    put(w, &c, 1);
+}
+
+/**
+ * @brief Dấu phẩy trước phần tử thứ 2 trở đi (không áp dụng cho giá trị sau key)
+ */
+static void begin_value(json_writer_t *w) {
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    if (w->depth == 0) {
+        return;
+    }
+
+    uint8_t bit = 1u << (w->depth - 1);
+    if (w->has_items & bit) {
+        put_char(w, ',');
+    }
+    w->has_items |= bit;
+}
+
+static void begin_container(json_writer_t *w, char open) {
+    begin_value(w);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    put_char(w, open);
+    w->depth++;
+    w->has_items &= ~(1u << (w->depth - 1));
+}
+
+static void end_container(json_writer_t *w, char close) {
+    if (w->depth == 0) {
+        w->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    w->depth--;
+    put_char(w, close);
+}
+
+/**
+ * @brief Ghi chuỗi có ngoặc kép, escape ", \ và ký tự điều khiển
+ */
+static void put_quoted(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    const char *run = s;
+
+    put_char(w, '"');
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        put(w, run, s - run);
+        run = s + 1;
+        if (c == '"' || c == '\\') {
+            char esc[2] = { '\\', (char)c };
+            put(w, esc, 2);
+        } else {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F] };
+            put(w, esc, 6);
+        }
+    }
+    put(w, run, s - run);
+    put_char(w, '"');
+}
+
+/**
+ * @brief Ghi số nguyên không dấu (chữ số được sinh ngược vào buffer tạm)
+ */
+static void put_uint(json_writer_t *w, uint64_t value) {
+    char tmp[20];
+    int pos = sizeof(tmp);
+
+    do {
+        tmp[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    put(w, tmp + pos, sizeof(tmp) - pos);
+}
+
+// ==================== PUBLIC API ====================
+
+void json_writer_init(json_writer_t *w, json_sink_t sink, void *ctx) {
+    w->sink = sink;
+    w->ctx = ctx;
+    w->err = ESP_OK;
+    w->flushed = false;
+    w->after_key = false;
+    w->depth = 0;
+    w->has_items = 0;
+    w->len = 0;
+}
+
+esp_err_t json_writer_flush(json_writer_t *w) {
+    if (w->sink != NULL) {
+        flush_block(w);
+    }
+    return w->err;
+}
+
+void json_begin_object(json_writer_t *w) {
+    begin_container(w, '{');
+}
+
+void json_end_object(json_writer_t *w) {
+    end_container(w, '}');
+}
+
+void json_begin_array(json_writer_t *w) {
+    begin_container(w, '[');
+}
+
+void json_end_array(json_writer_t *w) {
+    end_container(w, ']');
+}
+
+void json_key(json_writer_t *w, const char *key) {
+    begin_value(w);
+    put_quoted(w, key);
+    put_char(w, ':');
+    w->after_key = true;
+}
+
+void json_string(json_writer_t *w, const char *value) {
+    begin_value(w);
+    put_quoted(w, value);
+}
+
+void json_uint(json_writer_t *w, uint64_t value) {
+    begin_value(w);
+    put_uint(w, value);
+}
+
+void json_int(json_writer_t *w, int64_t value) {
+    begin_value(w);
+    if (value < 0) {
+        put_char(w, '-');
+        put_uint(w, (uint64_t)0 - (uint64_t)value);
+    } else {
+        put_uint(w, (uint64_t)value);
+    }
+}
+
+void json_bool(json_writer_t *w, bool value) {
+    begin_value(w);
+    if (value) {
+        put(w, "true", 4);
+    } else {
+        put(w, "false", 5);
+    }
+}
+
+void json_null(json_writer_t *w) {
+    begin_value(w);
+    put(w, "null", 4);
+}
+
+void json_deci(json_writer_t *w, int32_t deci) {
+    uint32_t abs_deci = (deci < 0) ? (uint32_t)0 - (uint32_t)deci : (uint32_t)deci;
+    char frac[2] = { '.', (char)('0' + abs_deci % 10) };
+
+    begin_value(w);
+    if (deci < 0) {
+        put_char(w, '-');
+    }
+    put_uint(w, abs_deci / 10);
+    put(w, frac, 2);
+}
+
+void json_float1(json_writer_t *w, float value) {
+    // NaN không bằng chính nó; ngoài khoảng int32/10 coi như không hợp lệ
+    if (value != value || value > 2.0e8f || value < -2.0e8f) {
+        json_null(w);
+        return;
+    }
+    json_deci(w, (int32_t)(value * 10.0f + (value >= 0 ? 0.5f : -0.5f)));
+}
+
+void json_field_string(json_writer_t *w, const char *key, const char *value) {
+    json_key(w, key);
+    json_string(w, value);
+}
+
+void json_field_uint(json_writer_t *w, const char *key, uint64_t value) {
+    json_key(w, key);
+    json_uint(w, value);
+}
+
+void json_field_int(json_writer_t *w, const char *key, int64_t value) {
+    json_key(w, key);
+    json_int(w, value);
+}
+
+void json_field_bool(json_writer_t *w, const char *key, bool value) {
+    json_key(w, key);
+    json_bool(w, value);
+}
+
+void json_field_float1(json_writer_t *w, const char *key, float value) {
+    json_key(w, key);
+    json_float1(w, value);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file json_writer.h
+ * @brief JSON Writer - Ghi JSON tuần tự vào buffer cố định, đẩy ra sink theo từng khối
+ * @features RAM cố định cho mọi độ dài, số thập phân 1 chữ số bằng số nguyên (không printf float)
+ *
+ * Không gọi driver nào nên có thể biên dịch và chạy trên host.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// ==================== JSON WRITER CONFIGURATION ====================
+
+#define JSON_WRITER_CHUNK       512     // Kích thước khối gửi ra sink
+#define JSON_WRITER_MAX_DEPTH   8       // Số object/array lồng nhau tối đa
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Nơi nhận từng khối dữ liệu (VD: httpd_resp_send_chunk)
+ */
+typedef esp_err_t (*json_sink_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief Trạng thái writer (thường đặt trên stack của handler)
+ */
+typedef struct {
+    json_sink_t sink;           // NULL => chỉ ghi vào buf, tràn => ESP_ERR_NO_MEM
+    void *ctx;
+    esp_err_t err;              // Lỗi đầu tiên, các lần ghi sau bị bỏ qua
+    bool flushed;               // Đã có khối nào được gửi ra sink chưa
+    bool after_key;             // Giá trị kế tiếp thuộc về key vừa ghi
+    uint8_t depth;
+    uint8_t has_items;          // Bit i: container ở độ sâu i đã có phần tử
+    size_t len;
+    char buf[JSON_WRITER_CHUNK];
+} json_writer_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Khởi tạo writer
+ * @param sink Hàm nhận khối dữ liệu, NULL nếu chỉ cần JSON trong buf (tin ngắn)
+ */
+void json_writer_init(json_writer_t *w, json_sink_t sink, void *ctx);
+
+/**
+ * @brief Gửi phần còn lại trong buf ra sink
+ * @return Lỗi đầu tiên gặp phải khi ghi (ESP_OK nếu không có)
+ */
+esp_err_t json_writer_flush(json_writer_t *w);
+
+// Container
+void json_begin_object(json_writer_t *w);
+void json_end_object(json_writer_t *w);
+void json_begin_array(json_writer_t *w);
+void json_end_array(json_writer_t *w);
+
+/**
+ * @brief Ghi key của object (giá trị ghi ngay sau đó)
+ */
+void json_key(json_writer_t *w, const char *key);
+
+// Giá trị
+void json_string(json_writer_t *w, const char *value);
+void json_uint(json_writer_t *w, uint64_t value);
+void json_int(json_writer_t *w, int64_t value);
+void json_bool(json_writer_t *w, bool value);
+void json_null(json_writer_t *w);
+
+/**
+ * @brief Ghi số fixed-point 1 chữ số thập phân: 253 => 25.3, -5 => -0.5
+ */
+void json_deci(json_writer_t *w, int32_t deci);
+
+/**
+ * @brief Làm tròn float về 0.1 rồi ghi bằng json_deci (NaN/Inf => null)
+ */
+void json_float1(json_writer_t *w, float value);
+
+// Cặp key/giá trị
+void json_field_string(json_writer_t *w, const char *key, const char *value);
+void json_field_uint(json_writer_t *w, const char *key, uint64_t value);
+void json_field_int(json_writer_t *w, const char *key, int64_t value);
+void json_field_bool(json_writer_t *w, const char *key, bool value);
+void json_field_float1(json_writer_t *w, const char *key, float value);
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,164 @@
+/**
+ * @file latency.c
+ * @brief Latency Instrumentation Implementation
+ *
+ * Mỗi giai đoạn có 1 histogram bucket log2: ghi chỉ tốn 1 lần đếm bit và vài
+ * phép cộng trong critical section, nên có thể để bật thường xuyên.
+ */
+
+#include "latency.h"
+#include "esp_timer.h"
+#include <string.h>
+
+// ==================== GLOBAL STATE ====================
+
+static latency_hist_t s_stages[LATENCY_STAGE_MAX];
+static int64_t s_last_fire_us = 0;
+static int64_t s_prev_fire_us = 0;     // 0 => không tính jitter cho lần kế tiếp
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const s_stage_names[LATENCY_STAGE_MAX] = {
+    [LATENCY_STAGE_WAKE]    = "wake",
+    [LATENCY_STAGE_READ]    = "read",
+    [LATENCY_STAGE_PUBLISH] = "publish",
+    [LATENCY_STAGE_DISPLAY] = "display",
+    [LATENCY_STAGE_ALERT]   = "alert",
+    [LATENCY_STAGE_WEB]     = "web",
+    [LATENCY_STAGE_PUSH]    = "push",
+    [LATENCY_STAGE_JITTER]  = "jitter",
+};
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Chỉ số bucket: floor(log2(value)), 0 và 1 cùng vào bucket 0
+ */
+static inline int bucket_index(uint32_t value_us) {
+    if (value_us < 2) {
+        return 0;
+    }
+    int idx = 31 - __builtin_clz(value_us);
+    return (idx < LATENCY_BUCKETS) ? idx : LATENCY_BUCKETS - 1;
+}
+
+/**
+ * @brief Cận trên của bucket chứa phân vị pct (%), không vượt quá max
+ */
+static uint32_t bucket_percentile(const latency_hist_t *hist, uint32_t pct) {
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    uint32_t target = (uint32_t)(((uint64_t)hist->count * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            uint32_t upper = (i >= 31) ? UINT32_MAX : (2u << i) - 1;
+            return (upper < hist->max_us) ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+// ==================== PUBLIC API ====================
+
+void latency_hist_record(latency_hist_t *hist, uint32_t value_us) {
+    int idx = bucket_index(value_us);
+
+    taskENTER_CRITICAL(&s_lock);
+    hist->count++;
+    hist->sum_us += value_us;
+    hist->buckets[idx]++;
+    if (value_us > hist->max_us) {
+        hist->max_us = value_us;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void latency_hist_summarize(const latency_hist_t *hist, latency_summary_t *summary) {
+    latency_hist_t copy;
+
+    taskENTER_CRITICAL(&s_lock);
+    copy = *hist;
+    taskEXIT_CRITICAL(&s_lock);
+
+    summary->count = copy.count;
+    summary->sum_us = copy.sum_us;
+    summary->avg_us = copy.count ? (uint32_t)(copy.sum_us / copy.count) : 0;
+    summary->p50_us = bucket_percentile(&copy, 50);
+    summary->p99_us = bucket_percentile(&copy, 99);
+    summary->max_us = copy.max_us;
+}
+
+void latency_mark_fire(int64_t period_us) {
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_lock);
+    int64_t prev = s_prev_fire_us;
+    s_prev_fire_us = now;
+    s_last_fire_us = now;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (prev != 0) {
+        int64_t jitter = (now - prev) - period_us;
+        latency_record(LATENCY_STAGE_JITTER, (uint32_t)(jitter < 0 ? -jitter : jitter));
+    }
+}
+
+void latency_restart_period(void) {
+    taskENTER_CRITICAL(&s_lock);
+    s_prev_fire_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+int64_t latency_last_fire_us(void) {
+    taskENTER_CRITICAL(&s_lock);
+    int64_t fire_us = s_last_fire_us;
+    taskEXIT_CRITICAL(&s_lock);
+    return fire_us;
+}
+
+void latency_record_since(latency_stage_t stage, int64_t origin_us) {
+    if (origin_us <= 0) {
+        return;     // Không có dấu thời gian gốc (VD: mẫu trước khi timer chạy)
+    }
+    int64_t delta = esp_timer_get_time() - origin_us;
+    latency_record(stage, delta > 0 ? (uint32_t)delta : 0);
+}
+
+void latency_record(latency_stage_t stage, uint32_t value_us) {
+    if (stage < LATENCY_STAGE_MAX) {
+        latency_hist_record(&s_stages[stage], value_us);
+    }
+}
+
+void latency_get_summary(latency_stage_t stage, latency_summary_t *summary) {
+    if (stage >= LATENCY_STAGE_MAX) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+    latency_hist_summarize(&s_stages[stage], summary);
+}
+
+const char *latency_stage_name(latency_stage_t stage) {
+    return (stage < LATENCY_STAGE_MAX) ? s_stage_names[stage] : "unknown";
+}
+
+void latency_reset(void) {
+    taskENTER_CRITICAL(&s_lock);
+    memset(s_stages, 0, sizeof(s_stages));
+    s_prev_fire_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void latency_print(void) {
+    printf("%-8s %8s %10s %10s %10s %10s\n", "stage", "count", "avg_us", "p50_us", "p99_us", "max_us");
+    for (int i = 0; i < LATENCY_STAGE_MAX; i++) {
+        latency_summary_t s;
+        latency_get_summary((latency_stage_t)i, &s);
+        printf("%-8s %8" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 "\n",
+               latency_stage_name((latency_stage_t)i), s.count, s.avg_us, s.p50_us, s.p99_us, s.max_us);
+    }
+}
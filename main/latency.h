@@ -0,0 +1,123 @@
+/**
+ * @file latency.h
+ * @brief Latency Instrumentation - Đo độ trễ từng giai đoạn của pipeline cảm biến
+ * @features Histogram log2 cố định (p50/p99/max), jitter chu kỳ lấy mẫu
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "config.h"
+
+// ==================== LATENCY CONFIGURATION ====================
+
+#define LATENCY_BUCKETS     24      // Bucket i chứa [2^i, 2^(i+1)) us => tối đa ~16s
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Các giai đoạn được đo (tất cả tính từ lúc sensor timer kích hoạt, trừ READ/JITTER)
+ */
+typedef enum {
+    LATENCY_STAGE_WAKE = 0,     // Timer fire -> bắt đầu đọc DHT22
+    LATENCY_STAGE_READ,         // Bắt đầu đọc -> đọc xong
+    LATENCY_STAGE_PUBLISH,      // Timer fire -> publish lên sample bus
+    LATENCY_STAGE_DISPLAY,      // Timer fire -> OLED flush xong
+    LATENCY_STAGE_ALERT,        // Timer fire -> LED/buzzer được cập nhật
+    LATENCY_STAGE_WEB,          // Timer fire -> dữ liệu hiển thị trên HTTP API
+    LATENCY_STAGE_PUSH,         // Timer fire -> frame WebSocket đã gửi tới client
+    LATENCY_STAGE_JITTER,       // |chu kỳ thực tế - chu kỳ cấu hình|
+    LATENCY_STAGE_MAX
+} latency_stage_t;
+
+/**
+ * @brief Dấu thời gian đi kèm mỗi mẫu (esp_timer_get_time, us)
+ */
+typedef struct {
+    int64_t fire_us;            // Sensor timer kích hoạt
+    int64_t read_start_us;
+    int64_t read_end_us;
+    int64_t publish_us;         // Ghi vào sample bus
+} latency_stamps_t;
+
+/**
+ * @brief Histogram bucket log2 cố định (ghi O(1), không cấp phát)
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[LATENCY_BUCKETS];
+} latency_hist_t;
+
+/**
+ * @brief Tóm tắt 1 histogram
+ */
+typedef struct {
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t avg_us;
+    uint32_t p50_us;            // Cận trên của bucket chứa phân vị
+    uint32_t p99_us;
+    uint32_t max_us;
+} latency_summary_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Ghi 1 giá trị vào histogram bất kỳ (có khóa ngắn, an toàn giữa các task)
+ */
+void latency_hist_record(latency_hist_t *hist, uint32_t value_us);
+
+/**
+ * @brief Tính p50/p99/max của histogram bất kỳ
+ */
+void latency_hist_summarize(const latency_hist_t *hist, latency_summary_t *summary);
+
+/**
+ * @brief Ghi nhận sensor timer kích hoạt (gọi từ timer callback)
+ * @param period_us Chu kỳ cấu hình hiện tại, dùng để tính jitter
+ */
+void latency_mark_fire(int64_t period_us);
+
+/**
+ * @brief Bỏ qua jitter của lần kích hoạt kế tiếp (sau khi đổi chu kỳ timer)
+ */
+void latency_restart_period(void);
+
+/**
+ * @brief Thời điểm sensor timer kích hoạt gần nhất
+ */
+int64_t latency_last_fire_us(void);
+
+/**
+ * @brief Ghi độ trễ (now - origin_us) cho 1 giai đoạn
+ */
+void latency_record_since(latency_stage_t stage, int64_t origin_us);
+
+/**
+ * @brief Ghi độ trễ đã tính sẵn cho 1 giai đoạn
+ */
+void latency_record(latency_stage_t stage, uint32_t value_us);
+
+/**
+ * @brief Lấy tóm tắt của 1 giai đoạn
+ */
+void latency_get_summary(latency_stage_t stage, latency_summary_t *summary);
+
+/**
+ * @brief Tên giai đoạn (dùng cho JSON/console)
+ */
+const char *latency_stage_name(latency_stage_t stage);
+
+/**
+ * @brief Xóa toàn bộ histogram
+ */
+void latency_reset(void);
+
+/**
+ * @brief In bảng độ trễ ra console
+ */
+void latency_print(void);
+
+#endif // LATENCY_H
@@ -0,0 +1,298 @@
+/**
+ * @file live_stream.c
+ * @brief Live Stream Implementation
+ *
+ * Producer (web_task, alert_task, timer) chỉ chép tin (hoặc giá trị + hàm định dạng)
+ * vào slot rồi xếp 1 work vào httpd (httpd_queue_work). Work chạy trong task của httpd
+ * nên mọi lần định dạng/gửi frame đều nằm trên 1 task duy nhất, không cần khóa socket.
+ *
+ * Chỉ dùng API của esp_http_server và FreeRTOS => build được cho target linux.
+ */
+
+#include "live_stream.h"
+#include "sdkconfig.h"
+#include "latency.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdatomic.h>
+
+#if !CONFIG_HTTPD_WS_SUPPORT
+#error "live_stream cần CONFIG_HTTPD_WS_SUPPORT=y (xem sdkconfig.defaults)"
+#endif
+
+static const char *TAG = "LIVE_STREAM";
+
+#define LIVE_STREAM_MAX_FDS     8       // >= max_open_sockets của httpd
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Tin mới nhất của 1 loại (giữ lại sau khi gửi để gửi cho client mới)
+ */
+typedef struct {
+    char msg[LIVE_STREAM_MSG_LEN];
+    size_t len;                 // 0 = chưa có tin
+    live_stream_format_t format; // != NULL => tin = format(value), định dạng khi gửi
+    uint32_t value;
+    int64_t origin_us;
+    bool pending;               // Chưa được broadcast
+} live_slot_t;
+
+// ==================== GLOBAL STATE ====================
+
+static httpd_handle_t s_server = NULL;
+static live_slot_t s_slots[LIVE_STREAM_KIND_MAX];
+static atomic_bool s_work_queued = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static char s_tx[LIVE_STREAM_MSG_LEN];      // Chỉ dùng trong task httpd
+
+static atomic_uint s_clients = 0;
+static atomic_uint s_messages = 0;
+static atomic_uint s_frames = 0;
+static atomic_uint s_coalesced = 0;
+static atomic_uint s_send_errors = 0;
+static atomic_uint s_rejected = 0;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Chép tin của 1 slot ra buffer (trong critical section ngắn)
+ * @param take true => đánh dấu đã gửi, chỉ chép nếu đang pending;
+ *             false (client mới) => chỉ chép nếu không pending, vì work broadcast sắp chạy
+ *             cũng gửi tới client mới => tránh nhận trùng 1 mẫu
+ * @return Độ dài tin, 0 nếu không có gì để gửi
+ */
+static size_t slot_copy(live_stream_kind_t kind, char *out, bool take, int64_t *origin_us) {
+    live_slot_t *slot = &s_slots[kind];
+    live_stream_format_t format = NULL;
+    uint32_t value = 0;
+    size_t len = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    if ((slot->len > 0 || slot->format != NULL) && take == slot->pending) {
+        format = slot->format;
+        value = slot->value;
+        if (format == NULL) {
+            len = slot->len;
+            memcpy(out, slot->msg, len);
+        }
+        if (origin_us != NULL) {
+            *origin_us = slot->origin_us;
+        }
+        if (take) {
+            slot->pending = false;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    // Định dạng ngoài critical section, trên stack của task httpd
+    if (format != NULL) {
+        len = format(value, out, LIVE_STREAM_MSG_LEN);
+    }
+    return len;
+}
+
+/**
+ * @brief Gửi 1 frame text tới mọi client WebSocket (chạy trong task httpd)
+ */
+static void send_to_all(const char *msg, size_t len) {
+    int fds[LIVE_STREAM_MAX_FDS];
+    size_t num_fds = LIVE_STREAM_MAX_FDS;
+    unsigned clients = 0;
+
+    if (httpd_get_client_list(s_server, &num_fds, fds) != ESP_OK) {
+        return;
+    }
+
+    httpd_ws_frame_t frame = {
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)msg,
+        .len = len,
+    };
+
+    for (size_t i = 0; i < num_fds; i++) {
+        if (httpd_ws_get_fd_info(s_server, fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            continue;
+        }
+        if (httpd_ws_send_frame_async(s_server, fds[i], &frame) == ESP_OK) {
+            atomic_fetch_add_explicit(&s_frames, 1, memory_order_relaxed);
+            clients++;
+        } else {
+            // Client đã mất kết nối: đóng để trả socket cho httpd
+            atomic_fetch_add_explicit(&s_send_errors, 1, memory_order_relaxed);
+            httpd_sess_trigger_close(s_server, fds[i]);
+        }
+    }
+    atomic_store_explicit(&s_clients, clients, memory_order_relaxed);
+}
+
+/**
+ * @brief Work của httpd: gửi mọi slot đang pending
+ */
+static void broadcast_work(void *arg) {
+    // Xóa cờ trước khi đọc slot: tin post sau thời điểm này sẽ xếp work mới
+    atomic_store(&s_work_queued, false);
+
+    for (int kind = 0; kind < LIVE_STREAM_KIND_MAX; kind++) {
+        int64_t origin_us = 0;
+        size_t len = slot_copy((live_stream_kind_t)kind, s_tx, true, &origin_us);
+        if (len == 0) {
+            continue;
+        }
+
+        send_to_all(s_tx, len);
+        atomic_fetch_add_explicit(&s_messages, 1, memory_order_relaxed);
+        if (origin_us > 0) {
+            latency_record_since(LATENCY_STAGE_PUSH, origin_us);
+        }
+    }
+}
+
+/**
+ * @brief Đếm số client WebSocket hiện có (kể cả client vừa bắt tay xong)
+ */
+static unsigned count_clients(void) {
+    int fds[LIVE_STREAM_MAX_FDS];
+    size_t num_fds = LIVE_STREAM_MAX_FDS;
+    unsigned clients = 0;
+
+    if (httpd_get_client_list(s_server, &num_fds, fds) != ESP_OK) {
+        return 0;
+    }
+    for (size_t i = 0; i < num_fds; i++) {
+        if (httpd_ws_get_fd_info(s_server, fds[i]) == HTTPD_WS_CLIENT_WEBSOCKET) {
+            clients++;
+        }
+    }
+    return clients;
+}
+
+// ==================== PUBLIC API ====================
+
+void live_stream_init(httpd_handle_t server) {
+    s_server = server;
+}
+
+esp_err_t live_stream_handler(httpd_req_t *req) {
+    // Lần gọi đầu (GET) ngay sau bắt tay: nhận client và gửi trạng thái hiện tại
+    if (req->method == HTTP_GET) {
+        unsigned clients = count_clients();
+        if (clients > LIVE_STREAM_MAX_CLIENTS) {
+            ESP_LOGW(TAG, "Reject client (fd %d): %u/%d clients",
+                     httpd_req_to_sockfd(req), clients, LIVE_STREAM_MAX_CLIENTS);
+            atomic_fetch_add_explicit(&s_rejected, 1, memory_order_relaxed);
+            return ESP_FAIL;  // httpd đóng session
+        }
+        atomic_store_explicit(&s_clients, clients, memory_order_relaxed);
+        ESP_LOGI(TAG, "Client connected (fd %d), %u client(s)", httpd_req_to_sockfd(req), clients);
+
+        char msg[LIVE_STREAM_MSG_LEN];
+        for (int kind = 0; kind < LIVE_STREAM_KIND_MAX; kind++) {
+            size_t len = slot_copy((live_stream_kind_t)kind, msg, false, NULL);
+            if (len == 0) {
+                continue;
+            }
+            httpd_ws_frame_t frame = {
+                .type = HTTPD_WS_TYPE_TEXT,
+                .payload = (uint8_t *)msg,
+                .len = len,
+            };
+            if (httpd_ws_send_frame(req, &frame) != ESP_OK) {
+                return ESP_FAIL;
+            }
+        }
+        return ESP_OK;
+    }
+
+    // Frame từ client: dashboard không gửi lệnh nào, chỉ đọc để xả socket
+    uint8_t buf[LIVE_STREAM_RX_LEN];
+    httpd_ws_frame_t frame = { 0 };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (frame.len > sizeof(buf)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (frame.len > 0) {
+        frame.payload = buf;
+        ret = httpd_ws_recv_frame(req, &frame, frame.len);
+    }
+    return ret;
+}
+
+/**
+ * @brief Xếp work broadcast nếu chưa có work nào đang chờ
+ */
+static void schedule_broadcast(void) {
+    if (!atomic_exchange(&s_work_queued, true)) {
+        if (httpd_queue_work(s_server, broadcast_work, NULL) != ESP_OK) {
+            atomic_store(&s_work_queued, false);
+            ESP_LOGW(TAG, "httpd_queue_work failed");
+        }
+    }
+}
+
+/**
+ * @brief Không có client thì chỉ giữ tin cho client mới, không đánh thức httpd
+ */
+static bool has_clients(void) {
+    return s_server != NULL && atomic_load_explicit(&s_clients, memory_order_relaxed) > 0;
+}
+
+void live_stream_post(live_stream_kind_t kind, const char *json, size_t len, int64_t origin_us) {
+    if (kind >= LIVE_STREAM_KIND_MAX || len == 0 || len > LIVE_STREAM_MSG_LEN) {
+        return;
+    }
+
+    bool broadcast = has_clients();
+
+    live_slot_t *slot = &s_slots[kind];
+    portENTER_CRITICAL(&s_lock);
+    if (slot->pending) {
+        atomic_fetch_add_explicit(&s_coalesced, 1, memory_order_relaxed);
+    }
+    memcpy(slot->msg, json, len);
+    slot->len = len;
+    slot->format = NULL;
+    slot->origin_us = origin_us;
+    slot->pending = broadcast;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (broadcast) {
+        schedule_broadcast();
+    }
+}
+
+void live_stream_post_value(live_stream_kind_t kind, live_stream_format_t format, uint32_t value) {
+    if (kind >= LIVE_STREAM_KIND_MAX || format == NULL) {
+        return;
+    }
+
+    bool broadcast = has_clients();
+
+    live_slot_t *slot = &s_slots[kind];
+    portENTER_CRITICAL(&s_lock);
+    if (slot->pending) {
+        atomic_fetch_add_explicit(&s_coalesced, 1, memory_order_relaxed);
+    }
+    slot->format = format;
+    slot->value = value;
+    slot->origin_us = 0;
+    slot->pending = broadcast;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (broadcast) {
+        schedule_broadcast();
+    }
+}
+
+void live_stream_get_stats(live_stream_stats_t *stats) {
+    stats->clients = atomic_load_explicit(&s_clients, memory_order_relaxed);
+    stats->messages = atomic_load_explicit(&s_messages, memory_order_relaxed);
+    stats->frames = atomic_load_explicit(&s_frames, memory_order_relaxed);
+    stats->coalesced = atomic_load_explicit(&s_coalesced, memory_order_relaxed);
+    stats->send_errors = atomic_load_explicit(&s_send_errors, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&s_rejected, memory_order_relaxed);
+}
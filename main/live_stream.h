@@ -0,0 +1,81 @@
+/**
+ * @file live_stream.h
+ * @brief Live Stream - Đẩy mẫu mới và thay đổi trạng thái tới dashboard qua WebSocket
+ * @features Định dạng 1 lần / gửi cho mọi client, gộp tin chưa gửi, gửi trạng thái hiện tại khi kết nối
+ */
+
+#ifndef LIVE_STREAM_H
+#define LIVE_STREAM_H
+
+#include "esp_http_server.h"
+#include "config.h"
+
+// ==================== LIVE STREAM CONFIGURATION ====================
+
+#define LIVE_STREAM_URI             "/ws"
+#define LIVE_STREAM_MAX_CLIENTS     3       // Chừa ít nhất 1 socket cho request HTTP thường
+#define LIVE_STREAM_MSG_LEN         256     // Độ dài tối đa 1 tin (JSON)
+#define LIVE_STREAM_RX_LEN          64      // Client không gửi lệnh, chỉ đọc bỏ
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Loại tin - mỗi loại giữ 1 tin mới nhất, tin chưa gửi bị thay bằng tin mới hơn
+ */
+typedef enum {
+    LIVE_STREAM_SAMPLE = 0,     // Mẫu cảm biến mới
+    LIVE_STREAM_BUZZER,         // Buzzer bật/tắt
+    LIVE_STREAM_KIND_MAX
+} live_stream_kind_t;
+
+/**
+ * @brief Thống kê live stream
+ */
+typedef struct {
+    uint32_t clients;           // Số client WebSocket đang kết nối
+    uint32_t messages;          // Số tin đã broadcast
+    uint32_t frames;            // Số frame đã gửi (tin x client)
+    uint32_t coalesced;         // Tin bị thay trước khi kịp gửi
+    uint32_t send_errors;       // Gửi lỗi => đóng client
+    uint32_t rejected;          // Kết nối bị từ chối do quá LIVE_STREAM_MAX_CLIENTS
+} live_stream_stats_t;
+
+/**
+ * @brief Định dạng tin từ 1 giá trị (chạy trong task httpd)
+ * @return Độ dài tin, 0 nếu lỗi
+ */
+typedef size_t (*live_stream_format_t)(uint32_t value, char *out, size_t size);
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Gắn live stream vào HTTP server đã khởi động
+ */
+void live_stream_init(httpd_handle_t server);
+
+/**
+ * @brief Handler của URI LIVE_STREAM_URI (đăng ký với .is_websocket = true)
+ */
+esp_err_t live_stream_handler(httpd_req_t *req);
+
+/**
+ * @brief Broadcast 1 tin tới mọi client (không chặn, gọi được từ mọi task)
+ *
+ * Tin được chép vào slot của loại tương ứng rồi gửi trong task của httpd.
+ * @param origin_us Thời điểm gốc để đo độ trễ LATENCY_STAGE_PUSH (0 = không đo)
+ */
+void live_stream_post(live_stream_kind_t kind, const char *json, size_t len, int64_t origin_us);
+
+/**
+ * @brief Như live_stream_post() nhưng chỉ lưu giá trị; tin được định dạng trong task httpd
+ *
+ * Dành cho caller có stack nhỏ (timer daemon, alert_task): không giữ buffer JSON trên stack.
+ */
+void live_stream_post_value(live_stream_kind_t kind, live_stream_format_t format, uint32_t value);
+
+/**
+ * @brief Lấy thống kê live stream
+ */
+void live_stream_get_stats(live_stream_stats_t *stats);
+
+#endif // LIVE_STREAM_H
@@ -1,13 +1,20 @@
 /**
  * @file main.c
  * @brief Hệ thống Giám sát Nhiệt độ - ESP-IDF FreeRTOS (FULL FEATURES + WEBSERVER)
- * @features Tasks, Queues, Software Timers, Mutex, Semaphores, Event Groups, Task Notifications
+ * @features Tasks, Sample Bus (publish/subscribe), Software Timers, Task Notifications
  * @webserver HTTP REST API, WiFi connectivity, Web Dashboard
  */
 
 #include "config.h"
 #include "dht22.h"
 #include "ssd1306.h"
+#include "i2c_bus.h"
+#include "sample_bus.h"
+#include "sampler.h"
+#include "latency.h"
+#include "pipeline_bench.h"
+#include "app_console.h"
+#include "sample_log.h"
 #include "webserver.h"
 #include "wifi.h"
 #include "freertos/FreeRTOS.h"
@@ -16,60 +23,23 @@
 #include "freertos/semphr.h"
 #include "freertos/event_groups.h"
 #include "freertos/timers.h"
+#include "esp_timer.h"
 #include <stdio.h>
 #include <string.h>
 
 static const char *TAG = "MAIN";
 
 // ==================== FREERTOS HANDLES ====================
-// Queue để truyền dữ liệu cảm biến
-static QueueHandle_t sensor_queue = NULL;
-
-// Mutex bảo vệ I2C bus (OLED và DHT22 dùng chung GPIO)
-SemaphoreHandle_t i2c_mutex = NULL;
-
-// Binary Semaphore để đồng bộ dữ liệu mới
-SemaphoreHandle_t data_ready_semaphore = NULL;
-
-// Event Group quản lý trạng thái hệ thống
-EventGroupHandle_t system_event_group = NULL;
-
-// Software Timers
-static TimerHandle_t sensor_timer = NULL;      // Timer đọc cảm biến mỗi 1s
+// Software Timers (sensor_timer thuộc về sampler.c)
 static TimerHandle_t buzzer_timer = NULL;      // Timer tắt buzzer sau 5s
 
 // Task Handles (để dùng Task Notification)
+TaskHandle_t sensor_task_handle = NULL;
 TaskHandle_t display_task_handle = NULL;
 TaskHandle_t alert_task_handle = NULL;
 
 // ==================== HELPER FUNCTIONS ====================
 
-/**
- * @brief Xác định trạng thái hệ thống theo nhiệt độ
- */
-system_state_t get_system_state(float temperature) {
-    if (temperature >= TEMP_OVERHEAT) {
-        return STATE_OVERHEAT;
-    } else if (temperature >= TEMP_WARNING) {
-        return STATE_WARNING;
-    } else {
-        return STATE_NORMAL;
-    }
-}
-
-/**
- * @brief Chuyển đổi state sang chuỗi
- */
-const char* get_state_string(system_state_t state) {
-    switch (state) {
-        case STATE_NORMAL:   return "NORMAL";
-        case STATE_WARNING:  return "WARNING";
-        case STATE_OVERHEAT: return "DANGER!";
-        case STATE_ERROR:    return "ERROR";
-        default:             return "UNKNOWN";
-    }
-}
-
 /**
  * @brief Lấy trạng thái buzzer (ON nếu timer đang chạy, OFF nếu không)
  */
@@ -82,22 +52,16 @@ bool get_buzzer_status(void) {
 
 // ==================== SOFTWARE TIMER CALLBACKS ====================
 
-/**
- * @brief Timer callback: Đọc cảm biến mỗi 1 giây
- */
-void sensor_timer_callback(TimerHandle_t xTimer) {
-    // Đánh thức sensor_task bằng Task Notification
-    if (xTaskNotifyGive(xTaskGetHandle("sensor_task")) == pdPASS) {
-        ESP_LOGD(TAG, "Sensor timer triggered");
-    }
-}
-
 /**
  * @brief Timer callback: Tắt buzzer sau 10 giây
  */
 void buzzer_timer_callback(TimerHandle_t xTimer) {
     gpio_set_level(BUZZER_PIN, 0);
     ESP_LOGI(TAG, "Buzzer auto-off after 10s");
+    
+    #if ENABLE_WEBSERVER
+    webserver_notify_buzzer(false);
+    #endif
 }
 
 // ==================== TASK IMPLEMENTATIONS ====================
@@ -107,162 +71,129 @@ void buzzer_timer_callback(TimerHandle_t xTimer) {
  */
 void sensor_task(void *pvParameters) {
     sensor_data_t data;
+    latency_stamps_t stamps;
     
     ESP_LOGI(TAG, "✓ Sensor task started");
     
     while (1) {
-        // Đợi notification từ sensor_timer (thay vì vTaskDelay)
+        // Đợi notification từ sampler (thay vì vTaskDelay)
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         
-        // Lấy Mutex để bảo vệ I2C (nếu cần đọc qua I2C)
-        if (xSemaphoreTake(i2c_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        stamps.fire_us = latency_last_fire_us();
+        stamps.read_start_us = esp_timer_get_time();
+        latency_record_since(LATENCY_STAGE_WAKE, stamps.fire_us);
+        
+        // Đọc DHT22 (thiết bị GPIO bit-bang, không dùng bus I2C => không cần khóa)
+        #if CONFIG_PIPELINE_BENCH
+        esp_err_t read_ret = pipeline_bench_read(&data.temperature, &data.humidity);
+        #else
+        esp_err_t read_ret = dht22_read(&data.temperature, &data.humidity);
+        #endif
+        stamps.read_end_us = esp_timer_get_time();
+        latency_record(LATENCY_STAGE_READ, (uint32_t)(stamps.read_end_us - stamps.read_start_us));
+        
+        if (read_ret == ESP_OK) {
+            data.is_valid = true;
+            data.timestamp = stamps.read_end_us;
             
-            // Đọc DHT22
-            if (dht22_read(&data.temperature, &data.humidity) == ESP_OK) {
-                data.is_valid = true;
-                data.timestamp = esp_timer_get_time();
-                
-                ESP_LOGI(TAG, "📊 DHT22: T=%.1f°C, H=%.1f%%", 
-                         data.temperature, data.humidity);
-                
-                // Xác định trạng thái mới
-                system_state_t new_state = get_system_state(data.temperature);
-                
-                // Cập nhật Event Group
-                xEventGroupClearBits(system_event_group, 
-                                     EVENT_STATE_NORMAL | EVENT_STATE_WARNING | EVENT_STATE_OVERHEAT);
-                
-                if (new_state == STATE_NORMAL) {
-                    xEventGroupSetBits(system_event_group, EVENT_STATE_NORMAL);
-                } else if (new_state == STATE_WARNING) {
-                    xEventGroupSetBits(system_event_group, EVENT_STATE_WARNING);
-                } else if (new_state == STATE_OVERHEAT) {
-                    xEventGroupSetBits(system_event_group, EVENT_STATE_OVERHEAT);
-                }
-                
-                // Set bit NEW_DATA
-                xEventGroupSetBits(system_event_group, EVENT_NEW_DATA);
-                
-                // Gửi data qua Queue
-                xQueueSend(sensor_queue, &data, 0);
-                
-                // Đánh thức display_task bằng Task Notification
-                xTaskNotifyGive(display_task_handle);
-                
-                // Signal semaphore báo có dữ liệu mới
-                xSemaphoreGive(data_ready_semaphore);
-                
-                // ========== CẬP NHẬT WEBSERVER ==========
-                #if ENABLE_WEBSERVER
-                webserver_update_sensor_data(&data, new_state);
-                #endif
-                
+            ESP_LOGI(TAG, "📊 DHT22: T=%.1f°C, H=%.1f%%", 
+                     data.temperature, data.humidity);
+            
+            // Adaptive: chọn chu kỳ đọc tiếp theo theo giá trị vừa đọc
+            sampler_on_sample(&data);
+            
+            // Publish 1 lần vào sample bus, mọi consumer đọc bằng con trỏ
+            if (sample_bus_publish(&data, get_system_state(data.temperature), &stamps) != ESP_OK) {
+                ESP_LOGW(TAG, "⚠ Sample bus full, sample dropped");
             } else {
-                data.is_valid = false;
-                ESP_LOGW(TAG, "⚠ Failed to read DHT22");
+                latency_record_since(LATENCY_STAGE_PUBLISH, stamps.fire_us);
             }
             
-            xSemaphoreGive(i2c_mutex);
         } else {
-            ESP_LOGW(TAG, "⚠ I2C Mutex timeout");
+            data.is_valid = false;
+            ESP_LOGW(TAG, "⚠ Failed to read DHT22");
         }
     }
 }
 
 /**
- * @brief Task hiển thị OLED (dùng Task Notification + Event Group)
+ * @brief Task hiển thị OLED (subscriber LATEST_ONLY: chỉ vẽ mẫu mới nhất)
  */
 void display_task(void *pvParameters) {
-    sensor_data_t data;
+    sample_bus_sub_t sub = (sample_bus_sub_t)pvParameters;
     char temp_str[32], humi_str[32], status_str[32];
-    EventBits_t bits;
     
     ESP_LOGI(TAG, "✓ Display task started");
     
     while (1) {
-        // Đợi notification từ sensor_task
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Đợi mẫu mới từ sample bus
+        const sample_t *sample = sample_bus_receive(sub, portMAX_DELAY);
+        if (sample == NULL) {
+            continue;
+        }
         
-        // Đợi semaphore báo có dữ liệu mới
-        if (xSemaphoreTake(data_ready_semaphore, pdMS_TO_TICKS(200)) == pdTRUE) {
-            
-            // Nhận dữ liệu từ queue
-            if (xQueueReceive(sensor_queue, &data, pdMS_TO_TICKS(100)) == pdTRUE) {
-                if (data.is_valid) {
-                    
-                    // Lấy Mutex I2C trước khi viết OLED
-                    if (xSemaphoreTake(i2c_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        
-                        // Xóa màn hình
-                        ssd1306_clear();
-                        
-                        // Hiển thị tiêu đề
-                        ssd1306_draw_string(0, 0, "TEMP MONITOR", 1);
-                        
-                        // Hiển thị nhiệt độ
-                        snprintf(temp_str, sizeof(temp_str), "TEMP: %.1fC", data.temperature);
-                        ssd1306_draw_string(0, 16, temp_str, 1);
-                        
-                        // Hiển thị độ ẩm
-                        snprintf(humi_str, sizeof(humi_str), "HUMI: %.1f%%", data.humidity);
-                        ssd1306_draw_string(0, 32, humi_str, 1);
-                        
-                        // Đọc trạng thái từ Event Group
-                        bits = xEventGroupGetBits(system_event_group);
-                        
-                        if (bits & EVENT_STATE_OVERHEAT) {
-                            snprintf(status_str, sizeof(status_str), "STATUS: DANGER!");
-                        } else if (bits & EVENT_STATE_WARNING) {
-                            snprintf(status_str, sizeof(status_str), "STATUS: WARNING");
-                        } else if (bits & EVENT_STATE_NORMAL) {
-                            snprintf(status_str, sizeof(status_str), "STATUS: NORMAL");
-                        } else {
-                            snprintf(status_str, sizeof(status_str), "STATUS: ---");
-                        }
-                        
-                        ssd1306_draw_string(0, 48, status_str, 1);
-                        
-                        xSemaphoreGive(i2c_mutex);
-                        
-                        ESP_LOGI(TAG, "🖥 Display updated: %s", status_str);
-                    }
-                }
+        // Vẽ vào framebuffer RAM (không cần bus I2C)
+        ssd1306_clear();
+        
+        // Hiển thị tiêu đề
+        ssd1306_draw_string(0, 0, "TEMP MONITOR", 1);
+        
+        // Hiển thị nhiệt độ
+        snprintf(temp_str, sizeof(temp_str), "TEMP: %.1fC", sample->data.temperature);
+        ssd1306_draw_string(0, 16, temp_str, 1);
+        
+        // Hiển thị độ ẩm
+        snprintf(humi_str, sizeof(humi_str), "HUMI: %.1f%%", sample->data.humidity);
+        ssd1306_draw_string(0, 32, humi_str, 1);
+        
+        // Trạng thái đi kèm mẫu
+        switch (sample->state) {
+            case STATE_OVERHEAT: snprintf(status_str, sizeof(status_str), "STATUS: DANGER!"); break;
+            case STATE_WARNING:  snprintf(status_str, sizeof(status_str), "STATUS: WARNING"); break;
+            case STATE_NORMAL:   snprintf(status_str, sizeof(status_str), "STATUS: NORMAL"); break;
+            default:             snprintf(status_str, sizeof(status_str), "STATUS: ---"); break;
+        }
+        
+        ssd1306_draw_string(0, 48, status_str, 1);
+        
+        // Đã vẽ xong => nhả mẫu trước khi flush
+        int64_t fire_us = sample->stamps.fire_us;
+        sample_bus_release(sub);
+        
+        // Xếp flush vào I2C bus manager, rồi chờ xong để đo độ trễ tới màn hình
+        if (ssd1306_display() == ESP_OK) {
+            if (ssd1306_wait_flush(pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS)) == ESP_OK) {
+                latency_record_since(LATENCY_STAGE_DISPLAY, fire_us);
             }
+            
+            ssd1306_bus_stats_t bus_stats;
+            ssd1306_get_bus_stats(&bus_stats);
+            ESP_LOGI(TAG, "🖥 Display updated: %s (%" PRIu32 " bytes I2C)",
+                     status_str, bus_stats.last_flush_bytes);
         }
     }
 }
 
 /**
- * @brief Task xử lý cảnh báo (Buzzer & LED) - dùng Event Group
+ * @brief Task xử lý cảnh báo (Buzzer & LED) - subscriber DROP_OLDEST
  */
 void alert_task(void *pvParameters) {
-    EventBits_t bits;
+    sample_bus_sub_t sub = (sample_bus_sub_t)pvParameters;
     system_state_t last_state = STATE_NORMAL;
     
     ESP_LOGI(TAG, "✓ Alert task started");
     
     while (1) {
-        // Đợi sự kiện NEW_DATA từ Event Group
-        bits = xEventGroupWaitBits(
-            system_event_group,
-            EVENT_NEW_DATA,
-            pdTRUE,  // Clear bit sau khi đọc
-            pdFALSE, // Chỉ cần 1 bit
-            portMAX_DELAY
-        );
+        // Đợi mẫu mới từ sample bus
+        const sample_t *sample = sample_bus_receive(sub, portMAX_DELAY);
         
-        if (bits & EVENT_NEW_DATA) {
-            // Đọc trạng thái hiện tại
-            bits = xEventGroupGetBits(system_event_group);
-            
-            system_state_t new_state;
-            if (bits & EVENT_STATE_OVERHEAT) {
-                new_state = STATE_OVERHEAT;
-            } else if (bits & EVENT_STATE_WARNING) {
-                new_state = STATE_WARNING;
-            } else {
-                new_state = STATE_NORMAL;
-            }
+        if (sample != NULL) {
+            system_state_t new_state = sample->state;
+            int64_t fire_us = sample->stamps.fire_us;
+            #if ENABLE_WEBSERVER
+            bool buzzer_was_on = get_buzzer_status();
+            #endif
+            sample_bus_release(sub);
             
             // Xử lý từng trạng thái (kể cả khi không thay đổi)
             switch (new_state) {
@@ -274,6 +205,9 @@ void alert_task(void *pvParameters) {
                     if (xTimerIsTimerActive(buzzer_timer) == pdFALSE) {
                         gpio_set_level(BUZZER_PIN, 1);
                         xTimerStart(buzzer_timer, 0);
+                        #if ENABLE_WEBSERVER
+                        webserver_notify_buzzer(true);
+                        #endif
                         
                         if (new_state != last_state) {
                             ESP_LOGW(TAG, "🚨 ALERT: OVERHEAT! Buzzer ON (cycle 1)");
@@ -290,6 +224,11 @@ void alert_task(void *pvParameters) {
                     
                     // Dừng timer buzzer
                     xTimerStop(buzzer_timer, 0);
+                    #if ENABLE_WEBSERVER
+                    if (buzzer_was_on) {
+                        webserver_notify_buzzer(false);
+                    }
+                    #endif
                     
                     if (new_state != last_state) {
                         ESP_LOGW(TAG, "⚠ ALERT: WARNING! LED ON");
@@ -303,6 +242,11 @@ void alert_task(void *pvParameters) {
                     
                     // Dừng timer buzzer
                     xTimerStop(buzzer_timer, 0);
+                    #if ENABLE_WEBSERVER
+                    if (buzzer_was_on) {
+                        webserver_notify_buzzer(false);
+                    }
+                    #endif
                     
                     if (new_state != last_state) {
                         ESP_LOGI(TAG, "✓ ALERT: NORMAL");
@@ -313,20 +257,70 @@ void alert_task(void *pvParameters) {
                     break;
             }
             
+            // LED/buzzer đã được cập nhật theo mẫu này
+            latency_record_since(LATENCY_STAGE_ALERT, fire_us);
+            
             // Cập nhật last_state sau khi xử lý
             last_state = new_state;
         }
     }
 }
 
+/**
+ * @brief Task ghi nhật ký flash (subscriber DROP_OLDEST, ưu tiên thấp nhất vì xóa sector ~30 ms)
+ */
+void log_task(void *pvParameters) {
+    sample_bus_sub_t sub = (sample_bus_sub_t)pvParameters;
+    system_state_t last_state = STATE_NORMAL;
+    
+    ESP_LOGI(TAG, "✓ Log task started");
+    
+    while (1) {
+        const sample_t *sample = sample_bus_receive(sub, portMAX_DELAY);
+        if (sample != NULL) {
+            // Chép ra rồi nhả slot ngay: xóa sector không được giữ slot (chặn publisher)
+            sample_t copy = *sample;
+            sample_bus_release(sub);
+            
+            sample_log_append(&copy);
+            
+            // Đổi trạng thái (VD: vừa quá nhiệt) => ghi ngay, không đợi đủ trang
+            if (copy.state != last_state) {
+                sample_log_flush();
+                last_state = copy.state;
+            }
+        }
+    }
+}
+
+#if ENABLE_WEBSERVER
+/**
+ * @brief Task cập nhật webserver (subscriber DROP_OLDEST => history không mất mẫu)
+ */
+void web_task(void *pvParameters) {
+    sample_bus_sub_t sub = (sample_bus_sub_t)pvParameters;
+    
+    ESP_LOGI(TAG, "✓ Web task started");
+    
+    while (1) {
+        const sample_t *sample = sample_bus_receive(sub, portMAX_DELAY);
+        if (sample != NULL) {
+            webserver_update_sensor_data(sample);
+            latency_record_since(LATENCY_STAGE_WEB, sample->stamps.fire_us);
+            sample_bus_release(sub);
+        }
+    }
+}
+#endif
+
 /**
  * @brief App main - ESP-IDF entry point
  */
 void app_main(void) {
     ESP_LOGI(TAG, "\n╔════════════════════════════════════════════════════════╗");
     ESP_LOGI(TAG, "║  TEMPERATURE MONITORING SYSTEM + WEBSERVER           ║");
-    ESP_LOGI(TAG, "║  Tasks | Queues | Timers | Mutex | Semaphores       ║");
-    ESP_LOGI(TAG, "║  Event Groups | Task Notifications | WiFi + HTTP     ║");
+    ESP_LOGI(TAG, "║  Tasks | Sample Bus | Timers | I2C Bus Manager      ║");
+    ESP_LOGI(TAG, "║  Task Notifications | WiFi + HTTP                    ║");
     ESP_LOGI(TAG, "╚════════════════════════════════════════════════════════╝\n");
     
     // ==================== KHỞI TẠO PHẦN CỨNG ====================
@@ -344,8 +338,8 @@ void app_main(void) {
     gpio_set_level(LED_PIN, 0);
     ESP_LOGI(TAG, "✓ GPIO initialized (Buzzer=%d, LED=%d)", BUZZER_PIN, LED_PIN);
     
-    // Khởi tạo I2C
-    if (i2c_master_init() != ESP_OK) {
+    // Khởi tạo I2C bus manager (chủ sở hữu duy nhất của I2C_MASTER_NUM)
+    if (i2c_bus_init() != ESP_OK) {
         ESP_LOGE(TAG, "✗ Failed to initialize I2C!");
         return;
     }
@@ -364,6 +358,15 @@ void app_main(void) {
     vTaskDelay(pdMS_TO_TICKS(2000));
     ESP_LOGI(TAG, "✓ DHT22 initialized (GPIO=%d)", DHT_PIN);
     
+    // Sampling scheduler: không bao giờ đọc nhanh hơn chu kỳ tối thiểu của DHT22
+    if (sampler_init(DHT22_MIN_PERIOD_MS, SENSOR_READ_PERIOD_MS) != ESP_OK) {
+        ESP_LOGE(TAG, "✗ Failed to create sampler!");
+        return;
+    }
+    
+    // Nhật ký mẫu trên flash (không có partition => chạy tiếp, chỉ mất lịch sử qua reboot)
+    bool log_enabled = (sample_log_init() == ESP_OK);
+    
     // ==================== KHỞI TẠO WiFi VÀ WEBSERVER ====================
     
     #if ENABLE_WEBSERVER
@@ -388,55 +391,30 @@ void app_main(void) {
     
     // ==================== TẠO FREERTOS OBJECTS ====================
     
-    // 1. Queue - Truyền dữ liệu sensor
-    sensor_queue = xQueueCreate(5, sizeof(sensor_data_t));
-    if (sensor_queue == NULL) {
-        ESP_LOGE(TAG, "✗ Failed to create queue!");
-        return;
-    }
-    ESP_LOGI(TAG, "✓ Queue created (size=5)");
-    
-    // 2. Mutex - Bảo vệ I2C bus
-    i2c_mutex = xSemaphoreCreateMutex();
-    if (i2c_mutex == NULL) {
-        ESP_LOGE(TAG, "✗ Failed to create I2C mutex!");
-        return;
-    }
-    ESP_LOGI(TAG, "✓ I2C Mutex created");
-    
-    // 3. Binary Semaphore - Đồng bộ dữ liệu mới
-    data_ready_semaphore = xSemaphoreCreateBinary();
-    if (data_ready_semaphore == NULL) {
-        ESP_LOGE(TAG, "✗ Failed to create semaphore!");
+    // 1. Sample Bus - Publish/subscribe dữ liệu sensor
+    if (sample_bus_init() != ESP_OK) {
+        ESP_LOGE(TAG, "✗ Failed to create sample bus!");
         return;
     }
-    ESP_LOGI(TAG, "✓ Data Ready Semaphore created");
     
-    // 4. Event Group - Quản lý trạng thái hệ thống
-    system_event_group = xEventGroupCreate();
-    if (system_event_group == NULL) {
-        ESP_LOGE(TAG, "✗ Failed to create event group!");
+    // Mỗi consumer chỉ cần 1 lần đăng ký (trước khi sensor timer chạy)
+    sample_bus_sub_t display_sub = sample_bus_subscribe("display", SAMPLE_BUS_LATEST_ONLY);
+    sample_bus_sub_t alert_sub = sample_bus_subscribe("alert", SAMPLE_BUS_DROP_OLDEST);
+    if (display_sub == NULL || alert_sub == NULL) {
+        ESP_LOGE(TAG, "✗ Failed to subscribe to sample bus!");
         return;
     }
-    // Set trạng thái ban đầu là NORMAL
-    xEventGroupSetBits(system_event_group, EVENT_STATE_NORMAL);
-    ESP_LOGI(TAG, "✓ Event Group created (initial: NORMAL)");
-    
-    // 5. Software Timer - Đọc cảm biến mỗi 1 giây
-    sensor_timer = xTimerCreate(
-        "SensorTimer",                      // Tên timer
-        pdMS_TO_TICKS(1000),                // Chu kỳ 1 giây
-        pdTRUE,                             // Auto-reload
-        (void *)0,                          // Timer ID
-        sensor_timer_callback               // Callback
-    );
-    if (sensor_timer == NULL) {
-        ESP_LOGE(TAG, "✗ Failed to create sensor timer!");
+    sample_bus_sub_t log_sub = log_enabled ? sample_bus_subscribe("log", SAMPLE_BUS_DROP_OLDEST) : NULL;
+    #if ENABLE_WEBSERVER
+    sample_bus_sub_t web_sub = sample_bus_subscribe("web", SAMPLE_BUS_DROP_OLDEST);
+    if (web_sub == NULL) {
+        ESP_LOGE(TAG, "✗ Failed to subscribe to sample bus!");
         return;
     }
-    ESP_LOGI(TAG, "✓ Sensor Timer created (1s period)");
+    #endif
+    ESP_LOGI(TAG, "✓ Sample Bus created (%d subscribers)", sample_bus_get_subscriber_count());
     
-    // 6. Software Timer - Tắt buzzer sau 5 giây
+    // 2. Software Timer - Tắt buzzer sau 5 giây
     buzzer_timer = xTimerCreate(
         "BuzzerTimer",                      // Tên timer
         pdMS_TO_TICKS(10000),               // 10 giây
@@ -461,7 +439,7 @@ void app_main(void) {
         4096,
         NULL,
         5,
-        NULL
+        &sensor_task_handle
     );
     ESP_LOGI(TAG, "✓ Sensor Task created (Priority 5)");
     
@@ -470,9 +448,9 @@ void app_main(void) {
         display_task,
         "display_task",
         4096,
-        NULL,
+        display_sub,
         4,
-        &display_task_handle  // Lưu handle để dùng Task Notification
+        &display_task_handle
     );
     ESP_LOGI(TAG, "✓ Display Task created (Priority 4)");
     
@@ -481,28 +459,68 @@ void app_main(void) {
         alert_task,
         "alert_task",
         2048,
-        NULL,
+        alert_sub,
         3,
-        &alert_task_handle    // Lưu handle để dùng Task Notification
+        &alert_task_handle
     );
     ESP_LOGI(TAG, "✓ Alert Task created (Priority 3)");
     
+    #if ENABLE_WEBSERVER
+    // Task 4: Web Task (Priority 2)
+    xTaskCreate(
+        web_task,
+        "web_task",
+        3072,
+        web_sub,
+        2,
+        NULL
+    );
+    ESP_LOGI(TAG, "✓ Web Task created (Priority 2)");
+    #endif
+    
+    // Task 5: Log Task (Priority 1)
+    if (log_sub != NULL) {
+        xTaskCreate(
+            log_task,
+            "log_task",
+            3072,
+            log_sub,
+            1,
+            NULL
+        );
+        ESP_LOGI(TAG, "✓ Log Task created (Priority 1)");
+    }
+    
     // ==================== KHỞI ĐỘNG TIMERS ====================
     
-    // Khởi động sensor timer
-    if (xTimerStart(sensor_timer, 0) != pdPASS) {
+    #if CONFIG_PIPELINE_BENCH
+    // Benchmark: timer tổng hợp tốc độ cao thay cho sensor timer (bỏ qua chu kỳ tối thiểu của DHT22)
+    if (pipeline_bench_start(sensor_task_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "✗ Failed to start pipeline benchmark!");
+        return;
+    }
+    ESP_LOGW(TAG, "⚠ Pipeline benchmark mode: DHT22 replaced by synthetic source");
+    #else
+    // Khởi động sensor timer (sampler đánh thức sensor_task qua handle đã lưu)
+    if (sampler_start(sensor_task_handle) != ESP_OK) {
         ESP_LOGE(TAG, "✗ Failed to start sensor timer!");
         return;
     }
-    ESP_LOGI(TAG, "✓ Sensor Timer started");
+    ESP_LOGI(TAG, "✓ Sensor Timer started (%" PRIu32 " ms period)", sampler_get_period_ms());
+    #endif
+    
+    // Console chẩn đoán (lệnh 'latency')
+    if (app_console_init() != ESP_OK) {
+        ESP_LOGW(TAG, "⚠ Console unavailable");
+    }
     
     // ==================== SYSTEM READY ====================
     
     ESP_LOGI(TAG, "\n╔════════════════════════════════════════════════════════╗");
     ESP_LOGI(TAG, "║              🚀 SYSTEM RUNNING!                       ║");
-    ESP_LOGI(TAG, "║  📊 Sensor reading every 1s                           ║");
+    ESP_LOGI(TAG, "║  📊 Sensor reading every %5" PRIu32 " ms                     ║", sampler_get_period_ms());
     ESP_LOGI(TAG, "║  🖥  Display updates on new data                      ║");
-    ESP_LOGI(TAG, "║  🔔 Alerts via Event Group + Timer                    ║");
+    ESP_LOGI(TAG, "║  🔔 Alerts via Sample Bus + Timer                     ║");
     #if ENABLE_WEBSERVER
     ESP_LOGI(TAG, "║  🌐 Webserver: http://%s                              ║", wifi_get_ip_address());
     #endif
@@ -0,0 +1,276 @@
+/**
+ * @file pipeline_bench.c
+ * @brief Pipeline Stress Benchmark Implementation
+ *
+ * esp_timer định kỳ (độ phân giải µs, không bị giới hạn bởi tick 1 ms) đánh thức sensor_task
+ * giống sampler_timer_callback(). Mỗi bậc tần số chạy PIPELINE_BENCH_STEP_MS, sau đó so sánh
+ * bộ đếm của sample bus, histogram độ trễ và thời gian chạy của từng task trước/sau bậc đó.
+ */
+
+#include "pipeline_bench.h"
+#include "sample_bus.h"
+#include "latency.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "BENCH";
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Ảnh chụp bộ đếm tại đầu/cuối 1 bậc
+ */
+typedef struct {
+    int64_t time_us;
+    uint32_t fired;
+    uint32_t reads;
+    uint32_t publish_drops;
+    uint32_t delivered[SAMPLE_BUS_MAX_SUBSCRIBERS];
+    uint32_t dropped[SAMPLE_BUS_MAX_SUBSCRIBERS];
+    TaskStatus_t tasks[PIPELINE_BENCH_MAX_TASKS];
+    UBaseType_t task_count;
+    configRUN_TIME_COUNTER_TYPE total_runtime;
+} bench_snapshot_t;
+
+/**
+ * @brief Kết quả 1 bậc (cho bảng tổng kết)
+ */
+typedef struct {
+    uint32_t rate_hz;
+    float throughput;           // Mẫu publish/s
+    uint32_t drops;             // Publish drop + drop của consumer DROP_OLDEST/BLOCK
+    uint32_t p99_publish_us;
+    uint32_t p99_alert_us;
+    uint32_t p99_web_us;
+    bool saturated;
+} bench_result_t;
+
+// ==================== GLOBAL STATE ====================
+
+static const uint32_t s_rates_hz[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 };
+#define BENCH_RATE_COUNT    (sizeof(s_rates_hz) / sizeof(s_rates_hz[0]))
+
+static esp_timer_handle_t s_timer = NULL;
+static TaskHandle_t s_sensor_task = NULL;
+static int64_t s_period_us = 0;
+
+static atomic_uint_fast32_t s_fired = 0;
+static atomic_uint_fast32_t s_reads = 0;
+
+// Ảnh chụp lớn (~1 KB mỗi cái) => static thay vì trên stack
+static bench_snapshot_t s_before;
+static bench_snapshot_t s_after;
+static bench_result_t s_results[BENCH_RATE_COUNT];
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Timer tổng hợp: giống sampler_timer_callback()
+ */
+static void bench_timer_callback(void *arg) {
+    latency_mark_fire(s_period_us);
+    atomic_fetch_add_explicit(&s_fired, 1, memory_order_relaxed);
+    xTaskNotifyGive(s_sensor_task);
+}
+
+static void take_snapshot(bench_snapshot_t *snap) {
+    snap->time_us = esp_timer_get_time();
+    snap->fired = atomic_load_explicit(&s_fired, memory_order_relaxed);
+    snap->reads = atomic_load_explicit(&s_reads, memory_order_relaxed);
+    snap->publish_drops = sample_bus_get_publish_drops();
+
+    for (int i = 0; i < sample_bus_get_subscriber_count(); i++) {
+        sample_bus_sub_stats_t st;
+        if (sample_bus_get_stats(i, &st) == ESP_OK) {
+            snap->delivered[i] = st.delivered;
+            snap->dropped[i] = st.dropped;
+        }
+    }
+
+    snap->task_count = uxTaskGetSystemState(snap->tasks, PIPELINE_BENCH_MAX_TASKS, &snap->total_runtime);
+}
+
+/**
+ * @brief In % CPU của từng task trong bậc vừa chạy (phép trừ không dấu => đúng khi bộ đếm quay vòng)
+ */
+static void print_cpu(const bench_snapshot_t *before, const bench_snapshot_t *after) {
+    uint32_t total = (uint32_t)after->total_runtime - (uint32_t)before->total_runtime;
+
+    if (total == 0) {
+        return;
+    }
+    printf("  %-16s %6s\n", "task", "cpu%");
+    for (UBaseType_t i = 0; i < after->task_count; i++) {
+        uint32_t prev = 0;
+        for (UBaseType_t j = 0; j < before->task_count; j++) {
+            if (before->tasks[j].xHandle == after->tasks[i].xHandle) {
+                prev = (uint32_t)before->tasks[j].ulRunTimeCounter;
+                break;
+            }
+        }
+        uint32_t delta = (uint32_t)after->tasks[i].ulRunTimeCounter - prev;
+        float pct = 100.0f * (float)delta / (float)total;
+        if (pct >= 0.1f) {
+            printf("  %-16s %6.1f\n", after->tasks[i].pcTaskName, pct);
+        }
+    }
+}
+
+/**
+ * @brief Chạy 1 bậc tần số và in kết quả chi tiết
+ */
+static void run_step(uint32_t rate_hz, bench_result_t *result) {
+    latency_summary_t lat[LATENCY_STAGE_MAX];
+    uint32_t drops = 0;
+
+    s_period_us = 1000000 / rate_hz;
+    latency_reset();
+    take_snapshot(&s_before);
+
+    esp_timer_start_periodic(s_timer, (uint64_t)s_period_us);
+    vTaskDelay(pdMS_TO_TICKS(PIPELINE_BENCH_STEP_MS));
+    esp_timer_stop(s_timer);
+
+    // Chụp ngay khi dừng: throughput là những gì pipeline theo kịp trong cửa sổ đo
+    take_snapshot(&s_after);
+    for (int i = 0; i < LATENCY_STAGE_MAX; i++) {
+        latency_get_summary((latency_stage_t)i, &lat[i]);
+    }
+
+    float window_s = (float)(s_after.time_us - s_before.time_us) / 1e6f;
+    uint32_t fired = s_after.fired - s_before.fired;
+    uint32_t reads = s_after.reads - s_before.reads;
+    uint32_t publish_drops = s_after.publish_drops - s_before.publish_drops;
+    uint32_t published = reads - publish_drops;
+
+    printf("\n=== %" PRIu32 " Hz (%.1f s) ===\n", rate_hz, window_s);
+    printf("  fired %" PRIu32 "  read %" PRIu32 "  published %" PRIu32 " (%.1f/s)  missed %" PRIu32
+           "  publish_drops %" PRIu32 "\n",
+           fired, reads, published, published / window_s, fired - reads, publish_drops);
+
+    printf("  %-10s %-12s %12s %8s\n", "consumer", "policy", "delivered/s", "dropped");
+    for (int i = 0; i < sample_bus_get_subscriber_count(); i++) {
+        sample_bus_sub_stats_t st;
+        if (sample_bus_get_stats(i, &st) != ESP_OK) {
+            continue;
+        }
+        uint32_t delivered = s_after.delivered[i] - s_before.delivered[i];
+        uint32_t dropped = s_after.dropped[i] - s_before.dropped[i];
+        static const char *const policy_names[] = { "LATEST_ONLY", "DROP_OLDEST", "BLOCK" };
+        printf("  %-10s %-12s %12.1f %8" PRIu32 "\n", st.name, policy_names[st.policy],
+               delivered / window_s, dropped);
+
+        // LATEST_ONLY bỏ mẫu cũ theo thiết kế (display), không tính là mất dữ liệu
+        if (st.policy != SAMPLE_BUS_LATEST_ONLY) {
+            drops += dropped;
+        }
+    }
+
+    printf("  %-8s %8s %10s %10s %10s\n", "stage", "count", "p50_us", "p99_us", "max_us");
+    for (int i = 0; i < LATENCY_STAGE_MAX; i++) {
+        if (lat[i].count == 0) {
+            continue;
+        }
+        printf("  %-8s %8" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 "\n",
+               latency_stage_name((latency_stage_t)i), lat[i].count, lat[i].p50_us, lat[i].p99_us, lat[i].max_us);
+    }
+    print_cpu(&s_before, &s_after);
+
+    result->rate_hz = rate_hz;
+    result->throughput = published / window_s;
+    result->drops = drops + publish_drops;
+    result->p99_publish_us = lat[LATENCY_STAGE_PUBLISH].p99_us;
+    result->p99_alert_us = lat[LATENCY_STAGE_ALERT].p99_us;
+    result->p99_web_us = lat[LATENCY_STAGE_WEB].p99_us;
+    result->saturated = result->drops > 0 ||
+                        result->throughput * 100.0f < (float)rate_hz * PIPELINE_BENCH_SATURATED_PCT;
+
+    // Để consumer xử lý hết mẫu còn trong ring trước bậc kế tiếp
+    vTaskDelay(pdMS_TO_TICKS(PIPELINE_BENCH_DRAIN_MS));
+}
+
+/**
+ * @brief Task benchmark: chạy lần lượt các bậc <= PIPELINE_BENCH_MAX_HZ rồi in bảng tổng kết
+ */
+static void bench_task(void *pvParameters) {
+    int steps = 0;
+    int first_saturated = -1;
+
+    ESP_LOGI(TAG, "Pipeline benchmark: up to %d Hz, %d ms per step", PIPELINE_BENCH_MAX_HZ, PIPELINE_BENCH_STEP_MS);
+
+    // sensor_task log mỗi mẫu: ở kHz UART sẽ là nút cổ chai chứ không phải pipeline => tắt log khi đo
+    esp_log_level_set("*", ESP_LOG_ERROR);
+
+    for (size_t i = 0; i < BENCH_RATE_COUNT && s_rates_hz[i] <= PIPELINE_BENCH_MAX_HZ; i++) {
+        run_step(s_rates_hz[i], &s_results[i]);
+        steps++;
+        if (s_results[i].saturated && first_saturated < 0) {
+            first_saturated = (int)i;
+        }
+    }
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    printf("\n=== Pipeline benchmark summary ===\n");
+    printf("%8s %12s %8s %14s %12s %10s\n", "rate_hz", "samples/s", "drops", "p99_publish_us",
+           "p99_alert_us", "p99_web_us");
+    for (int i = 0; i < steps; i++) {
+        const bench_result_t *r = &s_results[i];
+        printf("%8" PRIu32 " %12.1f %8" PRIu32 " %14" PRIu32 " %12" PRIu32 " %10" PRIu32 "%s\n",
+               r->rate_hz, r->throughput, r->drops, r->p99_publish_us, r->p99_alert_us, r->p99_web_us,
+               r->saturated ? "  << saturated" : "");
+    }
+    if (first_saturated < 0) {
+        printf("No saturation up to %d Hz\n", PIPELINE_BENCH_MAX_HZ);
+    } else if (first_saturated == 0) {
+        printf("Saturated at the first step (%" PRIu32 " Hz)\n", s_rates_hz[0]);
+    } else {
+        printf("Sustained: %" PRIu32 " Hz, saturates at %" PRIu32 " Hz\n",
+               s_rates_hz[first_saturated - 1], s_rates_hz[first_saturated]);
+    }
+
+#if CONFIG_IDF_TARGET_LINUX
+    // Host: thoát sau bảng tổng kết để chạy được trong script/CI (giống replay);
+    // bão hòa ngay từ bậc đầu => pipeline hỏng => mã lỗi
+    fflush(stdout);
+    exit(first_saturated == 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+#endif
+    vTaskDelete(NULL);
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t pipeline_bench_start(TaskHandle_t sensor_task) {
+    const esp_timer_create_args_t args = {
+        .callback = bench_timer_callback,
+        .name = "bench_sensor",
+    };
+
+    s_sensor_task = sensor_task;
+    esp_err_t ret = esp_timer_create(&args, &s_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create benchmark timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (xTaskCreate(bench_task, "bench_task", 4096, NULL, PIPELINE_BENCH_TASK_PRIORITY, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pipeline_bench_read(float *temperature, float *humidity) {
+    uint32_t n = atomic_fetch_add_explicit(&s_reads, 1, memory_order_relaxed);
+    uint32_t phase = n % PIPELINE_BENCH_WAVE_SAMPLES;
+    uint32_t half = PIPELINE_BENCH_WAVE_SAMPLES / 2;
+    uint32_t up = (phase < half) ? phase : PIPELINE_BENCH_WAVE_SAMPLES - phase;
+
+    // Sóng tam giác 25.0 -> 50.0°C, bước 0.1°C: đi qua cả TEMP_WARNING và TEMP_OVERHEAT
+    *temperature = 25.0f + (float)(up * 250 / half) / 10.0f;
+    *humidity = 55.0f;
+    return ESP_OK;
+}
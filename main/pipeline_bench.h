@@ -0,0 +1,49 @@
+/**
+ * @file pipeline_bench.h
+ * @brief Pipeline Stress Benchmark - Cảm biến tổng hợp tốc độ cao cho sensor_task -> display/alert/web/log
+ * @features Tăng dần tần số tới kHz, throughput, số mẫu bỏ theo consumer, CPU theo task, độ trễ đuôi
+ *
+ * Bật bằng menuconfig (CONFIG_PIPELINE_BENCH): app_main gọi pipeline_bench_start() thay cho
+ * sampler_start() và sensor_task đọc pipeline_bench_read() thay cho dht22_read().
+ */
+
+#ifndef PIPELINE_BENCH_H
+#define PIPELINE_BENCH_H
+
+#include "config.h"
+
+// ==================== BENCHMARK CONFIGURATION ====================
+
+#ifdef CONFIG_PIPELINE_BENCH_MAX_HZ
+#define PIPELINE_BENCH_MAX_HZ           CONFIG_PIPELINE_BENCH_MAX_HZ
+#else
+#define PIPELINE_BENCH_MAX_HZ           1000    // menuconfig: Temperature Monitor Configuration
+#endif
+
+#ifdef CONFIG_PIPELINE_BENCH_STEP_MS
+#define PIPELINE_BENCH_STEP_MS          CONFIG_PIPELINE_BENCH_STEP_MS
+#else
+#define PIPELINE_BENCH_STEP_MS          5000
+#endif
+
+#define PIPELINE_BENCH_DRAIN_MS         500     // Chờ consumer xử lý hết giữa 2 bậc
+#define PIPELINE_BENCH_SATURATED_PCT    95      // Throughput < 95% tần số đặt => bão hòa
+#define PIPELINE_BENCH_WAVE_SAMPLES     500     // Chu kỳ sóng tam giác 25 -> 50 -> 25°C (đi qua 2 ngưỡng)
+#define PIPELINE_BENCH_MAX_TASKS        24
+#define PIPELINE_BENCH_TASK_PRIORITY    6       // Trên sensor_task để đo đúng thời điểm
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Tạo timer tổng hợp và task chạy các bậc tần số (in kết quả ra console)
+ * @param sensor_task Task được đánh thức thay cho sensor_timer
+ */
+esp_err_t pipeline_bench_start(TaskHandle_t sensor_task);
+
+/**
+ * @brief Nguồn thay cho dht22_read(): trả về ngay, không chạm phần cứng
+ * @return ESP_OK
+ */
+esp_err_t pipeline_bench_read(float *temperature, float *humidity);
+
+#endif // PIPELINE_BENCH_H
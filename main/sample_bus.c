@@ -0,0 +1,260 @@
+/**
+ * @file sample_bus.c
+ * @brief Sample Bus Implementation
+ *
+ * Publisher ghi mỗi mẫu đúng 1 lần vào ring s_ring. Mỗi subscriber chỉ giữ
+ * cursor (seq của mẫu tiếp theo cần đọc) và đọc mẫu bằng con trỏ, nên thêm
+ * consumer không tốn thêm bản sao hay hàng đợi nào - chỉ 1 lần đăng ký.
+ *
+ * Slot đang được subscriber giữ (giữa receive và release) không bao giờ bị
+ * ghi đè: publisher sẽ chờ tối đa SAMPLE_BUS_PUBLISH_TIMEOUT_MS rồi bỏ mẫu.
+ */
+
+#include "sample_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "SAMPLE_BUS";
+
+// ==================== DATA STRUCTURES ====================
+
+struct sample_bus_sub {
+    const char *name;
+    sample_bus_policy_t policy;
+    uint32_t cursor;                // Seq của mẫu tiếp theo cần đọc
+    bool holding;                   // Đang giữ slot cursor % SAMPLE_BUS_DEPTH
+    SemaphoreHandle_t wake;         // Được give mỗi khi có mẫu mới
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t max_depth;
+};
+
+// ==================== GLOBAL STATE ====================
+
+static sample_t s_ring[SAMPLE_BUS_DEPTH];
+static uint8_t s_holds[SAMPLE_BUS_DEPTH];     // Số subscriber đang giữ mỗi slot
+static uint32_t s_head = 0;                    // Seq của mẫu sẽ publish tiếp theo
+
+static struct sample_bus_sub s_subs[SAMPLE_BUS_MAX_SUBSCRIBERS];
+static int s_num_subs = 0;
+
+static SemaphoreHandle_t s_space = NULL;       // Được give khi subscriber nhả slot
+static uint32_t s_publish_drops = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Kiểm tra slot kế tiếp có ghi được không (gọi trong critical section)
+ */
+static bool slot_writable(void) {
+    if (s_holds[s_head % SAMPLE_BUS_DEPTH] > 0) {
+        return false;
+    }
+
+    for (int i = 0; i < s_num_subs; i++) {
+        const struct sample_bus_sub *sub = &s_subs[i];
+        if (sub->policy == SAMPLE_BUS_BLOCK && s_head - sub->cursor >= SAMPLE_BUS_DEPTH) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Ghi mẫu vào slot kế tiếp và đẩy các subscriber tụt hậu (gọi trong critical section)
+ */
+static void commit_sample(const sensor_data_t *data, system_state_t state,
+                          const latency_stamps_t *stamps, int64_t now_us) {
+    // Subscriber chưa đọc mẫu sắp bị ghi đè => bỏ mẫu cũ nhất
+    for (int i = 0; i < s_num_subs; i++) {
+        struct sample_bus_sub *sub = &s_subs[i];
+        if (s_head - sub->cursor >= SAMPLE_BUS_DEPTH) {
+            uint32_t oldest = s_head - SAMPLE_BUS_DEPTH + 1;
+            sub->dropped += oldest - sub->cursor;
+            sub->cursor = oldest;
+        }
+    }
+
+    sample_t *slot = &s_ring[s_head % SAMPLE_BUS_DEPTH];
+    slot->data = *data;
+    slot->state = state;
+    slot->seq = s_head + 1;     // Seq bắt đầu từ 1 => since=0 nghĩa là "mọi mẫu"
+    if (stamps != NULL) {
+        slot->stamps = *stamps;
+    } else {
+        memset(&slot->stamps, 0, sizeof(slot->stamps));
+    }
+    slot->stamps.publish_us = now_us;
+    s_head++;
+
+    for (int i = 0; i < s_num_subs; i++) {
+        struct sample_bus_sub *sub = &s_subs[i];
+        uint32_t depth = s_head - sub->cursor;
+        if (depth > sub->max_depth) {
+            sub->max_depth = depth;
+        }
+    }
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t sample_bus_init(void) {
+    s_space = xSemaphoreCreateBinary();
+    if (s_space == NULL) {
+        ESP_LOGE(TAG, "Failed to create bus semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Sample bus initialized (depth=%d, max subscribers=%d)",
+             SAMPLE_BUS_DEPTH, SAMPLE_BUS_MAX_SUBSCRIBERS);
+    return ESP_OK;
+}
+
+void sample_bus_deinit(void) {
+    for (int i = 0; i < s_num_subs; i++) {
+        vSemaphoreDelete(s_subs[i].wake);
+    }
+    if (s_space != NULL) {
+        vSemaphoreDelete(s_space);
+    }
+
+    memset(s_subs, 0, sizeof(s_subs));
+    memset(s_holds, 0, sizeof(s_holds));
+    s_num_subs = 0;
+    s_head = 0;
+    s_space = NULL;
+    s_publish_drops = 0;
+}
+
+sample_bus_sub_t sample_bus_subscribe(const char *name, sample_bus_policy_t policy) {
+    SemaphoreHandle_t wake = xSemaphoreCreateBinary();
+    if (wake == NULL) {
+        ESP_LOGE(TAG, "Failed to create semaphore for %s", name);
+        return NULL;
+    }
+
+    struct sample_bus_sub *sub = NULL;
+    taskENTER_CRITICAL(&s_lock);
+    if (s_num_subs < SAMPLE_BUS_MAX_SUBSCRIBERS) {
+        sub = &s_subs[s_num_subs];
+        memset(sub, 0, sizeof(*sub));
+        sub->name = name;
+        sub->policy = policy;
+        sub->cursor = s_head;
+        sub->wake = wake;
+        s_num_subs++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (sub == NULL) {
+        ESP_LOGE(TAG, "No free subscriber slot for %s", name);
+        vSemaphoreDelete(wake);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Subscriber '%s' registered (policy=%d)", name, policy);
+    return sub;
+}
+
+esp_err_t sample_bus_publish(const sensor_data_t *data, system_state_t state,
+                             const latency_stamps_t *stamps) {
+    TickType_t start = xTaskGetTickCount();
+    TickType_t limit = pdMS_TO_TICKS(SAMPLE_BUS_PUBLISH_TIMEOUT_MS);
+
+    while (1) {
+        int64_t now_us = esp_timer_get_time();
+
+        taskENTER_CRITICAL(&s_lock);
+        bool writable = slot_writable();
+        if (writable) {
+            commit_sample(data, state, stamps, now_us);
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (writable) {
+            for (int i = 0; i < s_num_subs; i++) {
+                xSemaphoreGive(s_subs[i].wake);
+            }
+            return ESP_OK;
+        }
+
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= limit || xSemaphoreTake(s_space, limit - elapsed) != pdTRUE) {
+            taskENTER_CRITICAL(&s_lock);
+            s_publish_drops++;
+            taskEXIT_CRITICAL(&s_lock);
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+const sample_t *sample_bus_receive(sample_bus_sub_t sub, TickType_t timeout) {
+    if (sub->holding) {
+        sample_bus_release(sub);
+    }
+
+    while (1) {
+        const sample_t *sample = NULL;
+
+        taskENTER_CRITICAL(&s_lock);
+        if (sub->cursor != s_head) {
+            // LATEST_ONLY: bỏ qua mọi mẫu cũ, chỉ đọc mẫu mới nhất
+            if (sub->policy == SAMPLE_BUS_LATEST_ONLY && s_head - sub->cursor > 1) {
+                sub->dropped += s_head - 1 - sub->cursor;
+                sub->cursor = s_head - 1;
+            }
+            uint32_t idx = sub->cursor % SAMPLE_BUS_DEPTH;
+            s_holds[idx]++;
+            sub->holding = true;
+            sample = &s_ring[idx];
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (sample != NULL) {
+            return sample;
+        }
+        if (xSemaphoreTake(sub->wake, timeout) != pdTRUE) {
+            return NULL;
+        }
+    }
+}
+
+void sample_bus_release(sample_bus_sub_t sub) {
+    taskENTER_CRITICAL(&s_lock);
+    if (sub->holding) {
+        s_holds[sub->cursor % SAMPLE_BUS_DEPTH]--;
+        sub->cursor++;
+        sub->delivered++;
+        sub->holding = false;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    xSemaphoreGive(s_space);
+}
+
+int sample_bus_get_subscriber_count(void) {
+    return s_num_subs;
+}
+
+esp_err_t sample_bus_get_stats(int index, sample_bus_sub_stats_t *stats) {
+    if (index < 0 || index >= s_num_subs || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    const struct sample_bus_sub *sub = &s_subs[index];
+    stats->name = sub->name;
+    stats->policy = sub->policy;
+    stats->delivered = sub->delivered;
+    stats->dropped = sub->dropped;
+    stats->depth = s_head - sub->cursor;
+    stats->max_depth = sub->max_depth;
+    taskEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+uint32_t sample_bus_get_publish_drops(void) {
+    return s_publish_drops;
+}
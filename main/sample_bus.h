@@ -0,0 +1,111 @@
+/**
+ * @file sample_bus.h
+ * @brief Sample Bus - Publish/subscribe mẫu cảm biến không sao chép
+ * @features Ring dùng chung, cursor riêng cho mỗi subscriber, chính sách backpressure
+ */
+
+#ifndef SAMPLE_BUS_H
+#define SAMPLE_BUS_H
+
+#include "config.h"
+#include "latency.h"
+
+// ==================== SAMPLE BUS CONFIGURATION ====================
+
+#define SAMPLE_BUS_DEPTH                8       // Số mẫu trong ring dùng chung
+#define SAMPLE_BUS_MAX_SUBSCRIBERS      6
+#define SAMPLE_BUS_PUBLISH_TIMEOUT_MS   100     // Thời gian chờ tối đa khi có subscriber BLOCK
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Một mẫu trên bus (subscriber đọc trực tiếp bằng con trỏ)
+ */
+typedef struct {
+    sensor_data_t data;
+    system_state_t state;
+    uint32_t seq;           // Số thứ tự tăng dần của mẫu (từ 1, không lặp lại)
+    latency_stamps_t stamps;    // Dấu thời gian từng giai đoạn (publish_us do bus điền)
+} sample_t;
+
+/**
+ * @brief Chính sách khi subscriber không theo kịp publisher
+ */
+typedef enum {
+    SAMPLE_BUS_LATEST_ONLY = 0, // Chỉ đọc mẫu mới nhất, bỏ qua các mẫu cũ (display)
+    SAMPLE_BUS_DROP_OLDEST,     // Ring đầy => bỏ mẫu cũ nhất chưa đọc
+    SAMPLE_BUS_BLOCK,           // Ring đầy => publisher chờ subscriber (có timeout)
+} sample_bus_policy_t;
+
+/**
+ * @brief Handle subscriber
+ */
+typedef struct sample_bus_sub *sample_bus_sub_t;
+
+/**
+ * @brief Thống kê của 1 subscriber
+ */
+typedef struct {
+    const char *name;
+    sample_bus_policy_t policy;
+    uint32_t delivered;     // Số mẫu đã đọc xong
+    uint32_t dropped;       // Số mẫu bị bỏ qua do tràn (overflow)
+    uint32_t depth;         // Số mẫu chưa đọc hiện tại
+    uint32_t max_depth;     // Số mẫu chưa đọc lớn nhất quan sát được
+} sample_bus_sub_stats_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Khởi tạo sample bus
+ * @return ESP_OK nếu thành công
+ */
+esp_err_t sample_bus_init(void);
+
+/**
+ * @brief Xóa ring và mọi subscriber (handle cũ không còn hợp lệ); gọi sample_bus_init để dùng lại
+ */
+void sample_bus_deinit(void);
+
+/**
+ * @brief Đăng ký subscriber mới (nhận các mẫu publish sau thời điểm đăng ký)
+ * @return Handle, hoặc NULL nếu hết chỗ
+ */
+sample_bus_sub_t sample_bus_subscribe(const char *name, sample_bus_policy_t policy);
+
+/**
+ * @brief Publish 1 mẫu vào ring dùng chung (chỉ 1 publisher)
+ * @return ESP_OK, hoặc ESP_ERR_TIMEOUT nếu subscriber BLOCK/đang giữ mẫu không nhả kịp
+ */
+esp_err_t sample_bus_publish(const sensor_data_t *data, system_state_t state,
+                             const latency_stamps_t *stamps);
+
+/**
+ * @brief Chờ mẫu tiếp theo của subscriber
+ *
+ * Con trỏ trỏ thẳng vào ring và hợp lệ cho tới khi gọi sample_bus_release().
+ * @return Con trỏ mẫu, hoặc NULL nếu timeout
+ */
+const sample_t *sample_bus_receive(sample_bus_sub_t sub, TickType_t timeout);
+
+/**
+ * @brief Nhả mẫu đã nhận và tiến cursor
+ */
+void sample_bus_release(sample_bus_sub_t sub);
+
+/**
+ * @brief Số subscriber đã đăng ký
+ */
+int sample_bus_get_subscriber_count(void);
+
+/**
+ * @brief Lấy thống kê subscriber thứ index
+ */
+esp_err_t sample_bus_get_stats(int index, sample_bus_sub_stats_t *stats);
+
+/**
+ * @brief Số mẫu publisher phải bỏ vì hết thời gian chờ
+ */
+uint32_t sample_bus_get_publish_drops(void);
+
+#endif // SAMPLE_BUS_H
@@ -0,0 +1,385 @@
+/**
+ * @file sample_log.c
+ * @brief Sample Log Implementation
+ *
+ * Bố cục partition: N sector 4 KB, dùng xoay vòng. Slot 0 của mỗi sector là
+ * header (magic, seq tăng dần, boot, CRC), slot 1..255 là bản ghi 16 byte.
+ * Sector có seq lớn nhất là sector đang ghi (head); sector kế tiếp theo vòng
+ * là sector cũ nhất và sẽ bị xóa khi head đầy => mỗi sector bị xóa đúng 1 lần
+ * mỗi vòng (wear-levelling tự nhiên, không cần bảng ánh xạ).
+ *
+ * Bản ghi được gom trong RAM tới biên trang 256 byte rồi ghi 1 lần. Mất điện
+ * giữa chừng chỉ làm hỏng các slot của trang đang ghi: khi mount, slot có CRC
+ * sai bị đếm là rách và bỏ qua, việc ghi tiếp tục từ slot sau bản ghi cuối cùng.
+ *
+ * Reader đọc trực tiếp vùng mmap, kiểm tra s_sector_seq trước và sau khi chép
+ * để biết sector có bị xóa trong lúc đọc không (writer đặt về 0 trước khi xóa).
+ */
+
+#include "sample_log.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "SAMPLE_LOG";
+
+#define SECTOR_MAGIC    0x31474C53  // "SLG1"
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Header ở slot 0 của mỗi sector
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;               // Thứ tự mở sector (từ 1, không lặp lại)
+    uint16_t boot;              // Boot lúc mở sector
+    uint8_t reserved[5];        // Giữ 0xFF
+    uint8_t crc;                // CRC-8 của 15 byte đầu
+} sector_header_t;
+
+_Static_assert(sizeof(sector_header_t) == SAMPLE_LOG_RECORD_SIZE, "sector_header_t layout");
+
+// ==================== GLOBAL STATE ====================
+
+static const esp_partition_t *s_part = NULL;
+static const uint8_t *s_map = NULL;
+static esp_partition_mmap_handle_t s_map_handle;
+static uint32_t s_num_sectors = 0;
+static uint32_t s_seq_base = 0;             // Sector vật lý của seq 1 (seq n ở (n - 1 + base) % N)
+static atomic_uint *s_sector_seq = NULL;    // Seq của từng sector vật lý, 0 = trống/hỏng/đang xóa
+
+// Chỉ writer truy cập
+static uint32_t s_head_sector = 0;
+static uint32_t s_head_seq = 0;
+static uint32_t s_flash_slot = 1;           // Slot kế tiếp chưa ghi của sector head
+static uint16_t s_boot = 0;
+static sample_log_record_t s_page[SAMPLE_LOG_RECORDS_PER_PAGE];  // Phần trang chờ ghi
+static uint32_t s_pending = 0;
+
+static atomic_uint s_end_lsn = 0;           // LSN kế tiếp sẽ xuất hiện trên flash
+static sample_log_stats_t s_stats;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief CRC-8 (đa thức 0x07)
+ */
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool slot_erased(const uint8_t *slot) {
+    for (int i = 0; i < SAMPLE_LOG_RECORD_SIZE; i++) {
+        if (slot[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool record_valid(const sample_log_record_t *r) {
+    return r->crc == crc8((const uint8_t *)r, SAMPLE_LOG_RECORD_SIZE - 1);
+}
+
+static const uint8_t *slot_ptr(uint32_t sector, uint32_t slot) {
+    return s_map + sector * SAMPLE_LOG_SECTOR_SIZE + slot * SAMPLE_LOG_RECORD_SIZE;
+}
+
+static bool header_valid(const sector_header_t *h) {
+    return h->magic == SECTOR_MAGIC && h->seq != 0 &&
+           h->crc == crc8((const uint8_t *)h, sizeof(*h) - 1);
+}
+
+static uint32_t sector_of_seq(uint32_t seq) {
+    return (seq - 1 + s_seq_base) % s_num_sectors;
+}
+
+/**
+ * @brief Xóa sector kế tiếp theo vòng và ghi header seq mới
+ */
+static esp_err_t open_sector(uint32_t seq) {
+    uint32_t sector = sector_of_seq(seq);
+    size_t offset = (size_t)sector * SAMPLE_LOG_SECTOR_SIZE;
+
+    // Reader phải thấy sector không còn hợp lệ trước khi dữ liệu cũ bị xóa
+    atomic_store_explicit(&s_sector_seq[sector], 0, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    esp_err_t ret = esp_partition_erase_range(s_part, offset, SAMPLE_LOG_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erase sector %" PRIu32 " failed: %s", sector, esp_err_to_name(ret));
+        s_stats.write_errors++;
+        return ret;
+    }
+    s_stats.erases++;
+
+    sector_header_t hdr;
+    memset(&hdr, 0xFF, sizeof(hdr));
+    hdr.magic = SECTOR_MAGIC;
+    hdr.seq = seq;
+    hdr.boot = s_boot;
+    hdr.crc = crc8((const uint8_t *)&hdr, sizeof(hdr) - 1);
+    ret = esp_partition_write(s_part, offset, &hdr, sizeof(hdr));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Write header %" PRIu32 " failed: %s", sector, esp_err_to_name(ret));
+        s_stats.write_errors++;
+        return ret;
+    }
+
+    s_head_sector = sector;
+    s_head_seq = seq;
+    s_flash_slot = 1;
+    atomic_store_explicit(&s_sector_seq[sector], seq, memory_order_release);
+    atomic_store_explicit(&s_end_lsn, seq * SAMPLE_LOG_RECORDS_PER_SECTOR, memory_order_release);
+    return ESP_OK;
+}
+
+/**
+ * @brief Ghi phần trang đang chờ vào các slot trống kế tiếp của sector head
+ */
+static esp_err_t write_pending(void) {
+    size_t offset = (size_t)s_head_sector * SAMPLE_LOG_SECTOR_SIZE + s_flash_slot * SAMPLE_LOG_RECORD_SIZE;
+    esp_err_t ret = esp_partition_write(s_part, offset, s_page, s_pending * SAMPLE_LOG_RECORD_SIZE);
+
+    if (ret != ESP_OK) {
+        // Slot có thể đã bị ghi 1 phần => bỏ qua, CRC sẽ loại chúng khi đọc
+        ESP_LOGE(TAG, "Write page failed: %s", esp_err_to_name(ret));
+        s_stats.write_errors++;
+    } else {
+        s_stats.pages_written++;
+    }
+
+    s_flash_slot += s_pending;
+    s_pending = 0;
+    atomic_store_explicit(&s_end_lsn, s_head_seq * SAMPLE_LOG_RECORDS_PER_SECTOR + s_flash_slot - 1,
+                          memory_order_release);
+    return ret;
+}
+
+/**
+ * @brief Tìm slot ghi tiếp trong sector head, đếm slot rách, lấy boot lớn nhất
+ */
+static void recover_head(uint16_t *max_boot) {
+    uint32_t last = 0;
+
+    // Slot cuối cùng đã bị động tới (kể cả ghi dở)
+    for (uint32_t slot = SAMPLE_LOG_RECORDS_PER_SECTOR; slot >= 1; slot--) {
+        if (!slot_erased(slot_ptr(s_head_sector, slot))) {
+            last = slot;
+            break;
+        }
+    }
+
+    for (uint32_t slot = 1; slot <= last; slot++) {
+        sample_log_record_t r;
+        memcpy(&r, slot_ptr(s_head_sector, slot), sizeof(r));
+        if (!record_valid(&r)) {
+            s_stats.torn++;
+        } else if (r.boot > *max_boot) {
+            *max_boot = r.boot;
+        }
+    }
+    s_flash_slot = last + 1;
+
+    if (s_stats.torn > 0) {
+        ESP_LOGW(TAG, "Recovered from torn write: %" PRIu32 " slot(s) skipped", s_stats.torn);
+    }
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t sample_log_init(void) {
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                      SAMPLE_LOG_PARTITION_LABEL);
+    if (s_part == NULL) {
+        ESP_LOGW(TAG, "Partition '%s' not found, sample log disabled", SAMPLE_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_num_sectors = s_part->size / SAMPLE_LOG_SECTOR_SIZE;
+    if (s_num_sectors < 2) {
+        ESP_LOGE(TAG, "Partition too small (%" PRIu32 " bytes)", s_part->size);
+        s_part = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const void *map;
+    esp_err_t ret = esp_partition_mmap(s_part, 0, (size_t)s_num_sectors * SAMPLE_LOG_SECTOR_SIZE,
+                                       ESP_PARTITION_MMAP_DATA, &map, &s_map_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "mmap failed: %s", esp_err_to_name(ret));
+        s_part = NULL;
+        return ret;
+    }
+    s_map = map;
+
+    s_sector_seq = calloc(s_num_sectors, sizeof(*s_sector_seq));
+    if (s_sector_seq == NULL) {
+        esp_partition_munmap(s_map_handle);
+        s_map = NULL;
+        s_part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Header hợp lệ có seq lớn nhất = sector head
+    uint16_t max_boot = 0;
+    bool found = false;
+    for (uint32_t sector = 0; sector < s_num_sectors; sector++) {
+        sector_header_t hdr;
+        memcpy(&hdr, slot_ptr(sector, 0), sizeof(hdr));
+        if (!header_valid(&hdr)) {
+            continue;
+        }
+        atomic_store_explicit(&s_sector_seq[sector], hdr.seq, memory_order_relaxed);
+        if (!found || hdr.seq > s_head_seq) {
+            s_head_seq = hdr.seq;
+            s_head_sector = sector;
+            max_boot = hdr.boot;
+            found = true;
+        }
+    }
+
+    if (found) {
+        s_seq_base = (s_head_sector + s_num_sectors - (s_head_seq - 1) % s_num_sectors) % s_num_sectors;
+        recover_head(&max_boot);
+        s_boot = max_boot + 1;
+        atomic_store_explicit(&s_end_lsn, s_head_seq * SAMPLE_LOG_RECORDS_PER_SECTOR + s_flash_slot - 1,
+                              memory_order_release);
+    } else {
+        // Partition mới => mở sector 0 với seq 1
+        s_seq_base = 0;
+        s_boot = 1;
+        ret = open_sector(1);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    sample_log_span_t span = sample_log_get_span();
+    ESP_LOGI(TAG, "✓ Sample log mounted: %" PRIu32 " sectors, %" PRIu32 " records, boot %u",
+             s_num_sectors, span.end - span.begin, s_boot);
+    return ESP_OK;
+}
+
+void sample_log_deinit(void) {
+    if (s_map != NULL) {
+        esp_partition_munmap(s_map_handle);
+    }
+    free(s_sector_seq);
+
+    s_part = NULL;
+    s_map = NULL;
+    s_sector_seq = NULL;
+    s_num_sectors = 0;
+    s_seq_base = 0;
+    s_head_sector = 0;
+    s_head_seq = 0;
+    s_flash_slot = 1;
+    s_boot = 0;
+    s_pending = 0;
+    atomic_store_explicit(&s_end_lsn, 0, memory_order_release);
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+esp_err_t sample_log_append(const sample_t *sample) {
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Sector head đầy (phần chờ luôn được ghi ở biên trang/sector) => mở sector mới
+    if (s_flash_slot > SAMPLE_LOG_RECORDS_PER_SECTOR) {
+        esp_err_t ret = open_sector(s_head_seq + 1);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    sample_log_record_t *r = &s_page[s_pending++];
+    float temp = sample->data.temperature * 10.0f;
+    float hum = sample->data.humidity * 10.0f;
+    r->uptime_ms = (uint32_t)(sample->data.timestamp / 1000);
+    r->seq = sample->seq;
+    r->temp_deci = (int16_t)(temp + (temp >= 0 ? 0.5f : -0.5f));
+    r->hum_deci = (uint16_t)(hum + 0.5f);
+    r->boot = s_boot;
+    r->flags = ((uint8_t)sample->state & SAMPLE_LOG_FLAG_STATE_MASK) |
+               (sample->data.is_valid ? SAMPLE_LOG_FLAG_VALID : 0);
+    r->crc = crc8((const uint8_t *)r, SAMPLE_LOG_RECORD_SIZE - 1);
+
+    // Đủ tới biên trang (cũng là cuối sector) => ghi 1 lần
+    if ((s_flash_slot + s_pending) % SAMPLE_LOG_RECORDS_PER_PAGE == 0) {
+        return write_pending();
+    }
+    return ESP_OK;
+}
+
+esp_err_t sample_log_flush(void) {
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return (s_pending > 0) ? write_pending() : ESP_OK;
+}
+
+sample_log_span_t sample_log_get_span(void) {
+    sample_log_span_t span = { 0, 0 };
+    if (s_sector_seq == NULL) {
+        return span;
+    }
+
+    span.end = atomic_load_explicit(&s_end_lsn, memory_order_acquire);
+
+    // Sector hợp lệ cũ nhất
+    uint32_t oldest = 0;
+    for (uint32_t sector = 0; sector < s_num_sectors; sector++) {
+        uint32_t seq = atomic_load_explicit(&s_sector_seq[sector], memory_order_relaxed);
+        if (seq != 0 && (oldest == 0 || seq < oldest)) {
+            oldest = seq;
+        }
+    }
+    span.begin = (oldest != 0) ? oldest * SAMPLE_LOG_RECORDS_PER_SECTOR : span.end;
+    if (span.begin > span.end) {
+        span.begin = span.end;
+    }
+    return span;
+}
+
+bool sample_log_read(uint32_t lsn, sample_log_record_t *out) {
+    if (s_map == NULL || lsn >= atomic_load_explicit(&s_end_lsn, memory_order_acquire)) {
+        return false;
+    }
+
+    uint32_t seq = lsn / SAMPLE_LOG_RECORDS_PER_SECTOR;
+    uint32_t slot = lsn % SAMPLE_LOG_RECORDS_PER_SECTOR + 1;
+    uint32_t sector = sector_of_seq(seq);
+
+    if (atomic_load_explicit(&s_sector_seq[sector], memory_order_acquire) != seq) {
+        return false;
+    }
+    memcpy(out, slot_ptr(sector, slot), sizeof(*out));
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&s_sector_seq[sector], memory_order_relaxed) != seq) {
+        return false;
+    }
+    return record_valid(out);
+}
+
+void sample_log_get_stats(sample_log_stats_t *stats) {
+    sample_log_span_t span = sample_log_get_span();
+
+    *stats = s_stats;
+    stats->sectors = s_num_sectors;
+    stats->boot = s_boot;
+    stats->records = span.end - span.begin;
+    stats->pending = s_pending;
+}
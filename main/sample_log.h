@@ -0,0 +1,118 @@
+/**
+ * @file sample_log.h
+ * @brief Sample Log - Nhật ký mẫu append-only trên partition flash (giữ qua reboot/brown-out)
+ * @features Ghi theo trang 256 byte, xoay vòng qua mọi sector (wear-levelling),
+ *           đọc qua esp_partition_mmap, khôi phục trang ghi dở khi mất điện
+ *
+ * Chỉ dùng esp_partition nên chạy được trên target linux (partition giả lập bằng file).
+ */
+
+#ifndef SAMPLE_LOG_H
+#define SAMPLE_LOG_H
+
+#include "sample_bus.h"
+
+// ==================== SAMPLE LOG CONFIGURATION ====================
+
+#define SAMPLE_LOG_PARTITION_LABEL      "samplelog"     // Xem partitions.csv
+#define SAMPLE_LOG_SECTOR_SIZE          4096            // Đơn vị xóa của flash
+#define SAMPLE_LOG_PAGE_SIZE            256             // Đơn vị ghi 1 lần (1 trang flash)
+#define SAMPLE_LOG_RECORD_SIZE          16
+
+#define SAMPLE_LOG_RECORDS_PER_PAGE     (SAMPLE_LOG_PAGE_SIZE / SAMPLE_LOG_RECORD_SIZE)
+#define SAMPLE_LOG_RECORDS_PER_SECTOR   (SAMPLE_LOG_SECTOR_SIZE / SAMPLE_LOG_RECORD_SIZE - 1)  // Slot 0 = header
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief 1 bản ghi trên flash (16 byte, slot toàn 0xFF = chưa ghi)
+ */
+typedef struct {
+    uint32_t uptime_ms;         // Thời điểm đọc kể từ lần khởi động boot
+    uint32_t seq;               // Seq trên sample bus (đếm lại từ 1 mỗi lần khởi động)
+    int16_t temp_deci;          // 0.1 °C
+    uint16_t hum_deci;          // 0.1 %
+    uint16_t boot;              // Số lần khởi động (tăng dần, suy ra từ log khi mount)
+    uint8_t flags;              // Bit 0-1: system_state_t, bit 2: is_valid
+    uint8_t crc;                // CRC-8 của 15 byte đầu
+} sample_log_record_t;
+
+_Static_assert(sizeof(sample_log_record_t) == SAMPLE_LOG_RECORD_SIZE, "sample_log_record_t layout");
+
+#define SAMPLE_LOG_FLAG_STATE_MASK  0x03
+#define SAMPLE_LOG_FLAG_VALID       0x04
+
+/**
+ * @brief Khoảng LSN [begin, end) đọc được trên flash
+ *
+ * LSN (log sequence number) = seq_sector * SAMPLE_LOG_RECORDS_PER_SECTOR + slot,
+ * tăng dần qua mọi lần khởi động. Slot bị rách (CRC sai) nằm trong khoảng nhưng đọc trả về false.
+ */
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+} sample_log_span_t;
+
+/**
+ * @brief Thống kê nhật ký
+ */
+typedef struct {
+    uint32_t sectors;           // Số sector của partition
+    uint32_t boot;              // Số lần khởi động hiện tại
+    uint32_t records;           // Số bản ghi đang giữ trên flash (kể cả slot rách)
+    uint32_t pending;           // Số bản ghi còn trong RAM chờ ghi trang
+    uint32_t pages_written;     // Số lần ghi trang từ lúc khởi động
+    uint32_t erases;            // Số sector đã xóa từ lúc khởi động
+    uint32_t torn;              // Slot rách phát hiện khi mount (mất điện lúc đang ghi)
+    uint32_t write_errors;
+} sample_log_stats_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Mount nhật ký: tìm partition, mmap, tìm sector/slot ghi tiếp theo
+ *
+ * Sector có header hỏng được bỏ qua; slot sau bản ghi cuối cùng trên flash là
+ * nơi ghi tiếp (bỏ qua phần trang ghi dở), boot = boot lớn nhất trên log + 1.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND nếu không có partition SAMPLE_LOG_PARTITION_LABEL
+ */
+esp_err_t sample_log_init(void);
+
+/**
+ * @brief Unmount nhật ký (bỏ mmap, xóa trạng thái RAM); gọi sample_log_init để mount lại
+ *
+ * Phần trang đang chờ trong RAM bị bỏ như khi mất điện, gọi sample_log_flush trước nếu cần giữ.
+ */
+void sample_log_deinit(void);
+
+/**
+ * @brief Thêm 1 mẫu (chỉ gọi từ 1 task); ghi xuống flash khi đủ 1 trang
+ *
+ * Mở sector mới (xóa sector cũ nhất, ~30 ms) khi sector hiện tại đầy.
+ */
+esp_err_t sample_log_append(const sample_t *sample);
+
+/**
+ * @brief Ghi ngay phần trang đang chờ trong RAM (cùng task với sample_log_append)
+ *
+ * Các slot còn trống của trang vẫn được ghi tiếp sau đó (flash NOR chỉ đổi bit 1 -> 0).
+ */
+esp_err_t sample_log_flush(void);
+
+/**
+ * @brief Khoảng LSN đang có trên flash (không gồm phần chờ trong RAM)
+ */
+sample_log_span_t sample_log_get_span(void);
+
+/**
+ * @brief Đọc bản ghi ở LSN từ vùng mmap (chép 16 byte)
+ * @return false nếu chưa có, đã bị xóa trong lúc đọc hoặc CRC sai
+ */
+bool sample_log_read(uint32_t lsn, sample_log_record_t *out);
+
+/**
+ * @brief Lấy thống kê
+ */
+void sample_log_get_stats(sample_log_stats_t *stats);
+
+#endif // SAMPLE_LOG_H
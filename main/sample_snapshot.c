@@ -0,0 +1,39 @@
+/**
+ * @file sample_snapshot.c
+ * @brief Sample Snapshot Implementation
+ *
+ * Writer chỉ ghi vào buffer không active rồi tăng generation; reader chép buffer
+ * active và thử lại nếu generation đổi trong lúc chép.
+ */
+
+#include "sample_snapshot.h"
+#include <stdatomic.h>
+
+// ==================== GLOBAL STATE ====================
+
+static sample_snapshot_t s_buf[2];
+static atomic_uint s_gen = 0;
+
+// ==================== PUBLIC API ====================
+
+void sample_snapshot_publish(const sample_t *sample) {
+    unsigned gen = atomic_load_explicit(&s_gen, memory_order_relaxed) + 1;
+
+    // Generation trước đó phải hiển thị trước khi ghi đè buffer cũ (fence rw,w)
+    atomic_thread_fence(memory_order_release);
+    s_buf[gen & 1].data = sample->data;
+    s_buf[gen & 1].state = sample->state;
+    s_buf[gen & 1].seq = sample->seq;
+    atomic_store_explicit(&s_gen, gen, memory_order_release);
+}
+
+void sample_snapshot_read(sample_snapshot_t *out) {
+    unsigned gen_before, gen_after;
+
+    do {
+        gen_before = atomic_load_explicit(&s_gen, memory_order_acquire);
+        *out = s_buf[gen_before & 1];
+        atomic_thread_fence(memory_order_acquire);
+        gen_after = atomic_load_explicit(&s_gen, memory_order_relaxed);
+    } while (gen_after != gen_before);
+}
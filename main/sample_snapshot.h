@@ -0,0 +1,37 @@
+/**
+ * @file sample_snapshot.h
+ * @brief Sample Snapshot - Mẫu mới nhất cho reader không khóa (handler web, long-poll)
+ * @features Double-buffer + generation: 1 writer, reader chép và thử lại nếu bị ghi đè giữa chừng
+ *
+ * Không phụ thuộc httpd nên test/ chạy được writer/reader song song trên host.
+ */
+
+#ifndef SAMPLE_SNAPSHOT_H
+#define SAMPLE_SNAPSHOT_H
+
+#include "sample_bus.h"
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Bản chép của mẫu mới nhất
+ */
+typedef struct {
+    sensor_data_t data;
+    system_state_t state;
+    uint32_t seq;               // 0 = chưa có mẫu nào
+} sample_snapshot_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Công bố mẫu mới nhất (chỉ gọi từ 1 writer)
+ */
+void sample_snapshot_publish(const sample_t *sample);
+
+/**
+ * @brief Đọc mẫu mới nhất không khóa (không bao giờ bị rách), gọi được từ nhiều task
+ */
+void sample_snapshot_read(sample_snapshot_t *out);
+
+#endif // SAMPLE_SNAPSHOT_H
@@ -0,0 +1,220 @@
+/**
+ * @file sampler.c
+ * @brief Sampling Scheduler Implementation
+ *
+ * sensor_timer thuộc về module này. Mọi thay đổi chu kỳ (từ POST /api/config
+ * hoặc từ chế độ adaptive) đều đi qua xTimerChangePeriod() và luôn bị giới hạn
+ * bởi chu kỳ tối thiểu của driver, nên không bao giờ đọc DHT22 nhanh hơn 2s.
+ */
+
+#include "sampler.h"
+#include "latency.h"
+#include "esp_log.h"
+#include <math.h>
+
+static const char *TAG = "SAMPLER";
+
+// ==================== GLOBAL STATE ====================
+
+static TimerHandle_t s_timer = NULL;
+static TaskHandle_t s_sensor_task = NULL;
+static bool s_running = false;
+
+static uint32_t s_min_period_ms = 0;
+static uint32_t s_interval_ms = 0;      // Chu kỳ cấu hình
+static uint32_t s_period_ms = 0;        // Chu kỳ timer đang chạy
+static sampler_mode_t s_mode = SAMPLER_MODE_FIXED;
+
+static float s_temp_warning = TEMP_WARNING;
+static float s_temp_overheat = TEMP_OVERHEAT;
+
+// Trạng thái adaptive (chỉ sensor_task truy cập)
+static float s_last_temp = NAN;
+static uint32_t s_stable_count = 0;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Timer callback: đánh thức task đọc cảm biến
+ */
+static void sampler_timer_callback(TimerHandle_t xTimer) {
+    latency_mark_fire((int64_t)s_period_ms * 1000);
+
+    if (s_sensor_task != NULL) {
+        xTaskNotifyGive(s_sensor_task);
+    }
+}
+
+/**
+ * @brief Giới hạn chu kỳ về [min của driver, SAMPLER_MAX_PERIOD_MS]
+ */
+static uint32_t clamp_period(uint32_t period_ms) {
+    if (period_ms < s_min_period_ms) {
+        return s_min_period_ms;
+    }
+    if (period_ms > SAMPLER_MAX_PERIOD_MS) {
+        return SAMPLER_MAX_PERIOD_MS;
+    }
+    return period_ms;
+}
+
+/**
+ * @brief Áp dụng chu kỳ mới cho timer nếu khác chu kỳ hiện tại
+ */
+static void apply_period(uint32_t period_ms) {
+    period_ms = clamp_period(period_ms);
+
+    taskENTER_CRITICAL(&s_lock);
+    bool changed = (period_ms != s_period_ms);
+    s_period_ms = period_ms;
+    bool running = s_running;
+    taskEXIT_CRITICAL(&s_lock);
+
+    // Timer chưa start => chu kỳ được áp dụng trong sampler_start()
+    if (!changed || !running) {
+        return;
+    }
+
+    if (xTimerChangePeriod(s_timer, pdMS_TO_TICKS(period_ms), pdMS_TO_TICKS(100)) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to change period to %" PRIu32 " ms", period_ms);
+        return;
+    }
+    latency_restart_period();   // Lần kích hoạt đầu tiên tính từ lúc đổi, không phải jitter
+    ESP_LOGI(TAG, "Sampling period -> %" PRIu32 " ms", period_ms);
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t sampler_init(uint32_t min_period_ms, uint32_t interval_ms) {
+    s_min_period_ms = min_period_ms;
+    s_interval_ms = clamp_period(interval_ms);
+    s_period_ms = s_interval_ms;
+
+    if (interval_ms < min_period_ms) {
+        ESP_LOGW(TAG, "Interval %" PRIu32 " ms below sensor minimum, using %" PRIu32 " ms",
+                 interval_ms, s_interval_ms);
+    }
+
+    s_timer = xTimerCreate(
+        "SensorTimer",                      // Tên timer
+        pdMS_TO_TICKS(s_period_ms),         // Chu kỳ ban đầu
+        pdTRUE,                             // Auto-reload
+        (void *)0,                          // Timer ID
+        sampler_timer_callback              // Callback
+    );
+    if (s_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create sensor timer");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Sampler initialized (period=%" PRIu32 " ms, min=%" PRIu32 " ms)",
+             s_period_ms, s_min_period_ms);
+    return ESP_OK;
+}
+
+esp_err_t sampler_start(TaskHandle_t sensor_task) {
+    s_sensor_task = sensor_task;
+
+    taskENTER_CRITICAL(&s_lock);
+    s_running = true;
+    uint32_t period_ms = s_period_ms;
+    taskEXIT_CRITICAL(&s_lock);
+
+    // xTimerChangePeriod() cũng start timer đang dormant
+    if (xTimerChangePeriod(s_timer, pdMS_TO_TICKS(period_ms), 0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start sensor timer");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+uint32_t sampler_set_interval(uint32_t interval_ms) {
+    interval_ms = clamp_period(interval_ms);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_interval_ms = interval_ms;
+    taskEXIT_CRITICAL(&s_lock);
+
+    // Adaptive sẽ tự điều chỉnh từ chu kỳ mới ở mẫu kế tiếp
+    apply_period(interval_ms);
+    return interval_ms;
+}
+
+void sampler_set_mode(sampler_mode_t mode) {
+    taskENTER_CRITICAL(&s_lock);
+    bool changed = (mode != s_mode);
+    s_mode = mode;
+    uint32_t interval_ms = s_interval_ms;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "Sampling mode -> %s", mode == SAMPLER_MODE_ADAPTIVE ? "ADAPTIVE" : "FIXED");
+        apply_period(interval_ms);
+    }
+}
+
+void sampler_set_thresholds(float temp_warning, float temp_overheat) {
+    taskENTER_CRITICAL(&s_lock);
+    s_temp_warning = temp_warning;
+    s_temp_overheat = temp_overheat;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void sampler_get_thresholds(float *temp_warning, float *temp_overheat) {
+    taskENTER_CRITICAL(&s_lock);
+    *temp_warning = s_temp_warning;
+    *temp_overheat = s_temp_overheat;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void sampler_on_sample(const sensor_data_t *data) {
+    if (data == NULL || !data->is_valid) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    sampler_mode_t mode = s_mode;
+    uint32_t interval_ms = s_interval_ms;
+    uint32_t period_ms = s_period_ms;
+    float temp_warning = s_temp_warning;
+    taskEXIT_CRITICAL(&s_lock);
+
+    float temp = data->temperature;
+    float last_temp = s_last_temp;
+    s_last_temp = temp;
+
+    if (mode != SAMPLER_MODE_ADAPTIVE) {
+        return;
+    }
+
+    uint32_t target_ms;
+    if (temp >= temp_warning - SAMPLER_ADAPTIVE_BAND_C) {
+        // Gần (hoặc vượt) ngưỡng cảnh báo => đọc nhanh nhất driver cho phép
+        target_ms = s_min_period_ms;
+        s_stable_count = 0;
+    } else if (!isnan(last_temp) && fabsf(temp - last_temp) < SAMPLER_STABLE_DELTA_C) {
+        // Ổn định => giãn dần chu kỳ (gấp đôi sau mỗi SAMPLER_STABLE_COUNT mẫu)
+        target_ms = (period_ms > interval_ms) ? period_ms : interval_ms;
+        if (++s_stable_count >= SAMPLER_STABLE_COUNT) {
+            s_stable_count = 0;
+            uint32_t limit_ms = interval_ms * SAMPLER_BACKOFF_MAX_FACTOR;
+            target_ms = (target_ms * 2 < limit_ms) ? target_ms * 2 : limit_ms;
+        }
+    } else {
+        // Đang thay đổi => quay về chu kỳ cấu hình
+        target_ms = interval_ms;
+        s_stable_count = 0;
+    }
+
+    apply_period(target_ms);
+}
+
+uint32_t sampler_get_period_ms(void) {
+    return s_period_ms;
+}
+
+sampler_mode_t sampler_get_mode(void) {
+    return s_mode;
+}
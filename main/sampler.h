@@ -0,0 +1,81 @@
+/**
+ * @file sampler.h
+ * @brief Sampling Scheduler - Điều khiển chu kỳ đọc cảm biến lúc runtime
+ * @features Giới hạn chu kỳ tối thiểu của driver, đổi chu kỳ trực tiếp, chế độ adaptive
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "config.h"
+
+// ==================== SAMPLER CONFIGURATION ====================
+
+#define SAMPLER_MAX_PERIOD_MS       60000   // Chu kỳ lớn nhất cho phép
+#define SAMPLER_ADAPTIVE_BAND_C     1.0f    // Cách ngưỡng <= 1°C => đọc nhanh nhất
+#define SAMPLER_STABLE_DELTA_C      0.2f    // Thay đổi nhỏ hơn => coi là ổn định
+#define SAMPLER_STABLE_COUNT        5       // Số mẫu ổn định liên tiếp trước khi giãn chu kỳ
+#define SAMPLER_BACKOFF_MAX_FACTOR  8       // Giãn tối đa 8 lần chu kỳ cấu hình
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Chế độ lấy mẫu
+ */
+typedef enum {
+    SAMPLER_MODE_FIXED = 0,     // Luôn dùng chu kỳ cấu hình
+    SAMPLER_MODE_ADAPTIVE,      // Nhanh gần ngưỡng, giãn ra khi ổn định
+} sampler_mode_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Tạo timer lấy mẫu
+ * @param min_period_ms Chu kỳ tối thiểu của driver cảm biến (VD: DHT22_MIN_PERIOD_MS)
+ * @param interval_ms Chu kỳ cấu hình ban đầu (sẽ bị giới hạn về [min, max])
+ * @return ESP_OK nếu thành công
+ */
+esp_err_t sampler_init(uint32_t min_period_ms, uint32_t interval_ms);
+
+/**
+ * @brief Bắt đầu đánh thức task đọc cảm biến (Task Notification) theo chu kỳ
+ */
+esp_err_t sampler_start(TaskHandle_t sensor_task);
+
+/**
+ * @brief Đổi chu kỳ cấu hình ngay lập tức (xTimerChangePeriod)
+ * @return Chu kỳ thực sự được áp dụng sau khi giới hạn
+ */
+uint32_t sampler_set_interval(uint32_t interval_ms);
+
+/**
+ * @brief Chọn chế độ FIXED/ADAPTIVE
+ */
+void sampler_set_mode(sampler_mode_t mode);
+
+/**
+ * @brief Cập nhật ngưỡng nhiệt độ (dùng cho adaptive và phân loại trạng thái)
+ */
+void sampler_set_thresholds(float temp_warning, float temp_overheat);
+
+/**
+ * @brief Lấy ngưỡng nhiệt độ hiện tại
+ */
+void sampler_get_thresholds(float *temp_warning, float *temp_overheat);
+
+/**
+ * @brief Báo kết quả 1 lần đọc để chế độ adaptive chọn chu kỳ tiếp theo
+ */
+void sampler_on_sample(const sensor_data_t *data);
+
+/**
+ * @brief Chu kỳ timer đang chạy (ms)
+ */
+uint32_t sampler_get_period_ms(void);
+
+/**
+ * @brief Chế độ hiện tại
+ */
+sampler_mode_t sampler_get_mode(void);
+
+#endif // SAMPLER_H
@@ -0,0 +1,84 @@
+/**
+ * @file i2c_master.h
+ * @brief Host Simulation - Tập con API driver/i2c_master.h dùng bởi i2c_bus.c (target linux)
+ *
+ * Transaction được chuyển tới thiết bị ảo theo địa chỉ (SSD1306 ở OLED_I2C_ADDR),
+ * chờ đúng thời gian truyền ở scl_speed_hz rồi gọi on_trans_done như ISR của driver thật.
+ */
+
+#ifndef SIM_DRIVER_I2C_MASTER_H
+#define SIM_DRIVER_I2C_MASTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+// ==================== DATA STRUCTURES ====================
+
+typedef enum {
+    I2C_NUM_0 = 0,
+    I2C_NUM_MAX,
+} i2c_port_t;
+
+typedef enum {
+    I2C_CLK_SRC_DEFAULT = 0,
+} i2c_clock_source_t;
+
+typedef enum {
+    I2C_ADDR_BIT_LEN_7 = 0,
+    I2C_ADDR_BIT_LEN_10,
+} i2c_addr_bit_len_t;
+
+typedef struct sim_i2c_bus *i2c_master_bus_handle_t;
+typedef struct sim_i2c_dev *i2c_master_dev_handle_t;
+
+typedef struct {
+    i2c_port_t i2c_port;
+    gpio_num_t sda_io_num;
+    gpio_num_t scl_io_num;
+    i2c_clock_source_t clk_source;
+    uint8_t glitch_ignore_cnt;
+    int intr_priority;
+    size_t trans_queue_depth;
+    struct {
+        uint32_t enable_internal_pullup : 1;
+    } flags;
+} i2c_master_bus_config_t;
+
+typedef struct {
+    i2c_addr_bit_len_t dev_addr_length;
+    uint16_t device_address;
+    uint32_t scl_speed_hz;
+} i2c_device_config_t;
+
+typedef enum {
+    I2C_EVENT_ALIVE = 0,
+    I2C_EVENT_DONE,
+    I2C_EVENT_NACK,
+    I2C_EVENT_TIMEOUT,
+} i2c_master_event_t;
+
+typedef struct {
+    i2c_master_event_t event;
+} i2c_master_event_data_t;
+
+typedef bool (*i2c_master_callback_t)(i2c_master_dev_handle_t dev, const i2c_master_event_data_t *evt_data,
+                                      void *arg);
+
+typedef struct {
+    i2c_master_callback_t on_trans_done;
+} i2c_master_event_callbacks_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle);
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle);
+esp_err_t i2c_master_register_event_callbacks(i2c_master_dev_handle_t i2c_dev,
+                                              const i2c_master_event_callbacks_t *cbs, void *user_data);
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms);
+
+#endif // SIM_DRIVER_I2C_MASTER_H
@@ -0,0 +1,162 @@
+/**
+ * @file sim.h
+ * @brief Host Simulation - Phần cứng ảo cho target linux (DHT22, SSD1306, GPIO, WiFi)
+ * @features DHT22 theo kịch bản (const/ramp/sine/step/trace) + lỗi giả lập, SSD1306 ảo ghi GDDRAM
+ *           và lưu lượng I2C, xuất frame PBM, GPIO đếm cạnh (buzzer/LED),
+ *           phát lại trace ghi từ board theo đồng hồ ảo (nhanh hơn thời gian thực) + báo cáo
+ *
+ * Chỉ biên dịch khi IDF_TARGET = linux (main/CMakeLists.txt). Code ứng dụng không đổi:
+ * các header trong sim/include/driver thay cho driver ESP-IDF.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+// ==================== SIM CONFIGURATION ====================
+
+// Biến môi trường đọc lúc khởi tạo driver
+#define SIM_DHT22_ENV           "SIM_DHT22"         // Kịch bản DHT22, VD: "profile=ramp,t=24,to=32,span=600,crc=0.01"
+#define SIM_OLED_DIR_ENV        "SIM_OLED_DIR"      // Thư mục ghi frame_NNNNNN.pbm (không đặt => không ghi)
+#define SIM_I2C_TRACE_ENV       "SIM_I2C_TRACE"     // File ghi từng transaction I2C (không đặt => không ghi)
+#define SIM_REPLAY_ENV          "SIM_REPLAY"        // Trace để phát lại: .bin / .csv từ /api/history.bin|.csv
+#define SIM_REPORT_ENV          "SIM_REPORT"        // File báo cáo replay (không đặt => stdout)
+#define SIM_SPEED_ENV           "SIM_SPEED"         // Giới hạn tốc độ replay (x thời gian thực), 0 = nhanh nhất
+
+#define SIM_OLED_FRAME_GAP_US   20000   // Bus lặng lâu hơn => flush trước đã xong, ghi frame
+#define SIM_TRACE_MAX_POINTS    4096    // Số điểm tối đa của profile=trace
+#define SIM_REPLAY_TAIL_MS      15000   // Chạy thêm sau mẫu cuối (buzzer 10s kịp tắt) rồi in báo cáo
+#define SIM_REPLAY_BOOT_GAP_MS  2000    // Khoảng cách gán cho 2 mẫu liền kề khác boot
+#define SIM_REPLAY_MAX_TRANSITIONS  256 // Số lần đổi trạng thái tối đa liệt kê trong báo cáo
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief Dạng tín hiệu của DHT22 ảo (t = giây kể từ khi khởi động)
+ */
+typedef enum {
+    SIM_PROFILE_CONST = 0,      // temp, hum
+    SIM_PROFILE_RAMP,           // temp -> temp_to trong span giây rồi giữ nguyên
+    SIM_PROFILE_SINE,           // temp + amplitude * sin(2πt / span)
+    SIM_PROFILE_STEP,           // temp, nhảy lên temp_to tại t = span
+    SIM_PROFILE_TRACE,          // Nội suy tuyến tính file CSV "giây,nhiệt độ,độ ẩm" (lặp lại)
+} sim_profile_t;
+
+/**
+ * @brief Kịch bản DHT22 (chuỗi "key=value,..." của SIM_DHT22_ENV)
+ */
+typedef struct {
+    sim_profile_t profile;      // profile=const|ramp|sine|step|trace
+    float temp;                 // t=      (°C)
+    float hum;                  // h=      (%)
+    float temp_to;              // to=     ramp/step: nhiệt độ đích
+    float amplitude;            // amp=    sine: biên độ (°C)
+    uint32_t span_s;            // span=   ramp: thời gian tăng, sine: chu kỳ, step: thời điểm nhảy
+    float noise;                // noise=  nhiễu đều ±noise °C trên mỗi lần đọc
+    float p_timeout;            // timeout= xác suất sensor không phản hồi
+    float p_crc;                // crc=     xác suất sai checksum
+    float p_invalid;            // invalid= xác suất giá trị ngoài dải đo (checksum vẫn đúng)
+    uint32_t seed;              // seed=   cùng seed => cùng chuỗi nhiễu/lỗi
+    char trace_path[128];       // file=   profile=trace
+} sim_dht22_config_t;
+
+/**
+ * @brief Bộ đếm của DHT22 ảo
+ */
+typedef struct {
+    uint32_t frames;            // Số lần rmt_receive
+    uint32_t timeouts;
+    uint32_t crc_errors;
+    uint32_t invalid;
+    float last_temp;            // Giá trị thật của lần đọc gần nhất (trước khi mã hóa)
+    float last_hum;
+} sim_dht22_stats_t;
+
+/**
+ * @brief Bộ đếm của SSD1306 ảo
+ */
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;             // Địa chỉ + control + payload
+    uint32_t command_bytes;
+    uint32_t data_bytes;
+    uint32_t frames;            // Số flush hoàn chỉnh (tách bằng SIM_OLED_FRAME_GAP_US)
+    bool display_on;
+} sim_oled_stats_t;
+
+/**
+ * @brief Trạng thái 1 chân GPIO
+ */
+typedef struct {
+    int level;
+    uint32_t rising;
+    uint32_t falling;
+    int64_t high_us;            // Tổng thời gian ở mức cao
+} sim_gpio_pin_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Đổi kịch bản DHT22 lúc đang chạy (chuỗi như SIM_DHT22_ENV)
+ * @return ESP_ERR_INVALID_ARG nếu có key lạ hoặc không đọc được file trace
+ */
+esp_err_t sim_dht22_configure(const char *spec);
+
+/**
+ * @brief Nhiệt độ/độ ẩm kịch bản tại thời điểm t_us (không nhiễu, không lỗi)
+ */
+void sim_dht22_value_at(int64_t t_us, float *temperature, float *humidity);
+
+void sim_dht22_get_stats(sim_dht22_stats_t *stats);
+
+/**
+ * @brief Thiết bị ảo trên bus I2C: SSD1306 nhận 1 transaction ghi
+ * @return ESP_OK
+ */
+esp_err_t sim_oled_write(const uint8_t *data, size_t len);
+
+/**
+ * @brief Ghi nội dung panel đang hiển thị ra file PBM (P4, 128x64, điểm sáng = 1)
+ */
+esp_err_t sim_oled_dump_pbm(const char *path);
+
+void sim_oled_get_stats(sim_oled_stats_t *stats);
+
+/**
+ * @brief Số transaction I2C tới địa chỉ không có thiết bị ảo (trả về NACK)
+ */
+uint32_t sim_i2c_get_nacks(void);
+
+/**
+ * @brief Trạng thái chân GPIO (mức hiện tại, số cạnh, thời gian ở mức cao)
+ */
+void sim_gpio_get(gpio_num_t pin, sim_gpio_pin_t *out);
+
+/**
+ * @brief Đọc trace của SIM_REPLAY_ENV (gọi khi tạo kênh RMT của DHT22)
+ * @return ESP_ERR_NOT_FOUND nếu không replay, ESP_ERR_INVALID_ARG nếu file hỏng
+ */
+esp_err_t sim_replay_init(void);
+
+/**
+ * @brief Đang chạy chế độ replay (WiFi/HTTP tắt, đồng hồ ảo bật)
+ */
+bool sim_replay_active(void);
+
+/**
+ * @brief Bắt đầu replay ở lần đọc DHT22 đầu tiên: đặt gốc thời gian, đăng ký sample bus,
+ *        chạy đồng hồ ảo. Gọi lại nhiều lần không có tác dụng.
+ */
+void sim_replay_start(void);
+
+/**
+ * @brief Mẫu ghi gần nhất tại thời điểm t_us (giữ nguyên giá trị giữa 2 mẫu)
+ * @return false nếu mẫu ghi không hợp lệ => DHT22 ảo không phản hồi
+ */
+bool sim_replay_value_at(int64_t t_us, float *temperature, float *humidity);
+
+#endif // SIM_H
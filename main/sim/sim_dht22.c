@@ -0,0 +1,420 @@
+/**
+ * @file sim_dht22.c
+ * @brief Host Simulation - DHT22 ảo sau API RMT RX (driver/rmt_rx.h)
+ *
+ * Mỗi rmt_receive() lấy giá trị kịch bản tại thời điểm hiện tại, cộng nhiễu, rút thăm lỗi
+ * (timeout / sai checksum / ngoài dải đo) rồi mã hóa thành đúng chuỗi symbol mà RMT đo được
+ * trên chân thật, nên dht22.c và dht22_decode.c chạy nguyên vẹn.
+ */
+
+#include "sim.h"
+#include "driver/rmt_rx.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+static const char *TAG = "SIM_DHT22";
+
+#define SIM_DHT22_FRAME_MS      5       // Thời gian 1 khung trên dây (start response + 40 bit)
+#define SIM_DHT22_SYMBOLS       43      // Phản hồi (2) + 40 bit + symbol kết thúc
+#define SIM_DHT22_INVALID_TEMP  150.0f  // Ngoài dải đo -40..80°C
+
+// ==================== DATA STRUCTURES ====================
+
+struct sim_rmt_channel {
+    gpio_num_t gpio;
+    rmt_rx_done_callback_t on_recv_done;
+    void *user_ctx;
+    bool enabled;
+};
+
+/**
+ * @brief 1 điểm của profile=trace
+ */
+typedef struct {
+    float t_s;
+    float temp;
+    float hum;
+} trace_point_t;
+
+// ==================== GLOBAL STATE ====================
+
+static struct sim_rmt_channel s_channel;
+static sim_dht22_config_t s_cfg = {
+    .profile = SIM_PROFILE_CONST,
+    .temp = 25.0f,
+    .hum = 60.0f,
+    .temp_to = 25.0f,
+    .amplitude = 5.0f,
+    .span_s = 600,
+    .seed = 1,
+};
+static trace_point_t *s_trace = NULL;
+static size_t s_trace_count = 0;
+static uint32_t s_rng = 1;
+static sim_dht22_stats_t s_stats = {0};
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_configured = false;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief LCG (Numerical Recipes) - cùng seed => cùng chuỗi, không phụ thuộc libc
+ * @return Số thực đều trong [0, 1)
+ */
+static float rng_uniform(void) {
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return (s_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static bool parse_profile(const char *name, sim_profile_t *out) {
+    static const char *const names[] = { "const", "ramp", "sine", "step", "trace" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *out = (sim_profile_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Đọc file CSV "giây,nhiệt độ,độ ẩm" (bỏ qua dòng không đủ 3 cột, VD: header)
+ */
+static esp_err_t load_trace(const char *path, trace_point_t **out, size_t *count) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open trace %s", path);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    trace_point_t *points = malloc(SIM_TRACE_MAX_POINTS * sizeof(trace_point_t));
+    size_t n = 0;
+    char line[96];
+
+    if (points == NULL) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+    while (n < SIM_TRACE_MAX_POINTS && fgets(line, sizeof(line), f) != NULL) {
+        trace_point_t p;
+        if (sscanf(line, "%f,%f,%f", &p.t_s, &p.temp, &p.hum) == 3) {
+            points[n++] = p;
+        }
+    }
+    fclose(f);
+
+    if (n == 0) {
+        ESP_LOGE(TAG, "Trace %s has no samples", path);
+        free(points);
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = points;
+    *count = n;
+    return ESP_OK;
+}
+
+/**
+ * @brief Nội suy trace tại t (lặp lại sau điểm cuối)
+ */
+static void trace_value_at(float t_s, float *temp, float *hum) {
+    const trace_point_t *p = s_trace;
+    size_t n = s_trace_count;
+    float period = p[n - 1].t_s;
+
+    if (n == 1 || period <= 0.0f) {
+        *temp = p[0].temp;
+        *hum = p[0].hum;
+        return;
+    }
+
+    t_s = fmodf(t_s, period);
+    size_t i = 1;
+    while (i < n - 1 && p[i].t_s < t_s) {
+        i++;
+    }
+    float dt = p[i].t_s - p[i - 1].t_s;
+    float k = (dt > 0.0f) ? (t_s - p[i - 1].t_s) / dt : 1.0f;
+    if (k < 0.0f) {
+        k = 0.0f;
+    }
+    *temp = p[i - 1].temp + k * (p[i].temp - p[i - 1].temp);
+    *hum = p[i - 1].hum + k * (p[i].hum - p[i - 1].hum);
+}
+
+/**
+ * @brief Mã hóa 1 giá trị thành 5 byte như cảm biến (0.1 đơn vị, bit 15 = dấu âm)
+ */
+static void encode_frame(float temp, float hum, uint8_t data[5]) {
+    long hum_raw = lroundf(hum * 10.0f);
+    long temp_raw = lroundf(fabsf(temp) * 10.0f);
+
+    if (hum_raw < 0) hum_raw = 0;
+    if (hum_raw > 1000) hum_raw = 1000;
+    if (temp_raw > 0x7FFF) temp_raw = 0x7FFF;
+    if (temp < 0.0f) temp_raw |= 0x8000;
+
+    data[0] = (uint8_t)(hum_raw >> 8);
+    data[1] = (uint8_t)hum_raw;
+    data[2] = (uint8_t)(temp_raw >> 8);
+    data[3] = (uint8_t)temp_raw;
+    data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+}
+
+/**
+ * @brief Chuỗi symbol RMT bắt đầu lúc MCU nhả line (level: 1 = HIGH)
+ *
+ * Phần còn lại của xung HIGH sau start (~30us), phản hồi LOW 80 / HIGH 80,
+ * mỗi bit LOW 50 / HIGH 26 hoặc 70, rồi line về idle HIGH (duration = 0).
+ */
+static size_t encode_symbols(const uint8_t data[5], rmt_symbol_word_t *symbols) {
+    size_t n = 0;
+
+    symbols[n++] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 30, .level1 = 0, .duration1 = 80 };
+    symbols[n++] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 80, .level1 = 0, .duration1 = 50 };
+    for (int bit = 0; bit < 40; bit++) {
+        bool one = data[bit / 8] & (0x80 >> (bit % 8));
+        symbols[n++] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = one ? 70 : 26,
+                                            .level1 = 0, .duration1 = 50 };
+    }
+    symbols[n++] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 0 };
+    return n;
+}
+
+static void ensure_configured(void) {
+    if (!s_configured) {
+        const char *spec = getenv(SIM_DHT22_ENV);
+        if (sim_dht22_configure(spec != NULL ? spec : "") != ESP_OK) {
+            ESP_LOGW(TAG, "Bad %s, using defaults", SIM_DHT22_ENV);
+            s_configured = true;
+        }
+    }
+}
+
+// ==================== DRIVER API ====================
+
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+    ensure_configured();
+    if (sim_replay_init() == ESP_ERR_INVALID_ARG) {
+        exit(1);    // Replay không có trace => không có gì để báo cáo
+    }
+    s_channel.gpio = config->gpio_num;
+    *ret_chan = &s_channel;
+    ESP_LOGI(TAG, "Virtual DHT22 on GPIO %d", config->gpio_num);
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t rx_channel, const rmt_rx_event_callbacks_t *cbs,
+                                          void *user_data) {
+    rx_channel->on_recv_done = cbs->on_recv_done;
+    rx_channel->user_ctx = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+    channel->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_receive(rmt_channel_handle_t rx_channel, void *buffer, size_t buffer_size,
+                      const rmt_receive_config_t *config) {
+    rmt_symbol_word_t *symbols = (rmt_symbol_word_t *)buffer;
+    float temp, hum, noise;
+    float r_fault;
+    uint8_t data[5];
+
+    if (!rx_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (buffer_size < SIM_DHT22_SYMBOLS * sizeof(rmt_symbol_word_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    bool responds = true;
+    if (sim_replay_active()) {
+        // Replay: mẫu ghi từ board, mẫu ghi lỗi => không phản hồi
+        sim_replay_start();
+        responds = sim_replay_value_at(esp_timer_get_time(), &temp, &hum);
+    } else {
+        sim_dht22_value_at(esp_timer_get_time(), &temp, &hum);
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    noise = s_cfg.noise * (2.0f * rng_uniform() - 1.0f);
+    r_fault = rng_uniform();
+    s_stats.frames++;
+    taskEXIT_CRITICAL(&s_lock);
+
+    temp += noise;
+
+    // Thời gian khung trên dây
+    vTaskDelay(pdMS_TO_TICKS(SIM_DHT22_FRAME_MS));
+
+    // Các loại lỗi loại trừ nhau, xếp liên tiếp trên [0, 1)
+    bool timeout = !responds || r_fault < s_cfg.p_timeout;
+    bool invalid = !timeout && r_fault < s_cfg.p_timeout + s_cfg.p_invalid;
+    bool crc = !timeout && !invalid && r_fault < s_cfg.p_timeout + s_cfg.p_invalid + s_cfg.p_crc;
+
+    if (invalid) {
+        temp = SIM_DHT22_INVALID_TEMP;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.timeouts += timeout;
+    s_stats.invalid += invalid;
+    s_stats.crc_errors += crc;
+    s_stats.last_temp = temp;
+    s_stats.last_hum = hum;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (timeout) {
+        return ESP_OK;     // Không phản hồi => không gọi callback, dht22.c tự hết giờ
+    }
+
+    encode_frame(temp, hum, data);
+    if (crc) {
+        data[4] ^= 0x01;
+    }
+
+    rmt_rx_done_event_data_t edata = {
+        .received_symbols = symbols,
+        .num_symbols = encode_symbols(data, symbols),
+    };
+    if (rx_channel->on_recv_done != NULL) {
+        rx_channel->on_recv_done(rx_channel, &edata, rx_channel->user_ctx);
+    }
+    return ESP_OK;
+}
+
+// ==================== SIM API ====================
+
+esp_err_t sim_dht22_configure(const char *spec) {
+    sim_dht22_config_t cfg = {
+        .profile = SIM_PROFILE_CONST,
+        .temp = 25.0f,
+        .hum = 60.0f,
+        .amplitude = 5.0f,
+        .span_s = 600,
+        .seed = 1,
+    };
+    bool has_to = false;
+    char buf[256];
+    char *save = NULL;
+
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (char *tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(tok, '=');
+        if (eq == NULL) {
+            ESP_LOGE(TAG, "Expected key=value: %s", tok);
+            return ESP_ERR_INVALID_ARG;
+        }
+        *eq = '\0';
+        const char *key = tok;
+        const char *val = eq + 1;
+
+        if (strcmp(key, "profile") == 0) {
+            if (!parse_profile(val, &cfg.profile)) {
+                ESP_LOGE(TAG, "Unknown profile: %s", val);
+                return ESP_ERR_INVALID_ARG;
+            }
+        } else if (strcmp(key, "t") == 0) {
+            cfg.temp = strtof(val, NULL);
+        } else if (strcmp(key, "h") == 0) {
+            cfg.hum = strtof(val, NULL);
+        } else if (strcmp(key, "to") == 0) {
+            cfg.temp_to = strtof(val, NULL);
+            has_to = true;
+        } else if (strcmp(key, "amp") == 0) {
+            cfg.amplitude = strtof(val, NULL);
+        } else if (strcmp(key, "span") == 0) {
+            cfg.span_s = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(key, "noise") == 0) {
+            cfg.noise = strtof(val, NULL);
+        } else if (strcmp(key, "timeout") == 0) {
+            cfg.p_timeout = strtof(val, NULL);
+        } else if (strcmp(key, "crc") == 0) {
+            cfg.p_crc = strtof(val, NULL);
+        } else if (strcmp(key, "invalid") == 0) {
+            cfg.p_invalid = strtof(val, NULL);
+        } else if (strcmp(key, "seed") == 0) {
+            cfg.seed = (uint32_t)strtoul(val, NULL, 10);
+        } else if (strcmp(key, "file") == 0) {
+            snprintf(cfg.trace_path, sizeof(cfg.trace_path), "%s", val);
+        } else {
+            ESP_LOGE(TAG, "Unknown key: %s", key);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (!has_to) {
+        cfg.temp_to = cfg.temp;
+    }
+    if (cfg.span_s == 0) {
+        cfg.span_s = 1;
+    }
+
+    trace_point_t *trace = NULL;
+    size_t trace_count = 0;
+    if (cfg.profile == SIM_PROFILE_TRACE) {
+        esp_err_t ret = load_trace(cfg.trace_path, &trace, &trace_count);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    trace_point_t *old = s_trace;
+    s_cfg = cfg;
+    s_trace = trace;
+    s_trace_count = trace_count;
+    s_rng = cfg.seed;
+    s_configured = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    free(old);
+    ESP_LOGI(TAG, "Profile %d: T=%.1f..%.1f, H=%.1f, span=%" PRIu32 "s, noise=%.2f, faults=%.3f/%.3f/%.3f",
+             cfg.profile, cfg.temp, cfg.temp_to, cfg.hum, cfg.span_s, cfg.noise,
+             cfg.p_timeout, cfg.p_crc, cfg.p_invalid);
+    return ESP_OK;
+}
+
+void sim_dht22_value_at(int64_t t_us, float *temperature, float *humidity) {
+    float t_s = t_us / 1000000.0f;
+    float span = (float)s_cfg.span_s;
+
+    *humidity = s_cfg.hum;
+    switch (s_cfg.profile) {
+        case SIM_PROFILE_RAMP:
+            *temperature = (t_s >= span) ? s_cfg.temp_to
+                                         : s_cfg.temp + (s_cfg.temp_to - s_cfg.temp) * (t_s / span);
+            break;
+        case SIM_PROFILE_SINE:
+            *temperature = s_cfg.temp + s_cfg.amplitude * sinf(2.0f * (float)M_PI * t_s / span);
+            break;
+        case SIM_PROFILE_STEP:
+            *temperature = (t_s >= span) ? s_cfg.temp_to : s_cfg.temp;
+            break;
+        case SIM_PROFILE_TRACE:
+            trace_value_at(t_s, temperature, humidity);
+            break;
+        default:
+            *temperature = s_cfg.temp;
+            break;
+    }
+}
+
+void sim_dht22_get_stats(sim_dht22_stats_t *stats) {
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+}
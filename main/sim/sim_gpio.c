@@ -0,0 +1,90 @@
+/**
+ * @file sim_gpio.c
+ * @brief Host Simulation - GPIO ảo (mức, số cạnh, thời gian ở mức cao của từng chân)
+ */
+
+#include "sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "SIM_GPIO";
+
+// ==================== GLOBAL STATE ====================
+
+static sim_gpio_pin_t s_pins[GPIO_NUM_MAX];
+static int64_t s_high_since_us[GPIO_NUM_MAX];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool pin_ok(gpio_num_t pin) {
+    return pin >= 0 && pin < GPIO_NUM_MAX;
+}
+
+// ==================== DRIVER API ====================
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (config->pin_bit_mask & (1ULL << pin)) {
+            gpio_set_direction((gpio_num_t)pin, config->mode);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!pin_ok(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    int new_level = level ? 1 : 0;
+    sim_gpio_pin_t *p = &s_pins[gpio_num];
+
+    taskENTER_CRITICAL(&s_lock);
+    if (new_level != p->level) {
+        if (new_level) {
+            p->rising++;
+            s_high_since_us[gpio_num] = now_us;
+        } else {
+            p->falling++;
+            p->high_us += now_us - s_high_since_us[gpio_num];
+        }
+        p->level = new_level;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    return pin_ok(gpio_num) ? s_pins[gpio_num].level : 0;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    if (!pin_ok(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGD(TAG, "GPIO %d mode %d", gpio_num, mode);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull) {
+    return pin_ok(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// ==================== SIM API ====================
+
+void sim_gpio_get(gpio_num_t pin, sim_gpio_pin_t *out) {
+    if (!pin_ok(pin)) {
+        *out = (sim_gpio_pin_t){0};
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_pins[pin];
+    if (out->level) {
+        out->high_us += now_us - s_high_since_us[pin];  // Đang ở mức cao
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
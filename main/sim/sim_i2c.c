@@ -0,0 +1,121 @@
+/**
+ * @file sim_i2c.c
+ * @brief Host Simulation - Bus I2C ảo (driver/i2c_master.h)
+ *
+ * Mỗi transaction: ghi vào file trace (nếu có SIM_I2C_TRACE), chờ thời gian truyền
+ * 9 bit/byte ở scl_speed_hz, chuyển dữ liệu cho thiết bị ảo rồi gọi on_trans_done.
+ * Địa chỉ không có thiết bị => I2C_EVENT_NACK.
+ */
+
+#include "sim.h"
+#include "config.h"
+#include "driver/i2c_master.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+static const char *TAG = "SIM_I2C";
+
+#define SIM_I2C_MAX_DEVICES     4
+
+// ==================== DATA STRUCTURES ====================
+
+struct sim_i2c_bus {
+    gpio_num_t sda;
+    gpio_num_t scl;
+};
+
+struct sim_i2c_dev {
+    uint16_t addr;
+    uint32_t scl_hz;
+    i2c_master_callback_t on_trans_done;
+    void *user_data;
+};
+
+// ==================== GLOBAL STATE ====================
+
+static struct sim_i2c_bus s_bus;
+static struct sim_i2c_dev s_devs[SIM_I2C_MAX_DEVICES];
+static int s_dev_count = 0;
+static FILE *s_trace = NULL;
+static uint32_t s_nacks = 0;
+
+// ==================== DRIVER API ====================
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle) {
+    const char *trace_path = getenv(SIM_I2C_TRACE_ENV);
+
+    s_bus.sda = bus_config->sda_io_num;
+    s_bus.scl = bus_config->scl_io_num;
+    if (trace_path != NULL && s_trace == NULL) {
+        s_trace = fopen(trace_path, "w");
+        if (s_trace == NULL) {
+            ESP_LOGW(TAG, "Cannot open I2C trace %s", trace_path);
+        } else {
+            fprintf(s_trace, "# time_us addr len first_bytes\n");
+        }
+    }
+    *ret_bus_handle = &s_bus;
+    ESP_LOGI(TAG, "Virtual I2C bus (SDA=%d, SCL=%d)", s_bus.sda, s_bus.scl);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle) {
+    if (s_dev_count >= SIM_I2C_MAX_DEVICES) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    struct sim_i2c_dev *dev = &s_devs[s_dev_count++];
+    dev->addr = dev_config->device_address;
+    dev->scl_hz = dev_config->scl_speed_hz ? dev_config->scl_speed_hz : 100000;
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_register_event_callbacks(i2c_master_dev_handle_t i2c_dev,
+                                              const i2c_master_event_callbacks_t *cbs, void *user_data) {
+    i2c_dev->on_trans_done = cbs->on_trans_done;
+    i2c_dev->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms) {
+    i2c_master_event_data_t evt = { .event = I2C_EVENT_DONE };
+    uint32_t bus_us = (uint32_t)((uint64_t)(write_size + 1) * 9 * 1000000 / i2c_dev->scl_hz);
+
+    if (s_trace != NULL) {
+        fprintf(s_trace, "%" PRId64 " 0x%02X %u", esp_timer_get_time(), i2c_dev->addr, (unsigned)write_size);
+        for (size_t i = 0; i < write_size && i < 8; i++) {
+            fprintf(s_trace, " %02X", write_buffer[i]);
+        }
+        fputc('\n', s_trace);
+    }
+
+    // Thời gian chiếm bus như phần cứng thật (1 KB ở 400 kHz ~ 23 ms)
+    if (bus_us >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS((bus_us + 999) / 1000));
+    }
+
+    if (i2c_dev->addr == OLED_I2C_ADDR) {
+        sim_oled_write(write_buffer, write_size);
+    } else {
+        evt.event = I2C_EVENT_NACK;
+        s_nacks++;
+    }
+
+    if (i2c_dev->on_trans_done != NULL) {
+        i2c_dev->on_trans_done(i2c_dev, &evt, i2c_dev->user_data);
+        return ESP_OK;
+    }
+    return (evt.event == I2C_EVENT_DONE) ? ESP_OK : ESP_FAIL;
+}
+
+// ==================== SIM API ====================
+
+uint32_t sim_i2c_get_nacks(void) {
+    return s_nacks;
+}
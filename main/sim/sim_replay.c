@@ -0,0 +1,415 @@
+/**
+ * @file sim_replay.c
+ * @brief Host Simulation - Phát lại trace cảm biến theo đồng hồ ảo + báo cáo so sánh giữa các build
+ *
+ * Trace là file ghi từ board (GET /api/history.bin hoặc /api/history.csv, tools/trace_capture.py).
+ * DHT22 ảo trả về mẫu ghi gần nhất tại thời điểm ảo hiện tại; toàn bộ pipeline (sampler,
+ * sample bus, alert, display, log) chạy nguyên vẹn.
+ *
+ * Đồng hồ ảo: task ưu tiên thấp nhất chỉ chạy khi mọi task khác đang block, mỗi vòng
+ * tiến tick FreeRTOS thêm 1 (xTaskCatchUpTicks) và esp_timer_get_time() thêm 1 ms
+ * (--wrap trong main/CMakeLists.txt). Khoảng chờ rỗi được bỏ qua nên replay nhanh hơn
+ * thời gian thực, còn thứ tự sự kiện và độ trễ theo tick giữ nguyên.
+ */
+
+#include "sim.h"
+#include "config.h"
+#include "dht22.h"
+#include "ssd1306.h"
+#include "sample_bus.h"
+#include "latency.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+static const char *TAG = "SIM_REPLAY";
+
+#define REPLAY_THB_HEADER_SIZE  16
+#define REPLAY_THB_MIN_RECORD   24
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief 1 mẫu ghi (thời gian tính từ mẫu đầu tiên của trace)
+ */
+typedef struct {
+    int64_t t_ms;
+    int16_t temp_deci;
+    uint16_t hum_deci;
+    bool valid;
+} replay_point_t;
+
+/**
+ * @brief 1 lần đổi trạng thái quan sát được trên sample bus
+ */
+typedef struct {
+    int64_t t_ms;
+    uint32_t seq;
+    system_state_t from;
+    system_state_t to;
+    float temperature;
+} replay_transition_t;
+
+// ==================== GLOBAL STATE ====================
+
+static replay_point_t *s_points = NULL;
+static size_t s_count = 0;
+static const char *s_path = NULL;
+
+static bool s_started = false;
+static int64_t s_origin_us = 0;         // Thời điểm ảo của lần đọc đầu tiên
+static _Atomic int64_t s_skipped_us = 0; // Thời gian ảo đã nhảy qua
+
+// Chỉ observer task ghi
+static replay_transition_t s_transitions[SIM_REPLAY_MAX_TRANSITIONS];
+static uint32_t s_transition_count = 0;
+static uint32_t s_state_samples[STATE_ERROR + 1];
+static uint32_t s_samples = 0;
+
+int64_t __real_esp_timer_get_time(void);
+
+// ==================== VIRTUAL CLOCK ====================
+
+/**
+ * @brief esp_timer_get_time() của mọi component = thời gian thực + thời gian ảo đã nhảy qua
+ */
+int64_t __wrap_esp_timer_get_time(void) {
+    return __real_esp_timer_get_time() + atomic_load_explicit(&s_skipped_us, memory_order_relaxed);
+}
+
+// ==================== TRACE LOADING ====================
+
+static uint16_t get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+/**
+ * @brief Thêm 1 mẫu, đổi timestamp theo boot thành trục thời gian liên tục
+ */
+static bool append_point(uint16_t boot, int64_t timestamp_ms, int16_t temp_deci, uint16_t hum_deci, bool valid) {
+    static uint16_t last_boot;
+    static int64_t last_ts_ms;
+    static size_t capacity = 0;
+
+    if (s_count == capacity) {
+        size_t new_capacity = capacity ? capacity * 2 : 1024;
+        replay_point_t *p = realloc(s_points, new_capacity * sizeof(replay_point_t));
+        if (p == NULL) {
+            return false;
+        }
+        s_points = p;
+        capacity = new_capacity;
+    }
+
+    replay_point_t *pt = &s_points[s_count];
+    if (s_count == 0) {
+        pt->t_ms = 0;
+    } else {
+        int64_t gap_ms = timestamp_ms - last_ts_ms;
+        if (boot != last_boot || gap_ms <= 0) {
+            gap_ms = SIM_REPLAY_BOOT_GAP_MS;   // Reboot giữa trace: đồng hồ uptime bắt đầu lại
+        }
+        pt->t_ms = s_points[s_count - 1].t_ms + gap_ms;
+    }
+    pt->temp_deci = temp_deci;
+    pt->hum_deci = hum_deci;
+    pt->valid = valid;
+    last_boot = boot;
+    last_ts_ms = timestamp_ms;
+    s_count++;
+    return true;
+}
+
+/**
+ * @brief Đọc file THB1 (GET /api/history.bin): header 16 byte + schema + bản ghi 24 byte
+ */
+static esp_err_t load_thb(FILE *f) {
+    uint8_t hdr[REPLAY_THB_HEADER_SIZE];
+    uint8_t rec[64];
+
+    if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint16_t header_size = get_le16(hdr + 4);
+    uint16_t record_size = get_le16(hdr + 6);
+    if (record_size < REPLAY_THB_MIN_RECORD || record_size > sizeof(rec) || header_size < sizeof(hdr)) {
+        ESP_LOGE(TAG, "Unsupported THB1 layout (header %u, record %u)", header_size, record_size);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (fseek(f, header_size, SEEK_SET) != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Bản ghi mới hơn có thể dài hơn: chỉ đọc các trường đã biết, bỏ qua phần đuôi
+    while (fread(rec, 1, record_size, f) == record_size) {
+        int64_t ts_ms = (int64_t)((uint64_t)get_le32(rec + 8) | ((uint64_t)get_le32(rec + 12) << 32));
+        if (!append_point(get_le16(rec + 16), ts_ms, (int16_t)get_le16(rec + 18), get_le16(rec + 20),
+                          rec[23] != 0)) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Đọc CSV của GET /api/history.csv (id,seq,boot,timestamp_ms,temperature,humidity,status,valid)
+ */
+static esp_err_t load_csv(FILE *f) {
+    char line[128];
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        unsigned boot;
+        int64_t ts_ms;
+        float temp, hum;
+        int valid;
+        if (sscanf(line, "%*u,%*u,%u,%" SCNd64 ",%f,%f,%*[^,],%d", &boot, &ts_ms, &temp, &hum, &valid) != 5) {
+            continue;   // Header
+        }
+        int16_t temp_deci = (int16_t)(temp * 10.0f + (temp < 0.0f ? -0.5f : 0.5f));
+        if (!append_point((uint16_t)boot, ts_ms, temp_deci, (uint16_t)(hum * 10.0f + 0.5f), valid != 0)) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+// ==================== REPORT ====================
+
+static void write_report(FILE *out, int64_t virtual_ms, int64_t real_ms) {
+    ssd1306_bus_stats_t oled_bus;
+    sim_oled_stats_t oled;
+    sim_gpio_pin_t buzzer, led;
+    dht22_stats_t dht;
+
+    ssd1306_get_bus_stats(&oled_bus);
+    sim_oled_get_stats(&oled);
+    sim_gpio_get(BUZZER_PIN, &buzzer);
+    sim_gpio_get(LED_PIN, &led);
+    dht22_get_stats(&dht);
+
+    fprintf(out, "# replay %s\n", s_path);
+    fprintf(out, "trace_samples %u\n", (unsigned)s_count);
+    fprintf(out, "trace_duration_s %.1f\n", s_points[s_count - 1].t_ms / 1000.0);
+    fprintf(out, "virtual_s %.1f\n", virtual_ms / 1000.0);
+    fprintf(out, "# real_s %.2f (x%.0f)\n", real_ms / 1000.0,
+            real_ms > 0 ? (double)virtual_ms / (double)real_ms : 0.0);
+
+    fprintf(out, "\n[transitions]\n");
+    for (uint32_t i = 0; i < s_transition_count && i < SIM_REPLAY_MAX_TRANSITIONS; i++) {
+        const replay_transition_t *t = &s_transitions[i];
+        fprintf(out, "%9.1f s  seq %-6" PRIu32 " %-8s -> %-8s T=%.1f\n", t->t_ms / 1000.0, t->seq,
+                get_state_string(t->from), get_state_string(t->to), t->temperature);
+    }
+    if (s_transition_count > SIM_REPLAY_MAX_TRANSITIONS) {
+        fprintf(out, "... %" PRIu32 " more\n", s_transition_count - SIM_REPLAY_MAX_TRANSITIONS);
+    }
+    fprintf(out, "transitions %" PRIu32 "\n", s_transition_count);
+
+    fprintf(out, "\n[states]\n");
+    fprintf(out, "samples %" PRIu32 "\n", s_samples);
+    for (int s = STATE_NORMAL; s <= STATE_OVERHEAT; s++) {
+        fprintf(out, "%-8s %" PRIu32 "\n", get_state_string((system_state_t)s), s_state_samples[s]);
+    }
+
+    fprintf(out, "\n[outputs]\n");
+    fprintf(out, "buzzer_activations %" PRIu32 "\n", buzzer.rising);
+    fprintf(out, "buzzer_on_s %.1f\n", buzzer.high_us / 1e6);
+    fprintf(out, "led_activations %" PRIu32 "\n", led.rising);
+    fprintf(out, "led_on_s %.1f\n", led.high_us / 1e6);
+    fprintf(out, "display_flushes %" PRIu32 "\n", oled_bus.flushes);
+    fprintf(out, "display_frames %" PRIu32 "\n", oled.frames);
+    fprintf(out, "display_i2c_bytes %" PRIu32 "\n", oled_bus.bytes);
+
+    fprintf(out, "\n[sensor]\n");
+    fprintf(out, "ok %" PRIu32 "\ntimeout %" PRIu32 "\ncrc_error %" PRIu32 "\ninvalid %" PRIu32 "\n",
+            dht.ok, dht.timeout, dht.crc_error, dht.invalid);
+
+    fprintf(out, "\n[sample_bus]  delivered dropped max_depth\n");
+    for (int i = 0; i < sample_bus_get_subscriber_count(); i++) {
+        sample_bus_sub_stats_t st;
+        if (sample_bus_get_stats(i, &st) == ESP_OK) {
+            fprintf(out, "%-8s %9" PRIu32 " %7" PRIu32 " %9" PRIu32 "\n",
+                    st.name, st.delivered, st.dropped, st.max_depth);
+        }
+    }
+    fprintf(out, "publish_drops %" PRIu32 "\n", sample_bus_get_publish_drops());
+
+    // Số lần đo theo giai đoạn chỉ phụ thuộc trace => so sánh được
+    fprintf(out, "\n[latency]  count\n");
+    for (int st = 0; st < LATENCY_STAGE_MAX; st++) {
+        latency_summary_t sum;
+        latency_get_summary((latency_stage_t)st, &sum);
+        fprintf(out, "%-8s %6" PRIu32 "\n", latency_stage_name((latency_stage_t)st), sum.count);
+    }
+
+    // Giá trị độ trễ đo bằng đồng hồ thật của host (max là µs chính xác, p50/p99 bị chặn bởi max)
+    // => đổi giữa các lần chạy, in sau '#' để diff bỏ qua
+    fprintf(out, "\n# latency_us  p50 p99 max\n");
+    for (int st = 0; st < LATENCY_STAGE_MAX; st++) {
+        latency_summary_t sum;
+        latency_get_summary((latency_stage_t)st, &sum);
+        fprintf(out, "# %-8s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 "\n",
+                latency_stage_name((latency_stage_t)st), sum.p50_us, sum.p99_us, sum.max_us);
+    }
+}
+
+// ==================== TASKS ====================
+
+/**
+ * @brief Subscriber "replay": ghi lại các lần đổi trạng thái
+ */
+static void sim_observer_task(void *pvParameters) {
+    sample_bus_sub_t sub = (sample_bus_sub_t)pvParameters;
+    system_state_t last = STATE_NORMAL;
+
+    while (1) {
+        const sample_t *sample = sample_bus_receive(sub, portMAX_DELAY);
+        if (sample == NULL) {
+            continue;
+        }
+
+        system_state_t state = sample->state;
+        if (state <= STATE_ERROR) {
+            s_state_samples[state]++;
+        }
+        if (state != last) {
+            if (s_transition_count < SIM_REPLAY_MAX_TRANSITIONS) {
+                replay_transition_t *t = &s_transitions[s_transition_count];
+                t->t_ms = (sample->data.timestamp - s_origin_us) / 1000;
+                t->seq = sample->seq;
+                t->from = last;
+                t->to = state;
+                t->temperature = sample->data.temperature;
+            }
+            s_transition_count++;
+            last = state;
+        }
+        s_samples++;
+        sample_bus_release(sub);
+    }
+}
+
+/**
+ * @brief Đồng hồ ảo (ưu tiên idle): chỉ chạy khi mọi task khác đang block
+ */
+static void sim_clock_task(void *pvParameters) {
+    const char *speed_str = getenv(SIM_SPEED_ENV);
+    uint32_t speed = speed_str ? (uint32_t)strtoul(speed_str, NULL, 10) : 0;
+    int64_t real_start_us = __real_esp_timer_get_time();
+    int64_t end_us = s_origin_us + (s_points[s_count - 1].t_ms + SIM_REPLAY_TAIL_MS) * 1000;
+
+    while (1) {
+        int64_t now_us = esp_timer_get_time();
+        int64_t real_us = __real_esp_timer_get_time() - real_start_us;
+
+        if (now_us >= end_us) {
+            const char *path = getenv(SIM_REPORT_ENV);
+            FILE *out = path ? fopen(path, "w") : stdout;
+            if (out == NULL) {
+                ESP_LOGE(TAG, "Cannot open report %s", path);
+                out = stdout;
+            }
+            write_report(out, (now_us - s_origin_us) / 1000, real_us / 1000);
+            fflush(out);
+            ESP_LOGI(TAG, "Replay done (%" PRIu32 " transitions)", s_transition_count);
+            exit(0);
+        }
+
+        // SIM_SPEED: không để thời gian ảo vượt quá speed x thời gian thực
+        if (speed > 0 && now_us - s_origin_us > real_us * (int64_t)speed) {
+            vTaskDelay(1);
+            continue;
+        }
+
+        atomic_fetch_add_explicit(&s_skipped_us, 1000, memory_order_relaxed);
+        xTaskCatchUpTicks(1);
+    }
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t sim_replay_init(void) {
+    const char *path = getenv(SIM_REPLAY_ENV);
+    char magic[4] = {0};
+    esp_err_t ret;
+
+    if (path == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t n = fread(magic, 1, sizeof(magic), f);
+    rewind(f);
+    if (n == sizeof(magic) && memcmp(magic, "THB1", 4) == 0) {
+        ret = load_thb(f);
+    } else {
+        ret = load_csv(f);
+    }
+    fclose(f);
+
+    if (ret == ESP_OK && s_count == 0) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Bad trace %s: %s", path, esp_err_to_name(ret));
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_path = path;
+    ESP_LOGI(TAG, "Replaying %u samples (%.1f s) from %s", (unsigned)s_count,
+             s_points[s_count - 1].t_ms / 1000.0, path);
+    return ESP_OK;
+}
+
+bool sim_replay_active(void) {
+    return getenv(SIM_REPLAY_ENV) != NULL;
+}
+
+void sim_replay_start(void) {
+    if (s_started || s_count == 0) {
+        return;
+    }
+    s_started = true;
+    s_origin_us = esp_timer_get_time();
+
+    // Lần đọc đầu tiên xảy ra sau khi app_main đã đăng ký mọi subscriber
+    sample_bus_sub_t sub = sample_bus_subscribe("replay", SAMPLE_BUS_DROP_OLDEST);
+    if (sub == NULL) {
+        ESP_LOGE(TAG, "No free sample bus slot for replay observer");
+        exit(1);
+    }
+    xTaskCreate(sim_observer_task, "sim_observer", 3072, sub, 1, NULL);
+    xTaskCreate(sim_clock_task, "sim_clock", 4096, NULL, tskIDLE_PRIORITY, NULL);
+}
+
+bool sim_replay_value_at(int64_t t_us, float *temperature, float *humidity) {
+    int64_t t_ms = (t_us - s_origin_us) / 1000;
+    size_t lo = 0;
+    size_t hi = s_count;
+
+    // Mẫu cuối cùng có t_ms <= t
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (s_points[mid].t_ms <= t_ms) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *temperature = s_points[lo].temp_deci / 10.0f;
+    *humidity = s_points[lo].hum_deci / 10.0f;
+    return s_points[lo].valid;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file sim_ssd1306.c
+ * @brief Host Simulation - SSD1306 ảo (bộ phân tích lệnh + GDDRAM 128x64)
+ *
+ * Nhận đúng các byte ssd1306.c gửi qua I2C: control 0x00 = chuỗi lệnh, 0x40 = dữ liệu.
+ * Hỗ trợ 3 chế độ địa chỉ (horizontal/vertical/page) nên flush toàn màn hình, flush
+ * theo cửa sổ và ghi theo page đều cho ra cùng một ảnh. Ảnh lưu theo tọa độ của
+ * ứng dụng (bỏ qua SEG remap / COM scan vì chỉ đổi hướng lắp panel).
+ */
+
+#include "sim.h"
+#include "ssd1306.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "SIM_OLED";
+
+// ==================== DATA STRUCTURES ====================
+
+typedef enum {
+    ADDR_MODE_HORIZONTAL = 0,
+    ADDR_MODE_VERTICAL = 1,
+    ADDR_MODE_PAGE = 2,
+} addr_mode_t;
+
+/**
+ * @brief Trạng thái bên trong controller
+ */
+typedef struct {
+    uint8_t gddram[SSD1306_PAGES][OLED_WIDTH];
+    addr_mode_t mode;
+    uint8_t col_start, col_end, col;
+    uint8_t page_start, page_end, page;
+    bool inverted;
+    bool dirty;                 // Có dữ liệu mới từ frame trước
+    uint8_t cmd;                // Lệnh đang chờ tham số
+    uint8_t args[2];
+    uint8_t args_needed;
+    uint8_t args_got;
+} panel_t;
+
+// ==================== GLOBAL STATE ====================
+
+static panel_t s_panel = {
+    .col_end = OLED_WIDTH - 1,
+    .page_end = SSD1306_PAGES - 1,
+};
+static sim_oled_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_last_write_us = 0;
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Số byte tham số theo sau 1 lệnh (0 = lệnh 1 byte)
+ */
+static uint8_t command_arg_count(uint8_t cmd) {
+    switch (cmd) {
+        case SSD1306_CMD_COLUMN_ADDR:
+        case SSD1306_CMD_PAGE_ADDR:
+            return 2;
+        case SSD1306_CMD_MEMORY_MODE:
+        case SSD1306_CMD_SET_CONTRAST:
+        case SSD1306_CMD_SET_MULTIPLEX:
+        case SSD1306_CMD_SET_DISPLAY_OFFSET:
+        case SSD1306_CMD_SET_DISPLAY_CLOCK_DIV:
+        case SSD1306_CMD_SET_PRECHARGE:
+        case SSD1306_CMD_SET_COM_PINS:
+        case SSD1306_CMD_SET_VCOM_DETECT:
+        case SSD1306_CMD_CHARGE_PUMP:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void execute_command(panel_t *p) {
+    uint8_t cmd = p->cmd;
+
+    switch (cmd) {
+        case SSD1306_CMD_MEMORY_MODE:
+            p->mode = (addr_mode_t)(p->args[0] & 0x03);
+            return;
+        case SSD1306_CMD_COLUMN_ADDR:
+            p->col_start = p->args[0] % OLED_WIDTH;
+            p->col_end = p->args[1] % OLED_WIDTH;
+            p->col = p->col_start;
+            return;
+        case SSD1306_CMD_PAGE_ADDR:
+            p->page_start = p->args[0] % SSD1306_PAGES;
+            p->page_end = p->args[1] % SSD1306_PAGES;
+            p->page = p->page_start;
+            return;
+        case SSD1306_CMD_NORMAL_DISPLAY:
+        case SSD1306_CMD_INVERT_DISPLAY:
+            p->inverted = (cmd == SSD1306_CMD_INVERT_DISPLAY);
+            p->dirty = true;
+            return;
+        case SSD1306_CMD_DISPLAY_OFF:
+        case SSD1306_CMD_DISPLAY_ON:
+            s_stats.display_on = (cmd == SSD1306_CMD_DISPLAY_ON);
+            p->dirty = true;
+            return;
+        default:
+            break;
+    }
+
+    // Page addressing: 0x00-0x0F cột thấp, 0x10-0x1F cột cao, 0xB0-0xB7 page
+    if (p->mode == ADDR_MODE_PAGE) {
+        if (cmd <= 0x0F) {
+            p->col = (p->col & 0xF0) | cmd;
+        } else if (cmd <= 0x1F) {
+            p->col = ((cmd & 0x07) << 4) | (p->col & 0x0F);
+        } else if ((cmd & 0xF8) == 0xB0) {
+            p->page = cmd & 0x07;
+        }
+    }
+}
+
+static void feed_command(panel_t *p, uint8_t byte) {
+    if (p->args_needed > 0) {
+        p->args[p->args_got++] = byte;
+        if (p->args_got < p->args_needed) {
+            return;
+        }
+        p->args_needed = 0;
+        execute_command(p);
+        return;
+    }
+
+    p->cmd = byte;
+    p->args_got = 0;
+    p->args_needed = command_arg_count(byte);
+    if (p->args_needed == 0) {
+        execute_command(p);
+    }
+}
+
+/**
+ * @brief Ghi 1 byte vào GDDRAM rồi tăng con trỏ theo chế độ địa chỉ
+ */
+static void feed_data(panel_t *p, uint8_t byte) {
+    p->gddram[p->page][p->col] = byte;
+    p->dirty = true;
+
+    switch (p->mode) {
+        case ADDR_MODE_HORIZONTAL:
+            if (p->col < p->col_end) {
+                p->col++;
+            } else {
+                p->col = p->col_start;
+                p->page = (p->page < p->page_end) ? p->page + 1 : p->page_start;
+            }
+            break;
+        case ADDR_MODE_VERTICAL:
+            if (p->page < p->page_end) {
+                p->page++;
+            } else {
+                p->page = p->page_start;
+                p->col = (p->col < p->col_end) ? p->col + 1 : p->col_start;
+            }
+            break;
+        default:
+            // Page mode: cột tăng tới cuối dòng thì quay về 0, page giữ nguyên
+            p->col = (p->col + 1) % OLED_WIDTH;
+            break;
+    }
+}
+
+/**
+ * @brief Bus lặng lâu hơn SIM_OLED_FRAME_GAP_US => flush trước đã xong
+ */
+static void maybe_finish_frame(int64_t now_us) {
+    const char *dir = getenv(SIM_OLED_DIR_ENV);
+    uint32_t frame;
+
+    if (!s_panel.dirty || now_us - s_last_write_us < SIM_OLED_FRAME_GAP_US) {
+        return;
+    }
+    s_panel.dirty = false;
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    frame = s_stats.frames++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (dir != NULL) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/frame_%06" PRIu32 ".pbm", dir, frame);
+        if (sim_oled_dump_pbm(path) != ESP_OK) {
+            ESP_LOGW(TAG, "Cannot write %s", path);
+        }
+    }
+}
+
+// ==================== PUBLIC API ====================
+
+esp_err_t sim_oled_write(const uint8_t *data, size_t len) {
+    int64_t now_us = esp_timer_get_time();
+    size_t payload = (len > 0) ? len - 1 : 0;
+
+    maybe_finish_frame(now_us);
+    s_last_write_us = now_us;
+
+    if (len > 0) {
+        bool is_data = (data[0] & 0x40) != 0;
+        for (size_t i = 1; i < len; i++) {
+            if (is_data) {
+                feed_data(&s_panel, data[i]);
+            } else {
+                feed_command(&s_panel, data[i]);
+            }
+        }
+
+        taskENTER_CRITICAL(&s_stats_lock);
+        if (is_data) {
+            s_stats.data_bytes += payload;
+        } else {
+            s_stats.command_bytes += payload;
+        }
+        taskEXIT_CRITICAL(&s_stats_lock);
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.transactions++;
+    s_stats.bytes += len + 1;   // + byte địa chỉ
+    taskEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+esp_err_t sim_oled_dump_pbm(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+
+    fprintf(f, "P4\n%d %d\n", OLED_WIDTH, OLED_HEIGHT);
+    for (int y = 0; y < OLED_HEIGHT; y++) {
+        uint8_t row[OLED_WIDTH / 8] = {0};
+        for (int x = 0; x < OLED_WIDTH; x++) {
+            bool lit = (s_panel.gddram[y / 8][x] >> (y % 8)) & 0x01;
+            if (s_panel.inverted) {
+                lit = !lit;
+            }
+            if (lit && s_stats.display_on) {
+                row[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+            }
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    fclose(f);
+    return ESP_OK;
+}
+
+void sim_oled_get_stats(sim_oled_stats_t *stats) {
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
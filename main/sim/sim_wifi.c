@@ -0,0 +1,32 @@
+/**
+ * @file sim_wifi.c
+ * @brief Host Simulation - WiFi ảo (target linux dùng luôn mạng của máy host)
+ */
+
+#include "wifi.h"
+#include "sim.h"
+#include "esp_log.h"
+
+static const char *TAG = "SIM_WIFI";
+
+esp_err_t wifi_init_sta(void) {
+    if (sim_replay_active()) {
+        // Replay chạy theo đồng hồ ảo: không mở socket HTTP
+        ESP_LOGI(TAG, "Replay mode, network disabled");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    ESP_LOGI(TAG, "Host network, no WiFi to join");
+    return ESP_OK;
+}
+
+bool wifi_is_connected(void) {
+    return true;
+}
+
+const char* wifi_get_ip_address(void) {
+    return "127.0.0.1";
+}
+
+esp_err_t wifi_stop(void) {
+    return ESP_OK;
+}
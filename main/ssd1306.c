@@ -1,6 +1,8 @@
 
 #include "ssd1306.h"
+#include "i2c_bus.h"
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
 static const char *TAG = TAG_DISPLAY;
@@ -68,64 +70,76 @@ static const uint8_t font5x7[][5] = {
     {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
 };
 
-/**
- * @brief Gửi command tới SSD1306
- */
-static esp_err_t ssd1306_write_command(uint8_t cmd) {
-    i2c_cmd_handle_t handle = i2c_cmd_link_create();
-    i2c_master_start(handle);
-    i2c_master_write_byte(handle, (OLED_I2C_ADDR << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(handle, 0x00, true); // command mode
-    i2c_master_write_byte(handle, cmd, true);
-    i2c_master_stop(handle);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS));
-    i2c_cmd_link_delete(handle);
-    return ret;
-}
+// ==================== FRAMEBUFFER ====================
+
+// Framebuffer 1KB tổ chức theo page: byte [page * OLED_WIDTH + x], bit 0 = dòng trên cùng của page
+static uint8_t s_buffer[SSD1306_BUFFER_SIZE];
+
+// Shadow: nội dung panel đang hiển thị (để flush vi sai).
+// Đặt ngay sau control byte 0x40 để gửi toàn màn hình trực tiếp từ shadow.
+static uint8_t s_shadow_tx[1 + SSD1306_BUFFER_SIZE];
+static uint8_t *const s_shadow = &s_shadow_tx[1];
+static volatile bool s_shadow_valid = false;
+
+// Staging cho transaction bất đồng bộ (phải sống tới khi bus task gửi xong)
+static uint8_t s_window_tx[SSD1306_PAGES][7];               // [0x00][6 byte window]
+static uint8_t s_span_tx[SSD1306_PAGES][1 + OLED_WIDTH];    // [0x40][data]
+
+// Theo dõi flush đang chạy trên bus
+static i2c_master_dev_handle_t s_dev = NULL;
+static SemaphoreHandle_t s_flush_idle = NULL;   // Có sẵn khi không còn transaction nào của flush trước
+static uint32_t s_inflight = 0;
+static bool s_staging = false;
+static portMUX_TYPE s_flush_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Thống kê lưu lượng I2C (để đo chi phí bus trước/sau tối ưu)
+static ssd1306_bus_stats_t s_bus_stats = {0};
 
 /**
- * @brief Gửi data tới SSD1306
+ * @brief Callback hoàn thành transaction (chạy trong bus task)
  */
-static esp_err_t ssd1306_write_data(uint8_t data) {
-    i2c_cmd_handle_t handle = i2c_cmd_link_create();
-    i2c_master_start(handle);
-    i2c_master_write_byte(handle, (OLED_I2C_ADDR << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(handle, 0x40, true); // data mode
-    i2c_master_write_byte(handle, data, true);
-    i2c_master_stop(handle);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS));
-    i2c_cmd_link_delete(handle);
-    return ret;
+static void ssd1306_xfer_done(esp_err_t result, void *arg) {
+    if (result != ESP_OK) {
+        // Không biết panel đang hiển thị gì => lần sau gửi lại toàn bộ
+        s_shadow_valid = false;
+    }
+    
+    taskENTER_CRITICAL(&s_flush_lock);
+    s_inflight--;
+    bool idle = (!s_staging && s_inflight == 0);
+    taskEXIT_CRITICAL(&s_flush_lock);
+    
+    if (idle) {
+        xSemaphoreGive(s_flush_idle);
+    }
 }
 
 /**
- * @brief Khởi tạo I2C master
+ * @brief Đưa 1 transaction của flush hiện tại vào hàng đợi bus
  */
-esp_err_t i2c_master_init(void) {
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = I2C_MASTER_SDA_IO,
-        .scl_io_num = I2C_MASTER_SCL_IO,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+static esp_err_t ssd1306_submit(const uint8_t *tx, size_t len) {
+    i2c_bus_xfer_t xfer = {
+        .dev = s_dev,
+        .tx = tx,
+        .tx_len = len,
+        .done_cb = ssd1306_xfer_done,
+        .arg = NULL,
     };
     
-    esp_err_t err = i2c_param_config(I2C_MASTER_NUM, &conf);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "I2C config failed");
-        return err;
-    }
+    taskENTER_CRITICAL(&s_flush_lock);
+    s_inflight++;
+    taskEXIT_CRITICAL(&s_flush_lock);
     
-    err = i2c_driver_install(I2C_MASTER_NUM, conf.mode, 
-                             I2C_MASTER_RX_BUF_LEN, I2C_MASTER_TX_BUF_LEN, 0);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "I2C driver install failed");
-        return err;
+    esp_err_t ret = i2c_bus_submit(&xfer, I2C_BUS_PRIO_NORMAL);
+    if (ret != ESP_OK) {
+        taskENTER_CRITICAL(&s_flush_lock);
+        s_inflight--;
+        taskEXIT_CRITICAL(&s_flush_lock);
+        return ret;
     }
     
-    ESP_LOGI(TAG, "I2C initialized (SDA=%d, SCL=%d)", 
-             I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO);
+    s_bus_stats.transactions++;
+    s_bus_stats.bytes += len + 1;  // địa chỉ + control byte + payload
     return ESP_OK;
 }
 
@@ -133,106 +147,318 @@ esp_err_t i2c_master_init(void) {
  * @brief Khởi tạo SSD1306 - Theo code test thành công
  */
 esp_err_t ssd1306_init(void) {
+    // Initialization sequence (giống code test), gửi trong 1 transaction
+    static const uint8_t init_seq[] = {
+        0x00,                                   // control byte: command stream
+        SSD1306_CMD_DISPLAY_OFF,
+        SSD1306_CMD_MEMORY_MODE, 0x00,          // horizontal mode (bắt buộc cho bulk flush)
+        SSD1306_CMD_SET_START_LINE,
+        SSD1306_CMD_SET_CONTRAST, 0x7F,
+        SSD1306_CMD_SEG_REMAP | 0x01,
+        SSD1306_CMD_NORMAL_DISPLAY,
+        SSD1306_CMD_SET_MULTIPLEX, 0x3F,
+        SSD1306_CMD_COM_SCAN_DEC,
+        SSD1306_CMD_SET_DISPLAY_OFFSET, 0x00,
+        SSD1306_CMD_SET_DISPLAY_CLOCK_DIV, 0x80,
+        SSD1306_CMD_SET_PRECHARGE, 0xF1,
+        SSD1306_CMD_SET_COM_PINS, 0x12,
+        SSD1306_CMD_SET_VCOM_DETECT, 0x40,
+        SSD1306_CMD_CHARGE_PUMP, 0x14,
+        SSD1306_CMD_DISPLAY_ON,
+    };
+    
+    esp_err_t ret = i2c_bus_add_device(OLED_I2C_ADDR, I2C_MASTER_FREQ_HZ, &s_dev);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    s_flush_idle = xSemaphoreCreateBinary();
+    if (s_flush_idle == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_flush_idle);
+    
+    s_shadow_tx[0] = 0x40;  // control byte: data stream
+    for (int page = 0; page < SSD1306_PAGES; page++) {
+        s_window_tx[page][0] = 0x00;
+        s_span_tx[page][0] = 0x40;
+    }
+    
     vTaskDelay(pdMS_TO_TICKS(100));
     
-    // Initialization sequence (giống code test)
-    ssd1306_write_command(0xAE); // display off
-    ssd1306_write_command(0x20);
-    ssd1306_write_command(0x00); // horizontal mode
-    ssd1306_write_command(0x40);
-    ssd1306_write_command(0x81);
-    ssd1306_write_command(0x7F);
-    ssd1306_write_command(0xA1);
-    ssd1306_write_command(0xA6);
-    ssd1306_write_command(0xA8);
-    ssd1306_write_command(0x3F);
-    ssd1306_write_command(0xC8);
-    ssd1306_write_command(0xD3);
-    ssd1306_write_command(0x00);
-    ssd1306_write_command(0xD5);
-    ssd1306_write_command(0x80);
-    ssd1306_write_command(0xD9);
-    ssd1306_write_command(0xF1);
-    ssd1306_write_command(0xDA);
-    ssd1306_write_command(0x12);
-    ssd1306_write_command(0xDB);
-    ssd1306_write_command(0x40);
-    ssd1306_write_command(0x8D);
-    ssd1306_write_command(0x14);
-    ssd1306_write_command(0xAF); // display on
+    ret = i2c_bus_transmit_sync(s_dev, init_seq, sizeof(init_seq));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SSD1306 init sequence failed");
+        return ret;
+    }
     
     ssd1306_clear();
+    ret = ssd1306_display();
     
     ESP_LOGI(TAG, "SSD1306 initialized");
-    return ESP_OK;
+    return ret;
 }
 
 /**
- * @brief Xóa buffer - Theo code test
+ * @brief Xóa framebuffer (chỉ RAM, không truy cập bus)
  */
 esp_err_t ssd1306_clear(void) {
-    for (int i = 0; i < 8; i++) {
-        ssd1306_write_command(0xB0 + i); // page
-        ssd1306_write_command(0x00);
-        ssd1306_write_command(0x10);
-        for (int j = 0; j < 128; j++) {
-            ssd1306_write_data(0x00);
-        }
-    }
+    memset(s_buffer, 0, sizeof(s_buffer));
     return ESP_OK;
 }
 
 /**
- * @brief Set cursor position
+ * @brief Đưa 1 cửa sổ [col0..col1] x [page0..page1] vào hàng đợi bus
+ * 
+ * Trong horizontal mode, dữ liệu của cửa sổ chỉ liên tục khi phủ hết chiều ngang,
+ * nên chỉ dùng cho 1 page (data lấy từ s_span_tx) hoặc toàn màn hình (từ shadow).
  */
-static void ssd1306_set_cursor(uint8_t page, uint8_t col) {
-    ssd1306_write_command(0xB0 + page);           // Set page address
-    ssd1306_write_command(0x00 + (col & 0x0F));   // Set lower column address
-    ssd1306_write_command(0x10 + (col >> 4));     // Set higher column address
+static esp_err_t ssd1306_queue_window(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1,
+                                      const uint8_t *data_tx, size_t data_len) {
+    uint8_t *window = s_window_tx[page0];
+    window[1] = SSD1306_CMD_COLUMN_ADDR;
+    window[2] = col0;
+    window[3] = col1;
+    window[4] = SSD1306_CMD_PAGE_ADDR;
+    window[5] = page0;
+    window[6] = page1;
+    
+    esp_err_t ret = ssd1306_submit(window, sizeof(s_window_tx[0]));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return ssd1306_submit(data_tx, 1 + data_len);
 }
 
 /**
- * @brief Write single character
+ * @brief Gửi framebuffer lên màn hình (chỉ gửi phần thay đổi so với shadow)
+ * 
+ * Với mỗi page, tìm cột đầu/cuối khác với shadow và chỉ gửi đoạn đó qua
+ * cửa sổ COLUMN_ADDR/PAGE_ADDR. Nếu tổng chi phí vượt quá 1 lần gửi toàn bộ
+ * (hoặc shadow chưa hợp lệ) thì gửi toàn màn hình trong 1 transaction.
+ * 
+ * Hàm chỉ xếp transaction vào bus manager rồi trả về; lỗi bus được xử lý
+ * bất đồng bộ bằng cách đánh dấu shadow không hợp lệ.
  */
-static void ssd1306_write_char(char c) {
-    if (c < 32 || c > 90) c = 32; // Default to space if out of range
+esp_err_t ssd1306_display(void) {
+    uint8_t first[SSD1306_PAGES];
+    uint8_t last[SSD1306_PAGES];
+    uint32_t diff_cost = 0;
+    uint32_t bytes_before = s_bus_stats.bytes;
+    esp_err_t ret = ESP_OK;
+    
+    // Staging buffer chỉ được ghi lại khi flush trước đã xong
+    if (xSemaphoreTake(s_flush_idle, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Previous flush still pending, frame skipped");
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    if (s_shadow_valid) {
+        for (int page = 0; page < SSD1306_PAGES; page++) {
+            const uint8_t *cur = &s_buffer[page * OLED_WIDTH];
+            const uint8_t *old = &s_shadow[page * OLED_WIDTH];
+            int lo = 0, hi = OLED_WIDTH - 1;
+            
+            while (lo < OLED_WIDTH && cur[lo] == old[lo]) lo++;
+            if (lo == OLED_WIDTH) {
+                first[page] = 1;  // first > last => page không đổi
+                last[page] = 0;
+                continue;
+            }
+            while (cur[hi] == old[hi]) hi--;
+            
+            first[page] = lo;
+            last[page] = hi;
+            diff_cost += SSD1306_WINDOW_OVERHEAD + (hi - lo + 1);
+        }
+    }
     
-    for (int i = 0; i < 5; i++) {
-        ssd1306_write_data(font5x7[c - 32][i]);
+    taskENTER_CRITICAL(&s_flush_lock);
+    s_staging = true;
+    taskEXIT_CRITICAL(&s_flush_lock);
+    
+    if (!s_shadow_valid || diff_cost >= SSD1306_WINDOW_OVERHEAD + SSD1306_BUFFER_SIZE) {
+        // Toàn màn hình: 1 cửa sổ + 1 data stream 1024 byte gửi thẳng từ shadow
+        memcpy(s_shadow, s_buffer, SSD1306_BUFFER_SIZE);
+        s_shadow_valid = true;
+        ret = ssd1306_queue_window(0, OLED_WIDTH - 1, 0, SSD1306_PAGES - 1,
+                                   s_shadow_tx, SSD1306_BUFFER_SIZE);
+    } else {
+        for (int page = 0; page < SSD1306_PAGES && ret == ESP_OK; page++) {
+            if (first[page] > last[page]) {
+                continue;
+            }
+            size_t len = last[page] - first[page] + 1;
+            const uint8_t *src = &s_buffer[page * OLED_WIDTH + first[page]];
+            
+            memcpy(&s_shadow[page * OLED_WIDTH + first[page]], src, len);
+            memcpy(&s_span_tx[page][1], src, len);
+            ret = ssd1306_queue_window(first[page], last[page], page, page, s_span_tx[page], len);
+        }
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Flush rejected by I2C bus: %s", esp_err_to_name(ret));
+        s_shadow_valid = false;
+    }
+    
+    taskENTER_CRITICAL(&s_flush_lock);
+    s_staging = false;
+    bool idle = (s_inflight == 0);
+    taskEXIT_CRITICAL(&s_flush_lock);
+    
+    if (idle) {
+        xSemaphoreGive(s_flush_idle);
     }
-    ssd1306_write_data(0x00); // Add spacing between characters
+    
+    s_bus_stats.flushes++;
+    s_bus_stats.last_flush_bytes = s_bus_stats.bytes - bytes_before;
+    return ret;
 }
 
 /**
- * @brief Gửi buffer lên màn hình - KHÔNG SỬ DỤNG NỮA
+ * @brief Chờ mọi transaction của lần flush gần nhất hoàn thành
  */
-esp_err_t ssd1306_display(void) {
-    // Không cần nữa vì đang write trực tiếp
+esp_err_t ssd1306_wait_flush(TickType_t timeout) {
+    if (xSemaphoreTake(s_flush_idle, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    xSemaphoreGive(s_flush_idle);
     return ESP_OK;
 }
 
+/**
+ * @brief Lấy thống kê lưu lượng I2C của driver
+ */
+void ssd1306_get_bus_stats(ssd1306_bus_stats_t *stats) {
+    *stats = s_bus_stats;
+}
 
+/**
+ * @brief Reset thống kê lưu lượng I2C
+ */
+void ssd1306_reset_bus_stats(void) {
+    memset(&s_bus_stats, 0, sizeof(s_bus_stats));
+}
 
+// ==================== DRAWING (RAM ONLY) ====================
 
+/**
+ * @brief Set/clear 1 pixel trong framebuffer (tự cắt nếu ngoài màn hình)
+ */
+static inline void fb_set_pixel(int x, int y, bool color) {
+    if (x < 0 || x >= OLED_WIDTH || y < 0 || y >= OLED_HEIGHT) {
+        return;
+    }
+    uint8_t *byte = &s_buffer[(y / 8) * OLED_WIDTH + x];
+    if (color) {
+        *byte |= (1 << (y & 7));
+    } else {
+        *byte &= ~(1 << (y & 7));
+    }
+}
 
 /**
- * @brief Vẽ chuỗi - Write trực tiếp như code test
+ * @brief Vẽ 1 pixel
  */
-esp_err_t ssd1306_draw_string(uint8_t x, uint8_t y, const char *str, uint8_t size) {
-    // Chuyển đổi y (pixel) sang page (0-7)
-    uint8_t page = y / 8;
+esp_err_t ssd1306_draw_pixel(uint8_t x, uint8_t y, bool color) {
+    if (x >= OLED_WIDTH || y >= OLED_HEIGHT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fb_set_pixel(x, y, color);
+    return ESP_OK;
+}
+
+/**
+ * @brief Vẽ 1 ký tự 5x7 (+1 cột khoảng cách), phóng to theo size
+ */
+esp_err_t ssd1306_draw_char(uint8_t x, uint8_t y, char c, uint8_t size) {
+    if (size == 0) size = 1;
+    if (c >= 'a' && c <= 'z') c -= 32;  // Font chỉ có chữ hoa
+    if (c < 32 || c > 90) c = 32;       // Default to space if out of range
     
-    ssd1306_set_cursor(page, x);
+    const uint8_t *glyph = font5x7[c - 32];
     
-    while (*str) {
-        ssd1306_write_char(*str);
+    for (int col = 0; col < 6; col++) {
+        uint8_t line = (col < 5) ? glyph[col] : 0x00;  // Cột 6 = khoảng cách
+        for (int row = 0; row < 8; row++) {
+            bool on = (line >> row) & 0x01;
+            for (int dx = 0; dx < size; dx++) {
+                for (int dy = 0; dy < size; dy++) {
+                    fb_set_pixel(x + col * size + dx, y + row * size + dy, on);
+                }
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Vẽ chuỗi vào framebuffer (tọa độ pixel)
+ */
+esp_err_t ssd1306_draw_string(uint8_t x, uint8_t y, const char *str, uint8_t size) {
+    if (size == 0) size = 1;
+    
+    int cx = x;
+    while (*str && cx < OLED_WIDTH) {
+        ssd1306_draw_char(cx, y, *str, size);
+        cx += 6 * size;
         str++;
     }
     
     return ESP_OK;
 }
 
+/**
+ * @brief Vẽ đường thẳng (Bresenham)
+ */
+esp_err_t ssd1306_draw_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+    int dx = abs((int)x1 - (int)x0);
+    int dy = -abs((int)y1 - (int)y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    int err = dx + dy;
+    int x = x0, y = y0;
+    
+    while (1) {
+        fb_set_pixel(x, y, true);
+        if (x == x1 && y == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x += sx; }
+        if (e2 <= dx) { err += dx; y += sy; }
+    }
+    return ESP_OK;
+}
 
+/**
+ * @brief Tô đặc hình chữ nhật
+ */
+esp_err_t ssd1306_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    for (int i = x; i < x + w; i++) {
+        for (int j = y; j < y + h; j++) {
+            fb_set_pixel(i, j, true);
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Vẽ viền hình chữ nhật
+ */
+esp_err_t ssd1306_draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    if (w == 0 || h == 0) {
+        return ESP_OK;
+    }
+    for (int i = x; i < x + w; i++) {
+        fb_set_pixel(i, y, true);
+        fb_set_pixel(i, y + h - 1, true);
+    }
+    for (int j = y; j < y + h; j++) {
+        fb_set_pixel(x, j, true);
+        fb_set_pixel(x + w - 1, j, true);
+    }
+    return ESP_OK;
+}
 
 /**
  * @brief Hiển thị màn hình chào
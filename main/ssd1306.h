@@ -35,10 +35,29 @@
 #define SSD1306_CMD_EXTERNAL_VCC            0x01
 #define SSD1306_CMD_SWITCH_CAP_VCC          0x02
 
+// Framebuffer (page-organised: 8 page x 128 cột)
+#define SSD1306_PAGES                       (OLED_HEIGHT / 8)
+#define SSD1306_BUFFER_SIZE                 (OLED_WIDTH * SSD1306_PAGES)
+
+// Chi phí cố định của 1 cửa sổ flush: transaction command (addr + ctrl + 6 byte)
+// + phần đầu transaction data (addr + ctrl)
+#define SSD1306_WINDOW_OVERHEAD             10
+
+/**
+ * @brief Thống kê lưu lượng I2C của driver
+ */
+typedef struct {
+    uint32_t transactions;  // Số transaction I2C (START..STOP)
+    uint32_t bytes;         // Tổng số byte trên bus (địa chỉ + control + payload)
+    uint32_t flushes;       // Số lần gọi ssd1306_display()
+    uint32_t last_flush_bytes;  // Số byte bus của lần flush gần nhất
+} ssd1306_bus_stats_t;
+
 // Function prototypes
 esp_err_t ssd1306_init(void);
 esp_err_t ssd1306_clear(void);
 esp_err_t ssd1306_display(void);
+esp_err_t ssd1306_wait_flush(TickType_t timeout);
 esp_err_t ssd1306_draw_pixel(uint8_t x, uint8_t y, bool color);
 esp_err_t ssd1306_draw_char(uint8_t x, uint8_t y, char c, uint8_t size);
 esp_err_t ssd1306_draw_string(uint8_t x, uint8_t y, const char *str, uint8_t size);
@@ -47,5 +66,7 @@ esp_err_t ssd1306_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
 esp_err_t ssd1306_draw_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
 esp_err_t ssd1306_update_display(sensor_data_t *data, system_state_t state);
 esp_err_t ssd1306_show_welcome_screen(void);
+void ssd1306_get_bus_stats(ssd1306_bus_stats_t *stats);
+void ssd1306_reset_bus_stats(void);
 
 #endif // SSD1306_H
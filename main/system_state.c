@@ -0,0 +1,40 @@
+/**
+ * @file system_state.c
+ * @brief Trạng thái hệ thống theo nhiệt độ (dùng chung cho main, webserver, display)
+ *
+ * Tách khỏi main.c để test/ có thể link riêng mà không kéo theo các task.
+ */
+
+#include "config.h"
+#include "sampler.h"
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief Xác định trạng thái hệ thống theo nhiệt độ (ngưỡng cấu hình lúc runtime)
+ */
+system_state_t get_system_state(float temperature) {
+    float temp_warning, temp_overheat;
+    sampler_get_thresholds(&temp_warning, &temp_overheat);
+
+    if (temperature >= temp_overheat) {
+        return STATE_OVERHEAT;
+    } else if (temperature >= temp_warning) {
+        return STATE_WARNING;
+    } else {
+        return STATE_NORMAL;
+    }
+}
+
+/**
+ * @brief Chuyển đổi state sang chuỗi
+ */
+const char* get_state_string(system_state_t state) {
+    switch (state) {
+        case STATE_NORMAL:   return "NORMAL";
+        case STATE_WARNING:  return "WARNING";
+        case STATE_OVERHEAT: return "DANGER!";
+        case STATE_ERROR:    return "ERROR";
+        default:             return "UNKNOWN";
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file web_assets.c
+ * @brief Web Assets Implementation
+ *
+ * File trong main/www được nén lúc build nên handler chỉ gửi thẳng vùng flash,
+ * không định dạng hay nén lúc chạy. ETag là hash FNV-1a của dữ liệu nén.
+ */
+
+#include "web_assets.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "WEB_ASSETS";
+
+// ==================== EMBEDDED FILES ====================
+
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[]   asm("_binary_index_html_gz_end");
+extern const uint8_t style_css_gz_start[]  asm("_binary_style_css_gz_start");
+extern const uint8_t style_css_gz_end[]    asm("_binary_style_css_gz_end");
+extern const uint8_t app_js_gz_start[]     asm("_binary_app_js_gz_start");
+extern const uint8_t app_js_gz_end[]       asm("_binary_app_js_gz_end");
+
+/**
+ * @brief 1 file tĩnh đã nén
+ */
+typedef struct {
+    const char *uri;
+    const char *content_type;
+    const char *cache_control;
+    const uint8_t *start;
+    const uint8_t *end;
+    char etag[12];              // "\"xxxxxxxx\"" + '\0'
+} web_asset_t;
+
+static web_asset_t s_assets[] = {
+    { "/",          "text/html; charset=utf-8",       WEB_ASSET_CACHE_DOCUMENT,  index_html_gz_start, index_html_gz_end },
+    { "/style.css", "text/css",                       WEB_ASSET_CACHE_VERSIONED, style_css_gz_start,  style_css_gz_end },
+    { "/app.js",    "application/javascript",         WEB_ASSET_CACHE_VERSIONED, app_js_gz_start,     app_js_gz_end },
+};
+
+#define NUM_ASSETS  (sizeof(s_assets) / sizeof(s_assets[0]))
+
+// ==================== HELPER FUNCTIONS ====================
+
+/**
+ * @brief FNV-1a 32-bit
+ */
+static uint32_t fnv1a(const uint8_t *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Tìm asset theo URI (không tính query string, VD: /app.js?v=...)
+ */
+static const web_asset_t *find_asset(const char *uri) {
+    size_t len = strcspn(uri, "?");
+    for (size_t i = 0; i < NUM_ASSETS; i++) {
+        if (strlen(s_assets[i].uri) == len && strncmp(s_assets[i].uri, uri, len) == 0) {
+            return &s_assets[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Client đã có đúng phiên bản này chưa (If-None-Match chứa ETag)
+ */
+static bool client_has_etag(httpd_req_t *req, const char *etag) {
+    char value[64];
+    size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+    if (len == 0 || len >= sizeof(value)) {
+        return false;
+    }
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    return strstr(value, etag) != NULL || strcmp(value, "*") == 0;
+}
+
+// ==================== PUBLIC API ====================
+
+void web_assets_init(void) {
+    for (size_t i = 0; i < NUM_ASSETS; i++) {
+        web_asset_t *a = &s_assets[i];
+        size_t size = a->end - a->start;
+        snprintf(a->etag, sizeof(a->etag), "\"%08" PRIx32 "\"", fnv1a(a->start, size));
+        ESP_LOGI(TAG, "%-10s %5u bytes gzip, ETag %s", a->uri, (unsigned)size, a->etag);
+    }
+}
+
+esp_err_t web_assets_send(httpd_req_t *req) {
+    const web_asset_t *a = find_asset(req->uri);
+    if (a == NULL) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    httpd_resp_set_hdr(req, "ETag", a->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", a->cache_control);
+
+    if (client_has_etag(req, a->etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, a->content_type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    return httpd_resp_send(req, (const char *)a->start, a->end - a->start);
+}
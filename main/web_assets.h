@@ -0,0 +1,32 @@
+/**
+ * @file web_assets.h
+ * @brief Web Assets - Dashboard HTML/CSS/JS nén gzip sẵn, nhúng trong firmware
+ * @features Content-Encoding gzip, ETag theo nội dung, Cache-Control, 304 Not Modified
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include "esp_http_server.h"
+#include "config.h"
+
+// ==================== CACHE POLICY ====================
+
+// index.html luôn được kiểm tra lại (304 nếu không đổi); CSS/JS có hash trong URL
+#define WEB_ASSET_CACHE_DOCUMENT    "no-cache"
+#define WEB_ASSET_CACHE_VERSIONED   "public, max-age=31536000, immutable"
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Tính ETag cho mọi asset (gọi 1 lần trước khi đăng ký route)
+ */
+void web_assets_init(void);
+
+/**
+ * @brief Gửi asset tương ứng với URI của request (bỏ qua query string)
+ * @return ESP_OK, hoặc ESP_ERR_NOT_FOUND nếu không có asset
+ */
+esp_err_t web_assets_send(httpd_req_t *req);
+
+#endif // WEB_ASSETS_H
@@ -0,0 +1,53 @@
+/**
+ * @file web_json.c
+ * @brief Web JSON Implementation
+ */
+
+#include "web_json.h"
+
+// ==================== PUBLIC API ====================
+
+void web_json_sensor(json_writer_t *w, const char *type, uint32_t seq,
+                     const sensor_data_t *data, system_state_t state) {
+    json_begin_object(w);
+    if (type != NULL) {
+        json_field_string(w, "type", type);
+    }
+    json_field_uint(w, "seq", seq);
+    json_field_float1(w, "temperature", data->temperature);
+    json_field_float1(w, "humidity", data->humidity);
+    json_field_string(w, "status", get_state_string(state));
+    json_field_bool(w, "is_valid", data->is_valid);
+    json_field_int(w, "timestamp", data->timestamp);
+    json_end_object(w);
+}
+
+void web_json_status(json_writer_t *w, const sensor_data_t *data, system_state_t state) {
+    json_begin_object(w);
+    json_field_float1(w, "temperature", data->temperature);
+    json_field_float1(w, "humidity", data->humidity);
+    json_field_string(w, "status", get_state_string(state));
+    json_end_object(w);
+}
+
+void web_json_history_sample(json_writer_t *w, const history_sample_t *s) {
+    json_begin_object(w);
+    json_field_uint(w, "seq", s->seq);
+    json_key(w, "temperature");
+    json_deci(w, s->temp_deci);
+    json_key(w, "humidity");
+    json_deci(w, s->hum_deci);
+    json_field_string(w, "status", get_state_string((system_state_t)s->state));
+    json_field_int(w, "timestamp", s->timestamp_ms * 1000);
+    json_end_object(w);
+}
+
+void web_json_buzzer(json_writer_t *w, bool on, bool typed) {
+    json_begin_object(w);
+    if (typed) {
+        json_field_string(w, "type", "buzzer");
+    }
+    json_field_string(w, "buzzer_status", on ? "ON" : "OFF");
+    json_field_bool(w, "is_active", on);
+    json_end_object(w);
+}
@@ -0,0 +1,40 @@
+/**
+ * @file web_json.h
+ * @brief Web JSON - Body JSON của các endpoint REST và tin live stream
+ * @features Dùng chung cho handler HTTP, long-poll và WebSocket, ghi qua json_writer
+ *
+ * Không gọi httpd nên test/ kiểm tra được đúng byte mà handler gửi đi.
+ */
+
+#ifndef WEB_JSON_H
+#define WEB_JSON_H
+
+#include "config.h"
+#include "json_writer.h"
+#include "history_codec.h"
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Mẫu mới nhất: /api/sensor, long-poll ?since=, tin "sample" của /ws
+ * @param type Giá trị trường "type" đứng đầu (tin live stream), NULL = không có
+ */
+void web_json_sensor(json_writer_t *w, const char *type, uint32_t seq,
+                     const sensor_data_t *data, system_state_t state);
+
+/**
+ * @brief Trạng thái ngắn gọn của /api/status
+ */
+void web_json_status(json_writer_t *w, const sensor_data_t *data, system_state_t state);
+
+/**
+ * @brief 1 bản ghi thô của /api/history (giá trị deci-unit, không qua float)
+ */
+void web_json_history_sample(json_writer_t *w, const history_sample_t *s);
+
+/**
+ * @brief Trạng thái buzzer (typed => thêm "type" cho tin live stream)
+ */
+void web_json_buzzer(json_writer_t *w, bool on, bool typed);
+
+#endif // WEB_JSON_H
@@ -5,12 +5,28 @@
  */
 
 #include "webserver.h"
+#include "web_assets.h"
+#include "live_stream.h"
+#include "sample_log.h"
+#include "history_query.h"
+#include "json_writer.h"
+#include "web_json.h"
+#include "sample_snapshot.h"
+#include "sampler.h"
+#include "latency.h"
+#include "sample_bus.h"
+#include "i2c_bus.h"
+#include "dht22.h"
+#include "esp_timer.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <math.h>
 
 static const char *TAG = "WEBSERVER";
 
@@ -20,88 +36,119 @@ const char* get_state_string(system_state_t state);
 // ==================== GLOBAL STATE ====================
 
 static httpd_handle_t server = NULL;
-SemaphoreHandle_t webserver_data_mutex = NULL;
+SemaphoreHandle_t webserver_data_mutex = NULL;   // Chỉ bảo vệ current_config
 
-static sensor_data_t current_sensor_data = {0};
-static system_state_t current_system_state = STATE_NORMAL;
 static system_config_t current_config = {
     .temp_warning = TEMP_WARNING,
     .temp_overheat = TEMP_OVERHEAT,
     .sensor_interval_ms = SENSOR_READ_PERIOD_MS,
+    .adaptive_sampling = false,
     .buzzer_enabled = true
 };
 
-// Lịch sử dữ liệu (vòng tròn)
-static history_record_t history[MAX_HISTORY_RECORDS];
-static uint32_t history_count = 0;
-static uint32_t history_index = 0;
+// Long-poll: request đang chờ mẫu mới (chỉ truy cập trong task httpd)
+typedef struct {
+    httpd_req_t *req;           // Bản sao async, NULL = slot trống
+    uint32_t since;
+    int64_t deadline_us;
+} longpoll_waiter_t;
+
+static longpoll_waiter_t longpoll_waiters[LONGPOLL_MAX_WAITERS];
+static atomic_uint longpoll_count = 0;
+static esp_timer_handle_t longpoll_timer = NULL;
 
 // ==================== HELPER FUNCTIONS ====================
 
 /**
- * @brief Thêm bản ghi vào lịch sử
+ * @brief Query dài hơn buffer của handler => 414 thay vì bỏ qua mọi tham số
  */
-static void add_to_history(const sensor_data_t *data, system_state_t state) {
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        history[history_index].data = *data;
-        history[history_index].state = state;
-        
-        history_index = (history_index + 1) % MAX_HISTORY_RECORDS;
-        if (history_count < MAX_HISTORY_RECORDS) {
-            history_count++;
-        }
-        
-        xSemaphoreGive(webserver_data_mutex);
+static esp_err_t query_too_long(httpd_req_t *req) {
+    return httpd_resp_send_err(req, HTTPD_414_URI_TOO_LONG, "Query string too long");
+}
+
+/**
+ * @brief Đọc tham số số nguyên không âm từ query string
+ * @return true nếu có tham số key
+ */
+static bool query_get_u32(const char *query, const char *key, uint32_t *out) {
+    char value[16];
+    if (query == NULL || httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return false;
     }
+    *out = (uint32_t)strtoul(value, NULL, 10);
+    return true;
 }
 
 /**
- * @brief Tạo JSON string cho dữ liệu sensor (không dùng cJSON)
+ * @brief Đọc tham số số nguyên có dấu 64-bit từ query string
+ * @return true nếu có tham số key
  */
-static char* create_sensor_json(void) {
-    static char json_buffer[512];
-    
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        snprintf(json_buffer, sizeof(json_buffer),
-            "{\"temperature\":%.1f,\"humidity\":%.1f,\"status\":\"%s\",\"is_valid\":%s,\"timestamp\":%lld}",
-            current_sensor_data.temperature,
-            current_sensor_data.humidity,
-            get_state_string(current_system_state),
-            current_sensor_data.is_valid ? "true" : "false",
-            current_sensor_data.timestamp
-        );
-        
-        ESP_LOGD(TAG, "Sensor JSON: %s", json_buffer);
-        xSemaphoreGive(webserver_data_mutex);
-    } else {
-        // Fallback nếu mutex timeout
-        snprintf(json_buffer, sizeof(json_buffer),
-            "{\"temperature\":0,\"humidity\":0,\"status\":\"UNKNOWN\",\"is_valid\":false,\"timestamp\":0}");
-        ESP_LOGW(TAG, "Mutex timeout, returning fallback JSON");
+static bool query_get_i64(const char *query, const char *key, int64_t *out) {
+    char value[24];
+    if (query == NULL || httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return false;
     }
-    
-    return json_buffer;
+    *out = strtoll(value, NULL, 10);
+    return true;
 }
 
 /**
- * @brief Tạo JSON string cho cấu hình hệ thống
+ * @brief Sink của json_writer: mỗi khối là 1 chunk HTTP
  */
-static char* create_config_json(void) {
-    static char json_buffer[256];
-    
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        snprintf(json_buffer, sizeof(json_buffer),
-            "{\"temp_warning\":%.1f,\"temp_overheat\":%.1f,\"sensor_interval_ms\":%" PRIu32 ",\"buzzer_enabled\":%s}",
-            current_config.temp_warning,
-            current_config.temp_overheat,
-            current_config.sensor_interval_ms,
-            current_config.buzzer_enabled ? "true" : "false"
-        );
-        
-        xSemaphoreGive(webserver_data_mutex);
+static esp_err_t httpd_chunk_sink(void *ctx, const char *data, size_t len) {
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
+
+/**
+ * @brief Bắt đầu response JSON (writer ghi thẳng ra socket theo khối JSON_WRITER_CHUNK)
+ */
+static void json_response_begin(json_writer_t *w, httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+    json_writer_init(w, httpd_chunk_sink, req);
+}
+
+/**
+ * @brief Kết thúc response JSON
+ * 
+ * Response vừa 1 khối (đa số endpoint) được gửi 1 lần với Content-Length,
+ * response dài hơn kết thúc bằng chunk rỗng.
+ */
+static esp_err_t json_response_end(json_writer_t *w, httpd_req_t *req) {
+    if (w->err == ESP_OK && !w->flushed) {
+        return httpd_resp_send(req, w->buf, w->len);
+    }
+    esp_err_t err = json_writer_flush(w);
+    if (err != ESP_OK) {
+        return err;
     }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/**
+ * @brief Ghi JSON cấu hình hệ thống
+ */
+static void write_config_json(json_writer_t *w) {
+    system_config_t config = webserver_get_config();
     
-    return json_buffer;
+    json_begin_object(w);
+    json_field_float1(w, "temp_warning", config.temp_warning);
+    json_field_float1(w, "temp_overheat", config.temp_overheat);
+    json_field_uint(w, "sensor_interval_ms", config.sensor_interval_ms);
+    json_field_bool(w, "adaptive_sampling", config.adaptive_sampling);
+    json_field_uint(w, "sample_period_ms", sampler_get_period_ms());
+    json_field_bool(w, "buzzer_enabled", config.buzzer_enabled);
+    json_end_object(w);
+}
+
+/**
+ * @brief Áp dụng cấu hình lấy mẫu/ngưỡng cho sampler (gọi khi đang giữ mutex)
+ */
+static void apply_config_to_sampler(system_config_t *config) {
+    sampler_set_thresholds(config->temp_warning, config->temp_overheat);
+    sampler_set_mode(config->adaptive_sampling ? SAMPLER_MODE_ADAPTIVE : SAMPLER_MODE_FIXED);
+    
+    // Sampler giới hạn theo chu kỳ tối thiểu của driver => lưu lại giá trị thực
+    config->sensor_interval_ms = sampler_set_interval(config->sensor_interval_ms);
 }
 
 // ==================== PARSE FUNCTION ====================
@@ -114,6 +161,8 @@ static void parse_config_from_post(const char *data, int len) {
     char temp_warning_str[16] = {0};
     char temp_overheat_str[16] = {0};
     char buzzer_str[16] = {0};
+    char interval_str[16] = {0};
+    char adaptive_str[16] = {0};
     
     // Parse: "temp_warning":32.0
     const char *ptr = strstr(data, "\"temp_warning\"");
@@ -136,6 +185,20 @@ static void parse_config_from_post(const char *data, int len) {
         if (ptr) sscanf(ptr + 1, "%15s", buzzer_str);
     }
     
+    // Parse: "sensor_interval_ms":5000
+    ptr = strstr(data, "\"sensor_interval_ms\"");
+    if (ptr) {
+        ptr = strchr(ptr, ':');
+        if (ptr) sscanf(ptr + 1, "%15s", interval_str);
+    }
+    
+    // Parse: "adaptive_sampling":true/false
+    ptr = strstr(data, "\"adaptive_sampling\"");
+    if (ptr) {
+        ptr = strchr(ptr, ':');
+        if (ptr) sscanf(ptr + 1, "%15s", adaptive_str);
+    }
+    
     // Update config if values are valid
     if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         if (temp_warning_str[0] != 0) {
@@ -152,38 +215,141 @@ static void parse_config_from_post(const char *data, int len) {
             current_config.buzzer_enabled = (strstr(buzzer_str, "true") != NULL);
         }
         
+        if (interval_str[0] != 0) {
+            long val = strtol(interval_str, NULL, 10);
+            if (val > 0) current_config.sensor_interval_ms = (uint32_t)val;
+        }
+        
+        if (adaptive_str[0] != 0) {
+            current_config.adaptive_sampling = (strstr(adaptive_str, "true") != NULL);
+        }
+        
+        // Áp dụng ngay, không cần khởi động lại
+        apply_config_to_sampler(&current_config);
+        
         xSemaphoreGive(webserver_data_mutex);
     }
 }
 
+// ==================== LONG POLL ====================
+// Request ?since=N được tách khỏi task httpd bằng httpd_req_async_handler_begin,
+// nên httpd tiếp tục phục vụ client khác. Mọi thao tác trên longpoll_waiters
+// chạy trong task httpd (handler hoặc work xếp bằng httpd_queue_work) => không cần khóa.
+
+/**
+ * @brief Work của httpd: trả lời waiter đã có mẫu mới hoặc đã hết giờ
+ */
+static void longpoll_work(void *arg) {
+    sample_snapshot_t snap;
+    json_writer_t json;                 // Không có sink: định dạng 1 lần, gửi cho mọi waiter
+    int64_t now_us = esp_timer_get_time();
+    unsigned remaining = 0;
+    
+    sample_snapshot_read(&snap);
+    json_writer_init(&json, NULL, NULL);
+    web_json_sensor(&json, NULL, snap.seq, &snap.data, snap.state);
+    
+    for (int i = 0; i < LONGPOLL_MAX_WAITERS; i++) {
+        longpoll_waiter_t *w = &longpoll_waiters[i];
+        if (w->req == NULL) {
+            continue;
+        }
+        
+        if (snap.seq != w->since) {
+            httpd_resp_set_type(w->req, "application/json");
+            httpd_resp_send(w->req, json.buf, json.len);
+        } else if (now_us >= w->deadline_us) {
+            httpd_resp_set_status(w->req, "204 No Content");
+            httpd_resp_send(w->req, NULL, 0);
+        } else {
+            remaining++;
+            continue;
+        }
+        httpd_req_async_handler_complete(w->req);
+        w->req = NULL;
+    }
+    
+    atomic_store_explicit(&longpoll_count, remaining, memory_order_relaxed);
+    if (remaining == 0) {
+        esp_timer_stop(longpoll_timer);
+    }
+}
+
+/**
+ * @brief esp_timer: kiểm tra timeout của waiter trong task httpd
+ */
+static void longpoll_timer_callback(void *arg) {
+    httpd_queue_work(server, longpoll_work, NULL);
+}
+
+/**
+ * @brief Đưa request vào danh sách chờ (gọi trong handler)
+ */
+static esp_err_t longpoll_wait(httpd_req_t *req, uint32_t since, uint32_t timeout_ms) {
+    int slot = -1;
+    for (int i = 0; i < LONGPOLL_MAX_WAITERS; i++) {
+        if (longpoll_waiters[i].req == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    httpd_req_t *async_req;
+    if (httpd_req_async_handler_begin(req, &async_req) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Long-poll unavailable");
+        return ESP_FAIL;
+    }
+    
+    if (timeout_ms > LONGPOLL_MAX_TIMEOUT_MS) timeout_ms = LONGPOLL_MAX_TIMEOUT_MS;
+    longpoll_waiters[slot].req = async_req;
+    longpoll_waiters[slot].since = since;
+    longpoll_waiters[slot].deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    
+    if (atomic_fetch_add_explicit(&longpoll_count, 1, memory_order_relaxed) == 0) {
+        esp_timer_start_periodic(longpoll_timer, LONGPOLL_CHECK_PERIOD_MS * 1000);
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief GET /api/sensor - Lấy dữ liệu cảm biến hiện tại
+ * 
+ * ?since=N: chờ tới khi có mẫu seq khác N (tối đa ?timeout=ms), hết giờ => 204.
+ * since lớn hơn seq hiện tại (VD: thiết bị vừa khởi động lại) => trả về ngay.
  */
 static esp_err_t sensor_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "GET /api/sensor");
     
-    // Create local buffer to avoid race condition with static buffer
-    char json_buffer[512];
+    char query[64];
+    sample_snapshot_t snap;
+    uint32_t since = 0;
+    uint32_t timeout_ms = LONGPOLL_DEFAULT_TIMEOUT_MS;
+    bool wait = false;
     
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        snprintf(json_buffer, sizeof(json_buffer),
-            "{\"temperature\":%.1f,\"humidity\":%.1f,\"status\":\"%s\",\"is_valid\":%s,\"timestamp\":%lld}",
-            current_sensor_data.temperature,
-            current_sensor_data.humidity,
-            get_state_string(current_system_state),
-            current_sensor_data.is_valid ? "true" : "false",
-            current_sensor_data.timestamp
-        );
-        
-        xSemaphoreGive(webserver_data_mutex);
-        
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, json_buffer, strlen(json_buffer));
-    } else {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Mutex timeout");
+    esp_err_t qret = httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (qret == ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return query_too_long(req);
+    }
+    if (qret == ESP_OK) {
+        wait = query_get_u32(query, "since", &since);
+        query_get_u32(query, "timeout", &timeout_ms);
     }
     
-    return ESP_OK;
+    sample_snapshot_read(&snap);
+    if (wait && snap.seq == since && timeout_ms > 0) {
+        return longpoll_wait(req, since, timeout_ms);
+    }
+    
+    json_writer_t json;
+    json_response_begin(&json, req);
+    web_json_sensor(&json, NULL, snap.seq, &snap.data, snap.state);
+    return json_response_end(&json, req);
 }
 
 /**
@@ -192,12 +358,10 @@ static esp_err_t sensor_handler(httpd_req_t *req) {
 static esp_err_t config_get_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "GET /api/config");
     
-    char *json_str = create_config_json();
-    
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_str, strlen(json_str));
-    
-    return ESP_OK;
+    json_writer_t json;
+    json_response_begin(&json, req);
+    write_config_json(&json);
+    return json_response_end(&json, req);
 }
 
 /**
@@ -217,22 +381,260 @@ static esp_err_t config_post_handler(httpd_req_t *req) {
     buf[ret] = '\0';
     parse_config_from_post(buf, ret);
     
-    char *response_json = create_config_json();
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, response_json, strlen(response_json));
-    
     ESP_LOGI(TAG, "✓ Config updated");
-    return ESP_OK;
+    
+    json_writer_t json;
+    json_response_begin(&json, req);
+    write_config_json(&json);
+    return json_response_end(&json, req);
+}
+
+/**
+ * @brief Ghi 1 bucket tổng hợp (tầng MINUTE/HOUR) vào mảng records
+ */
+static void write_bucket_json(json_writer_t *json, const history_bucket_t *b) {
+    json_begin_object(json);
+    json_field_int(json, "timestamp", b->start_us);
+    json_field_uint(json, "count", b->count);
+    if (b->count > 0) {
+        json_field_float1(json, "temperature", b->temp_mean);
+        json_field_float1(json, "temp_min", b->temp_min);
+        json_field_float1(json, "temp_max", b->temp_max);
+        json_field_float1(json, "humidity", b->hum_mean);
+        json_field_float1(json, "hum_min", b->hum_min);
+        json_field_float1(json, "hum_max", b->hum_max);
+    }
+    json_field_string(json, "status", get_state_string(b->worst_state));
+    json_end_object(json);
+}
+
+/**
+ * @brief Trả bucket tổng hợp của tầng MINUTE/HOUR cho /api/history
+ * 
+ * Bucket đã đóng đến history_tier_end_us(), phần sau đó (bucket đang mở) tổng hợp lại
+ * từ ring thô. Đọc mốc trước => 2 phần không chồng nhau dù có bucket đóng giữa chừng.
+ */
+static esp_err_t history_buckets_response(httpd_req_t *req, history_tier_t tier, int64_t from_us,
+                                          int64_t to_us, int limit, int offset) {
+    int64_t tier_end_us = history_tier_end_us(tier);
+    history_span_t span = { 0, 0 };
+    if (tier_end_us > from_us) {
+        span = history_tier_range(tier, from_us, (tier_end_us - 1 < to_us) ? tier_end_us - 1 : to_us);
+    }
+    
+    history_bucket_t tail[HISTORY_TAIL_BUCKETS];
+    uint32_t tail_count = 0;
+    int64_t tail_from_us = (tier_end_us > from_us) ? tier_end_us : from_us;
+    if (tail_from_us <= to_us) {
+        tail_count = history_tier_tail(tier, tail_from_us, to_us, tail, HISTORY_TAIL_BUCKETS);
+    }
+    
+    uint32_t closed = span.end - span.begin;
+    uint32_t total = closed + tail_count;
+    
+    json_writer_t json;
+    json_response_begin(&json, req);
+    json_begin_object(&json);
+    json_field_string(&json, "tier", history_tier_name(tier));
+    json_field_uint(&json, "period_s", history_tier_period_s(tier));
+    json_field_uint(&json, "total", total);
+    json_field_int(&json, "limit", limit);
+    json_field_int(&json, "offset", offset);
+    json_key(&json, "records");
+    json_begin_array(&json);
+    
+    int count = 0;
+    for (uint32_t i = offset; i < total && count < limit && json.err == ESP_OK; i++) {
+        history_bucket_t b;
+        if (i >= closed) {
+            b = tail[i - closed];
+        } else if (!history_read_bucket(tier, span.begin + i, &b)) {
+            continue;  // Đã bị ghi đè trong lúc đọc
+        }
+        write_bucket_json(&json, &b);
+        count++;
+    }
+    
+    json_end_array(&json);
+    json_end_object(&json);
+    return json_response_end(&json, req);
+}
+
+/**
+ * @brief Trả bản ghi từ nhật ký flash cho /api/history?source=flash
+ * 
+ * Đọc thẳng vùng mmap của partition (không có bản sao lịch sử trong RAM).
+ * since là LSN: chỉ trả các bản ghi có lsn > since.
+ */
+static esp_err_t history_log_response(httpd_req_t *req, uint32_t since, int limit, int offset) {
+    sample_log_span_t span = sample_log_get_span();
+    sample_log_stats_t stats;
+    sample_log_get_stats(&stats);
+    
+    if (since >= span.begin) {
+        span.begin = (since < span.end) ? since + 1 : span.end;
+    }
+    uint32_t total = span.end - span.begin;
+    
+    json_writer_t json;
+    json_response_begin(&json, req);
+    json_begin_object(&json);
+    json_field_string(&json, "source", "flash");
+    json_field_uint(&json, "boot", stats.boot);
+    json_field_uint(&json, "total", total);
+    json_field_int(&json, "limit", limit);
+    json_field_int(&json, "offset", offset);
+    json_field_uint(&json, "last_lsn", (total > 0) ? span.end - 1 : since);
+    json_key(&json, "records");
+    json_begin_array(&json);
+    
+    int count = 0;
+    for (uint32_t i = offset; i < total && count < limit && json.err == ESP_OK; i++) {
+        sample_log_record_t r;
+        if (!sample_log_read(span.begin + i, &r)) {
+            continue;  // Slot rách hoặc sector vừa bị xóa
+        }
+        
+        json_begin_object(&json);
+        json_field_uint(&json, "lsn", span.begin + i);
+        json_field_uint(&json, "boot", r.boot);
+        json_field_uint(&json, "seq", r.seq);
+        json_field_uint(&json, "uptime_ms", r.uptime_ms);
+        json_key(&json, "temperature");
+        json_deci(&json, r.temp_deci);
+        json_key(&json, "humidity");
+        json_deci(&json, r.hum_deci);
+        json_field_string(&json, "status", get_state_string((system_state_t)(r.flags & SAMPLE_LOG_FLAG_STATE_MASK)));
+        json_end_object(&json);
+        count++;
+    }
+    
+    json_end_array(&json);
+    json_end_object(&json);
+    return json_response_end(&json, req);
+}
+
+/**
+ * @brief Trung bình timestamp / nhiệt độ của các mẫu hợp lệ trong [pos, end) (điểm C của LTTB)
+ * @return false nếu không có mẫu hợp lệ
+ */
+static bool lttb_average(history_iter_t *it, uint32_t end, int64_t *ts_ms, int64_t *temp) {
+    history_sample_t s;
+    int64_t sum_ts = 0;
+    int64_t sum_temp = 0;
+    uint32_t n = 0;
+    
+    it->end = end;
+    while (history_iter_next_sample(it, &s)) {
+        if (s.is_valid) {
+            sum_ts += s.timestamp_ms;
+            sum_temp += s.temp_deci;
+            n++;
+        }
+    }
+    if (n == 0) {
+        return false;
+    }
+    *ts_ms = sum_ts / n;
+    *temp = sum_temp * HISTORY_LTTB_Y_SCALE / n;
+    return true;
+}
+
+/**
+ * @brief Trả span đã giảm còn points điểm bằng LTTB cho /api/history?points=N
+ * 
+ * Mẫu đầu và cuối luôn được giữ, phần giữa chia đều thành points - 2 bucket theo vị trí.
+ * 2 iterator đi cùng chiều: lead tính trung bình bucket i + 1 trong khi trail chọn mẫu của bucket i
+ * => mỗi mẫu giải nén 2 lần, RAM cố định bất kể độ dài khoảng.
+ * Bucket có mẫu OVERHEAT giữ mẫu nóng nhất để đỉnh quá nhiệt luôn hiện trên biểu đồ.
+ */
+static esp_err_t history_lttb_response(httpd_req_t *req, history_span_t span, uint32_t points) {
+    uint32_t total = span.end - span.begin;
+    uint32_t buckets = points - 2;
+    history_iter_t lead;
+    history_iter_t trail;
+    history_sample_t a;
+    history_sample_t s;
+    uint32_t count = 0;
+    
+    json_writer_t json;
+    json_response_begin(&json, req);
+    json_begin_object(&json);
+    json_field_string(&json, "tier", history_tier_name(HISTORY_TIER_RAW));
+    json_field_string(&json, "downsample", "lttb");
+    json_field_uint(&json, "total", total);
+    json_field_uint(&json, "points", points);
+    json_key(&json, "records");
+    json_begin_array(&json);
+    
+    // Bucket i = [bucket_begin(i), bucket_begin(i + 1)), bucket_begin(buckets) = mẫu cuối
+    history_span_t lead_span = { span.begin + 1 + (total - 2) / buckets, span.end };
+    history_iter_begin(&lead, lead_span);
+    history_iter_begin(&trail, span);
+    trail.end = span.begin + 1;
+    if (history_iter_next_sample(&trail, &a)) {
+        web_json_history_sample(&json, &a);
+        count++;
+        
+        for (uint32_t i = 0; i < buckets && json.err == ESP_OK; i++) {
+            uint32_t next_begin = span.begin + 1 + (uint32_t)((uint64_t)(i + 1) * (total - 2) / buckets);
+            uint32_t next_end = (i + 1 < buckets)
+                ? span.begin + 1 + (uint32_t)((uint64_t)(i + 2) * (total - 2) / buckets)
+                : span.end;
+            int64_t cx_ms = a.timestamp_ms;
+            int64_t cy = (int64_t)a.temp_deci * HISTORY_LTTB_Y_SCALE;
+            history_lttb_t lttb;
+            
+            // Bucket i + 1 không có mẫu hợp lệ => C = A
+            lttb_average(&lead, next_end, &cx_ms, &cy);
+            
+            history_lttb_begin(&lttb, &a, cx_ms, cy, STATE_OVERHEAT);
+            trail.end = next_begin;
+            while (history_iter_next_sample(&trail, &s)) {
+                history_lttb_offer(&lttb, &s);
+            }
+            if (history_lttb_end(&lttb, &a)) {
+                web_json_history_sample(&json, &a);
+                count++;
+            }
+        }
+        
+        // trail đang ở mẫu cuối
+        trail.end = span.end;
+        if (json.err == ESP_OK && history_iter_next_sample(&trail, &s)) {
+            web_json_history_sample(&json, &s);
+            count++;
+        }
+    }
+    
+    json_end_array(&json);
+    json_field_uint(&json, "count", count);
+    json_end_object(&json);
+    return json_response_end(&json, req);
 }
 
 /**
  * @brief GET /api/history - Lấy lịch sử dữ liệu
+ * 
+ * ?from=&to=: khoảng timestamp (us, cùng đồng hồ với trường timestamp), ?last=S: S giây gần nhất.
+ * ?since=N: chỉ trả các bản ghi có seq > N (client gửi lại last_seq của lần trước); chỉ tầng raw.
+ * ?tier=raw|1m|1h: tầng lưu trữ; mặc định raw, hoặc tự chọn theo from khi có from/last (không có since).
+ * ?source=flash: nhật ký trên flash (giữ qua reboot), since là LSN.
+ * ?points=N: cả khoảng thô được giảm còn tối đa N điểm (LTTB, mặc định tầng raw), bỏ qua limit/offset.
+ * Các điều kiện được giải bằng tìm nhị phân, không quét ring.
  */
 static esp_err_t history_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "GET /api/history");
     
     int limit = 10;
     int offset = 0;
+    uint32_t since = 0;
+    int64_t from_us = INT64_MIN;
+    int64_t to_us = INT64_MAX;
+    uint32_t last_s = 0;
+    uint32_t points = 0;                // 0 => không giảm mẫu
+    int tier = -1;                      // -1 => chọn theo khoảng thời gian
+    bool from_flash = false;
     
     // Parse query string manually
     size_t query_len = httpd_req_get_url_query_len(req);
@@ -248,49 +650,106 @@ static esp_err_t history_handler(httpd_req_t *req) {
             if (ptr) {
                 offset = atoi(ptr + 7);
             }
+            
+            query_get_u32(query_str, "since", &since);
+            query_get_u32(query_str, "points", &points);
+            query_get_i64(query_str, "from", &from_us);
+            query_get_i64(query_str, "to", &to_us);
+            if (query_get_u32(query_str, "last", &last_s)) {
+                from_us = esp_timer_get_time() - (int64_t)last_s * 1000000;
+            }
+            
+            char source_str[8];
+            if (httpd_query_key_value(query_str, "source", source_str, sizeof(source_str)) == ESP_OK) {
+                from_flash = (strcmp(source_str, "flash") == 0);
+            }
+            
+            char tier_str[8];
+            if (httpd_query_key_value(query_str, "tier", tier_str, sizeof(tier_str)) == ESP_OK) {
+                for (int t = 0; t < HISTORY_TIER_MAX; t++) {
+                    if (strcmp(tier_str, history_tier_name((history_tier_t)t)) == 0) {
+                        tier = t;
+                    }
+                }
+            }
         }
         if (query_str) free(query_str);
     }
     
-    if (limit > MAX_HISTORY_RECORDS) limit = MAX_HISTORY_RECORDS;
+    if (limit > HISTORY_MAX_SAMPLES) limit = HISTORY_MAX_SAMPLES;
     if (limit < 1) limit = 1;
     if (offset < 0) offset = 0;
     
-    // Build JSON response
-    static char response[2048];
-    int pos = 0;
+    if (from_flash) {
+        return history_log_response(req, since, limit, offset);
+    }
     
-    pos += snprintf(response + pos, sizeof(response) - pos,
-        "{\"total\":%" PRIu32 ",\"limit\":%d,\"offset\":%d,\"records\":[",
-        history_count, limit, offset
-    );
+    // Khoảng dài hơn tầng thô => trả bucket 1 phút / 1 giờ
+    if (tier < 0) {
+        tier = (from_us == INT64_MIN || points > 0 || since > 0) ? HISTORY_TIER_RAW : history_pick_tier(from_us);
+    }
+    if (tier != HISTORY_TIER_RAW && since > 0) {
+        // Bucket không có seq => since không áp dụng được, báo lỗi thay vì bỏ qua im lặng
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "since: tier=raw only");
+    }
+    if (tier != HISTORY_TIER_RAW) {
+        return history_buckets_response(req, (history_tier_t)tier, from_us, to_us, limit, offset);
+    }
     
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        int count = 0;
-        for (int i = offset; i < history_count && count < limit && pos < sizeof(response) - 150; i++) {
-            if (count > 0) {
-                pos += snprintf(response + pos, sizeof(response) - pos, ",");
-            }
-            
-            pos += snprintf(response + pos, sizeof(response) - pos,
-                "{\"temperature\":%.1f,\"humidity\":%.1f,\"status\":\"%s\",\"timestamp\":%lld}",
-                history[i].data.temperature,
-                history[i].data.humidity,
-                get_state_string(history[i].state),
-                history[i].data.timestamp
-            );
-            count++;
+    // Khoảng thời gian, rồi bỏ qua các bản ghi client đã có (seq tăng dần)
+    history_span_t span = history_range(from_us, to_us);
+    span.begin = history_find_after_seq(span, since);
+    uint32_t total = span.end - span.begin;
+    
+    if (points > 0) {
+        if (points < 3) points = 3;
+        if (points > HISTORY_MAX_POINTS) points = HISTORY_MAX_POINTS;
+        if (total > points) {
+            return history_lttb_response(req, span, points);
         }
-        
-        xSemaphoreGive(webserver_data_mutex);
+        limit = points;                 // Khoảng đủ ngắn => trả nguyên
+        offset = 0;
     }
     
-    pos += snprintf(response + pos, sizeof(response) - pos, "]}");
+    // Seq mới nhất để client dùng cho ?since= lần sau
+    uint32_t last_seq = since;
+    history_record_t newest;
+    if (total > 0 && history_read(span.end - 1, &newest)) {
+        last_seq = newest.seq;
+    }
     
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, response, pos);
+    // Stream JSON (cũ nhất -> mới nhất), RAM cố định bất kể số bản ghi
+    json_writer_t json;
+    json_response_begin(&json, req);
+    json_begin_object(&json);
+    json_field_string(&json, "tier", history_tier_name(HISTORY_TIER_RAW));
+    json_field_uint(&json, "total", total);
+    json_field_int(&json, "limit", limit);
+    json_field_int(&json, "offset", offset);
+    json_field_uint(&json, "last_seq", last_seq);
+    json_key(&json, "records");
+    json_begin_array(&json);
     
-    return ESP_OK;
+    // Giải nén tuần tự từng khối, bản ghi bị ghi đè trong lúc đọc được bỏ qua
+    history_iter_t it;
+    history_record_t rec;
+    int count = 0;
+    span.begin = ((uint32_t)offset < total) ? span.begin + offset : span.end;
+    history_iter_begin(&it, span);
+    while (count < limit && json.err == ESP_OK && history_iter_next(&it, &rec)) {
+        json_begin_object(&json);
+        json_field_uint(&json, "seq", rec.seq);
+        json_field_float1(&json, "temperature", rec.data.temperature);
+        json_field_float1(&json, "humidity", rec.data.humidity);
+        json_field_string(&json, "status", get_state_string(rec.state));
+        json_field_int(&json, "timestamp", rec.data.timestamp);
+        json_end_object(&json);
+        count++;
+    }
+    
+    json_end_array(&json);
+    json_end_object(&json);
+    return json_response_end(&json, req);
 }
 
 /**
@@ -299,23 +758,13 @@ static esp_err_t history_handler(httpd_req_t *req) {
 static esp_err_t status_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "GET /api/status");
     
-    static char json_buffer[256];
-    
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        snprintf(json_buffer, sizeof(json_buffer),
-            "{\"temperature\":%.1f,\"humidity\":%.1f,\"status\":\"%s\"}",
-            current_sensor_data.temperature,
-            current_sensor_data.humidity,
-            get_state_string(current_system_state)
-        );
-        
-        xSemaphoreGive(webserver_data_mutex);
-    }
+    sample_snapshot_t snap;
+    sample_snapshot_read(&snap);
     
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_buffer, strlen(json_buffer));
-    
-    return ESP_OK;
+    json_writer_t json;
+    json_response_begin(&json, req);
+    web_json_status(&json, &snap.data, snap.state);
+    return json_response_end(&json, req);
 }
 
 /**
@@ -324,157 +773,987 @@ static esp_err_t status_handler(httpd_req_t *req) {
 static esp_err_t buzzer_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "GET /api/buzzer");
     
-    static char json_buffer[128];
+    json_writer_t json;
+    json_response_begin(&json, req);
+    web_json_buzzer(&json, get_buzzer_status(), false);
+    return json_response_end(&json, req);
+}
+
+/**
+ * @brief GET /api/latency - Độ trễ từng giai đoạn của pipeline (p50/p99/max, us)
+ * ?reset=1: xóa histogram sau khi trả kết quả (mở cửa sổ đo mới, như lệnh 'latency reset')
+ */
+static esp_err_t latency_handler(httpd_req_t *req) {
+    ESP_LOGI(TAG, "GET /api/latency");
     
-    bool buzzer_on = get_buzzer_status();
-    snprintf(json_buffer, sizeof(json_buffer),
-        "{\"buzzer_status\":\"%s\",\"is_active\":%s}",
-        buzzer_on ? "ON" : "OFF",
-        buzzer_on ? "true" : "false"
-    );
+    char query[32];
+    uint32_t reset = 0;
+    esp_err_t qret = httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (qret == ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return query_too_long(req);
+    }
+    if (qret == ESP_OK) {
+        query_get_u32(query, "reset", &reset);
+    }
     
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_buffer, strlen(json_buffer));
+    json_writer_t json;
+    json_response_begin(&json, req);
+    json_begin_object(&json);
+    json_key(&json, "stages");
+    json_begin_array(&json);
     
-    return ESP_OK;
+    for (int i = 0; i < LATENCY_STAGE_MAX; i++) {
+        latency_summary_t s;
+        latency_get_summary((latency_stage_t)i, &s);
+        json_begin_object(&json);
+        json_field_string(&json, "stage", latency_stage_name((latency_stage_t)i));
+        json_field_uint(&json, "count", s.count);
+        json_field_uint(&json, "avg_us", s.avg_us);
+        json_field_uint(&json, "p50_us", s.p50_us);
+        json_field_uint(&json, "p99_us", s.p99_us);
+        json_field_uint(&json, "max_us", s.max_us);
+        json_end_object(&json);
+    }
+    
+    json_end_array(&json);
+    json_end_object(&json);
+    
+    if (reset) {
+        latency_reset();
+    }
+    return json_response_end(&json, req);
 }
 
 /**
- * @brief GET / - Trang HTML chính (Gửi theo chunks để tránh lỗi socket)
- */
-static esp_err_t root_handler(httpd_req_t *req) {
-    ESP_LOGI(TAG, "GET /");
-    
-    httpd_resp_set_type(req, "text/html; charset=utf-8");
-    
-    // Phần 1: DOCTYPE + HEAD + CSS
-    const char *html_part1 = 
-        "<!DOCTYPE html><html><head><title>Temperature Monitor</title>"
-        "<meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>"
-        "<style>"
-        "* {margin:0;padding:0;box-sizing:border-box;}"
-        "body {font-family:Arial,sans-serif;background:#1a1a2e;color:#eee;padding:20px;}"
-        ".container {max-width:1000px;margin:0 auto;}"
-        "h1 {color:#00d4ff;margin-bottom:30px;text-align:center;}"
-        ".card {background:#16213e;border:1px solid #0f3460;border-radius:8px;padding:20px;margin-bottom:20px;}"
-        ".data-row {display:flex;justify-content:space-between;padding:10px 0;border-bottom:1px solid #0f3460;}"
-        ".data-row:last-child {border-bottom:none;}"
-        ".label {font-weight:bold;color:#00d4ff;}"
-        ".value {color:#00ff88;font-size:18px;}"
-        ".status.NORMAL {color:#00ff88;}"
-        ".status.WARNING {color:#ffaa00;}"
-        ".status.DANGER {color:#ff3333;}"
-        "button {background:#0f3460;border:2px solid #00d4ff;color:#00d4ff;padding:10px 20px;border-radius:5px;cursor:pointer;margin-right:10px;margin-top:10px;}"
-        "button:hover {background:#00d4ff;color:#1a1a2e;}"
-        "input {background:#0f3460;border:1px solid #00d4ff;color:#eee;padding:8px;border-radius:4px;width:100px;margin-right:5px;}"
-        ".loading {text-align:center;color:#00d4ff;}"
-        "</style></head><body>"
-        "<div class='container'><h1>🌡️ Temperature Monitoring</h1>";
-    
-    // Phần 2: HTML body
-    const char *html_part2 = 
-        "<div class='card'><h2>📊 Sensor Data</h2><div id='sensor-data' class='loading'>Loading...</div></div>"
-        "<div class='card'><h2>📯 Buzzer Status</h2><div id='buzzer-data' class='loading'>Loading...</div></div>"
-        "<div class='card'><h2>⚙️ Configuration</h2><div id='config-data' class='loading'>Loading...</div>"
-        "<div><input type='number' id='temp-warning' placeholder='Warning' step='0.1'>"
-        "<input type='number' id='temp-overheat' placeholder='Overheat' step='0.1'>"
-        "<button onclick='updateConfig()'>Update Config</button></div></div>"
-        "</div>";
-    
-    // Phần 3: JavaScript (Tối ưu - minified)
-    const char *html_part3 = 
-        "<script>"
-        "function fetchSensorData(){"
-        "fetch('/api/sensor').then(r=>r.json()).then(d=>{"
-        "let h='<div class=\"data-row\"><span class=\"label\">Temperature:</span><span class=\"value\">'+d.temperature.toFixed(1)+'°C</span></div>';"
-        "h+='<div class=\"data-row\"><span class=\"label\">Humidity:</span><span class=\"value\">'+d.humidity.toFixed(1)+'%</span></div>';"
-        "h+='<div class=\"data-row\"><span class=\"label\">Status:</span><span class=\"value status '+d.status+'\">'+d.status+'</span></div>';"
-        "document.getElementById('sensor-data').innerHTML=h;"
-        "}).catch(e=>console.error('Sensor error:',e));}"
-        "function fetchBuzzerStatus(){"
-        "fetch('/api/buzzer').then(r=>r.json()).then(d=>{"
-        "let color=d.is_active?'#ff3333':'#00ff88';"
-        "let h='<div class=\"data-row\"><span class=\"label\">Status:</span><span class=\"value\" style=\"color:'+color+'\">'+d.buzzer_status+'</span></div>';"
-        "document.getElementById('buzzer-data').innerHTML=h;"
-        "}).catch(e=>console.error('Buzzer error:',e));}"
-        "function fetchConfig(){"
-        "fetch('/api/config').then(r=>r.json()).then(d=>{"
-        "let h='<div class=\"data-row\"><span class=\"label\">Warning:</span><span class=\"value\">'+d.temp_warning.toFixed(1)+'°C</span></div>';"
-        "h+='<div class=\"data-row\"><span class=\"label\">Overheat:</span><span class=\"value\">'+d.temp_overheat.toFixed(1)+'°C</span></div>';"
-        "document.getElementById('config-data').innerHTML=h;"
-        "document.getElementById('temp-warning').value=d.temp_warning;"
-        "document.getElementById('temp-overheat').value=d.temp_overheat;"
-        "}).catch(e=>console.error('Config error:',e));}"
-        "function updateConfig(){"
-        "let w=parseFloat(document.getElementById('temp-warning').value);"
-        "let o=parseFloat(document.getElementById('temp-overheat').value);"
-        "fetch('/api/config',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({temp_warning:w,temp_overheat:o})})"
-        ".then(()=>{alert('Updated!');fetchConfig();}).catch(e=>alert('Error:'+e));}"
-        "document.addEventListener('DOMContentLoaded',function(){"
-        "fetchSensorData();fetchBuzzerStatus();fetchConfig();setInterval(fetchSensorData,2000);setInterval(fetchBuzzerStatus,2000);"
-        "});"
-        "</script></body></html>";
-    
-    // Gửi từng phần để tránh lỗi socket
-    httpd_resp_send_chunk(req, html_part1, strlen(html_part1));
-    httpd_resp_send_chunk(req, html_part2, strlen(html_part2));
-    httpd_resp_send_chunk(req, html_part3, strlen(html_part3));
-    
-    // Kết thúc gửi
-    httpd_resp_send_chunk(req, NULL, 0);
+ * @brief GET /, /style.css, /app.js - Dashboard nén gzip sẵn (xem web_assets.c)
+ */
+static esp_err_t asset_handler(httpd_req_t *req) {
+    ESP_LOGI(TAG, "GET %s", req->uri);
+    
+    return web_assets_send(req);
+}
+
+// ==================== HISTORY EXPORT ====================
+
+/**
+ * @brief 1 hàng xuất (chung cho nguồn RAM và flash), giá trị số nguyên như lúc lưu
+ */
+typedef struct {
+    uint32_t id;                // seq (RAM) hoặc LSN (flash): giá trị dùng cho ?since= lần sau
+    uint32_t seq;
+    int64_t timestamp_ms;       // Kể từ lần khởi động boot
+    uint16_t boot;
+    int16_t temp_deci;
+    uint16_t hum_deci;
+    uint8_t state;
+    bool is_valid;
+} export_row_t;
+
+/**
+ * @brief Nguồn hàng: ring lịch sử trong RAM hoặc nhật ký flash (?source=flash)
+ */
+typedef struct {
+    bool flash;
+    uint16_t boot;              // Boot hiện tại, gán cho các hàng từ RAM
+    uint32_t total;             // Cận trên số hàng (hàng bị ghi đè trong lúc xuất bị bỏ qua)
+    uint32_t lsn;               // Nguồn flash: LSN kế tiếp
+    uint32_t end;
+    history_iter_t it;          // Nguồn RAM
+} export_source_t;
+
+/**
+ * @brief Bộ đệm gửi: gom byte rồi gửi theo chunk HISTORY_EXPORT_CHUNK
+ */
+typedef struct {
+    httpd_req_t *req;
+    size_t len;
+    esp_err_t err;
+    char buf[HISTORY_EXPORT_CHUNK];
+} export_writer_t;
+
+static const char export_schema[] =
+    "id:u32,seq:u32,timestamp_ms:i64,boot:u16,temperature_deci:i16,humidity_deci:u16,state:u8,valid:u8";
+
+/**
+ * @brief Chọn nguồn và khoảng theo query (?from=&to=, ?last=S, ?since=N, ?source=flash)
+ * @return ESP_ERR_HTTPD_RESULT_TRUNC nếu query dài hơn buffer (caller trả 414, không xuất gì)
+ */
+static esp_err_t export_source_open(export_source_t *src, httpd_req_t *req) {
+    char query[128];
+    char source_str[8];
+    uint32_t since = 0;
+    uint32_t last_s = 0;
+    int64_t from_us = INT64_MIN;
+    int64_t to_us = INT64_MAX;
+    sample_log_stats_t stats;
+    
+    sample_log_get_stats(&stats);
+    src->boot = (uint16_t)stats.boot;
+    src->flash = false;
     
+    esp_err_t qret = httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (qret == ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return qret;
+    }
+    if (qret == ESP_OK) {
+        query_get_u32(query, "since", &since);
+        query_get_i64(query, "from", &from_us);
+        query_get_i64(query, "to", &to_us);
+        if (query_get_u32(query, "last", &last_s)) {
+            from_us = esp_timer_get_time() - (int64_t)last_s * 1000000;
+        }
+        if (httpd_query_key_value(query, "source", source_str, sizeof(source_str)) == ESP_OK) {
+            src->flash = (strcmp(source_str, "flash") == 0);
+        }
+    }
+    
+    if (src->flash) {
+        // Đồng hồ mỗi lần khởi động khác nhau => nhật ký flash chỉ lọc theo LSN
+        sample_log_span_t span = sample_log_get_span();
+        src->lsn = span.begin;
+        if (since >= span.begin) {
+            src->lsn = (since < span.end) ? since + 1 : span.end;
+        }
+        src->end = span.end;
+        src->total = src->end - src->lsn;
+    } else {
+        history_span_t span = history_range(from_us, to_us);
+        span.begin = history_find_after_seq(span, since);
+        src->total = span.end - span.begin;
+        history_iter_begin(&src->it, span);
+    }
     return ESP_OK;
 }
 
+static bool export_source_next(export_source_t *src, export_row_t *row) {
+    if (src->flash) {
+        sample_log_record_t r;
+        while (src->lsn < src->end) {
+            uint32_t lsn = src->lsn++;
+            if (!sample_log_read(lsn, &r)) {
+                continue;  // Slot rách hoặc sector vừa bị xóa
+            }
+            row->id = lsn;
+            row->seq = r.seq;
+            row->timestamp_ms = r.uptime_ms;
+            row->boot = r.boot;
+            row->temp_deci = r.temp_deci;
+            row->hum_deci = r.hum_deci;
+            row->state = r.flags & SAMPLE_LOG_FLAG_STATE_MASK;
+            row->is_valid = (r.flags & SAMPLE_LOG_FLAG_VALID) != 0;
+            return true;
+        }
+        return false;
+    }
+    
+    history_sample_t s;
+    if (!history_iter_next_sample(&src->it, &s)) {
+        return false;
+    }
+    row->id = s.seq;
+    row->seq = s.seq;
+    row->timestamp_ms = s.timestamp_ms;
+    row->boot = src->boot;
+    row->temp_deci = s.temp_deci;
+    row->hum_deci = s.hum_deci;
+    row->state = s.state;
+    row->is_valid = s.is_valid;
+    return true;
+}
+
+static void export_write(export_writer_t *w, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0 && w->err == ESP_OK) {
+        if (w->len == sizeof(w->buf)) {
+            w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+            w->len = 0;
+            continue;
+        }
+        size_t n = sizeof(w->buf) - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->len, p, n);
+        w->len += n;
+        p += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Gửi phần còn lại và chunk rỗng kết thúc
+ */
+static esp_err_t export_finish(export_writer_t *w) {
+    if (w->err == ESP_OK && w->len > 0) {
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    }
+    if (w->err != ESP_OK) {
+        return w->err;
+    }
+    return httpd_resp_send_chunk(w->req, NULL, 0);
+}
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_le64(uint8_t *p, uint64_t v) {
+    put_le32(p, (uint32_t)v);
+    put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+/**
+ * @brief Ghi số nguyên không dấu dạng thập phân, trả về số ký tự
+ */
+static int fmt_uint(char *out, uint64_t value) {
+    char tmp[20];
+    int pos = sizeof(tmp);
+    
+    do {
+        tmp[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    memcpy(out, tmp + pos, sizeof(tmp) - pos);
+    return sizeof(tmp) - pos;
+}
+
+/**
+ * @brief Ghi số fixed-point 1 chữ số thập phân (253 => "25.3")
+ */
+static int fmt_deci(char *out, int32_t deci) {
+    int n = 0;
+    uint32_t abs_deci = (deci < 0) ? (uint32_t)0 - (uint32_t)deci : (uint32_t)deci;
+    
+    if (deci < 0) {
+        out[n++] = '-';
+    }
+    n += fmt_uint(out + n, abs_deci / 10);
+    out[n++] = '.';
+    out[n++] = (char)('0' + abs_deci % 10);
+    return n;
+}
+
+/**
+ * @brief GET /api/history.bin - Xuất lịch sử dạng bản ghi nhị phân cố định
+ * 
+ * Header (little-endian): "THB1", u16 header_size, u16 record_size, u32 record_count (cận trên),
+ * u16 flags (bit 0 = nguồn flash), u16 schema_len, rồi chuỗi schema "tên:kiểu,..." đệm NUL tới bội 4.
+ * Sau đó là các bản ghi record_size byte theo đúng thứ tự trong schema, tới hết response.
+ */
+static esp_err_t history_bin_handler(httpd_req_t *req) {
+    ESP_LOGI(TAG, "GET /api/history.bin");
+    
+    export_source_t src;
+    export_writer_t w = { .req = req, .len = 0, .err = ESP_OK };
+    export_row_t row;
+    uint8_t hdr[16];
+    uint8_t rec[HISTORY_EXPORT_RECORD_SIZE];
+    size_t schema_len = sizeof(export_schema) - 1;
+    size_t schema_padded = (schema_len + 3) & ~(size_t)3;
+    
+    if (export_source_open(&src, req) != ESP_OK) {
+        return query_too_long(req);
+    }
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"history.bin\"");
+    
+    memcpy(hdr, "THB1", 4);
+    put_le16(hdr + 4, (uint16_t)(sizeof(hdr) + schema_padded));
+    put_le16(hdr + 6, HISTORY_EXPORT_RECORD_SIZE);
+    put_le32(hdr + 8, src.total);
+    put_le16(hdr + 12, src.flash ? 1 : 0);
+    put_le16(hdr + 14, (uint16_t)schema_len);
+    export_write(&w, hdr, sizeof(hdr));
+    export_write(&w, export_schema, schema_len);
+    export_write(&w, "\0\0\0", schema_padded - schema_len);
+    
+    while (w.err == ESP_OK && export_source_next(&src, &row)) {
+        put_le32(rec, row.id);
+        put_le32(rec + 4, row.seq);
+        put_le64(rec + 8, (uint64_t)row.timestamp_ms);
+        put_le16(rec + 16, row.boot);
+        put_le16(rec + 18, (uint16_t)row.temp_deci);
+        put_le16(rec + 20, row.hum_deci);
+        rec[22] = row.state;
+        rec[23] = row.is_valid ? 1 : 0;
+        export_write(&w, rec, sizeof(rec));
+    }
+    return export_finish(&w);
+}
+
+/**
+ * @brief GET /api/history.csv - Xuất lịch sử dạng CSV (chunked, cùng query với history.bin)
+ */
+static esp_err_t history_csv_handler(httpd_req_t *req) {
+    static const char header[] = "id,seq,boot,timestamp_ms,temperature,humidity,status,valid\n";
+    
+    ESP_LOGI(TAG, "GET /api/history.csv");
+    
+    export_source_t src;
+    export_writer_t w = { .req = req, .len = 0, .err = ESP_OK };
+    export_row_t row;
+    char line[96];
+    
+    if (export_source_open(&src, req) != ESP_OK) {
+        return query_too_long(req);
+    }
+    httpd_resp_set_type(req, "text/csv");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"history.csv\"");
+    export_write(&w, header, sizeof(header) - 1);
+    
+    while (w.err == ESP_OK && export_source_next(&src, &row)) {
+        const char *status = get_state_string((system_state_t)row.state);
+        size_t status_len = strlen(status);
+        int n = 0;
+        
+        n += fmt_uint(line + n, row.id);
+        line[n++] = ',';
+        n += fmt_uint(line + n, row.seq);
+        line[n++] = ',';
+        n += fmt_uint(line + n, row.boot);
+        line[n++] = ',';
+        n += fmt_uint(line + n, (uint64_t)row.timestamp_ms);
+        line[n++] = ',';
+        n += fmt_deci(line + n, row.temp_deci);
+        line[n++] = ',';
+        n += fmt_deci(line + n, row.hum_deci);
+        line[n++] = ',';
+        memcpy(line + n, status, status_len);
+        n += status_len;
+        line[n++] = ',';
+        line[n++] = row.is_valid ? '1' : '0';
+        line[n++] = '\n';
+        export_write(&w, line, n);
+    }
+    return export_finish(&w);
+}
+
+// ==================== AGGREGATION QUERY ====================
+
+/**
+ * @brief Trạng thái của /api/query (cấp phát heap: histogram p95 quá lớn cho stack httpd)
+ */
+typedef struct {
+    history_reducer_t reducer;
+    history_columns_t cols;
+    json_writer_t *json;
+} query_ctx_t;
+
+/**
+ * @brief Ghi 1 bucket kết quả (callback của history_reducer)
+ */
+static void query_emit(void *ctx, const history_query_bucket_t *bucket) {
+    json_writer_t *w = ((query_ctx_t *)ctx)->json;
+    json_begin_object(w);
+    json_field_int(w, "timestamp", bucket->start_ms * 1000);
+    json_field_uint(w, "count", bucket->count);
+    json_key(w, "value");
+    json_deci(w, bucket->value_deci);
+    json_end_object(w);
+}
+
+/**
+ * @brief Đọc độ dài bucket: "90", "90s", "5m", "1h" => giây
+ * @return 0 nếu sai cú pháp hoặc dài hơn QUERY_MAX_BUCKET_S (kiểm tra trước khi nhân => không tràn)
+ */
+static uint32_t parse_bucket_s(const char *str) {
+    char *end;
+    unsigned long value = strtoul(str, &end, 10);
+    unsigned long unit_s;
+    
+    if (end == str || *str == '-') {
+        return 0;
+    }
+    if (strcmp(end, "m") == 0) {
+        unit_s = 60;
+    } else if (strcmp(end, "h") == 0) {
+        unit_s = 3600;
+    } else if (*end == '\0' || strcmp(end, "s") == 0) {
+        unit_s = 1;
+    } else {
+        return 0;
+    }
+    if (value > QUERY_MAX_BUCKET_S / unit_s) {
+        return 0;
+    }
+    return (uint32_t)(value * unit_s);
+}
+
+/**
+ * @brief Giải nén mẫu thô vào chunk cột rồi rút gọn cột của metric
+ */
+static void query_reduce_raw(query_ctx_t *q, history_metric_t metric, history_span_t span) {
+    history_columns_t *cols = &q->cols;
+    history_iter_t it;
+    history_sample_t s;
+    
+    cols->count = 0;
+    history_iter_begin(&it, span);
+    while (q->json->err == ESP_OK && history_iter_next_sample(&it, &s)) {
+        if (!s.is_valid) {
+            continue;
+        }
+        cols->ts_ms[cols->count] = s.timestamp_ms;
+        cols->value[HISTORY_METRIC_TEMPERATURE][cols->count] = s.temp_deci;
+        cols->value[HISTORY_METRIC_HUMIDITY][cols->count] = (int16_t)s.hum_deci;
+        if (++cols->count == HISTORY_QUERY_CHUNK) {
+            history_reducer_add_column(&q->reducer, cols->ts_ms, cols->value[metric], cols->count);
+            cols->count = 0;
+        }
+    }
+    history_reducer_add_column(&q->reducer, cols->ts_ms, cols->value[metric], cols->count);
+}
+
+/**
+ * @brief Cộng các bucket 1m/1h (mỗi bucket nằm trọn trong 1 bucket kết quả)
+ */
+static void query_reduce_tier(query_ctx_t *q, history_metric_t metric, history_tier_t tier,
+                              int64_t from_us, int64_t to_us) {
+    history_span_t span = history_tier_range(tier, from_us, to_us);
+    
+    for (uint32_t pos = span.begin; pos < span.end && q->json->err == ESP_OK; pos++) {
+        history_bucket_t b;
+        if (!history_read_bucket(tier, pos, &b) || b.count == 0) {
+            continue;
+        }
+        bool temp = (metric == HISTORY_METRIC_TEMPERATURE);
+        int16_t mean = (int16_t)lroundf((temp ? b.temp_mean : b.hum_mean) * 10.0f);
+        int16_t min = (int16_t)lroundf((temp ? b.temp_min : b.hum_min) * 10.0f);
+        int16_t max = (int16_t)lroundf((temp ? b.temp_max : b.hum_max) * 10.0f);
+        history_reducer_add_summary(&q->reducer, b.start_us / 1000, b.count,
+                                    (int64_t)mean * b.count, min, max);
+    }
+}
+
+/**
+ * @brief Bucket đã đóng của tầng tới history_tier_end_us(), phần mới hơn (bucket đang mở) từ mẫu thô
+ */
+static void query_reduce_stitched(query_ctx_t *q, history_metric_t metric, history_tier_t tier,
+                                  int64_t from_us, int64_t to_us) {
+    // Đọc mốc trước: bucket đóng sau thời điểm này vẫn còn nguyên trong ring thô
+    int64_t tier_end_us = history_tier_end_us(tier);
+    
+    if (tier_end_us > from_us) {
+        query_reduce_tier(q, metric, tier, from_us, (tier_end_us - 1 < to_us) ? tier_end_us - 1 : to_us);
+    }
+    int64_t raw_from_us = (tier_end_us > from_us) ? tier_end_us : from_us;
+    if (raw_from_us <= to_us && q->json->err == ESP_OK) {
+        query_reduce_raw(q, metric, history_range(raw_from_us, to_us));
+    }
+}
+
+/**
+ * @brief GET /api/query - Tổng hợp theo bucket thời gian, tính trên thiết bị
+ * 
+ * ?metric=temperature|humidity, ?agg=avg|min|max|p95, ?bucket=60s|5m|1h (<= 7 ngày),
+ * ?from=&to= (us) hoặc ?last=S. Khoảng cũ hơn tầng thô => cộng dồn bucket 1m/1h (bucket làm tròn
+ * lên bội của tầng) rồi nối mẫu thô từ sau bucket đã đóng mới nhất; riêng p95 luôn tính trên
+ * mẫu thô. Chỉ trả bucket có mẫu hợp lệ.
+ */
+static esp_err_t query_handler(httpd_req_t *req) {
+    ESP_LOGI(TAG, "GET /api/query");
+    
+    char query[160];
+    char value[16];
+    history_metric_t metric = HISTORY_METRIC_TEMPERATURE;
+    history_agg_t agg = HISTORY_AGG_AVG;
+    uint32_t bucket_s = 60;
+    uint32_t last_s = 0;
+    int64_t from_us = INT64_MIN;
+    int64_t to_us = INT64_MAX;
+    
+    esp_err_t qret = httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (qret == ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return query_too_long(req);
+    }
+    if (qret == ESP_OK) {
+        if (httpd_query_key_value(query, "metric", value, sizeof(value)) == ESP_OK &&
+            !history_metric_parse(value, &metric)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "metric: temperature|humidity");
+        }
+        if (httpd_query_key_value(query, "agg", value, sizeof(value)) == ESP_OK &&
+            !history_agg_parse(value, &agg)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "agg: avg|min|max|p95");
+        }
+        if (httpd_query_key_value(query, "bucket", value, sizeof(value)) == ESP_OK) {
+            bucket_s = parse_bucket_s(value);
+            if (bucket_s == 0) {
+                return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bucket: N, Ns, Nm, Nh (1s .. 7 days)");
+            }
+        }
+        query_get_i64(query, "from", &from_us);
+        query_get_i64(query, "to", &to_us);
+        if (query_get_u32(query, "last", &last_s)) {
+            from_us = esp_timer_get_time() - (int64_t)last_s * 1000000;
+        }
+    }
+    
+    history_tier_t tier = HISTORY_TIER_RAW;
+    if (agg != HISTORY_AGG_P95 && from_us != INT64_MIN) {
+        tier = history_pick_tier(from_us);
+    }
+    if (tier != HISTORY_TIER_RAW) {
+        uint32_t period_s = history_tier_period_s(tier);
+        bucket_s = (bucket_s + period_s - 1) / period_s * period_s;
+    }
+    
+    query_ctx_t *q = malloc(sizeof(query_ctx_t));
+    if (q == NULL) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    }
+    
+    json_writer_t json;
+    q->json = &json;
+    history_reducer_init(&q->reducer, agg, (int64_t)bucket_s * 1000, query_emit, q);
+    
+    json_response_begin(&json, req);
+    json_begin_object(&json);
+    json_field_string(&json, "metric", history_metric_name(metric));
+    json_field_string(&json, "agg", history_agg_name(agg));
+    json_field_string(&json, "tier", history_tier_name(tier));
+    json_field_uint(&json, "bucket_s", bucket_s);
+    json_key(&json, "buckets");
+    json_begin_array(&json);
+    
+    if (tier == HISTORY_TIER_RAW) {
+        query_reduce_raw(q, metric, history_range(from_us, to_us));
+    } else {
+        query_reduce_stitched(q, metric, tier, from_us, to_us);
+    }
+    history_reducer_finish(&q->reducer);
+    free(q);
+    
+    json_end_array(&json);
+    json_end_object(&json);
+    return json_response_end(&json, req);
+}
+
+// ==================== HTTP METRICS ====================
+
+/**
+ * @brief Bộ đếm cho 1 route (handler thật được gọi qua instrumented_handler)
+ */
+typedef struct {
+    const char *uri;
+    const char *method;
+    esp_err_t (*handler)(httpd_req_t *req);
+    atomic_uint requests;
+    atomic_uint errors;
+    latency_hist_t latency;
+} http_route_t;
+
+static esp_err_t metrics_handler(httpd_req_t *req);
+
+static http_route_t route_root        = { .uri = "/",             .method = "GET",  .handler = asset_handler };
+static http_route_t route_style       = { .uri = "/style.css",    .method = "GET",  .handler = asset_handler };
+static http_route_t route_app         = { .uri = "/app.js",       .method = "GET",  .handler = asset_handler };
+static http_route_t route_sensor      = { .uri = "/api/sensor",   .method = "GET",  .handler = sensor_handler };
+static http_route_t route_status      = { .uri = "/api/status",   .method = "GET",  .handler = status_handler };
+static http_route_t route_buzzer      = { .uri = "/api/buzzer",   .method = "GET",  .handler = buzzer_handler };
+static http_route_t route_config_get  = { .uri = "/api/config",   .method = "GET",  .handler = config_get_handler };
+static http_route_t route_config_post = { .uri = "/api/config",   .method = "POST", .handler = config_post_handler };
+static http_route_t route_history     = { .uri = "/api/history",  .method = "GET",  .handler = history_handler };
+static http_route_t route_history_bin = { .uri = "/api/history.bin", .method = "GET", .handler = history_bin_handler };
+static http_route_t route_history_csv = { .uri = "/api/history.csv", .method = "GET", .handler = history_csv_handler };
+static http_route_t route_query       = { .uri = "/api/query",    .method = "GET",  .handler = query_handler };
+static http_route_t route_latency     = { .uri = "/api/latency",  .method = "GET",  .handler = latency_handler };
+static http_route_t route_metrics     = { .uri = "/metrics",      .method = "GET",  .handler = metrics_handler };
+static http_route_t route_ws          = { .uri = LIVE_STREAM_URI, .method = "GET",  .handler = live_stream_handler };
+
+static http_route_t *const all_routes[] = {
+    &route_root, &route_style, &route_app, &route_sensor, &route_status, &route_buzzer, &route_config_get,
+    &route_config_post, &route_history, &route_history_bin, &route_history_csv, &route_query, &route_latency,
+    &route_metrics, &route_ws,
+};
+
+/**
+ * @brief Gọi handler thật và cập nhật bộ đếm (không định dạng chuỗi trên đường nóng)
+ */
+static esp_err_t instrumented_handler(httpd_req_t *req) {
+    http_route_t *route = (http_route_t *)req->user_ctx;
+    int64_t start_us = esp_timer_get_time();
+    
+    esp_err_t ret = route->handler(req);
+    
+    atomic_fetch_add_explicit(&route->requests, 1, memory_order_relaxed);
+    if (ret != ESP_OK) {
+        atomic_fetch_add_explicit(&route->errors, 1, memory_order_relaxed);
+    }
+    latency_hist_record(&route->latency, (uint32_t)(esp_timer_get_time() - start_us));
+    return ret;
+}
+
+/**
+ * @brief Bộ đệm ghi /metrics: gom dòng rồi gửi theo chunk ~1KB
+ */
+typedef struct {
+    httpd_req_t *req;
+    size_t len;
+    esp_err_t err;
+    char buf[1024];
+} metrics_writer_t;
+
+static void metrics_flush(metrics_writer_t *w) {
+    if (w->err == ESP_OK && w->len > 0) {
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+static void metrics_printf(metrics_writer_t *w, const char *fmt, ...) {
+    char line[160];
+    va_list args;
+    
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n < 0) {
+        return;
+    }
+    if (n >= (int)sizeof(line)) {
+        n = sizeof(line) - 1;
+    }
+    
+    if (w->len + n > sizeof(w->buf)) {
+        metrics_flush(w);
+    }
+    memcpy(w->buf + w->len, line, n);
+    w->len += n;
+}
+
+/**
+ * @brief In 1 histogram dạng Prometheus summary (quantile 0.5/0.99 + _sum/_count/_max)
+ */
+static void metrics_summary(metrics_writer_t *w, const char *name, const char *labels,
+                            const latency_hist_t *hist) {
+    latency_summary_t s;
+    latency_hist_summarize(hist, &s);
+    
+    metrics_printf(w, "%s{%s,quantile=\"0.5\"} %" PRIu32 "\n", name, labels, s.p50_us);
+    metrics_printf(w, "%s{%s,quantile=\"0.99\"} %" PRIu32 "\n", name, labels, s.p99_us);
+    metrics_printf(w, "%s_sum{%s} %" PRIu64 "\n", name, labels, s.sum_us);
+    metrics_printf(w, "%s_count{%s} %" PRIu32 "\n", name, labels, s.count);
+    metrics_printf(w, "%s_max{%s} %" PRIu32 "\n", name, labels, s.max_us);
+}
+
+/**
+ * @brief Thời gian chạy của các task ở lần scrape trước (để tính CPU% theo khoảng)
+ */
+#define METRICS_MAX_TASKS   24
+
+static struct {
+    TaskHandle_t handle;
+    uint32_t runtime;
+} prev_task_runtime[METRICS_MAX_TASKS];
+static uint32_t prev_total_runtime = 0;
+
+static void metrics_tasks(metrics_writer_t *w) {
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 2;
+    if (capacity > METRICS_MAX_TASKS) {
+        capacity = METRICS_MAX_TASKS;
+    }
+    
+    TaskStatus_t *tasks = malloc(capacity * sizeof(TaskStatus_t));
+    if (tasks == NULL) {
+        return;
+    }
+    
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks, capacity, &total);
+    
+    // Phép trừ không dấu => vẫn đúng khi bộ đếm 32-bit quay vòng
+    uint32_t total_delta = (uint32_t)total - prev_total_runtime;
+    
+    metrics_printf(w, "# HELP freertos_task_cpu_percent CPU usage since the previous scrape\n"
+                      "# TYPE freertos_task_cpu_percent gauge\n");
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint32_t prev = 0;
+        for (int j = 0; j < METRICS_MAX_TASKS; j++) {
+            if (prev_task_runtime[j].handle == tasks[i].xHandle) {
+                prev = prev_task_runtime[j].runtime;
+                break;
+            }
+        }
+        uint32_t delta = (uint32_t)tasks[i].ulRunTimeCounter - prev;
+        float pct = total_delta ? (100.0f * delta / total_delta) : 0.0f;
+        metrics_printf(w, "freertos_task_cpu_percent{task=\"%s\"} %.2f\n", tasks[i].pcTaskName, pct);
+    }
+    
+    metrics_printf(w, "# HELP freertos_task_runtime_us_total Task run time (32-bit, wraps)\n"
+                      "# TYPE freertos_task_runtime_us_total counter\n");
+    for (UBaseType_t i = 0; i < count; i++) {
+        metrics_printf(w, "freertos_task_runtime_us_total{task=\"%s\"} %" PRIu32 "\n",
+                       tasks[i].pcTaskName, (uint32_t)tasks[i].ulRunTimeCounter);
+    }
+    
+    metrics_printf(w, "# HELP freertos_task_stack_high_water_bytes Minimum free stack ever observed\n"
+                      "# TYPE freertos_task_stack_high_water_bytes gauge\n");
+    for (UBaseType_t i = 0; i < count; i++) {
+        metrics_printf(w, "freertos_task_stack_high_water_bytes{task=\"%s\"} %" PRIu32 "\n",
+                       tasks[i].pcTaskName, (uint32_t)tasks[i].usStackHighWaterMark);
+    }
+    
+    // Lưu lại cho lần scrape sau (chỉ httpd task truy cập)
+    memset(prev_task_runtime, 0, sizeof(prev_task_runtime));
+    for (UBaseType_t i = 0; i < count; i++) {
+        prev_task_runtime[i].handle = tasks[i].xHandle;
+        prev_task_runtime[i].runtime = (uint32_t)tasks[i].ulRunTimeCounter;
+    }
+    prev_total_runtime = (uint32_t)total;
+    
+    free(tasks);
+}
+
+/**
+ * @brief GET /metrics - Prometheus text format
+ */
+static esp_err_t metrics_handler(httpd_req_t *req) {
+    static metrics_writer_t w;     // httpd chỉ có 1 task => dùng chung an toàn
+    char labels[96];
+    
+    w.req = req;
+    w.len = 0;
+    w.err = ESP_OK;
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    
+    // Heap và uptime
+    metrics_printf(&w, "# TYPE uptime_seconds gauge\nuptime_seconds %" PRId64 "\n",
+                   esp_timer_get_time() / 1000000);
+    metrics_printf(&w, "# TYPE heap_free_bytes gauge\nheap_free_bytes %" PRIu32 "\n",
+                   esp_get_free_heap_size());
+    metrics_printf(&w, "# TYPE heap_min_free_bytes gauge\nheap_min_free_bytes %" PRIu32 "\n",
+                   esp_get_minimum_free_heap_size());
+    
+    // Task: CPU, stack
+    metrics_tasks(&w);
+    
+    // Sample bus: độ sâu hàng đợi và overflow từng subscriber
+    metrics_printf(&w, "# TYPE sample_bus_depth gauge\n# TYPE sample_bus_max_depth gauge\n"
+                       "# TYPE sample_bus_delivered_total counter\n# TYPE sample_bus_dropped_total counter\n");
+    for (int i = 0; i < sample_bus_get_subscriber_count(); i++) {
+        sample_bus_sub_stats_t bs;
+        if (sample_bus_get_stats(i, &bs) != ESP_OK) {
+            continue;
+        }
+        metrics_printf(&w, "sample_bus_depth{subscriber=\"%s\"} %" PRIu32 "\n", bs.name, bs.depth);
+        metrics_printf(&w, "sample_bus_max_depth{subscriber=\"%s\"} %" PRIu32 "\n", bs.name, bs.max_depth);
+        metrics_printf(&w, "sample_bus_delivered_total{subscriber=\"%s\"} %" PRIu32 "\n", bs.name, bs.delivered);
+        metrics_printf(&w, "sample_bus_dropped_total{subscriber=\"%s\"} %" PRIu32 "\n", bs.name, bs.dropped);
+    }
+    metrics_printf(&w, "# TYPE sample_bus_publish_drops_total counter\nsample_bus_publish_drops_total %" PRIu32 "\n",
+                   sample_bus_get_publish_drops());
+    
+    // I2C bus manager
+    i2c_bus_stats_t is;
+    i2c_bus_get_stats(&is);
+    metrics_printf(&w, "# TYPE i2c_bus_transactions_total counter\n"
+                       "i2c_bus_transactions_total{result=\"ok\"} %" PRIu32 "\n"
+                       "i2c_bus_transactions_total{result=\"failed\"} %" PRIu32 "\n"
+                       "i2c_bus_transactions_total{result=\"rejected\"} %" PRIu32 "\n",
+                   is.completed, is.failed, is.rejected);
+    metrics_printf(&w, "# TYPE i2c_bus_bytes_total counter\ni2c_bus_bytes_total %" PRIu32 "\n", is.bytes);
+    metrics_printf(&w, "# TYPE i2c_bus_queue_high_watermark gauge\ni2c_bus_queue_high_watermark %" PRIu32 "\n",
+                   is.queue_high_watermark);
+    metrics_printf(&w, "# TYPE i2c_bus_queue_latency_us gauge\n"
+                       "i2c_bus_queue_latency_us{stat=\"avg\"} %" PRIu32 "\n"
+                       "i2c_bus_queue_latency_us{stat=\"max\"} %" PRIu32 "\n",
+                   is.latency_avg_us, is.latency_max_us);
+    
+    // DHT22
+    dht22_stats_t ds;
+    dht22_get_stats(&ds);
+    metrics_printf(&w, "# TYPE dht22_reads_total counter\n"
+                       "dht22_reads_total{result=\"ok\"} %" PRIu32 "\n"
+                       "dht22_reads_total{result=\"timeout\"} %" PRIu32 "\n"
+                       "dht22_reads_total{result=\"crc_error\"} %" PRIu32 "\n"
+                       "dht22_reads_total{result=\"invalid\"} %" PRIu32 "\n"
+                       "dht22_reads_total{result=\"other\"} %" PRIu32 "\n",
+                   ds.ok, ds.timeout, ds.crc_error, ds.invalid, ds.other);
+    
+    // HTTP: số request, lỗi và độ trễ từng URI
+    metrics_printf(&w, "# TYPE http_requests_total counter\n# TYPE http_request_errors_total counter\n");
+    for (size_t i = 0; i < sizeof(all_routes) / sizeof(all_routes[0]); i++) {
+        const http_route_t *r = all_routes[i];
+        metrics_printf(&w, "http_requests_total{uri=\"%s\",method=\"%s\"} %u\n", r->uri, r->method,
+                       atomic_load_explicit(&r->requests, memory_order_relaxed));
+        metrics_printf(&w, "http_request_errors_total{uri=\"%s\",method=\"%s\"} %u\n", r->uri, r->method,
+                       atomic_load_explicit(&r->errors, memory_order_relaxed));
+    }
+    metrics_printf(&w, "# TYPE http_request_duration_us summary\n");
+    for (size_t i = 0; i < sizeof(all_routes) / sizeof(all_routes[0]); i++) {
+        const http_route_t *r = all_routes[i];
+        snprintf(labels, sizeof(labels), "uri=\"%s\",method=\"%s\"", r->uri, r->method);
+        metrics_summary(&w, "http_request_duration_us", labels, &r->latency);
+    }
+    
+    // Live stream (WebSocket /ws)
+    live_stream_stats_t ls;
+    live_stream_get_stats(&ls);
+    metrics_printf(&w, "# TYPE live_stream_clients gauge\nlive_stream_clients %" PRIu32 "\n", ls.clients);
+    metrics_printf(&w, "# TYPE live_stream_messages_total counter\nlive_stream_messages_total %" PRIu32 "\n",
+                   ls.messages);
+    metrics_printf(&w, "# TYPE live_stream_frames_total counter\nlive_stream_frames_total %" PRIu32 "\n", ls.frames);
+    metrics_printf(&w, "# TYPE live_stream_coalesced_total counter\nlive_stream_coalesced_total %" PRIu32 "\n",
+                   ls.coalesced);
+    metrics_printf(&w, "# TYPE live_stream_errors_total counter\n"
+                       "live_stream_errors_total{reason=\"send\"} %" PRIu32 "\n"
+                       "live_stream_errors_total{reason=\"rejected\"} %" PRIu32 "\n",
+                   ls.send_errors, ls.rejected);
+    
+    // Lịch sử nén
+    history_stats_t hs;
+    history_get_stats(&hs);
+    metrics_printf(&w, "# TYPE history_samples gauge\nhistory_samples %" PRIu32 "\n", hs.samples);
+    metrics_printf(&w, "# TYPE history_bytes gauge\n"
+                       "history_bytes{kind=\"used\"} %" PRIu32 "\n"
+                       "history_bytes{kind=\"capacity\"} %" PRIu32 "\n",
+                   hs.used_bytes, hs.capacity_bytes);
+    
+    // Nhật ký flash
+    sample_log_stats_t sl;
+    sample_log_get_stats(&sl);
+    metrics_printf(&w, "# TYPE sample_log_records gauge\nsample_log_records %" PRIu32 "\n", sl.records);
+    metrics_printf(&w, "# TYPE sample_log_boot gauge\nsample_log_boot %" PRIu32 "\n", sl.boot);
+    metrics_printf(&w, "# TYPE sample_log_pages_written_total counter\nsample_log_pages_written_total %" PRIu32 "\n",
+                   sl.pages_written);
+    metrics_printf(&w, "# TYPE sample_log_erases_total counter\nsample_log_erases_total %" PRIu32 "\n", sl.erases);
+    metrics_printf(&w, "# TYPE sample_log_errors_total counter\n"
+                       "sample_log_errors_total{reason=\"torn\"} %" PRIu32 "\n"
+                       "sample_log_errors_total{reason=\"write\"} %" PRIu32 "\n",
+                   sl.torn, sl.write_errors);
+    
+    // Độ trễ pipeline cảm biến
+    metrics_printf(&w, "# TYPE sensor_pipeline_latency_us summary\n");
+    for (int i = 0; i < LATENCY_STAGE_MAX; i++) {
+        latency_summary_t s;
+        latency_get_summary((latency_stage_t)i, &s);
+        const char *stage = latency_stage_name((latency_stage_t)i);
+        metrics_printf(&w, "sensor_pipeline_latency_us{stage=\"%s\",quantile=\"0.5\"} %" PRIu32 "\n", stage, s.p50_us);
+        metrics_printf(&w, "sensor_pipeline_latency_us{stage=\"%s\",quantile=\"0.99\"} %" PRIu32 "\n", stage, s.p99_us);
+        metrics_printf(&w, "sensor_pipeline_latency_us_sum{stage=\"%s\"} %" PRIu64 "\n", stage, s.sum_us);
+        metrics_printf(&w, "sensor_pipeline_latency_us_count{stage=\"%s\"} %" PRIu32 "\n", stage, s.count);
+        metrics_printf(&w, "sensor_pipeline_latency_us_max{stage=\"%s\"} %" PRIu32 "\n", stage, s.max_us);
+    }
+    
+    metrics_flush(&w);
+    if (w.err != ESP_OK) {
+        return w.err;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
 // ==================== URL ROUTING ====================
 
 static const httpd_uri_t uri_get_root = {
     .uri = "/",
     .method = HTTP_GET,
-    .handler = root_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_root
+};
+
+static const httpd_uri_t uri_get_style = {
+    .uri = "/style.css",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_style
+};
+
+static const httpd_uri_t uri_get_app = {
+    .uri = "/app.js",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_app
 };
 
 static const httpd_uri_t uri_get_sensor = {
     .uri = "/api/sensor",
     .method = HTTP_GET,
-    .handler = sensor_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_sensor
 };
 
 static const httpd_uri_t uri_get_status = {
     .uri = "/api/status",
     .method = HTTP_GET,
-    .handler = status_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_status
 };
 
 static const httpd_uri_t uri_get_buzzer = {
     .uri = "/api/buzzer",
     .method = HTTP_GET,
-    .handler = buzzer_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_buzzer
 };
 
 static const httpd_uri_t uri_get_config = {
     .uri = "/api/config",
     .method = HTTP_GET,
-    .handler = config_get_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_config_get
 };
 
 static const httpd_uri_t uri_post_config = {
     .uri = "/api/config",
     .method = HTTP_POST,
-    .handler = config_post_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_config_post
 };
 
 static const httpd_uri_t uri_get_history = {
     .uri = "/api/history",
     .method = HTTP_GET,
-    .handler = history_handler,
-    .user_ctx = NULL
+    .handler = instrumented_handler,
+    .user_ctx = &route_history
+};
+
+static const httpd_uri_t uri_get_history_bin = {
+    .uri = "/api/history.bin",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_history_bin
+};
+
+static const httpd_uri_t uri_get_history_csv = {
+    .uri = "/api/history.csv",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_history_csv
+};
+
+static const httpd_uri_t uri_get_query = {
+    .uri = "/api/query",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_query
+};
+
+static const httpd_uri_t uri_get_latency = {
+    .uri = "/api/latency",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_latency
+};
+
+static const httpd_uri_t uri_get_metrics = {
+    .uri = "/metrics",
+    .method = HTTP_GET,
+    .handler = instrumented_handler,
+    .user_ctx = &route_metrics
+};
+
+static const httpd_uri_t uri_ws = {
+    .uri       = LIVE_STREAM_URI,
+    .method    = HTTP_GET,
+    .handler   = instrumented_handler,
+    .user_ctx  = &route_ws,
+    .is_websocket = true
 };
 
 // ==================== PUBLIC API ====================
@@ -489,6 +1768,8 @@ esp_err_t webserver_init(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = HTTP_SERVER_PORT;
     config.max_open_sockets = 4;  // Reduced to fit within LWIP_MAX_SOCKETS (7)
+    config.max_uri_handlers = 16; // Mặc định 8 không đủ cho mọi route
+    config.stack_size = 6144;     // Handler giữ JSON writer + bản chép khối lịch sử trên stack
     
     ESP_LOGI(TAG, "Starting HTTP Server on port %d", config.server_port);
     
@@ -497,23 +1778,50 @@ esp_err_t webserver_init(void) {
         return ESP_FAIL;
     }
     
+    // Timer kiểm tra timeout long-poll (chỉ chạy khi có request đang chờ)
+    if (longpoll_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = longpoll_timer_callback,
+            .name = "longpoll"
+        };
+        esp_timer_create(&timer_args, &longpoll_timer);
+    }
+    
+    // Tính ETag cho dashboard đã nhúng
+    web_assets_init();
+    live_stream_init(server);
+    webserver_notify_buzzer(get_buzzer_status());  // Client /ws mới luôn nhận trạng thái buzzer
+    
     // Đăng ký các URI handler
     httpd_register_uri_handler(server, &uri_get_root);
+    httpd_register_uri_handler(server, &uri_get_style);
+    httpd_register_uri_handler(server, &uri_get_app);
     httpd_register_uri_handler(server, &uri_get_sensor);
     httpd_register_uri_handler(server, &uri_get_status);
     httpd_register_uri_handler(server, &uri_get_buzzer);
     httpd_register_uri_handler(server, &uri_get_config);
     httpd_register_uri_handler(server, &uri_post_config);
     httpd_register_uri_handler(server, &uri_get_history);
+    httpd_register_uri_handler(server, &uri_get_history_bin);
+    httpd_register_uri_handler(server, &uri_get_history_csv);
+    httpd_register_uri_handler(server, &uri_get_query);
+    httpd_register_uri_handler(server, &uri_get_latency);
+    httpd_register_uri_handler(server, &uri_get_metrics);
+    httpd_register_uri_handler(server, &uri_ws);
     
     ESP_LOGI(TAG, "✓ HTTP Server initialized");
-    ESP_LOGI(TAG, "  GET  / - HTML Dashboard");
-    ESP_LOGI(TAG, "  GET  /api/sensor - Get sensor data");
+    ESP_LOGI(TAG, "  GET  / - HTML Dashboard (+ /style.css, /app.js)");
+    ESP_LOGI(TAG, "  GET  /api/sensor - Get sensor data (?since=N long-poll)");
     ESP_LOGI(TAG, "  GET  /api/status - Get status (short)");
     ESP_LOGI(TAG, "  GET  /api/buzzer - Get buzzer status");
     ESP_LOGI(TAG, "  GET  /api/config - Get configuration");
     ESP_LOGI(TAG, "  POST /api/config - Update configuration");
-    ESP_LOGI(TAG, "  GET  /api/history - Get history");
+    ESP_LOGI(TAG, "  GET  /api/history - Get history (?from=&to=, ?last=s, ?since=N, ?source=flash)");
+    ESP_LOGI(TAG, "  GET  /api/history.bin, /api/history.csv - Bulk history export");
+    ESP_LOGI(TAG, "  GET  /api/query?metric=&agg=&bucket= - Bucketed aggregation");
+    ESP_LOGI(TAG, "  GET  /api/latency - Pipeline latency histograms");
+    ESP_LOGI(TAG, "  GET  /metrics - Prometheus metrics");
+    ESP_LOGI(TAG, "  WS   %s - Live samples (push)", LIVE_STREAM_URI);
     
     return ESP_OK;
 }
@@ -527,21 +1835,48 @@ esp_err_t webserver_stop(void) {
     return ESP_OK;
 }
 
-void webserver_update_sensor_data(const sensor_data_t *data, system_state_t state) {
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        current_sensor_data = *data;
-        current_system_state = state;
-        
-        // Thêm vào lịch sử
-        add_to_history(data, state);
-        
-        xSemaphoreGive(webserver_data_mutex);
+void webserver_update_sensor_data(const sample_t *sample) {
+    // Không khóa: 1 writer duy nhất (web_task), reader dùng snapshot/generation
+    sample_snapshot_publish(sample);
+    history_append(sample);
+    
+    // Trả lời các request ?since= đang chờ (trong task httpd)
+    if (server != NULL && atomic_load_explicit(&longpoll_count, memory_order_relaxed) > 0) {
+        httpd_queue_work(server, longpoll_work, NULL);
     }
+    
+    // Định dạng 1 lần, live stream gửi cùng 1 buffer cho mọi client
+    json_writer_t json;
+    json_writer_init(&json, NULL, NULL);
+    web_json_sensor(&json, "sample", sample->seq, &sample->data, sample->state);
+    if (json.err == ESP_OK) {
+        live_stream_post(LIVE_STREAM_SAMPLE, json.buf, json.len, sample->stamps.fire_us);
+    }
+}
+
+/**
+ * @brief Định dạng tin buzzer cho live stream (chạy trong task httpd, stack đủ cho JSON writer)
+ */
+static size_t format_buzzer_message(uint32_t on, char *out, size_t size) {
+    json_writer_t json;
+    json_writer_init(&json, NULL, NULL);
+    web_json_buzzer(&json, on != 0, true);
+    if (json.err != ESP_OK || json.len > size) {
+        return 0;
+    }
+    memcpy(out, json.buf, json.len);
+    return json.len;
+}
+
+void webserver_notify_buzzer(bool on) {
+    // Gọi từ timer daemon và alert_task (stack 2048): chỉ lưu giá trị, không giữ JSON writer trên stack
+    live_stream_post_value(LIVE_STREAM_BUZZER, format_buzzer_message, on);
 }
 
 void webserver_update_config(const system_config_t *config) {
     if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         current_config = *config;
+        apply_config_to_sampler(&current_config);
         xSemaphoreGive(webserver_data_mutex);
     }
 }
@@ -556,20 +1891,16 @@ system_config_t webserver_get_config(void) {
 }
 
 uint32_t webserver_get_history_count(void) {
-    uint32_t count = 0;
-    if (xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        count = history_count;
-        xSemaphoreGive(webserver_data_mutex);
-    }
-    return count;
+    history_span_t span = history_get_span();
+    return span.end - span.begin;
 }
 
 history_record_t webserver_get_history(uint32_t index) {
     history_record_t record = {0};
-    if (index < MAX_HISTORY_RECORDS && 
-        xSemaphoreTake(webserver_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        record = history[index];
-        xSemaphoreGive(webserver_data_mutex);
+    history_span_t span = history_get_span();
+    
+    if (index < span.end - span.begin && !history_read(span.begin + index, &record)) {
+        memset(&record, 0, sizeof(record));  // Đã bị ghi đè trong lúc đọc
     }
     return record;
 }
@@ -1,7 +1,7 @@
 /**
  * @file webserver.h
  * @brief HTTP Webserver Module - REST API for Temperature Monitoring System
- * @features GET /api/sensor, POST /api/config, GET /api/history, GET /web
+ * @features GET /api/sensor, POST /api/config, GET /api/history (+ .bin/.csv), GET /api/query, GET /web, WebSocket /ws
  */
 
 #ifndef WEBSERVER_H
@@ -9,12 +9,32 @@
 
 #include "esp_http_server.h"
 #include "config.h"
+#include "sample_bus.h"
+#include "history.h"
 
 // ==================== WEBSERVER CONFIGURATION ====================
 
 #define SERVER_PORT             80
 #define MAX_HTTP_REQ_HDR_LEN    512
-#define MAX_HISTORY_RECORDS     100
+
+// Long-poll: GET /api/sensor?since=N giữ request (async) tới khi có mẫu seq > N
+#define LONGPOLL_MAX_WAITERS            2       // Mỗi waiter giữ 1 socket (max_open_sockets = 4)
+#define LONGPOLL_DEFAULT_TIMEOUT_MS     20000
+#define LONGPOLL_MAX_TIMEOUT_MS         30000
+#define LONGPOLL_CHECK_PERIOD_MS        250     // Độ phân giải timeout
+
+// Xuất lịch sử hàng loạt: GET /api/history.bin, /api/history.csv
+#define HISTORY_EXPORT_CHUNK            1024    // Kích thước chunk gửi ra socket
+#define HISTORY_EXPORT_RECORD_SIZE      24      // Byte/bản ghi của history.bin
+
+// Giảm mẫu cho biểu đồ: GET /api/history?points=N (LTTB)
+#define HISTORY_MAX_POINTS              1000
+
+// Bucket chưa đóng nối sau tầng MINUTE/HOUR (thường chỉ 1: bucket đang mở)
+#define HISTORY_TAIL_BUCKETS            4
+
+// Tổng hợp theo bucket: GET /api/query?bucket=... (giới hạn trước khi nhân đơn vị => không tràn uint32)
+#define QUERY_MAX_BUCKET_S              (7 * 24 * 3600)
 
 // ==================== DATA STRUCTURES ====================
 
@@ -25,17 +45,10 @@ typedef struct {
     float temp_warning;      // Ngưỡng cảnh báo
     float temp_overheat;     // Ngưỡng quá nhiệt
     uint32_t sensor_interval_ms;  // Khoảng thời gian đọc cảm biến
+    bool adaptive_sampling;  // Đọc nhanh gần ngưỡng, giãn chu kỳ khi ổn định
     bool buzzer_enabled;     // Bật/tắt buzzer
 } system_config_t;
 
-/**
- * @brief Lịch sử dữ liệu sensor
- */
-typedef struct {
-    sensor_data_t data;
-    system_state_t state;
-} history_record_t;
-
 // ==================== FUNCTION PROTOTYPES ====================
 
 /**
@@ -51,9 +64,16 @@ esp_err_t webserver_init(void);
 esp_err_t webserver_stop(void);
 
 /**
- * @brief Cập nhật dữ liệu sensor cho webserver (được gọi từ sensor_task)
+ * @brief Cập nhật dữ liệu sensor cho webserver và đẩy mẫu tới client /ws (được gọi từ web_task)
+ * 
+ * Không khóa: chỉ được gọi từ 1 task duy nhất (single writer).
+ */
+void webserver_update_sensor_data(const sample_t *sample);
+
+/**
+ * @brief Báo buzzer vừa bật/tắt cho client /ws (gọi được từ mọi task, kể cả timer callback)
  */
-void webserver_update_sensor_data(const sensor_data_t *data, system_state_t state);
+void webserver_notify_buzzer(bool on);
 
 /**
  * @brief Cập nhật cấu hình hệ thống
@@ -71,14 +91,14 @@ system_config_t webserver_get_config(void);
 uint32_t webserver_get_history_count(void);
 
 /**
- * @brief Lấy bản ghi lịch sử theo index
+ * @brief Lấy bản ghi lịch sử theo index (0 = bản ghi cũ nhất)
  */
 history_record_t webserver_get_history(uint32_t index);
 
 // ==================== WEBSERVER STATE MANAGEMENT ====================
 
 /**
- * @brief Khóa để bảo vệ dữ liệu webserver
+ * @brief Khóa bảo vệ cấu hình webserver (dữ liệu sensor/lịch sử không cần khóa)
  */
 extern SemaphoreHandle_t webserver_data_mutex;
 
@@ -6,8 +6,8 @@
 #ifndef WIFI_H
 #define WIFI_H
 
-#include "esp_wifi.h"
-#include "esp_event.h"
+#include <stdbool.h>
+#include "esp_err.h"
 
 // ==================== FUNCTION PROTOTYPES ====================
 
@@ -0,0 +1,90 @@
+function row(label, value, cls) {
+  return '<div class="data-row"><span class="label">' + label + '</span>' +
+         '<span class="value' + (cls ? ' ' + cls : '') + '">' + value + '</span></div>';
+}
+
+function showSensor(d) {
+  let h = row('Temperature:', d.temperature.toFixed(1) + '°C');
+  h += row('Humidity:', d.humidity.toFixed(1) + '%');
+  h += row('Status:', d.status, 'status ' + d.status);
+  document.getElementById('sensor-data').innerHTML = h;
+}
+
+function showBuzzer(d) {
+  let color = d.is_active ? '#ff3333' : '#00ff88';
+  document.getElementById('buzzer-data').innerHTML =
+    '<div class="data-row"><span class="label">Status:</span>' +
+    '<span class="value" style="color:' + color + '">' + d.buzzer_status + '</span></div>';
+}
+
+function fetchSensorData() {
+  fetch('/api/sensor').then(r => r.json()).then(showSensor)
+    .catch(e => console.error('Sensor error:', e));
+}
+
+function fetchBuzzerStatus() {
+  fetch('/api/buzzer').then(r => r.json()).then(showBuzzer)
+    .catch(e => console.error('Buzzer error:', e));
+}
+
+// Live stream: server đẩy mẫu mới qua /ws; mất kết nối => poll 2s và thử kết nối lại
+let pollTimer = null;
+let retryMs = 1000;
+
+function startPolling() {
+  if (pollTimer) return;
+  pollTimer = setInterval(function() { fetchSensorData(); fetchBuzzerStatus(); }, 2000);
+}
+
+function stopPolling() {
+  clearInterval(pollTimer);
+  pollTimer = null;
+}
+
+function connectLive() {
+  if (!('WebSocket' in window)) { startPolling(); return; }
+  let ws = new WebSocket((location.protocol === 'https:' ? 'wss://' : 'ws://') + location.host + '/ws');
+  ws.onopen = function() { stopPolling(); retryMs = 1000; };
+  ws.onmessage = function(ev) {
+    let d = JSON.parse(ev.data);
+    if (d.type === 'sample') showSensor(d);
+    else if (d.type === 'buzzer') showBuzzer(d);
+  };
+  ws.onclose = function() {
+    startPolling();
+    setTimeout(connectLive, retryMs);
+    retryMs = Math.min(retryMs * 2, 30000);
+  };
+}
+
+function fetchConfig() {
+  fetch('/api/config').then(r => r.json()).then(d => {
+    let h = row('Warning:', d.temp_warning.toFixed(1) + '°C');
+    h += row('Overheat:', d.temp_overheat.toFixed(1) + '°C');
+    h += row('Sampling:', d.sample_period_ms + ' ms' + (d.adaptive_sampling ? ' (adaptive)' : ''));
+    document.getElementById('config-data').innerHTML = h;
+    document.getElementById('temp-warning').value = d.temp_warning;
+    document.getElementById('temp-overheat').value = d.temp_overheat;
+    document.getElementById('sensor-interval').value = d.sensor_interval_ms;
+    document.getElementById('adaptive').checked = d.adaptive_sampling;
+  }).catch(e => console.error('Config error:', e));
+}
+
+function updateConfig() {
+  let w = parseFloat(document.getElementById('temp-warning').value);
+  let o = parseFloat(document.getElementById('temp-overheat').value);
+  let i = parseInt(document.getElementById('sensor-interval').value);
+  let a = document.getElementById('adaptive').checked;
+  fetch('/api/config', {
+    method: 'POST',
+    headers: {'Content-Type': 'application/json'},
+    body: JSON.stringify({temp_warning: w, temp_overheat: o, sensor_interval_ms: i, adaptive_sampling: a})
+  }).then(() => { alert('Updated!'); fetchConfig(); }).catch(e => alert('Error:' + e));
+}
+
+document.addEventListener('DOMContentLoaded', function() {
+  fetchSensorData();
+  fetchBuzzerStatus();
+  fetchConfig();
+  connectLive();
+});
@@ -0,0 +1,133 @@
+/**
+ * @file fake_i2c_master.c
+ * @brief Fake I2C Driver Implementation
+ */
+
+#include "fake_i2c_master.h"
+#include "i2c_bus.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+// ==================== GLOBAL STATE ====================
+
+#define FAKE_I2C_MAX_DEVICES    4
+
+struct sim_i2c_bus {
+    i2c_master_bus_config_t config;
+};
+
+struct sim_i2c_dev {
+    uint16_t addr;
+    i2c_master_callback_t on_trans_done;
+    void *user_data;
+};
+
+static struct sim_i2c_bus s_bus;
+static struct sim_i2c_dev s_devices[FAKE_I2C_MAX_DEVICES];
+static size_t s_num_devices = 0;
+
+static fake_i2c_xfer_t s_log[FAKE_I2C_LOG_LEN];
+static uint32_t s_count = 0;
+static portMUX_TYPE s_log_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Giữ bus: transaction kế tiếp báo s_held rồi chờ s_release
+static volatile bool s_hold = false;
+static SemaphoreHandle_t s_held = NULL;
+static SemaphoreHandle_t s_release = NULL;
+
+// ==================== DRIVER API (driver/i2c_master.h) ====================
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle) {
+    s_bus.config = *bus_config;
+    *ret_bus_handle = &s_bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle) {
+    if (s_num_devices >= FAKE_I2C_MAX_DEVICES) {
+        return ESP_ERR_NO_MEM;
+    }
+    struct sim_i2c_dev *dev = &s_devices[s_num_devices++];
+    dev->addr = dev_config->device_address;
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_register_event_callbacks(i2c_master_dev_handle_t i2c_dev,
+                                              const i2c_master_event_callbacks_t *cbs, void *user_data) {
+    i2c_dev->on_trans_done = cbs->on_trans_done;
+    i2c_dev->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms) {
+    int64_t start_us = esp_timer_get_time();
+
+    if (s_hold) {
+        s_hold = false;
+        xSemaphoreGive(s_held);
+        xSemaphoreTake(s_release, portMAX_DELAY);
+    }
+
+    taskENTER_CRITICAL(&s_log_lock);
+    if (s_count < FAKE_I2C_LOG_LEN) {
+        fake_i2c_xfer_t *x = &s_log[s_count];
+        x->addr = i2c_dev->addr;
+        x->len = write_size;
+        x->start_us = start_us;
+        memcpy(x->data, write_buffer, write_size < FAKE_I2C_MAX_TX ? write_size : FAKE_I2C_MAX_TX);
+    }
+    s_count++;
+    taskEXIT_CRITICAL(&s_log_lock);
+
+    if (i2c_dev->on_trans_done != NULL) {
+        const i2c_master_event_data_t evt = { .event = I2C_EVENT_DONE };
+        i2c_dev->on_trans_done(i2c_dev, &evt, i2c_dev->user_data);
+    }
+    return ESP_OK;
+}
+
+// ==================== PUBLIC API ====================
+
+void fake_i2c_start(void) {
+    static bool started = false;
+
+    if (!started) {
+        s_held = xSemaphoreCreateBinary();
+        s_release = xSemaphoreCreateBinary();
+        ESP_ERROR_CHECK(i2c_bus_init());
+        started = true;
+    }
+}
+
+void fake_i2c_reset(void) {
+    taskENTER_CRITICAL(&s_log_lock);
+    s_count = 0;
+    taskEXIT_CRITICAL(&s_log_lock);
+}
+
+uint32_t fake_i2c_count(void) {
+    taskENTER_CRITICAL(&s_log_lock);
+    uint32_t count = s_count;
+    taskEXIT_CRITICAL(&s_log_lock);
+    return count;
+}
+
+const fake_i2c_xfer_t *fake_i2c_get(uint32_t i) {
+    return (i < FAKE_I2C_LOG_LEN && i < fake_i2c_count()) ? &s_log[i] : NULL;
+}
+
+void fake_i2c_hold(void) {
+    s_hold = true;
+}
+
+bool fake_i2c_wait_held(TickType_t timeout) {
+    return xSemaphoreTake(s_held, timeout) == pdTRUE;
+}
+
+void fake_i2c_release(void) {
+    xSemaphoreGive(s_release);
+}
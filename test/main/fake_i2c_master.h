@@ -0,0 +1,71 @@
+/**
+ * @file fake_i2c_master.h
+ * @brief Fake I2C Driver - Thay driver/i2c_master.h trong test: ghi lại từng transaction
+ * @features Nội dung + thời điểm mỗi transaction, giữ bus (chặn trong transaction) để dồn hàng đợi
+ *
+ * i2c_bus.c và ssd1306.c chạy nguyên vẹn phía trên; on_trans_done được gọi ngay khi
+ * transaction kết thúc, giống ISR của driver thật ở chế độ async.
+ */
+
+#ifndef FAKE_I2C_MASTER_H
+#define FAKE_I2C_MASTER_H
+
+#include "freertos/FreeRTOS.h"
+#include "driver/i2c_master.h"
+
+// ==================== FAKE I2C CONFIGURATION ====================
+
+#define FAKE_I2C_LOG_LEN        48              // Số transaction giữ lại kể từ fake_i2c_reset()
+#define FAKE_I2C_MAX_TX         (1 + 1024)      // Control byte + toàn bộ framebuffer SSD1306
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief 1 transaction đã gửi (data bị cắt ở FAKE_I2C_MAX_TX byte)
+ */
+typedef struct {
+    uint16_t addr;
+    size_t len;
+    int64_t start_us;
+    uint8_t data[FAKE_I2C_MAX_TX];
+} fake_i2c_xfer_t;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+/**
+ * @brief Khởi tạo i2c_bus (1 lần cho cả app test)
+ */
+void fake_i2c_start(void);
+
+/**
+ * @brief Xóa nhật ký transaction
+ */
+void fake_i2c_reset(void);
+
+/**
+ * @brief Số transaction từ lần reset gần nhất (có thể lớn hơn FAKE_I2C_LOG_LEN)
+ */
+uint32_t fake_i2c_count(void);
+
+/**
+ * @brief Transaction thứ i (NULL nếu ngoài nhật ký)
+ */
+const fake_i2c_xfer_t *fake_i2c_get(uint32_t i);
+
+/**
+ * @brief Transaction kế tiếp sẽ chặn bus task cho tới fake_i2c_release()
+ */
+void fake_i2c_hold(void);
+
+/**
+ * @brief Chờ bus task vào transaction đang bị giữ
+ * @return true nếu bus đang bị giữ trước timeout
+ */
+bool fake_i2c_wait_held(TickType_t timeout);
+
+/**
+ * @brief Thả transaction đang bị giữ
+ */
+void fake_i2c_release(void);
+
+#endif // FAKE_I2C_MASTER_H
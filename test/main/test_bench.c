@@ -0,0 +1,68 @@
+/**
+ * @file test_bench.c
+ * @brief Benchmark Helper Implementation
+ *
+ * Target linux dùng glibc: định nghĩa lại malloc/calloc/realloc trong app test sẽ thay
+ * bản của libc (kể cả lời gọi từ FreeRTOS và heap_caps_*), nên mọi cấp phát đều được đếm
+ * trước khi chuyển cho __libc_*.
+ */
+
+#include "test_bench.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+volatile uint32_t test_bench_sink;
+
+static atomic_size_t s_alloc_bytes;
+static atomic_size_t s_alloc_calls;
+
+// ==================== ALLOCATION COUNTER ====================
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static void count_alloc(size_t size) {
+    atomic_fetch_add_explicit(&s_alloc_bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_alloc_calls, 1, memory_order_relaxed);
+}
+
+void *malloc(size_t size) {
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    count_alloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+// ==================== PUBLIC API ====================
+
+void test_bench_start(test_bench_t *b, const char *name) {
+    b->name = name;
+    b->alloc_bytes = atomic_load_explicit(&s_alloc_bytes, memory_order_relaxed);
+    b->alloc_calls = atomic_load_explicit(&s_alloc_calls, memory_order_relaxed);
+    b->start_us = esp_timer_get_time();
+}
+
+test_bench_result_t test_bench_end(test_bench_t *b, uint32_t ops) {
+    int64_t elapsed_us = esp_timer_get_time() - b->start_us;
+    test_bench_result_t r = {
+        .ops = ops,
+        .ns_per_op = (uint32_t)(elapsed_us * 1000 / (ops ? ops : 1)),
+        .alloc_bytes = atomic_load_explicit(&s_alloc_bytes, memory_order_relaxed) - b->alloc_bytes,
+        .alloc_calls = atomic_load_explicit(&s_alloc_calls, memory_order_relaxed) - b->alloc_calls,
+    };
+
+    printf("BENCH %-24s %9" PRIu32 " ops %9" PRIu32 " ns/op %8zu B alloc (%zu calls)\n",
+           b->name, r.ops, r.ns_per_op, r.alloc_bytes, r.alloc_calls);
+    return r;
+}
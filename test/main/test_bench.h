@@ -0,0 +1,55 @@
+/**
+ * @file test_bench.h
+ * @brief Benchmark Helper - Đo ns/op và số byte heap cấp phát của 1 vòng lặp
+ *
+ * Mỗi phép đo in đúng 1 dòng "BENCH ..." để so sánh giữa các lần chạy (grep BENCH).
+ */
+
+#ifndef TEST_BENCH_H
+#define TEST_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== BENCHMARK CONFIGURATION ====================
+
+#ifndef TEST_BENCH_ITERATIONS
+#define TEST_BENCH_ITERATIONS   100000  // Số thao tác mặc định mỗi phép đo
+#endif
+
+// ==================== DATA STRUCTURES ====================
+
+/**
+ * @brief 1 phép đo đang chạy
+ */
+typedef struct {
+    const char *name;
+    int64_t start_us;
+    size_t alloc_bytes;         // Bộ đếm cấp phát lúc bắt đầu
+    size_t alloc_calls;
+} test_bench_t;
+
+/**
+ * @brief Kết quả 1 phép đo
+ */
+typedef struct {
+    uint32_t ops;
+    uint32_t ns_per_op;
+    size_t alloc_bytes;         // Tổng byte malloc/calloc/realloc trong lúc đo
+    size_t alloc_calls;
+} test_bench_result_t;
+
+// Chống compiler bỏ vòng lặp vì kết quả không được dùng
+extern volatile uint32_t test_bench_sink;
+
+// ==================== FUNCTION PROTOTYPES ====================
+
+void test_bench_start(test_bench_t *b, const char *name);
+
+/**
+ * @brief Kết thúc phép đo và in "BENCH <name> <ops> ops <ns>/op <bytes> B alloc"
+ * @param ops Số thao tác đã làm (1 op = đơn vị của ns/op)
+ */
+test_bench_result_t test_bench_end(test_bench_t *b, uint32_t ops);
+
+#endif // TEST_BENCH_H
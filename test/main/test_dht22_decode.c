@@ -0,0 +1,231 @@
+/**
+ * @file test_dht22_decode.c
+ * @brief Test bộ giải mã khung DHT22 (chuỗi xung như RMT đo được)
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "dht22_decode.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+// Phản hồi 80/80 µs + 40 bit (LOW 50 + HIGH 26/70 µs) + symbol kết thúc
+#define FRAME_MAX_PULSES    (4 + DHT22_DATA_BYTES * 8 * 2 + 1)
+
+// H=65.0%, T=25.3°C, checksum = 0x02 + 0x8A + 0x00 + 0xFD
+static const uint8_t s_frame_bytes[DHT22_DATA_BYTES] = { 0x02, 0x8A, 0x00, 0xFD, 0x89 };
+
+// Biên độ lệch thời gian của RMT + cảm biến (± µs) mà bộ giải mã phải chịu được
+#define JITTER_US           15
+
+static uint32_t s_lcg = 1;
+
+/**
+ * @brief Lệch ngẫu nhiên trong [-jitter_us, +jitter_us] (LCG cố định seed => lặp lại được)
+ */
+static int jitter(int jitter_us) {
+    if (jitter_us == 0) {
+        return 0;
+    }
+    s_lcg = s_lcg * 1664525u + 1013904223u;
+    return (int)((s_lcg >> 16) % (uint32_t)(2 * jitter_us + 1)) - jitter_us;
+}
+
+static dht22_pulse_t pulse(int duration_us, int jitter_us, uint8_t level) {
+    return (dht22_pulse_t){ .duration_us = (uint16_t)(duration_us + jitter(jitter_us)), .level = level };
+}
+
+/**
+ * @brief Dựng khung xung cho 5 byte (không sửa checksum), mỗi xung lệch tối đa ±jitter_us
+ * @return Số xung
+ */
+static size_t build_frame_jitter(const uint8_t bytes[DHT22_DATA_BYTES], int jitter_us, dht22_pulse_t *out) {
+    size_t n = 0;
+
+    out[n++] = pulse(20, 0, 1);
+    out[n++] = pulse(80, jitter_us, 0);
+    out[n++] = pulse(80, jitter_us, 1);
+    out[n++] = pulse(50, jitter_us, 0);
+    for (int bit = 0; bit < DHT22_DATA_BYTES * 8; bit++) {
+        bool one = bytes[bit / 8] & (0x80 >> (bit % 8));
+        out[n++] = pulse(one ? 70 : 26, jitter_us, 1);
+        out[n++] = pulse(50, jitter_us, 0);
+    }
+    out[n++] = (dht22_pulse_t){ .duration_us = 0, .level = 1 };
+    return n;
+}
+
+static size_t build_frame(const uint8_t bytes[DHT22_DATA_BYTES], dht22_pulse_t *out) {
+    return build_frame_jitter(bytes, 0, out);
+}
+
+TEST_CASE("clean frame decodes to bytes and units", "[dht22]")
+{
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+    float t, h;
+    size_t n = build_frame(s_frame_bytes, pulses);
+
+    TEST_ASSERT_EQUAL(ESP_OK, dht22_decode_pulses(pulses, n, data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(s_frame_bytes, data, DHT22_DATA_BYTES);
+
+    dht22_decode_values(data, &t, &h);
+    TEST_ASSERT_EQUAL_FLOAT(25.3f, t);
+    TEST_ASSERT_EQUAL_FLOAT(65.0f, h);
+}
+
+TEST_CASE("negative temperature uses the sign bit", "[dht22]")
+{
+    // T = -10.1°C: 0x8065, H = 0.0%
+    const uint8_t bytes[DHT22_DATA_BYTES] = { 0x00, 0x00, 0x80, 0x65, 0xE5 };
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+    float t, h;
+
+    TEST_ASSERT_EQUAL(ESP_OK, dht22_decode_pulses(pulses, build_frame(bytes, pulses), data));
+    dht22_decode_values(data, &t, &h);
+    TEST_ASSERT_EQUAL_FLOAT(-10.1f, t);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, h);
+}
+
+TEST_CASE("checksum mismatch is rejected", "[dht22]")
+{
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t bytes[DHT22_DATA_BYTES];
+    uint8_t data[DHT22_DATA_BYTES];
+
+    // Lật lần lượt từng bit của checksum và của dữ liệu
+    for (int bit = 0; bit < DHT22_DATA_BYTES * 8; bit++) {
+        memcpy(bytes, s_frame_bytes, sizeof(bytes));
+        bytes[bit / 8] ^= (uint8_t)(0x80 >> (bit % 8));
+        size_t n = build_frame(bytes, pulses);
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, dht22_decode_pulses(pulses, n, data));
+    }
+}
+
+TEST_CASE("checksum is the low byte of the sum", "[dht22]")
+{
+    // 0xFF + 0xFF + 0x7F + 0xFF = 0x37C => checksum 0x7C
+    const uint8_t bytes[DHT22_DATA_BYTES] = { 0xFF, 0xFF, 0x7F, 0xFF, 0x7C };
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+
+    TEST_ASSERT_EQUAL(ESP_OK, dht22_decode_pulses(pulses, build_frame(bytes, pulses), data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, data, DHT22_DATA_BYTES);
+}
+
+TEST_CASE("frames with +-15 us jitter decode", "[dht22]")
+{
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t bytes[DHT22_DATA_BYTES];
+    uint8_t data[DHT22_DATA_BYTES];
+
+    s_lcg = 12345;
+    for (int frame = 0; frame < 1000; frame++) {
+        // Dữ liệu ngẫu nhiên với checksum đúng
+        bytes[4] = 0;
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = (uint8_t)(jitter(127) + 127);
+            bytes[4] += bytes[i];
+        }
+        size_t n = build_frame_jitter(bytes, JITTER_US, pulses);
+        TEST_ASSERT_EQUAL(ESP_OK, dht22_decode_pulses(pulses, n, data));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, data, DHT22_DATA_BYTES);
+    }
+}
+
+TEST_CASE("clipped preamble still decodes", "[dht22]")
+{
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+    size_t n = build_frame(s_frame_bytes, pulses);
+
+    // RMT bắt đầu đo trễ: mất 1, 2, 3 hoặc cả 4 xung phản hồi
+    for (size_t skip = 1; skip <= 4; skip++) {
+        TEST_ASSERT_EQUAL(ESP_OK, dht22_decode_pulses(pulses + skip, n - skip, data));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(s_frame_bytes, data, DHT22_DATA_BYTES);
+    }
+
+    // Xung HIGH phản hồi bị cắt ngắn (đo giữa chừng)
+    pulses[2].duration_us = 30;
+    TEST_ASSERT_EQUAL(ESP_OK, dht22_decode_pulses(pulses, n, data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(s_frame_bytes, data, DHT22_DATA_BYTES);
+}
+
+TEST_CASE("missing bit is not accepted", "[dht22]")
+{
+    dht22_pulse_t frame[FRAME_MAX_PULSES];
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+    size_t n = build_frame(s_frame_bytes, frame);
+
+    for (int bit = 0; bit < DHT22_DATA_BYTES * 8; bit++) {
+        // Bỏ cặp HIGH/LOW của bit này
+        size_t at = 4 + (size_t)bit * 2;
+        memcpy(pulses, frame, at * sizeof(dht22_pulse_t));
+        memcpy(pulses + at, frame + at + 2, (n - at - 2) * sizeof(dht22_pulse_t));
+
+        // Có phản hồi: xung HIGH 80 µs bị đọc thành bit đầu => dữ liệu lệch, sai checksum
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, dht22_decode_pulses(pulses, n - 2, data));
+        // Không có phản hồi: chỉ còn 39 xung HIGH
+        TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, dht22_decode_pulses(pulses + 4, n - 6, data));
+    }
+}
+
+TEST_CASE("overlong high pulse is an invalid response", "[dht22]")
+{
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+    size_t n = build_frame(s_frame_bytes, pulses);
+
+    pulses[4 + 10 * 2].duration_us = DHT22_BIT_HIGH_MAX_US + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, dht22_decode_pulses(pulses, n, data));
+}
+
+TEST_CASE("bench dht22_decode_pulses", "[dht22][bench]")
+{
+    dht22_pulse_t pulses[FRAME_MAX_PULSES];
+    uint8_t data[DHT22_DATA_BYTES];
+    float t, h;
+    size_t n = build_frame(s_frame_bytes, pulses);
+    test_bench_t b;
+
+    test_bench_start(&b, "dht22_decode");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        dht22_decode_pulses(pulses, n, data);
+        dht22_decode_values(data, &t, &h);
+        test_bench_sink += data[4];
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(s_frame_bytes, data, DHT22_DATA_BYTES);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+}
+
+TEST_CASE("bench dht22 decode throughput on jittered frames", "[dht22][bench]")
+{
+    enum { FRAMES = 64 };
+    static dht22_pulse_t pulses[FRAMES][FRAME_MAX_PULSES];
+    size_t counts[FRAMES];
+    uint8_t data[DHT22_DATA_BYTES];
+    uint32_t ok = 0;
+    test_bench_t b;
+
+    s_lcg = 777;
+    for (int f = 0; f < FRAMES; f++) {
+        counts[f] = build_frame_jitter(s_frame_bytes, JITTER_US, pulses[f]);
+    }
+
+    test_bench_start(&b, "dht22_decode_jitter");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        ok += dht22_decode_pulses(pulses[i % FRAMES], counts[i % FRAMES], data) == ESP_OK;
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    printf("BENCH %-24s %9" PRIu32 " frames/s\n", "dht22_decode_throughput",
+           r.ns_per_op ? 1000000000u / r.ns_per_op : 0);
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_BENCH_ITERATIONS, ok);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+}
@@ -0,0 +1,274 @@
+/**
+ * @file test_history.c
+ * @brief Test ring lịch sử: thứ tự cũ -> mới, ghi đè vòng theo khối, truy vấn khoảng, tầng 1 phút
+ *
+ * Ring là trạng thái toàn cục của history.c nên các test nối tiếp nhau: mọi mẫu
+ * đi qua append_at() với timestamp tăng dần và seq liên tục từ 1 (seq = vị trí + 1).
+ * Test app build với CONFIG_HISTORY_BLOCKS=4, CONFIG_HISTORY_MINUTE_BUCKETS=8.
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "history.h"
+
+static uint32_t s_seq = 0;          // Seq của mẫu cuối cùng đã ghi
+static int64_t s_now_ms = 1000;     // Timestamp của mẫu cuối cùng
+
+// Nhiệt độ (deci) suy ra từ seq để kiểm tra giá trị sau khi giải nén
+static int16_t temp_of(uint32_t seq) {
+    return (int16_t)(200 + (int32_t)(seq % 37) - 18);
+}
+
+static void append_at(int64_t ts_ms, int16_t temp_deci, bool valid, system_state_t state) {
+    sample_t s = {
+        .data = {
+            .temperature = temp_deci / 10.0f,
+            .humidity = 55.0f,
+            .timestamp = ts_ms * 1000,
+            .is_valid = valid,
+        },
+        .state = state,
+        .seq = ++s_seq,
+    };
+    history_append(&s);
+    s_now_ms = ts_ms;
+}
+
+/**
+ * @brief Ghi n mẫu hợp lệ cách nhau step_ms (giá trị theo temp_of)
+ */
+static void append_run(uint32_t n, int64_t step_ms) {
+    for (uint32_t i = 0; i < n; i++) {
+        append_at(s_now_ms + step_ms, temp_of(s_seq + 1), true, STATE_NORMAL);
+    }
+}
+
+static int16_t deci(float value) {
+    return (int16_t)(value * 10.0f + (value >= 0 ? 0.5f : -0.5f));
+}
+
+TEST_CASE("ring returns samples oldest to newest", "[history]")
+{
+    history_span_t before = history_get_span();
+    history_record_t r;
+
+    append_run(10, 2000);
+
+    history_span_t span = history_get_span();
+    TEST_ASSERT_EQUAL_UINT32(before.end + 10, span.end);
+    TEST_ASSERT_EQUAL_UINT32(s_seq, span.end);
+
+    for (uint32_t pos = span.end - 10; pos < span.end; pos++) {
+        TEST_ASSERT_TRUE(history_read(pos, &r));
+        TEST_ASSERT_EQUAL_UINT32(pos + 1, r.seq);
+        TEST_ASSERT_EQUAL_INT16(temp_of(r.seq), deci(r.data.temperature));
+        TEST_ASSERT_EQUAL_FLOAT(55.0f, r.data.humidity);
+        TEST_ASSERT_TRUE(r.data.is_valid);
+    }
+    TEST_ASSERT_FALSE(history_read(span.end, &r));
+}
+
+TEST_CASE("ring wraps by whole blocks and keeps order", "[history]")
+{
+    history_record_t r;
+    history_stats_t stats;
+    history_iter_t it;
+
+    // Đủ để ghi đè toàn bộ ring nhiều lần
+    append_run(3 * HISTORY_MAX_SAMPLES, 2000);
+
+    history_span_t span = history_get_span();
+    TEST_ASSERT_EQUAL_UINT32(s_seq, span.end);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, span.begin);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(HISTORY_MAX_SAMPLES, span.end - span.begin);
+
+    // Ring bỏ nguyên khối cũ nhất: khối đang mở + HISTORY_BLOCKS - 2 khối đầy còn lại
+    history_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_BLOCKS - 1, stats.blocks);
+    TEST_ASSERT_EQUAL_UINT32(span.end - span.begin, stats.samples);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(stats.capacity_bytes, stats.used_bytes);
+
+    TEST_ASSERT_FALSE(history_read(span.begin - 1, &r));
+    TEST_ASSERT_TRUE(history_read(span.begin, &r));
+    TEST_ASSERT_EQUAL_UINT32(span.begin + 1, r.seq);
+
+    uint32_t count = 0;
+    int64_t prev_ts = 0;
+    history_iter_begin(&it, span);
+    while (history_iter_next(&it, &r)) {
+        TEST_ASSERT_EQUAL_UINT32(span.begin + count + 1, r.seq);
+        TEST_ASSERT_EQUAL_INT16(temp_of(r.seq), deci(r.data.temperature));
+        if (count > 0) {
+            TEST_ASSERT_EQUAL_INT64(prev_ts + 2000 * 1000, r.data.timestamp);
+        }
+        prev_ts = r.data.timestamp;
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(span.end - span.begin, count);
+    TEST_ASSERT_EQUAL_INT64(s_now_ms * 1000, prev_ts);
+}
+
+TEST_CASE("range is inclusive on both ends", "[history]")
+{
+    history_record_t r;
+    int64_t t0 = s_now_ms + 1000;
+
+    append_run(10, 1000);   // t0, t0 + 1 s, ..., t0 + 9 s
+
+    history_span_t span = history_get_span();
+    history_span_t range = history_range((t0 + 2000) * 1000, (t0 + 5000) * 1000);
+    TEST_ASSERT_EQUAL_UINT32(4, range.end - range.begin);
+    TEST_ASSERT_TRUE(history_read(range.begin, &r));
+    TEST_ASSERT_EQUAL_INT64((t0 + 2000) * 1000, r.data.timestamp);
+    TEST_ASSERT_TRUE(history_read(range.end - 1, &r));
+    TEST_ASSERT_EQUAL_INT64((t0 + 5000) * 1000, r.data.timestamp);
+
+    // Giữa 2 mẫu => rỗng; sau mẫu mới nhất => rỗng tại span.end
+    range = history_range((t0 + 2500) * 1000, (t0 + 2900) * 1000);
+    TEST_ASSERT_EQUAL_UINT32(range.begin, range.end);
+    range = history_range((s_now_ms + 1) * 1000, INT64_MAX);
+    TEST_ASSERT_EQUAL_UINT32(span.end, range.begin);
+    TEST_ASSERT_EQUAL_UINT32(span.end, range.end);
+
+    // Trước mẫu cũ nhất => bắt đầu từ span.begin
+    range = history_range(0, (t0 + 9000) * 1000);
+    TEST_ASSERT_EQUAL_UINT32(span.begin, range.begin);
+    TEST_ASSERT_EQUAL_UINT32(span.end, range.end);
+
+    // from > to => rỗng
+    range = history_range((t0 + 5000) * 1000, (t0 + 2000) * 1000);
+    TEST_ASSERT_EQUAL_UINT32(range.begin, range.end);
+}
+
+TEST_CASE("find_after_seq returns the next position", "[history]")
+{
+    history_span_t span = history_get_span();
+    history_record_t r;
+
+    for (uint32_t seq = span.end - 20; seq < span.end; seq++) {
+        uint32_t pos = history_find_after_seq(span, seq);
+        TEST_ASSERT_TRUE(history_read(pos, &r));
+        TEST_ASSERT_EQUAL_UINT32(seq + 1, r.seq);
+    }
+    TEST_ASSERT_EQUAL_UINT32(span.end, history_find_after_seq(span, s_seq));
+    TEST_ASSERT_EQUAL_UINT32(span.begin, history_find_after_seq(span, 0));
+}
+
+TEST_CASE("minute buckets keep min/max, rounded mean and worst state", "[history]")
+{
+    history_bucket_t b;
+    int64_t m0 = (s_now_ms / 60000 + 1) * 60000;
+
+    // Phút m0: 25.0 + 25.1 => mean 25.05 làm tròn 25.1; mẫu lỗi chỉ góp trạng thái
+    append_at(m0 + 1000, 250, true, STATE_NORMAL);
+    append_at(m0 + 2000, 251, true, STATE_WARNING);
+    append_at(m0 + 3000, 0, false, STATE_ERROR);
+    // Phút m0 + 1: -0.1 + -0.2 => mean -0.15 làm tròn -0.2 (xa 0)
+    append_at(m0 + 61000, -1, true, STATE_NORMAL);
+    append_at(m0 + 62000, -2, true, STATE_NORMAL);
+    // Sang phút m0 + 2 => đóng bucket m0 + 1
+    append_at(m0 + 121000, 200, true, STATE_NORMAL);
+
+    history_span_t range = history_tier_range(HISTORY_TIER_MINUTE, m0 * 1000, (m0 + 61000) * 1000);
+    TEST_ASSERT_EQUAL_UINT32(2, range.end - range.begin);
+
+    TEST_ASSERT_TRUE(history_read_bucket(HISTORY_TIER_MINUTE, range.begin, &b));
+    TEST_ASSERT_EQUAL_INT64(m0 * 1000, b.start_us);
+    TEST_ASSERT_EQUAL_UINT32(2, b.count);
+    TEST_ASSERT_EQUAL_INT16(250, deci(b.temp_min));
+    TEST_ASSERT_EQUAL_INT16(251, deci(b.temp_max));
+    TEST_ASSERT_EQUAL_INT16(251, deci(b.temp_mean));
+    TEST_ASSERT_EQUAL(STATE_WARNING, b.worst_state);
+
+    TEST_ASSERT_TRUE(history_read_bucket(HISTORY_TIER_MINUTE, range.begin + 1, &b));
+    TEST_ASSERT_EQUAL_INT64((m0 + 60000) * 1000, b.start_us);
+    TEST_ASSERT_EQUAL_UINT32(2, b.count);
+    TEST_ASSERT_EQUAL_INT16(-2, deci(b.temp_min));
+    TEST_ASSERT_EQUAL_INT16(-1, deci(b.temp_max));
+    TEST_ASSERT_EQUAL_INT16(-2, deci(b.temp_mean));
+    TEST_ASSERT_EQUAL(STATE_NORMAL, b.worst_state);
+
+    // Bucket đóng mới nhất là m0 + 1 => phần raw nối tiếp bắt đầu từ m0 + 2 (bucket đang mở)
+    TEST_ASSERT_EQUAL_INT64((m0 + 120000) * 1000, history_tier_end_us(HISTORY_TIER_MINUTE));
+    TEST_ASSERT_EQUAL_INT64(INT64_MIN, history_tier_end_us(HISTORY_TIER_RAW));
+}
+
+TEST_CASE("tier tail rebuilds the open bucket from raw samples", "[history]")
+{
+    history_bucket_t tail[4];
+    int64_t m0 = (s_now_ms / 60000 + 1) * 60000;
+
+    append_at(m0 + 1000, 240, true, STATE_NORMAL);
+    // Bucket m0 + 1 đang mở: 2 mẫu hợp lệ + 1 mẫu lỗi
+    append_at(m0 + 61000, 300, true, STATE_NORMAL);
+    append_at(m0 + 62000, 0, false, STATE_ERROR);
+    append_at(m0 + 63000, 305, true, STATE_WARNING);
+
+    int64_t end_us = history_tier_end_us(HISTORY_TIER_MINUTE);
+    TEST_ASSERT_EQUAL_INT64((m0 + 60000) * 1000, end_us);
+
+    uint32_t n = history_tier_tail(HISTORY_TIER_MINUTE, end_us, INT64_MAX, tail, 4);
+    TEST_ASSERT_EQUAL_UINT32(1, n);
+    TEST_ASSERT_EQUAL_INT64(end_us, tail[0].start_us);
+    TEST_ASSERT_EQUAL_UINT32(2, tail[0].count);
+    TEST_ASSERT_EQUAL_INT16(300, deci(tail[0].temp_min));
+    TEST_ASSERT_EQUAL_INT16(305, deci(tail[0].temp_max));
+    TEST_ASSERT_EQUAL_INT16(303, deci(tail[0].temp_mean));
+    TEST_ASSERT_EQUAL(STATE_WARNING, tail[0].worst_state);     // Cùng thứ tự mức độ như bucket đã đóng
+
+    // Nhiều bucket chưa đóng (from trước mốc) bị cắt ở max, cũ -> mới
+    n = history_tier_tail(HISTORY_TIER_MINUTE, m0 * 1000, INT64_MAX, tail, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, n);
+    TEST_ASSERT_EQUAL_INT64(m0 * 1000, tail[0].start_us);
+    TEST_ASSERT_EQUAL_UINT32(0, history_tier_tail(HISTORY_TIER_RAW, end_us, INT64_MAX, tail, 4));
+}
+
+TEST_CASE("every bucket in a wrapped tier span is readable", "[history]")
+{
+    history_bucket_t b;
+
+    // 1 mẫu mỗi phút, vượt dung lượng tầng MINUTE vài lần
+    append_run(3 * HISTORY_MINUTE_BUCKETS, 60000);
+
+    history_span_t span = history_tier_range(HISTORY_TIER_MINUTE, 0, INT64_MAX);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_MINUTE_BUCKETS - 1, span.end - span.begin);
+
+    int64_t prev_us = 0;
+    for (uint32_t pos = span.begin; pos < span.end; pos++) {
+        TEST_ASSERT_TRUE_MESSAGE(history_read_bucket(HISTORY_TIER_MINUTE, pos, &b), "bucket in span not readable");
+        TEST_ASSERT_EQUAL_UINT32(1, b.count);
+        if (pos > span.begin) {
+            TEST_ASSERT_EQUAL_INT64(prev_us + 60 * 1000000LL, b.start_us);
+        }
+        prev_us = b.start_us;
+    }
+    TEST_ASSERT_FALSE(history_read_bucket(HISTORY_TIER_MINUTE, span.begin - 1, &b));
+    TEST_ASSERT_FALSE(history_read_bucket(HISTORY_TIER_MINUTE, span.end, &b));
+}
+
+TEST_CASE("bench history append and iterate", "[history][bench]")
+{
+    history_iter_t it;
+    history_sample_t s;
+    test_bench_t b;
+
+    test_bench_start(&b, "history_append");
+    append_run(TEST_BENCH_ITERATIONS, 2000);
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+
+    history_span_t span = history_get_span();
+    uint32_t ops = 0;
+    test_bench_start(&b, "history_iter_next_sample");
+    while (ops < TEST_BENCH_ITERATIONS) {
+        history_iter_begin(&it, span);
+        while (history_iter_next_sample(&it, &s)) {
+            test_bench_sink += (uint32_t)s.temp_deci;
+            ops++;
+        }
+    }
+    r = test_bench_end(&b, ops);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+    TEST_ASSERT_EQUAL_UINT32(s_seq, s.seq);
+}
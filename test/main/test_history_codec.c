@@ -0,0 +1,212 @@
+/**
+ * @file test_history_codec.c
+ * @brief Test nén/giải nén khối lịch sử: round-trip đầy khối, delta biên, giới hạn 359 mẫu
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "history_codec.h"
+#include "config.h"
+
+static history_block_t s_block;
+static history_codec_t s_enc;
+static history_sample_t s_in[HISTORY_BLOCK_MAX_SAMPLES + 1];
+static history_sample_t s_out[HISTORY_BLOCK_MAX_SAMPLES + 1];
+static uint32_t s_lcg = 1;
+
+static int rnd(int span) {
+    s_lcg = s_lcg * 1664525u + 1013904223u;
+    return (int)((s_lcg >> 16) % (uint32_t)(2 * span + 1)) - span;
+}
+
+/**
+ * @brief Nén s_in[0..n) vào s_block, trả về số mẫu nhận được (dừng ở lần append đầu tiên bị từ chối)
+ */
+static uint32_t encode(uint32_t n) {
+    history_block_init(&s_block, &s_enc, 1000, &s_in[0]);
+    uint32_t i = 1;
+    while (i < n && history_block_append(&s_block, &s_enc, &s_in[i])) {
+        i++;
+    }
+    TEST_ASSERT_EQUAL_UINT16(i, s_block.count);
+    return i;
+}
+
+/**
+ * @brief Giải nén toàn bộ khối và so từng trường với s_in
+ */
+static void assert_round_trip(uint32_t count) {
+    history_codec_t dec;
+
+    history_decoder_init(&dec, &s_block);
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(history_decoder_next(&dec, &s_block, &s_out[i]));
+        TEST_ASSERT_EQUAL_INT64(s_in[i].timestamp_ms, s_out[i].timestamp_ms);
+        TEST_ASSERT_EQUAL_UINT32(s_in[i].seq, s_out[i].seq);
+        TEST_ASSERT_EQUAL_INT16(s_in[i].temp_deci, s_out[i].temp_deci);
+        TEST_ASSERT_EQUAL_UINT16(s_in[i].hum_deci, s_out[i].hum_deci);
+        TEST_ASSERT_EQUAL_UINT8(s_in[i].state, s_out[i].state);
+        TEST_ASSERT_EQUAL(s_in[i].is_valid, s_out[i].is_valid);
+    }
+}
+
+/**
+ * @brief Chuỗi mẫu giống firmware: chu kỳ period_ms lệch ±jitter_ms, nhiệt độ/độ ẩm trôi chậm
+ */
+static void fill_trace(uint32_t n, int period_ms, int jitter_ms) {
+    history_sample_t s = {
+        .timestamp_ms = 1700000000000LL, .seq = 1, .temp_deci = 253, .hum_deci = 650,
+        .state = STATE_NORMAL, .is_valid = true,
+    };
+    for (uint32_t i = 0; i < n; i++) {
+        s_in[i] = s;
+        s.timestamp_ms += period_ms + rnd(jitter_ms);
+        s.seq++;
+        s.temp_deci = (int16_t)(s.temp_deci + rnd(1));
+        s.hum_deci = (uint16_t)(s.hum_deci + rnd(2));
+    }
+}
+
+TEST_CASE("constant samples fill exactly HISTORY_BLOCK_MAX_SAMPLES", "[history_codec]")
+{
+    TEST_ASSERT_EQUAL(359, HISTORY_BLOCK_MAX_SAMPLES);
+
+    // Cùng timestamp, giá trị không đổi, seq liên tục => 5 bit/mẫu, khối đầy đúng ở giới hạn
+    fill_trace(HISTORY_BLOCK_MAX_SAMPLES + 1, 0, 0);
+    for (uint32_t i = 1; i <= HISTORY_BLOCK_MAX_SAMPLES; i++) {
+        s_in[i].temp_deci = s_in[0].temp_deci;
+        s_in[i].hum_deci = s_in[0].hum_deci;
+    }
+
+    uint32_t count = encode(HISTORY_BLOCK_MAX_SAMPLES + 1);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_BLOCK_MAX_SAMPLES, count);
+    TEST_ASSERT_EQUAL_UINT16((HISTORY_BLOCK_MAX_SAMPLES - 1) * 5, s_block.bits);
+    assert_round_trip(count);
+
+    // Khối đầy: append bị từ chối và không làm đổi khối
+    uint16_t bits = s_block.bits;
+    TEST_ASSERT_FALSE(history_block_append(&s_block, &s_enc, &s_in[HISTORY_BLOCK_MAX_SAMPLES]));
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_BLOCK_MAX_SAMPLES, s_block.count);
+    TEST_ASSERT_EQUAL_UINT16(bits, s_block.bits);
+}
+
+TEST_CASE("realistic trace round-trips until the block is full", "[history_codec]")
+{
+    s_lcg = 42;
+    fill_trace(HISTORY_BLOCK_MAX_SAMPLES + 1, 2000, 3);
+
+    uint32_t count = encode(HISTORY_BLOCK_MAX_SAMPLES + 1);
+    TEST_ASSERT_GREATER_THAN_UINT32(100, count);
+    TEST_ASSERT_LESS_THAN_UINT32(HISTORY_BLOCK_MAX_SAMPLES, count);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(HISTORY_BLOCK_DATA_BYTES * 8, s_block.bits);
+    assert_round_trip(count);
+
+    // Lần append bị từ chối không được làm hỏng phần đã công bố
+    TEST_ASSERT_FALSE(history_block_append(&s_block, &s_enc, &s_in[count]));
+    assert_round_trip(count);
+}
+
+TEST_CASE("edge deltas round-trip", "[history_codec]")
+{
+    const history_sample_t base = {
+        .timestamp_ms = 1000, .seq = 10, .temp_deci = 0, .hum_deci = 500,
+        .state = STATE_NORMAL, .is_valid = true,
+    };
+    uint32_t n = 0;
+
+    s_in[n++] = base;
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms += 2000; s_in[n].seq++; n++;
+    // Khoảng trống: mất kết nối 3 giờ, seq nhảy (mẫu bị bỏ ở sample bus)
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms += 3 * 3600 * 1000LL; s_in[n].seq += 5400; n++;
+    // Đồng hồ lùi (timestamp giảm) và delta-of-delta 64 bit
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms -= 5000; s_in[n].seq++; n++;
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms = INT64_MAX / 2; s_in[n].seq++; n++;
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms = 0; s_in[n].seq++; n++;
+    // Mẫu lỗi: is_valid = false, trạng thái ERROR, giá trị 0
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms += 2000; s_in[n].seq++;
+    s_in[n].is_valid = false; s_in[n].state = STATE_ERROR; s_in[n].temp_deci = 0; s_in[n].hum_deci = 0; n++;
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms += 2000; s_in[n].seq++; n++;
+    // Phục hồi: hợp lệ lại, nhảy giá trị
+    s_in[n] = s_in[n - 1]; s_in[n].timestamp_ms += 2000; s_in[n].seq++;
+    s_in[n].is_valid = true; s_in[n].state = STATE_OVERHEAT; s_in[n].temp_deci = 800; s_in[n].hum_deci = 1000; n++;
+    // Chỉ đổi is_valid (state giữ nguyên)
+    s_in[n] = s_in[n - 1]; s_in[n].seq++; s_in[n].is_valid = false; n++;
+    // Delta cực đại của int16/uint16 (nhóm 17 bit)
+    s_in[n] = s_in[n - 1]; s_in[n].seq++; s_in[n].temp_deci = INT16_MIN; s_in[n].hum_deci = 0; n++;
+    s_in[n] = s_in[n - 1]; s_in[n].seq++; s_in[n].temp_deci = INT16_MAX; s_in[n].hum_deci = UINT16_MAX; n++;
+    // Biên nhóm 3/8 bit: delta ±4, ±5, ±128, ±129
+    static const int16_t steps[] = { 4, -4, 5, -5, 127, -128, 128, -129 };
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        s_in[n] = s_in[n - 1]; s_in[n].seq++; s_in[n].temp_deci = (int16_t)(100 + steps[i]);
+        s_in[n].hum_deci = (uint16_t)(500 + steps[i]); n++;
+        s_in[n] = s_in[n - 1]; s_in[n].seq++; s_in[n].temp_deci = 100; s_in[n].hum_deci = 500; n++;
+    }
+    // Seq quay vòng 32 bit
+    s_in[n] = s_in[n - 1]; s_in[n].seq = UINT32_MAX; n++;
+    s_in[n] = s_in[n - 1]; s_in[n].seq = 0; n++;
+
+    TEST_ASSERT_EQUAL_UINT32(n, encode(n));
+    assert_round_trip(n);
+}
+
+TEST_CASE("decoder stops at the end of the bit stream", "[history_codec]")
+{
+    history_codec_t dec;
+    history_sample_t out;
+
+    // Khối 1 mẫu, dữ liệu toàn bit 1 => prefix dài nhất lặp tới hết khối
+    history_block_init(&s_block, &s_enc, 0, &s_in[0]);
+    memset(s_block.data, 0xFF, sizeof(s_block.data));
+    history_decoder_init(&dec, &s_block);
+    TEST_ASSERT_TRUE(history_decoder_next(&dec, &s_block, &out));
+    uint32_t decoded = 0;
+    while (decoded < 1000 && history_decoder_next(&dec, &s_block, &out)) {
+        decoded++;
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(1000, decoded);
+}
+
+TEST_CASE("bench history codec density and speed", "[history_codec][bench]")
+{
+    history_codec_t dec;
+    history_sample_t out;
+    uint32_t samples = 0;
+    uint32_t blocks = 0;
+    test_bench_t b;
+
+    // Chu kỳ 2 s lệch ±3 ms, giá trị trôi chậm (giống DHT22 trong phòng)
+    s_lcg = 7;
+    fill_trace(HISTORY_BLOCK_MAX_SAMPLES + 1, SENSOR_READ_PERIOD_MS, 3);
+
+    test_bench_start(&b, "history_block_append");
+    while (samples < TEST_BENCH_ITERATIONS) {
+        samples += encode(HISTORY_BLOCK_MAX_SAMPLES + 1);
+        blocks++;
+    }
+    test_bench_result_t r = test_bench_end(&b, samples);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+
+    uint32_t per_block = s_block.count;
+    printf("BENCH %-24s %9" PRIu32 " samples/KB (%" PRIu32 " samples/block, %.1f bit/sample)\n",
+           "history_codec_density", per_block * 1024 / HISTORY_BLOCK_BYTES, per_block,
+           (double)s_block.bits / (per_block - 1));
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(100, per_block);
+
+    samples = 0;
+    test_bench_start(&b, "history_decoder_next");
+    while (samples < TEST_BENCH_ITERATIONS) {
+        history_decoder_init(&dec, &s_block);
+        for (uint32_t i = 0; i < per_block; i++) {
+            history_decoder_next(&dec, &s_block, &out);
+            test_bench_sink += (uint32_t)out.temp_deci;
+        }
+        samples += per_block;
+    }
+    r = test_bench_end(&b, samples);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+    TEST_ASSERT_EQUAL_UINT32(s_in[per_block - 1].seq, out.seq);
+}
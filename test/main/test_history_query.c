@@ -0,0 +1,429 @@
+/**
+ * @file test_history_query.c
+ * @brief Test bộ rút gọn /api/query so với cách tính thẳng (gom bucket, sắp xếp), LTTB của
+ *        /api/history?points=N, benchmark so với cách cũ: gửi mọi mẫu thô qua /api/history rồi
+ *        tổng hợp ở trình duyệt
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "history_query.h"
+#include "web_json.h"
+
+#define MAX_SAMPLES         6000
+#define MAX_BUCKETS         MAX_SAMPLES
+
+static int64_t s_ts[MAX_SAMPLES];
+static int16_t s_val[MAX_SAMPLES];
+static uint32_t s_count;
+static uint32_t s_lcg = 1;
+
+static history_query_bucket_t s_got[MAX_BUCKETS];
+static uint32_t s_got_count;
+static history_query_bucket_t s_ref[MAX_BUCKETS];
+static uint32_t s_ref_count;
+
+static history_reducer_t s_reducer;    // ~6 KB (histogram p95)
+
+static uint32_t rnd(uint32_t n) {
+    s_lcg = s_lcg * 1664525u + 1013904223u;
+    return (s_lcg >> 8) % n;
+}
+
+static void collect(void *ctx, const history_query_bucket_t *bucket) {
+    (void)ctx;
+    TEST_ASSERT_LESS_THAN_UINT32(MAX_BUCKETS, s_got_count);
+    s_got[s_got_count++] = *bucket;
+}
+
+/**
+ * @brief Dữ liệu ngẫu nhiên: khoảng cách mẫu 1..3000 ms, thỉnh thoảng mất kết nối vài phút;
+ *        giá trị đi ngẫu nhiên, thỉnh thoảng nhảy tới biên dải đo
+ */
+static void make_samples(uint32_t n, int64_t start_ms) {
+    int64_t ts = start_ms;
+    int32_t v = 250;
+
+    for (uint32_t i = 0; i < n; i++) {
+        ts += (rnd(50) == 0) ? 60000 + rnd(600000) : 1 + rnd(3000);
+        v += (int32_t)rnd(21) - 10;
+        if (rnd(200) == 0) {
+            v = rnd(2) ? HISTORY_QUERY_DECI_MIN : HISTORY_QUERY_DECI_MAX;
+        }
+        v = v < HISTORY_QUERY_DECI_MIN ? HISTORY_QUERY_DECI_MIN : v;
+        v = v > HISTORY_QUERY_DECI_MAX ? HISTORY_QUERY_DECI_MAX : v;
+        s_ts[i] = ts;
+        s_val[i] = (int16_t)v;
+    }
+    s_count = n;
+}
+
+static int cmp_i16(const void *a, const void *b) {
+    return *(const int16_t *)a - *(const int16_t *)b;
+}
+
+static int64_t floor_to(int64_t ts, int64_t period) {
+    int64_t q = ts / period;
+    if (ts % period != 0 && ts < 0) {
+        q--;
+    }
+    return q * period;
+}
+
+/**
+ * @brief Cách tính thẳng: gom mẫu của từng bucket, sắp xếp, lấy avg/min/max/p95 nearest-rank
+ */
+static void reference(history_agg_t agg, int64_t period_ms) {
+    static int16_t vals[MAX_SAMPLES];
+    uint32_t i = 0;
+
+    s_ref_count = 0;
+    while (i < s_count) {
+        int64_t start = floor_to(s_ts[i], period_ms);
+        uint32_t n = 0;
+        int64_t sum = 0;
+        while (i < s_count && floor_to(s_ts[i], period_ms) == start) {
+            vals[n++] = s_val[i];
+            sum += s_val[i];
+            i++;
+        }
+        qsort(vals, n, sizeof(vals[0]), cmp_i16);
+
+        history_query_bucket_t *b = &s_ref[s_ref_count++];
+        b->start_ms = start;
+        b->count = n;
+        switch (agg) {
+            case HISTORY_AGG_AVG: {
+                // Làm tròn nửa ra xa 0
+                int64_t twice = 2 * sum;
+                b->value_deci = (int32_t)((twice >= 0 ? twice + n : twice - (int64_t)n) / (2 * (int64_t)n));
+                break;
+            }
+            case HISTORY_AGG_MIN: b->value_deci = vals[0]; break;
+            case HISTORY_AGG_MAX: b->value_deci = vals[n - 1]; break;
+            default: {
+                uint32_t rank = (n * 95 + 99) / 100;   // ceil(0.95 n)
+                b->value_deci = vals[rank - 1];
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Đưa dữ liệu vào reducer theo từng cột có độ dài ngẫu nhiên 1..HISTORY_QUERY_CHUNK
+ */
+static void reduce(history_agg_t agg, int64_t period_ms) {
+    s_got_count = 0;
+    history_reducer_init(&s_reducer, agg, period_ms, collect, NULL);
+    for (uint32_t i = 0; i < s_count;) {
+        uint32_t n = 1 + rnd(HISTORY_QUERY_CHUNK);
+        if (n > s_count - i) {
+            n = s_count - i;
+        }
+        history_reducer_add_column(&s_reducer, &s_ts[i], &s_val[i], n);
+        i += n;
+    }
+    history_reducer_finish(&s_reducer);
+}
+
+static void assert_same_buckets(void) {
+    TEST_ASSERT_EQUAL_UINT32(s_ref_count, s_got_count);
+    for (uint32_t i = 0; i < s_ref_count; i++) {
+        TEST_ASSERT_EQUAL_INT64(s_ref[i].start_ms, s_got[i].start_ms);
+        TEST_ASSERT_EQUAL_UINT32(s_ref[i].count, s_got[i].count);
+        TEST_ASSERT_EQUAL_INT32(s_ref[i].value_deci, s_got[i].value_deci);
+    }
+}
+
+TEST_CASE("reducer matches brute-force sort for every agg and period", "[history_query]")
+{
+    static const int64_t periods[] = { 1, 7, 1000, 60000, 300000, 3600000 };
+
+    s_lcg = 2024;
+    for (int start = 0; start < 2; start++) {
+        // Cả timestamp âm (floor_div) lẫn dương
+        make_samples(MAX_SAMPLES, start == 0 ? -5000000 : 1700000000000LL);
+        for (int agg = 0; agg < HISTORY_AGG_COUNT; agg++) {
+            for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+                reference((history_agg_t)agg, periods[p]);
+                reduce((history_agg_t)agg, periods[p]);
+                assert_same_buckets();
+            }
+        }
+    }
+}
+
+TEST_CASE("p95 uses nearest rank on small buckets", "[history_query]")
+{
+    // 1 .. 20 mẫu trong cùng 1 bucket, giá trị giảm dần để histogram không trùng thứ tự nhập
+    for (uint32_t n = 1; n <= 20; n++) {
+        for (uint32_t i = 0; i < n; i++) {
+            s_ts[i] = i;
+            s_val[i] = (int16_t)(100 - 10 * (int32_t)i);
+        }
+        s_count = n;
+        reference(HISTORY_AGG_P95, 1000);
+        reduce(HISTORY_AGG_P95, 1000);
+        assert_same_buckets();
+    }
+    // n = 20 => rank 19 => giá trị lớn thứ 2
+    TEST_ASSERT_EQUAL_INT32(90, s_got[0].value_deci);
+}
+
+TEST_CASE("summaries combine to the same avg/min/max as raw samples", "[history_query]")
+{
+    static history_query_bucket_t minute[3][MAX_BUCKETS];
+    static int64_t minute_sum[MAX_BUCKETS];
+    uint32_t minutes = 0;
+
+    s_lcg = 99;
+    make_samples(MAX_SAMPLES, 1700000000000LL);
+
+    // Tầng 1 phút: count, tổng, min, max của từng phút (như history.c giữ sẵn)
+    for (int agg = HISTORY_AGG_AVG; agg <= HISTORY_AGG_MAX; agg++) {
+        reference((history_agg_t)agg, 60000);
+        memcpy(minute[agg], s_ref, s_ref_count * sizeof(s_ref[0]));
+        minutes = s_ref_count;
+    }
+    for (uint32_t m = 0, i = 0; m < minutes; m++) {
+        minute_sum[m] = 0;
+        for (uint32_t k = 0; k < minute[0][m].count; k++, i++) {
+            minute_sum[m] += s_val[i];
+        }
+    }
+
+    for (int agg = HISTORY_AGG_AVG; agg <= HISTORY_AGG_MAX; agg++) {
+        reference((history_agg_t)agg, 300000);
+
+        s_got_count = 0;
+        history_reducer_init(&s_reducer, (history_agg_t)agg, 300000, collect, NULL);
+        for (uint32_t m = 0; m < minutes; m++) {
+            history_reducer_add_summary(&s_reducer, minute[0][m].start_ms, minute[0][m].count, minute_sum[m],
+                                        (int16_t)minute[HISTORY_AGG_MIN][m].value_deci,
+                                        (int16_t)minute[HISTORY_AGG_MAX][m].value_deci);
+        }
+        history_reducer_finish(&s_reducer);
+        assert_same_buckets();
+    }
+
+    // p95 không cộng dồn được => bỏ qua summary
+    s_got_count = 0;
+    history_reducer_init(&s_reducer, HISTORY_AGG_P95, 300000, collect, NULL);
+    history_reducer_add_summary(&s_reducer, 0, 10, 100, 1, 20);
+    history_reducer_finish(&s_reducer);
+    TEST_ASSERT_EQUAL_UINT32(0, s_got_count);
+}
+
+// ==================== LTTB ====================
+
+#define LTTB_SERIES         3000
+#define LTTB_POINTS         50
+
+static history_sample_t s_series[LTTB_SERIES];
+static history_sample_t s_picked[LTTB_POINTS];
+
+/**
+ * @brief Giống history_lttb_response() của /api/history?points=N trên mảng mẫu thay vì ring
+ * @return Số điểm được chọn (mẫu đầu, 1 điểm mỗi bucket, mẫu cuối)
+ */
+static uint32_t lttb_downsample(const history_sample_t *in, uint32_t total, uint32_t points, history_sample_t *out) {
+    uint32_t buckets = points - 2;
+    uint32_t count = 0;
+    history_sample_t a = in[0];
+
+    out[count++] = a;
+    for (uint32_t i = 0; i < buckets; i++) {
+        uint32_t begin = 1 + (uint32_t)((uint64_t)i * (total - 2) / buckets);
+        uint32_t next_begin = 1 + (uint32_t)((uint64_t)(i + 1) * (total - 2) / buckets);
+        uint32_t next_end = (i + 1 < buckets) ? 1 + (uint32_t)((uint64_t)(i + 2) * (total - 2) / buckets) : total;
+        int64_t cx_ms = 0;
+        int64_t cy = 0;
+        uint32_t n = 0;
+        history_lttb_t lttb;
+
+        for (uint32_t k = next_begin; k < next_end; k++) {
+            cx_ms += in[k].timestamp_ms;
+            cy += in[k].temp_deci;
+            n++;
+        }
+        cx_ms = n ? cx_ms / n : a.timestamp_ms;
+        cy = n ? cy * HISTORY_LTTB_Y_SCALE / n : (int64_t)a.temp_deci * HISTORY_LTTB_Y_SCALE;
+
+        history_lttb_begin(&lttb, &a, cx_ms, cy, STATE_OVERHEAT);
+        for (uint32_t k = begin; k < next_begin; k++) {
+            history_lttb_offer(&lttb, &in[k]);
+        }
+        if (history_lttb_end(&lttb, &a)) {
+            out[count++] = a;
+        }
+    }
+    out[count++] = in[total - 1];
+    return count;
+}
+
+TEST_CASE("lttb keeps a one-sample overheat spike in a long flat series", "[history_query]")
+{
+    const uint32_t spike = 1234;
+
+    // 25.0 °C phẳng mỗi 2 s; 1 mẫu OVERHEAT 41.0 °C, cùng bucket có 1 mẫu tụt 5.0 °C
+    // (diện tích tam giác lớn hơn đỉnh => chỉ quy tắc OVERHEAT mới giữ được đỉnh)
+    for (uint32_t i = 0; i < LTTB_SERIES; i++) {
+        s_series[i] = (history_sample_t){
+            .timestamp_ms = 1700000000000LL + (int64_t)i * 2000,
+            .seq = i + 1,
+            .temp_deci = 250,
+            .hum_deci = 550,
+            .state = STATE_NORMAL,
+            .is_valid = true,
+        };
+    }
+    s_series[spike].temp_deci = 410;
+    s_series[spike].state = STATE_OVERHEAT;
+    s_series[spike + 3].temp_deci = 50;
+
+    uint32_t n = lttb_downsample(s_series, LTTB_SERIES, LTTB_POINTS, s_picked);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(LTTB_POINTS, n);
+    TEST_ASSERT_EQUAL_UINT32(s_series[0].seq, s_picked[0].seq);
+    TEST_ASSERT_EQUAL_UINT32(s_series[LTTB_SERIES - 1].seq, s_picked[n - 1].seq);
+
+    uint32_t spikes = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (i > 0) {
+            TEST_ASSERT_GREATER_THAN_INT64(s_picked[i - 1].timestamp_ms, s_picked[i].timestamp_ms);
+        }
+        if (s_picked[i].seq == s_series[spike].seq) {
+            TEST_ASSERT_EQUAL_INT16(410, s_picked[i].temp_deci);
+            TEST_ASSERT_EQUAL(STATE_OVERHEAT, s_picked[i].state);
+            spikes++;
+        }
+        TEST_ASSERT_TRUE_MESSAGE(s_picked[i].seq != s_series[spike + 3].seq, "dip picked instead of the overheat spike");
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, spikes);
+}
+
+// ==================== BENCHMARK ====================
+
+static esp_err_t count_sink(void *ctx, const char *data, size_t len) {
+    (void)data;
+    *(size_t *)ctx += len;
+    return ESP_OK;
+}
+
+static history_sample_t s_samples[MAX_SAMPLES];
+static history_columns_t s_cols;
+static json_writer_t s_json;
+
+static void emit_json(void *ctx, const history_query_bucket_t *bucket) {
+    json_writer_t *w = ctx;
+    json_begin_object(w);
+    json_field_int(w, "timestamp", bucket->start_ms * 1000);
+    json_field_uint(w, "count", bucket->count);
+    json_key(w, "value");
+    json_deci(w, bucket->value_deci);
+    json_end_object(w);
+}
+
+/**
+ * @brief Giống query_reduce_raw() của /api/query: mẫu -> chunk cột -> reducer -> JSON bucket
+ */
+static size_t serve_query(history_agg_t agg, int64_t period_ms) {
+    size_t sent = 0;
+
+    json_writer_init(&s_json, count_sink, &sent);
+    history_reducer_init(&s_reducer, agg, period_ms, emit_json, &s_json);
+    json_begin_array(&s_json);
+    s_cols.count = 0;
+    for (uint32_t i = 0; i < s_count; i++) {
+        const history_sample_t *s = &s_samples[i];
+        s_cols.ts_ms[s_cols.count] = s->timestamp_ms;
+        s_cols.value[HISTORY_METRIC_TEMPERATURE][s_cols.count] = s->temp_deci;
+        s_cols.value[HISTORY_METRIC_HUMIDITY][s_cols.count] = (int16_t)s->hum_deci;
+        if (++s_cols.count == HISTORY_QUERY_CHUNK) {
+            history_reducer_add_column(&s_reducer, s_cols.ts_ms, s_cols.value[HISTORY_METRIC_TEMPERATURE],
+                                       s_cols.count);
+            s_cols.count = 0;
+        }
+    }
+    history_reducer_add_column(&s_reducer, s_cols.ts_ms, s_cols.value[HISTORY_METRIC_TEMPERATURE], s_cols.count);
+    history_reducer_finish(&s_reducer);
+    json_end_array(&s_json);
+    json_writer_flush(&s_json);
+    return sent;
+}
+
+/**
+ * @brief Cách cũ: thiết bị gửi mọi mẫu thô (/api/history), trình duyệt tự tổng hợp
+ */
+static size_t serve_raw(void) {
+    size_t sent = 0;
+
+    json_writer_init(&s_json, count_sink, &sent);
+    json_begin_array(&s_json);
+    for (uint32_t i = 0; i < s_count; i++) {
+        web_json_history_sample(&s_json, &s_samples[i]);
+    }
+    json_end_array(&s_json);
+    json_writer_flush(&s_json);
+    return sent;
+}
+
+TEST_CASE("bench history_query vs raw samples aggregated client-side", "[history_query][bench]")
+{
+    test_bench_t b;
+
+    // Chu kỳ 2 s như firmware, bucket 1 phút
+    s_lcg = 5;
+    make_samples(MAX_SAMPLES, 1700000000000LL);
+    for (uint32_t i = 0; i < s_count; i++) {
+        s_ts[i] = 1700000000000LL + (int64_t)i * 2000;
+        s_samples[i] = (history_sample_t){
+            .timestamp_ms = s_ts[i], .seq = i + 1, .temp_deci = s_val[i], .hum_deci = 550,
+            .state = 0, .is_valid = true,
+        };
+    }
+
+    // Kết quả trên thiết bị giống hệt cách tính thẳng (phía client)
+    reference(HISTORY_AGG_AVG, 60000);
+    reduce(HISTORY_AGG_AVG, 60000);
+    assert_same_buckets();
+
+    uint32_t reps = TEST_BENCH_ITERATIONS / 1000 + 1;
+    size_t query_bytes = 0;
+    size_t raw_bytes = 0;
+
+    test_bench_start(&b, "history_query_avg_60s");
+    for (uint32_t r = 0; r < reps; r++) {
+        query_bytes = serve_query(HISTORY_AGG_AVG, 60000);
+    }
+    test_bench_result_t rq = test_bench_end(&b, reps * s_count);
+    TEST_ASSERT_EQUAL(0, rq.alloc_bytes);
+
+    test_bench_start(&b, "history_query_p95_60s");
+    for (uint32_t r = 0; r < reps; r++) {
+        serve_query(HISTORY_AGG_P95, 60000);
+    }
+    test_bench_end(&b, reps * s_count);
+
+    test_bench_start(&b, "history_raw_json");
+    for (uint32_t r = 0; r < reps; r++) {
+        raw_bytes = serve_raw();
+    }
+    test_bench_result_t rr = test_bench_end(&b, reps * s_count);
+
+    // Phần việc của trình duyệt: gom bucket rồi sắp xếp (như reference)
+    test_bench_start(&b, "client_side_aggregate");
+    for (uint32_t r = 0; r < reps; r++) {
+        reference(HISTORY_AGG_P95, 60000);
+    }
+    test_bench_end(&b, reps * s_count);
+
+    printf("BENCH %-24s query %zu B (%" PRIu32 " ns/sample), raw %zu B (%" PRIu32 " ns/sample) for %" PRIu32
+           " samples\n", "history_query_vs_raw", query_bytes, rq.ns_per_op, raw_bytes, rr.ns_per_op, s_count);
+    TEST_ASSERT_LESS_THAN_UINT32(raw_bytes / 10, query_bytes);
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_i2c_bus.c
+ * @brief Test I2C Bus Manager trên backend giả: thứ tự HIGH trước NORMAL, hàng đợi đầy, độ trễ xếp hàng
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "fake_i2c_master.h"
+#include "i2c_bus.h"
+#include "esp_timer.h"
+
+#define TEST_DEV_ADDR       0x50
+#define HOLD_MS             20
+#define DONE_TIMEOUT        pdMS_TO_TICKS(1000)
+
+static i2c_master_dev_handle_t s_dev;
+static SemaphoreHandle_t s_done;
+static esp_err_t s_results[2 * I2C_BUS_QUEUE_LEN + 2];
+
+static void done_cb(esp_err_t result, void *arg) {
+    s_results[(uintptr_t)arg] = result;
+    xSemaphoreGive(s_done);
+}
+
+static void setup(void) {
+    fake_i2c_start();
+    if (s_dev == NULL) {
+        TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_add_device(TEST_DEV_ADDR, 400000, &s_dev));
+        s_done = xSemaphoreCreateCounting(64, 0);
+        TEST_ASSERT_NOT_NULL(s_done);
+    }
+    fake_i2c_reset();
+}
+
+/**
+ * @brief Submit 1 transaction 1 byte (byte = tag để nhận ra thứ tự trên bus)
+ */
+static esp_err_t submit(const uint8_t *tag, i2c_bus_prio_t prio) {
+    const i2c_bus_xfer_t xfer = {
+        .dev = s_dev,
+        .tx = tag,
+        .tx_len = 1,
+        .done_cb = done_cb,
+        .arg = (void *)(uintptr_t)*tag,
+    };
+    return i2c_bus_submit(&xfer, prio);
+}
+
+static void wait_done(int n) {
+    for (int i = 0; i < n; i++) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(s_done, DONE_TIMEOUT) == pdTRUE);
+    }
+}
+
+TEST_CASE("HIGH transactions overtake queued NORMAL ones", "[i2c_bus]")
+{
+    static const uint8_t tags[] = { 0, 1, 2, 3, 4, 5 };
+    i2c_bus_stats_t stats;
+
+    setup();
+
+    // Bus đang bận với transaction 0 (ví dụ flush màn hình)
+    fake_i2c_hold();
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[0], I2C_BUS_PRIO_NORMAL));
+    TEST_ASSERT_TRUE(fake_i2c_wait_held(DONE_TIMEOUT));
+
+    // Trong lúc đó: 3 NORMAL rồi 2 HIGH
+    int64_t queued_us = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[1], I2C_BUS_PRIO_NORMAL));
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[2], I2C_BUS_PRIO_NORMAL));
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[3], I2C_BUS_PRIO_NORMAL));
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[4], I2C_BUS_PRIO_HIGH));
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[5], I2C_BUS_PRIO_HIGH));
+    vTaskDelay(pdMS_TO_TICKS(HOLD_MS));
+    fake_i2c_release();
+    wait_done(6);
+
+    // Thứ tự trên bus: 0 (đang chạy), HIGH 4, 5, rồi NORMAL 1, 2, 3 theo FIFO
+    static const uint8_t order[] = { 0, 4, 5, 1, 2, 3 };
+    TEST_ASSERT_EQUAL_UINT32(6, fake_i2c_count());
+    for (uint32_t i = 0; i < 6; i++) {
+        const fake_i2c_xfer_t *x = fake_i2c_get(i);
+        TEST_ASSERT_EQUAL_HEX8(TEST_DEV_ADDR, x->addr);
+        TEST_ASSERT_EQUAL(1, x->len);
+        TEST_ASSERT_EQUAL_UINT8(order[i], x->data[0]);
+        TEST_ASSERT_EQUAL(ESP_OK, s_results[order[i]]);
+        if (i > 0) {
+            TEST_ASSERT_GREATER_OR_EQUAL_INT64(fake_i2c_get(i - 1)->start_us, x->start_us);
+            // Mọi transaction xếp hàng phải chờ hết thời gian bus bị giữ
+            TEST_ASSERT_GREATER_OR_EQUAL_INT64(HOLD_MS * 1000, x->start_us - queued_us);
+        }
+    }
+
+    i2c_bus_get_stats(&stats);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(HOLD_MS * 1000, stats.latency_max_us);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(3, stats.queue_high_watermark);
+}
+
+TEST_CASE("full queue rejects without blocking", "[i2c_bus]")
+{
+    static uint8_t tags[I2C_BUS_QUEUE_LEN + 2];
+    i2c_bus_stats_t before, after;
+
+    setup();
+    for (uint32_t i = 0; i < sizeof(tags); i++) {
+        tags[i] = (uint8_t)i;
+    }
+    i2c_bus_get_stats(&before);
+
+    fake_i2c_hold();
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[0], I2C_BUS_PRIO_NORMAL));
+    TEST_ASSERT_TRUE(fake_i2c_wait_held(DONE_TIMEOUT));
+    for (uint32_t i = 1; i <= I2C_BUS_QUEUE_LEN; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[i], I2C_BUS_PRIO_NORMAL));
+    }
+
+    // Hàng đợi NORMAL đầy: từ chối ngay, hàng đợi HIGH vẫn nhận
+    int64_t t0 = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, submit(&tags[I2C_BUS_QUEUE_LEN + 1], I2C_BUS_PRIO_NORMAL));
+    TEST_ASSERT_LESS_THAN_INT64(HOLD_MS * 1000, esp_timer_get_time() - t0);
+    TEST_ASSERT_EQUAL(ESP_OK, submit(&tags[I2C_BUS_QUEUE_LEN + 1], I2C_BUS_PRIO_HIGH));
+
+    fake_i2c_release();
+    wait_done(I2C_BUS_QUEUE_LEN + 2);
+
+    i2c_bus_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(before.rejected + 1, after.rejected);
+    TEST_ASSERT_EQUAL_UINT32(before.completed + I2C_BUS_QUEUE_LEN + 2, after.completed);
+    TEST_ASSERT_EQUAL_UINT32(I2C_BUS_QUEUE_LEN, after.queue_high_watermark);
+    TEST_ASSERT_EQUAL_UINT8(I2C_BUS_QUEUE_LEN + 1, fake_i2c_get(1)->data[0]);
+}
+
+TEST_CASE("bench i2c_bus submit to completion", "[i2c_bus][bench]")
+{
+    static const uint8_t tx[2] = { 0x00, 0xAF };
+    i2c_bus_stats_t stats;
+    test_bench_t b;
+
+    setup();
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_transmit_sync(s_dev, tx, sizeof(tx)));    // Khởi động (ngoài phép đo)
+
+    // Độ trễ vòng submit -> bus task -> callback với backend không tốn thời gian truyền
+    test_bench_start(&b, "i2c_bus_transmit_sync");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS / 10; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_transmit_sync(s_dev, tx, sizeof(tx)));
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS / 10);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+
+    i2c_bus_get_stats(&stats);
+    printf("BENCH %-24s %9" PRIu32 " us avg %9" PRIu32 " us max (submit -> start, cả app test)\n",
+           "i2c_bus_queue_latency", stats.latency_avg_us, stats.latency_max_us);
+}
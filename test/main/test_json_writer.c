@@ -0,0 +1,341 @@
+/**
+ * @file test_json_writer.c
+ * @brief Test json_writer: định dạng byte-exact, escape, lồng nhau, cắt khối ở biên chunk, so với snprintf
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "json_writer.h"
+
+#define CAPTURE_MAX         (16 * JSON_WRITER_CHUNK)
+
+/**
+ * @brief Sink ghi lại toàn bộ dữ liệu và kích thước từng khối
+ */
+typedef struct {
+    char data[CAPTURE_MAX];
+    size_t len;
+    uint32_t chunks;
+    size_t chunk_len[32];
+    uint32_t fail_at;           // Khối thứ fail_at (từ 1) trả lỗi, 0 = không lỗi
+} capture_t;
+
+static json_writer_t s_json;
+static capture_t s_cap;
+
+static esp_err_t capture_sink(void *ctx, const char *data, size_t len) {
+    capture_t *cap = ctx;
+
+    cap->chunks++;
+    if (cap->chunks == cap->fail_at) {
+        return ESP_FAIL;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(CAPTURE_MAX, cap->len + len);
+    if (cap->chunks <= sizeof(cap->chunk_len) / sizeof(cap->chunk_len[0])) {
+        cap->chunk_len[cap->chunks - 1] = len;
+    }
+    memcpy(cap->data + cap->len, data, len);
+    cap->len += len;
+    return ESP_OK;
+}
+
+static esp_err_t null_sink(void *ctx, const char *data, size_t len) {
+    (void)data;
+    *(size_t *)ctx += len;
+    return ESP_OK;
+}
+
+static void begin(void) {
+    json_writer_init(&s_json, NULL, NULL);
+}
+
+static void begin_capture(void) {
+    memset(&s_cap, 0, sizeof(s_cap));
+    json_writer_init(&s_json, capture_sink, &s_cap);
+}
+
+static void assert_json(const char *expected) {
+    TEST_ASSERT_EQUAL(ESP_OK, json_writer_flush(&s_json));
+    TEST_ASSERT_EQUAL_UINT32(strlen(expected), s_json.len);
+    TEST_ASSERT_EQUAL_STRING_LEN(expected, s_json.buf, s_json.len);
+}
+
+static void assert_capture(const char *expected, size_t len) {
+    TEST_ASSERT_EQUAL(ESP_OK, json_writer_flush(&s_json));
+    TEST_ASSERT_EQUAL_UINT32(len, s_cap.len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, s_cap.data, len);
+    // Mọi khối trừ khối cuối đều đầy đúng 1 chunk
+    for (uint32_t i = 0; i + 1 < s_cap.chunks; i++) {
+        TEST_ASSERT_EQUAL_UINT32(JSON_WRITER_CHUNK, s_cap.chunk_len[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32((len + JSON_WRITER_CHUNK - 1) / JSON_WRITER_CHUNK, s_cap.chunks);
+}
+
+TEST_CASE("integers cover the full 64 bit range", "[json_writer]")
+{
+    begin();
+    json_begin_array(&s_json);
+    json_uint(&s_json, 0);
+    json_uint(&s_json, 10);
+    json_uint(&s_json, UINT64_MAX);
+    json_int(&s_json, -1);
+    json_int(&s_json, INT64_MAX);
+    json_int(&s_json, INT64_MIN);
+    json_end_array(&s_json);
+    assert_json("[0,10,18446744073709551615,-1,9223372036854775807,-9223372036854775808]");
+}
+
+TEST_CASE("deci values keep one decimal and the sign", "[json_writer]")
+{
+    begin();
+    json_begin_array(&s_json);
+    json_deci(&s_json, 0);
+    json_deci(&s_json, 5);
+    json_deci(&s_json, -5);
+    json_deci(&s_json, -10);
+    json_deci(&s_json, 253);
+    json_deci(&s_json, -400);
+    json_deci(&s_json, INT32_MAX);
+    json_deci(&s_json, INT32_MIN);
+    json_end_array(&s_json);
+    assert_json("[0.0,0.5,-0.5,-1.0,25.3,-40.0,214748364.7,-214748364.8]");
+}
+
+TEST_CASE("float1 rounds half away from zero and maps non-finite to null", "[json_writer]")
+{
+    begin();
+    json_begin_array(&s_json);
+    json_float1(&s_json, 25.3f);
+    json_float1(&s_json, 25.25f);       // 25.25 chính xác trong float => 25.3
+    json_float1(&s_json, -25.25f);
+    json_float1(&s_json, -0.04f);       // Làm tròn về 0 => không có "-0.0"
+    json_float1(&s_json, -0.06f);
+    json_float1(&s_json, 99.96f);
+    json_float1(&s_json, NAN);
+    json_float1(&s_json, INFINITY);
+    json_float1(&s_json, -INFINITY);
+    json_float1(&s_json, 3.0e8f);       // Ngoài khoảng int32 / 10
+    json_end_array(&s_json);
+    assert_json("[25.3,25.3,-25.3,0.0,-0.1,100.0,null,null,null,null]");
+}
+
+TEST_CASE("strings escape quotes, backslash and control characters", "[json_writer]")
+{
+    begin();
+    json_begin_object(&s_json);
+    json_field_string(&s_json, "k\"ey", "a\"b\\c\nd\x01\x1f" "e\x7f\xc3\xa9");
+    json_field_string(&s_json, "", "");
+    json_end_object(&s_json);
+    assert_json("{\"k\\\"ey\":\"a\\\"b\\\\c\\u000ad\\u0001\\u001fe\x7f\xc3\xa9\",\"\":\"\"}");
+}
+
+TEST_CASE("nested containers place commas correctly", "[json_writer]")
+{
+    begin();
+    json_begin_object(&s_json);
+    json_key(&s_json, "a");
+    json_begin_array(&s_json);
+    json_uint(&s_json, 1);
+    json_begin_array(&s_json);
+    json_end_array(&s_json);
+    json_begin_object(&s_json);
+    json_field_bool(&s_json, "b", false);
+    json_key(&s_json, "n");
+    json_null(&s_json);
+    json_end_object(&s_json);
+    json_end_array(&s_json);
+    json_key(&s_json, "c");
+    json_begin_object(&s_json);
+    json_end_object(&s_json);
+    json_field_int(&s_json, "d", -7);
+    json_end_object(&s_json);
+    assert_json("{\"a\":[1,[],{\"b\":false,\"n\":null}],\"c\":{},\"d\":-7}");
+}
+
+TEST_CASE("depth and balance errors are reported", "[json_writer]")
+{
+    begin();
+    for (int i = 0; i < JSON_WRITER_MAX_DEPTH; i++) {
+        json_begin_array(&s_json);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, s_json.err);
+    json_begin_array(&s_json);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, json_writer_flush(&s_json));
+
+    begin();
+    json_end_object(&s_json);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, json_writer_flush(&s_json));
+}
+
+TEST_CASE("output larger than one chunk without a sink fails with NO_MEM", "[json_writer]")
+{
+    begin();
+    json_begin_array(&s_json);
+    for (int i = 0; i < JSON_WRITER_CHUNK; i++) {
+        json_uint(&s_json, 7);
+    }
+    json_end_array(&s_json);
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, json_writer_flush(&s_json));
+    TEST_ASSERT_FALSE(s_json.flushed);
+}
+
+TEST_CASE("tokens split across chunk boundaries are reassembled exactly", "[json_writer]")
+{
+    static char expected[CAPTURE_MAX];
+    static char pad[JSON_WRITER_CHUNK];
+
+    // Dịch mọi token qua biên chunk đầu tiên từng byte một
+    for (int shift = 0; shift < 24; shift++) {
+        int pad_len = JSON_WRITER_CHUNK - 12 - shift;
+        memset(pad, 'x', pad_len);
+        pad[pad_len] = '\0';
+
+        begin_capture();
+        json_begin_array(&s_json);
+        json_string(&s_json, pad);
+        json_deci(&s_json, -5);
+        json_string(&s_json, "q\"\x01z");
+        json_int(&s_json, INT64_MIN);
+        json_float1(&s_json, NAN);
+        json_bool(&s_json, false);
+        json_end_array(&s_json);
+
+        int len = snprintf(expected, sizeof(expected), "[\"%s\",-0.5,\"q\\\"\\u0001z\",-9223372036854775808,null,false]",
+                           pad);
+        assert_capture(expected, (size_t)len);
+        TEST_ASSERT_EQUAL_UINT32(2, s_cap.chunks);
+        TEST_ASSERT_TRUE(s_json.flushed);
+    }
+
+    // Nhiều khối: 1200 số deci âm (VD: -0.5) nối nhau
+    begin_capture();
+    size_t len = 0;
+    json_begin_array(&s_json);
+    expected[len++] = '[';
+    for (int i = 0; i < 1200; i++) {
+        int deci = -(i % 37);
+        json_deci(&s_json, deci);
+        len += (size_t)snprintf(expected + len, sizeof(expected) - len, "%s%s%d.%d", i ? "," : "",
+                                deci < 0 ? "-" : "", -deci / 10, -deci % 10);
+    }
+    json_end_array(&s_json);
+    expected[len++] = ']';
+    assert_capture(expected, len);
+    TEST_ASSERT_GREATER_THAN_UINT32(4, s_cap.chunks);
+}
+
+TEST_CASE("sink error stops further output", "[json_writer]")
+{
+    begin_capture();
+    s_cap.fail_at = 2;
+    json_begin_array(&s_json);
+    for (int i = 0; i < 4 * JSON_WRITER_CHUNK; i++) {
+        json_uint(&s_json, 1);
+    }
+    json_end_array(&s_json);
+    TEST_ASSERT_EQUAL(ESP_FAIL, json_writer_flush(&s_json));
+    TEST_ASSERT_EQUAL_UINT32(2, s_cap.chunks);
+    TEST_ASSERT_EQUAL_UINT32(JSON_WRITER_CHUNK, s_cap.len);
+}
+
+// ==================== BENCHMARK ====================
+
+#define BENCH_ROWS          64
+
+/**
+ * @brief 1 dòng kiểu /api/history (giá trị deci giống DHT22)
+ */
+typedef struct {
+    uint32_t seq;
+    int16_t temp_deci;
+    uint16_t hum_deci;
+    int64_t timestamp_us;
+} bench_row_t;
+
+static bench_row_t s_rows[BENCH_ROWS];
+
+static void write_rows(json_writer_t *w) {
+    json_begin_array(w);
+    for (int i = 0; i < BENCH_ROWS; i++) {
+        json_begin_object(w);
+        json_field_uint(w, "seq", s_rows[i].seq);
+        json_key(w, "temperature");
+        json_deci(w, s_rows[i].temp_deci);
+        json_key(w, "humidity");
+        json_deci(w, s_rows[i].hum_deci);
+        json_field_string(w, "status", "NORMAL");
+        json_field_int(w, "timestamp", s_rows[i].timestamp_us);
+        json_end_object(w);
+    }
+    json_end_array(w);
+}
+
+static size_t write_rows_json(void) {
+    size_t sent = 0;
+
+    json_writer_init(&s_json, null_sink, &sent);
+    write_rows(&s_json);
+    json_writer_flush(&s_json);
+    return sent;
+}
+
+/**
+ * @brief Cách cũ: snprintf với %.1f vào buffer lớn
+ */
+static size_t write_rows_snprintf(char *buf, size_t size) {
+    size_t len = 0;
+    buf[len++] = '[';
+    for (int i = 0; i < BENCH_ROWS; i++) {
+        len += (size_t)snprintf(buf + len, size - len,
+                                "%s{\"seq\":%" PRIu32 ",\"temperature\":%.1f,\"humidity\":%.1f,"
+                                "\"status\":\"NORMAL\",\"timestamp\":%" PRId64 "}",
+                                i ? "," : "", s_rows[i].seq, s_rows[i].temp_deci / 10.0f,
+                                s_rows[i].hum_deci / 10.0f, s_rows[i].timestamp_us);
+    }
+    buf[len++] = ']';
+    return len;
+}
+
+TEST_CASE("bench json_writer vs snprintf", "[json_writer][bench]")
+{
+    static char ref[CAPTURE_MAX];
+    test_bench_t b;
+
+    for (int i = 0; i < BENCH_ROWS; i++) {
+        s_rows[i] = (bench_row_t){
+            .seq = 100000u + (uint32_t)i,
+            .temp_deci = (int16_t)(i * 7 - 100),    // Có cả giá trị âm (-10.0 .. 34.1)
+            .hum_deci = (uint16_t)(450 + i * 3),
+            .timestamp_us = 1700000000000000LL + (int64_t)i * 2000000,
+        };
+    }
+
+    // Cùng dữ liệu => cùng từng byte
+    size_t ref_len = write_rows_snprintf(ref, sizeof(ref));
+    begin_capture();
+    write_rows(&s_json);
+    assert_capture(ref, ref_len);
+    TEST_ASSERT_EQUAL_UINT32(ref_len, write_rows_json());
+
+    uint32_t reps = TEST_BENCH_ITERATIONS / BENCH_ROWS;
+    test_bench_start(&b, "json_writer_row");
+    for (uint32_t i = 0; i < reps; i++) {
+        test_bench_sink += (uint32_t)write_rows_json();
+    }
+    test_bench_result_t rw = test_bench_end(&b, reps * BENCH_ROWS);
+
+    test_bench_start(&b, "snprintf_row");
+    for (uint32_t i = 0; i < reps; i++) {
+        test_bench_sink += (uint32_t)write_rows_snprintf(ref, sizeof(ref));
+    }
+    test_bench_result_t rs = test_bench_end(&b, reps * BENCH_ROWS);
+
+    printf("BENCH %-24s json_writer %" PRIu32 " ns/row, snprintf %" PRIu32 " ns/row, %zu B/row\n",
+           "json_vs_snprintf", rw.ns_per_op, rs.ns_per_op, ref_len / BENCH_ROWS);
+    TEST_ASSERT_EQUAL(0, rw.alloc_bytes);
+}
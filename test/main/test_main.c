@@ -0,0 +1,18 @@
+/**
+ * @file test_main.c
+ * @brief Unity test app (target linux) - Chạy mọi TEST_CASE rồi thoát với mã lỗi
+ *
+ * Chạy: idf.py --preview set-target linux build && ./build/temp_monitor_test.elf
+ * Mã thoát khác 0 khi có test thất bại (dùng được trong CI).
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+void app_main(void) {
+    printf("Temperature Monitor - host tests\n");
+    unity_run_all_tests();
+    exit(Unity.TestFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
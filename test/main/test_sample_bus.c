@@ -0,0 +1,278 @@
+/**
+ * @file test_sample_bus.c
+ * @brief Test sample bus: subscriber chậm theo từng chính sách backpressure
+ *
+ * Mỗi test bắt đầu với bus trống (fresh_bus) nên seq của mẫu publish thứ n là n.
+ * Publish bị chặn chờ đúng SAMPLE_BUS_PUBLISH_TIMEOUT_MS trước khi bỏ mẫu.
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "sample_bus.h"
+
+#define SLOW_SAMPLES        32      // Số mẫu cho subscriber BLOCK chạy trên task riêng
+#define SLOW_HOLD_MS        2       // Thời gian giữ mỗi mẫu (<< SAMPLE_BUS_PUBLISH_TIMEOUT_MS)
+
+static void fresh_bus(void) {
+    sample_bus_deinit();
+    TEST_ASSERT_EQUAL(ESP_OK, sample_bus_init());
+}
+
+// Nhiệt độ suy ra từ seq để kiểm tra nội dung slot
+static float temp_of(uint32_t seq) {
+    return (float)(seq % 100);
+}
+
+static esp_err_t publish(uint32_t seq) {
+    sensor_data_t data = {
+        .temperature = temp_of(seq),
+        .humidity = 50.0f,
+        .timestamp = (int64_t)seq * 1000,
+        .is_valid = true,
+    };
+    return sample_bus_publish(&data, STATE_NORMAL, NULL);
+}
+
+/**
+ * @brief Publish n mẫu tiếp theo, tất cả phải thành công
+ */
+static void publish_run(uint32_t *seq, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, publish(++*seq));
+    }
+}
+
+static sample_bus_sub_stats_t stats_of(int index) {
+    sample_bus_sub_stats_t st;
+    TEST_ASSERT_EQUAL(ESP_OK, sample_bus_get_stats(index, &st));
+    return st;
+}
+
+/**
+ * @brief Publish bị chặn phải hết giờ sau SAMPLE_BUS_PUBLISH_TIMEOUT_MS và tăng bộ đếm drop
+ */
+static void assert_publish_times_out(uint32_t seq) {
+    uint32_t drops = sample_bus_get_publish_drops();
+    int64_t start_us = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, publish(seq));
+    int64_t waited_ms = (esp_timer_get_time() - start_us) / 1000;
+
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(SAMPLE_BUS_PUBLISH_TIMEOUT_MS - 10, (uint32_t)waited_ms);
+    TEST_ASSERT_EQUAL_UINT32(drops + 1, sample_bus_get_publish_drops());
+}
+
+TEST_CASE("latest-only subscriber skips to the newest sample", "[sample_bus]")
+{
+    uint32_t seq = 0;
+    fresh_bus();
+    sample_bus_sub_t sub = sample_bus_subscribe("display", SAMPLE_BUS_LATEST_ONLY);
+    TEST_ASSERT_NOT_NULL(sub);
+
+    publish_run(&seq, 5);
+    const sample_t *s = sample_bus_receive(sub, 0);
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_UINT32(5, s->seq);
+    sample_bus_release(sub);
+
+    sample_bus_sub_stats_t st = stats_of(0);
+    TEST_ASSERT_EQUAL_UINT32(1, st.delivered);
+    TEST_ASSERT_EQUAL_UINT32(4, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, st.depth);
+    TEST_ASSERT_EQUAL_UINT32(5, st.max_depth);
+    TEST_ASSERT_NULL(sample_bus_receive(sub, 0));
+
+    // Quá 1 vòng ring mà không đọc => vẫn chỉ nhận mẫu mới nhất
+    publish_run(&seq, 2 * SAMPLE_BUS_DEPTH);
+    s = sample_bus_receive(sub, 0);
+    TEST_ASSERT_EQUAL_UINT32(seq, s->seq);
+    sample_bus_release(sub);
+    st = stats_of(0);
+    TEST_ASSERT_EQUAL_UINT32(2, st.delivered);
+    TEST_ASSERT_EQUAL_UINT32(4 + 2 * SAMPLE_BUS_DEPTH - 1, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, sample_bus_get_publish_drops());
+}
+
+TEST_CASE("latest-only subscriber holding a slot is never overwritten", "[sample_bus]")
+{
+    uint32_t seq = 0;
+    fresh_bus();
+    sample_bus_sub_t sub = sample_bus_subscribe("display", SAMPLE_BUS_LATEST_ONLY);
+
+    publish_run(&seq, 1);
+    const sample_t *held = sample_bus_receive(sub, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, held->seq);
+
+    // Mọi slot khác được ghi, tới slot đang giữ thì publisher chờ rồi bỏ mẫu
+    publish_run(&seq, SAMPLE_BUS_DEPTH - 1);
+    assert_publish_times_out(seq + 1);
+    TEST_ASSERT_EQUAL_UINT32(1, held->seq);
+    TEST_ASSERT_EQUAL_FLOAT(temp_of(1), held->data.temperature);
+
+    // Nhả slot => publish tiếp được, mẫu bị bỏ không chiếm seq
+    sample_bus_release(sub);
+    publish_run(&seq, 1);
+    const sample_t *s = sample_bus_receive(sub, 0);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH + 1, s->seq);
+    sample_bus_release(sub);
+}
+
+TEST_CASE("drop-oldest subscriber loses the oldest samples on overflow", "[sample_bus]")
+{
+    uint32_t seq = 0;
+    fresh_bus();
+    sample_bus_sub_t sub = sample_bus_subscribe("web", SAMPLE_BUS_DROP_OLDEST);
+
+    // Publisher không bao giờ chờ subscriber DROP_OLDEST chưa giữ slot nào
+    publish_run(&seq, SAMPLE_BUS_DEPTH + 3);
+    sample_bus_sub_stats_t st = stats_of(0);
+    TEST_ASSERT_EQUAL_UINT32(3, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH, st.depth);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH, st.max_depth);
+
+    for (uint32_t expect = 4; expect <= seq; expect++) {
+        const sample_t *s = sample_bus_receive(sub, 0);
+        TEST_ASSERT_NOT_NULL(s);
+        TEST_ASSERT_EQUAL_UINT32(expect, s->seq);
+        TEST_ASSERT_EQUAL_FLOAT(temp_of(expect), s->data.temperature);
+        sample_bus_release(sub);
+    }
+    TEST_ASSERT_NULL(sample_bus_receive(sub, 0));
+
+    st = stats_of(0);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH, st.delivered);
+    TEST_ASSERT_EQUAL_UINT32(3, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, st.depth);
+    TEST_ASSERT_EQUAL_UINT32(0, sample_bus_get_publish_drops());
+}
+
+TEST_CASE("drop-oldest subscriber holding a slot blocks only that slot", "[sample_bus]")
+{
+    uint32_t seq = 0;
+    fresh_bus();
+    sample_bus_sub_t sub = sample_bus_subscribe("web", SAMPLE_BUS_DROP_OLDEST);
+
+    publish_run(&seq, SAMPLE_BUS_DEPTH + 3);
+    const sample_t *held = sample_bus_receive(sub, 0);
+    TEST_ASSERT_EQUAL_UINT32(4, held->seq);
+
+    // Slot kế tiếp của publisher chính là slot đang giữ
+    assert_publish_times_out(seq + 1);
+    TEST_ASSERT_EQUAL_UINT32(4, held->seq);
+    TEST_ASSERT_EQUAL_FLOAT(temp_of(4), held->data.temperature);
+    TEST_ASSERT_EQUAL_UINT32(3, stats_of(0).dropped);
+
+    // Nhả slot => ring còn chỗ cho seq 12 mà không phải bỏ thêm mẫu nào
+    sample_bus_release(sub);
+    publish_run(&seq, 1);
+    TEST_ASSERT_EQUAL_UINT32(3, stats_of(0).dropped);
+    TEST_ASSERT_EQUAL_UINT32(1, stats_of(0).delivered);
+    TEST_ASSERT_EQUAL_UINT32(5, sample_bus_receive(sub, 0)->seq);
+    sample_bus_release(sub);
+}
+
+TEST_CASE("block subscriber makes the publisher wait, then time out", "[sample_bus]")
+{
+    uint32_t seq = 0;
+    fresh_bus();
+    sample_bus_sub_t sub = sample_bus_subscribe("logger", SAMPLE_BUS_BLOCK);
+
+    publish_run(&seq, SAMPLE_BUS_DEPTH);
+    assert_publish_times_out(seq + 1);
+    assert_publish_times_out(seq + 1);
+    TEST_ASSERT_EQUAL_UINT32(2, sample_bus_get_publish_drops());
+
+    // BLOCK không bao giờ mất mẫu: drop nằm ở publisher, không ở subscriber
+    sample_bus_sub_stats_t st = stats_of(0);
+    TEST_ASSERT_EQUAL_UINT32(0, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH, st.depth);
+
+    TEST_ASSERT_EQUAL_UINT32(1, sample_bus_receive(sub, 0)->seq);
+    sample_bus_release(sub);
+    publish_run(&seq, 1);
+    for (uint32_t expect = 2; expect <= seq; expect++) {
+        TEST_ASSERT_EQUAL_UINT32(expect, sample_bus_receive(sub, 0)->seq);
+        sample_bus_release(sub);
+    }
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH + 1, stats_of(0).delivered);
+}
+
+typedef struct {
+    sample_bus_sub_t sub;
+    SemaphoreHandle_t done;
+    uint32_t received;
+    uint32_t out_of_order;
+} slow_reader_t;
+
+static void slow_reader_task(void *arg) {
+    slow_reader_t *r = arg;
+    uint32_t last_seq = 0;
+
+    while (r->received < SLOW_SAMPLES) {
+        const sample_t *s = sample_bus_receive(r->sub, pdMS_TO_TICKS(1000));
+        if (s == NULL) {
+            break;
+        }
+        if (s->seq != last_seq + 1) {
+            r->out_of_order++;
+        }
+        last_seq = s->seq;
+        vTaskDelay(pdMS_TO_TICKS(SLOW_HOLD_MS));     // Giữ slot như consumer ghi flash
+        sample_bus_release(r->sub);
+        r->received++;
+    }
+    xSemaphoreGive(r->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("slow block subscriber gets every sample while the others overflow", "[sample_bus]")
+{
+    uint32_t seq = 0;
+    fresh_bus();
+    slow_reader_t r = { .sub = sample_bus_subscribe("logger", SAMPLE_BUS_BLOCK), .done = xSemaphoreCreateBinary() };
+    sample_bus_sub_t web = sample_bus_subscribe("web", SAMPLE_BUS_DROP_OLDEST);
+    sample_bus_sub_t display = sample_bus_subscribe("display", SAMPLE_BUS_LATEST_ONLY);
+    TEST_ASSERT_NOT_NULL(r.sub);
+    TEST_ASSERT_NOT_NULL(web);
+    TEST_ASSERT_NOT_NULL(display);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(slow_reader_task, "slow_reader", 4096, &r, 5, NULL));
+
+    // Publisher nhanh hơn consumer => phải chờ, nhưng mỗi lần chờ ngắn hơn timeout
+    publish_run(&seq, SLOW_SAMPLES);
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(r.done, pdMS_TO_TICKS(5000)));
+    vSemaphoreDelete(r.done);
+
+    TEST_ASSERT_EQUAL_UINT32(SLOW_SAMPLES, r.received);
+    TEST_ASSERT_EQUAL_UINT32(0, r.out_of_order);
+    TEST_ASSERT_EQUAL_UINT32(0, sample_bus_get_publish_drops());
+
+    sample_bus_sub_stats_t st = stats_of(0);
+    TEST_ASSERT_EQUAL_UINT32(SLOW_SAMPLES, st.delivered);
+    TEST_ASSERT_EQUAL_UINT32(0, st.dropped);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(SAMPLE_BUS_DEPTH, st.max_depth);
+
+    // 2 subscriber không đọc: mọi mẫu đều được đếm (delivered + dropped + depth)
+    for (int i = 1; i <= 2; i++) {
+        st = stats_of(i);
+        TEST_ASSERT_EQUAL_UINT32(0, st.delivered);
+        TEST_ASSERT_EQUAL_UINT32(SLOW_SAMPLES - SAMPLE_BUS_DEPTH, st.dropped);
+        TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUS_DEPTH, st.depth);
+    }
+}
+
+TEST_CASE("subscriber table is bounded", "[sample_bus]")
+{
+    fresh_bus();
+    for (int i = 0; i < SAMPLE_BUS_MAX_SUBSCRIBERS; i++) {
+        TEST_ASSERT_NOT_NULL(sample_bus_subscribe("sub", SAMPLE_BUS_DROP_OLDEST));
+    }
+    TEST_ASSERT_NULL(sample_bus_subscribe("extra", SAMPLE_BUS_DROP_OLDEST));
+    TEST_ASSERT_EQUAL_INT(SAMPLE_BUS_MAX_SUBSCRIBERS, sample_bus_get_subscriber_count());
+
+    sample_bus_sub_stats_t st;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sample_bus_get_stats(SAMPLE_BUS_MAX_SUBSCRIBERS, &st));
+    sample_bus_deinit();
+}
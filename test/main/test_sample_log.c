@@ -0,0 +1,242 @@
+/**
+ * @file test_sample_log.c
+ * @brief Test nhật ký mẫu trên partition flash giả lập: mount lại, trang ghi dở, xoay vòng
+ *
+ * Partition "samplelog" của test app (test/partitions.csv) chỉ có vài sector để
+ * test xoay vòng nhanh. Mỗi test xóa trắng partition rồi mount lại từ đầu.
+ */
+
+#include <string.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "esp_partition.h"
+#include "sample_log.h"
+
+static const esp_partition_t *s_part;
+static uint32_t s_seq;
+
+/**
+ * @brief Xóa trắng partition rồi mount (như board mới nạp)
+ */
+static void mount_blank(void) {
+    sample_log_deinit();
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                      SAMPLE_LOG_PARTITION_LABEL);
+    TEST_ASSERT_NOT_NULL(s_part);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(s_part, 0, s_part->size));
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_init());
+    s_seq = 0;
+}
+
+/**
+ * @brief Mất điện rồi khởi động lại: phần chờ trong RAM mất, mount lại từ flash
+ */
+static void reboot(void) {
+    sample_log_deinit();
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_init());
+}
+
+static void append_n(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        s_seq++;
+        sample_t s = {
+            .data = {
+                .temperature = (int)(s_seq % 400) / 10.0f,
+                .humidity = 50.0f,
+                .timestamp = (int64_t)s_seq * 2000 * 1000,
+                .is_valid = true,
+            },
+            .state = STATE_NORMAL,
+            .seq = s_seq,
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, sample_log_append(&s));
+    }
+}
+
+static size_t slot_offset(uint32_t sector, uint32_t slot) {
+    return (size_t)sector * SAMPLE_LOG_SECTOR_SIZE + slot * SAMPLE_LOG_RECORD_SIZE;
+}
+
+/**
+ * @brief Mọi LSN trong span đọc được, seq tăng liên tục; trả về seq của bản ghi đầu
+ */
+static uint32_t assert_contiguous(sample_log_span_t span, uint16_t boot) {
+    sample_log_record_t r;
+    uint32_t first_seq = 0;
+
+    for (uint32_t lsn = span.begin; lsn < span.end; lsn++) {
+        TEST_ASSERT_TRUE(sample_log_read(lsn, &r));
+        if (lsn == span.begin) {
+            first_seq = r.seq;
+        }
+        TEST_ASSERT_EQUAL_UINT32(first_seq + (lsn - span.begin), r.seq);
+        TEST_ASSERT_EQUAL_INT16((int16_t)(r.seq % 400), r.temp_deci);
+        TEST_ASSERT_EQUAL_UINT16(500, r.hum_deci);
+        TEST_ASSERT_EQUAL_UINT16(boot, r.boot);
+        TEST_ASSERT_EQUAL_UINT8(SAMPLE_LOG_FLAG_VALID | STATE_NORMAL, r.flags);
+    }
+    return first_seq;
+}
+
+TEST_CASE("blank partition mounts empty at boot 1", "[sample_log]")
+{
+    sample_log_stats_t stats;
+
+    mount_blank();
+    sample_log_span_t span = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_LOG_RECORDS_PER_SECTOR, span.begin);
+    TEST_ASSERT_EQUAL_UINT32(span.begin, span.end);
+
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(s_part->size / SAMPLE_LOG_SECTOR_SIZE, stats.sectors);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.boot);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.records);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.erases);
+}
+
+TEST_CASE("records are written a page at a time", "[sample_log]")
+{
+    sample_log_stats_t stats;
+
+    mount_blank();
+    // Slot 0 là header => trang đầu chỉ còn 15 slot
+    append_n(SAMPLE_LOG_RECORDS_PER_PAGE - 2);
+    TEST_ASSERT_EQUAL_UINT32(0, sample_log_get_span().end - sample_log_get_span().begin);
+    append_n(1);
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_LOG_RECORDS_PER_PAGE - 1, stats.records);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pending);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pages_written);
+
+    append_n(3);
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.pending);
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_flush());
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_LOG_RECORDS_PER_PAGE + 2, stats.records);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pending);
+
+    TEST_ASSERT_EQUAL_UINT32(1, assert_contiguous(sample_log_get_span(), 1));
+}
+
+TEST_CASE("torn page is skipped and the LSN resumes after reboot", "[sample_log]")
+{
+    sample_log_stats_t stats;
+    sample_log_record_t r;
+
+    mount_blank();
+    append_n(20);
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_flush());
+    sample_log_span_t before = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(20, before.end - before.begin);
+
+    // Mất điện giữa lúc ghi trang kế tiếp (slot 21..23 của sector 0):
+    // slot 21 chỉ kịp ghi nửa đầu, slot 22 đủ byte nhưng sai CRC, slot 23 chưa tới
+    memset(&r, 0, sizeof(r));
+    r.seq = 21;
+    r.boot = 1;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(s_part, slot_offset(0, 21), &r, 8));
+    r.seq = 22;
+    r.crc = 0x5A;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(s_part, slot_offset(0, 22), &r, sizeof(r)));
+
+    // 5 bản ghi chờ trong RAM bị mất cùng lúc
+    append_n(5);
+    reboot();
+
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.torn);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.boot);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.erases);
+
+    sample_log_span_t span = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(before.begin, span.begin);
+    TEST_ASSERT_EQUAL_UINT32(before.end + 2, span.end);     // Slot rách vẫn chiếm LSN
+    TEST_ASSERT_EQUAL_UINT32(1, assert_contiguous((sample_log_span_t){ before.begin, before.end }, 1));
+    TEST_ASSERT_FALSE(sample_log_read(before.end, &r));
+    TEST_ASSERT_FALSE(sample_log_read(before.end + 1, &r));
+
+    // Ghi tiếp ngay sau slot rách, với boot mới
+    s_seq = 0;
+    append_n(4);
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_flush());
+    span = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(before.end + 2 + 4, span.end);
+    TEST_ASSERT_EQUAL_UINT32(1, assert_contiguous((sample_log_span_t){ before.end + 2, span.end }, 2));
+
+    // Khởi động lần nữa: không còn phát hiện thêm slot rách mới nào ngoài 2 slot cũ
+    reboot();
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.boot);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.torn);
+    TEST_ASSERT_EQUAL_UINT32(span.end, sample_log_get_span().end);
+}
+
+TEST_CASE("log wraps the partition and survives reboot", "[sample_log]")
+{
+    sample_log_stats_t stats;
+    sample_log_record_t r;
+
+    mount_blank();
+    uint32_t sectors = s_part->size / SAMPLE_LOG_SECTOR_SIZE;
+
+    // Ghi hơn 2 vòng partition
+    append_n((2 * sectors + 1) * SAMPLE_LOG_RECORDS_PER_SECTOR + 37);
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_flush());
+
+    sample_log_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2 * sectors + 2, stats.erases);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.write_errors);
+
+    // Sector cũ nhất đã bị xóa, còn đúng N - 1 sector đầy + sector head
+    sample_log_span_t span = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32((sectors - 1) * SAMPLE_LOG_RECORDS_PER_SECTOR + 37, span.end - span.begin);
+    TEST_ASSERT_FALSE(sample_log_read(span.begin - 1, &r));
+    TEST_ASSERT_FALSE(sample_log_read(span.end, &r));
+    uint32_t first_seq = assert_contiguous(span, 1);
+    TEST_ASSERT_EQUAL_UINT32(s_seq - (span.end - span.begin) + 1, first_seq);
+
+    // Mount lại: vị trí seq 1 trên vòng (s_seq_base) phải suy ra đúng từ header
+    reboot();
+    sample_log_span_t after = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(span.begin, after.begin);
+    TEST_ASSERT_EQUAL_UINT32(span.end, after.end);
+    TEST_ASSERT_EQUAL_UINT32(first_seq, assert_contiguous(after, 1));
+
+    // Ghi tiếp qua thêm 1 sector sau khi mount lại
+    append_n(SAMPLE_LOG_RECORDS_PER_SECTOR);
+    TEST_ASSERT_EQUAL(ESP_OK, sample_log_flush());
+    span = sample_log_get_span();
+    TEST_ASSERT_TRUE(sample_log_read(span.end - 1, &r));
+    TEST_ASSERT_EQUAL_UINT32(s_seq, r.seq);
+    TEST_ASSERT_EQUAL_UINT16(2, r.boot);
+}
+
+TEST_CASE("torn sector header falls back to the previous head", "[sample_log]")
+{
+    sample_log_record_t r;
+
+    mount_blank();
+    // Sector 0 đầy đúng tới slot cuối
+    append_n(SAMPLE_LOG_RECORDS_PER_SECTOR);
+    sample_log_span_t before = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_LOG_RECORDS_PER_SECTOR, before.end - before.begin);
+
+    // Mất điện khi đang mở sector 1: đã xóa, header mới ghi được 4 byte magic
+    const uint32_t magic = 0x31474C53;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(s_part, SAMPLE_LOG_SECTOR_SIZE, SAMPLE_LOG_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(s_part, SAMPLE_LOG_SECTOR_SIZE, &magic, sizeof(magic)));
+
+    reboot();
+    sample_log_span_t span = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(before.begin, span.begin);
+    TEST_ASSERT_EQUAL_UINT32(before.end, span.end);
+
+    // Lần ghi kế tiếp mở lại sector 1 (xóa header dở) và ghi tiếp liền mạch
+    append_n(SAMPLE_LOG_RECORDS_PER_PAGE - 1);
+    span = sample_log_get_span();
+    TEST_ASSERT_EQUAL_UINT32(before.end + SAMPLE_LOG_RECORDS_PER_PAGE - 1, span.end);
+    TEST_ASSERT_TRUE(sample_log_read(before.end, &r));
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_LOG_RECORDS_PER_SECTOR + 1, r.seq);
+    TEST_ASSERT_EQUAL_UINT16(2, r.boot);
+}
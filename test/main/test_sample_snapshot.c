@@ -0,0 +1,134 @@
+/**
+ * @file test_sample_snapshot.c
+ * @brief Stress test snapshot không khóa: 1 writer + nhiều reader pthread chạy song song thật
+ *
+ * Mỗi mẫu writer công bố có nhiệt độ, độ ẩm, timestamp suy ra từ seq; reader nào
+ * đọc được bộ (temperature, humidity, seq) không khớp nhau là đã đọc phải mẫu rách.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "sample_snapshot.h"
+
+#define STRESS_PUBLISHES    20000000    // ~1-2 s trên host, đủ để reader bị preempt giữa lúc chép cả khi chỉ có 1 CPU
+#define STRESS_READERS      3
+
+typedef struct {
+    uint64_t reads;
+    uint64_t contended_reads;   // Số lần đọc từ khi writer công bố mẫu đầu tiên (được đo thời gian)
+    uint32_t ns_per_read;       // Gồm cả kiểm tra rách, chủ yếu là chi phí thử lại khi writer đang ghi
+    uint64_t torn;
+    uint64_t backwards;         // seq nhỏ hơn lần đọc trước
+    uint32_t last_seq;
+} reader_result_t;
+
+static atomic_bool s_writer_done;
+
+// Các trường của mẫu seq (số nguyên nhỏ => float biểu diễn chính xác)
+static float temp_of(uint32_t seq) {
+    return (float)(seq % 1000);
+}
+
+static float hum_of(uint32_t seq) {
+    return (float)(seq % 997) + 0.5f;
+}
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+    for (uint32_t seq = 1; seq <= STRESS_PUBLISHES; seq++) {
+        sample_t s = {
+            .data = {
+                .temperature = temp_of(seq),
+                .humidity = hum_of(seq),
+                .timestamp = (int64_t)seq * 1000,
+                .is_valid = (seq & 1) != 0,
+            },
+            .state = (system_state_t)(seq % 4),
+            .seq = seq,
+        };
+        sample_snapshot_publish(&s);
+    }
+    atomic_store(&s_writer_done, true);
+    return NULL;
+}
+
+static void *reader_thread(void *arg) {
+    reader_result_t *r = arg;
+    sample_snapshot_t snap;
+    test_bench_t b;
+
+    while (!atomic_load_explicit(&s_writer_done, memory_order_relaxed)) {
+        sample_snapshot_read(&snap);
+        r->reads++;
+        if (snap.seq == 0) {
+            continue;   // Writer chưa công bố mẫu nào
+        }
+        if (r->contended_reads++ == 0) {
+            test_bench_start(&b, "snapshot_read_contended");
+        }
+        if (snap.data.temperature != temp_of(snap.seq) || snap.data.humidity != hum_of(snap.seq) ||
+            snap.data.timestamp != (int64_t)snap.seq * 1000 || snap.data.is_valid != ((snap.seq & 1) != 0) ||
+            snap.state != (system_state_t)(snap.seq % 4)) {
+            r->torn++;
+        }
+        if (snap.seq < r->last_seq) {
+            r->backwards++;
+        }
+        r->last_seq = snap.seq;
+    }
+    if (r->contended_reads > 0) {
+        r->ns_per_read = test_bench_end(&b, (uint32_t)r->contended_reads).ns_per_op;
+    }
+    return NULL;
+}
+
+TEST_CASE("concurrent readers never see a torn snapshot", "[sample_snapshot]")
+{
+    pthread_t writer;
+    pthread_t readers[STRESS_READERS];
+    reader_result_t results[STRESS_READERS] = { 0 };
+    sample_snapshot_t snap;
+
+    atomic_store(&s_writer_done, false);
+    for (int i = 0; i < STRESS_READERS; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&readers[i], NULL, reader_thread, &results[i]));
+    }
+    TEST_ASSERT_EQUAL(0, pthread_create(&writer, NULL, writer_thread, NULL));
+
+    pthread_join(writer, NULL);
+    for (int i = 0; i < STRESS_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    for (int i = 0; i < STRESS_READERS; i++) {
+        printf("reader %d: %" PRIu64 " reads (%" PRIu64 " while writing, %" PRIu32 " ns/read), last seq %" PRIu32 "\n",
+               i, results[i].reads, results[i].contended_reads, results[i].ns_per_read, results[i].last_seq);
+        TEST_ASSERT_GREATER_THAN_UINT32(0, (uint32_t)results[i].contended_reads);
+        TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)results[i].torn);
+        TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)results[i].backwards);
+    }
+
+    sample_snapshot_read(&snap);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_PUBLISHES, snap.seq);
+    TEST_ASSERT_EQUAL_FLOAT(temp_of(STRESS_PUBLISHES), snap.data.temperature);
+}
+
+// Mốc so sánh không có writer; số đo khi writer đang ghi là dòng BENCH snapshot_read_contended ở trên
+TEST_CASE("bench sample_snapshot_read", "[sample_snapshot][bench]")
+{
+    sample_snapshot_t snap;
+    test_bench_t b;
+
+    test_bench_start(&b, "sample_snapshot_read");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        sample_snapshot_read(&snap);
+        test_bench_sink += snap.seq;
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+}
@@ -0,0 +1,250 @@
+/**
+ * @file test_ssd1306.c
+ * @brief Test font 5x7 / vẽ glyph của SSD1306 qua đúng các byte flush ra bus
+ *
+ * Framebuffer là static trong ssd1306.c nên test đọc nó gián tiếp: flush vi sai
+ * chỉ gửi các cột thay đổi, fake_i2c_master ghi lại cửa sổ và dữ liệu đó.
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "fake_i2c_master.h"
+#include "ssd1306.h"
+#include <string.h>
+
+#define FLUSH_TIMEOUT       pdMS_TO_TICKS(1000)
+
+// Cột của 'A' và '1' trong font5x7 (bit 0 = dòng trên cùng)
+static const uint8_t s_glyph_a[5] = { 0x7E, 0x11, 0x11, 0x11, 0x7E };
+static const uint8_t s_glyph_1[5] = { 0x00, 0x42, 0x7F, 0x40, 0x00 };
+
+/**
+ * @brief Khởi tạo driver 1 lần, đưa panel (shadow) về màn hình trống và xóa nhật ký bus
+ */
+static void display_blank(void) {
+    static bool initialized = false;
+
+    fake_i2c_start();
+    if (!initialized) {
+        TEST_ASSERT_EQUAL(ESP_OK, ssd1306_init());
+        initialized = true;
+    }
+    ssd1306_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_display());
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_wait_flush(FLUSH_TIMEOUT));
+    fake_i2c_reset();
+}
+
+/**
+ * @brief Flush và chờ bus gửi xong
+ */
+static void flush(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_display());
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_wait_flush(FLUSH_TIMEOUT));
+}
+
+/**
+ * @brief Kiểm tra transaction i là cửa sổ [col0..col1] x [page0..page1]
+ */
+static void assert_window(uint32_t i, uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1) {
+    const uint8_t expected[7] = {
+        0x00, SSD1306_CMD_COLUMN_ADDR, col0, col1, SSD1306_CMD_PAGE_ADDR, page0, page1,
+    };
+    const fake_i2c_xfer_t *x = fake_i2c_get(i);
+
+    TEST_ASSERT_NOT_NULL(x);
+    TEST_ASSERT_EQUAL_HEX8(OLED_I2C_ADDR, x->addr);
+    TEST_ASSERT_EQUAL(sizeof(expected), x->len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, x->data, sizeof(expected));
+}
+
+/**
+ * @brief Kiểm tra transaction i là data stream (0x40 + len byte)
+ */
+static void assert_data(uint32_t i, const uint8_t *expected, size_t len) {
+    const fake_i2c_xfer_t *x = fake_i2c_get(i);
+
+    TEST_ASSERT_NOT_NULL(x);
+    TEST_ASSERT_EQUAL(1 + len, x->len);
+    TEST_ASSERT_EQUAL_HEX8(0x40, x->data[0]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, &x->data[1], len);
+}
+
+/**
+ * @brief Kiểm tra flush vi sai của vùng width cột bắt đầu ở (x, page first_page)
+ *
+ * expected[p * width + c] là byte của page first_page + p, cột x + c. Page nào có byte
+ * khác 0 phải được gửi bằng 1 cửa sổ + 1 span từ cột khác 0 đầu tiên tới cuối cùng.
+ */
+static void assert_spans(uint8_t x, uint8_t first_page, const uint8_t *expected, int num_pages, int width) {
+    uint32_t i = 0;
+
+    for (int p = 0; p < num_pages; p++) {
+        const uint8_t *cols = &expected[p * width];
+        int lo = 0, hi = width - 1;
+
+        while (lo < width && cols[lo] == 0) lo++;
+        if (lo == width) {
+            continue;
+        }
+        while (cols[hi] == 0) hi--;
+
+        assert_window(i++, x + lo, x + hi, first_page + p, first_page + p);
+        assert_data(i++, &cols[lo], hi - lo + 1);
+    }
+    TEST_ASSERT_EQUAL_UINT32(i, fake_i2c_count());
+}
+
+TEST_CASE("glyph is blitted column by column into page 0", "[ssd1306]")
+{
+    display_blank();
+
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(0, 0, 'A', 1));
+    flush();
+
+    // Cột khoảng cách (cột 6) vẫn trống => chỉ 5 cột được gửi
+    TEST_ASSERT_EQUAL_UINT32(2, fake_i2c_count());
+    assert_window(0, 0, 4, 0, 0);
+    assert_data(1, s_glyph_a, sizeof(s_glyph_a));
+}
+
+TEST_CASE("glyph lands on the right bits when y is not page aligned", "[ssd1306]")
+{
+    uint8_t expected[2][5];
+
+    display_blank();
+
+    // y = 3: mỗi cột trải qua 2 page (5 dòng trên ở page 0, 3 dòng dưới ở page 1)
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(10, 3, 'A', 1));
+    flush();
+
+    for (int col = 0; col < 5; col++) {
+        expected[0][col] = (uint8_t)(s_glyph_a[col] << 3);
+        expected[1][col] = (uint8_t)(s_glyph_a[col] >> 5);
+    }
+    assert_spans(10, 0, &expected[0][0], 2, 5);
+    TEST_ASSERT_EQUAL_UINT32(4, fake_i2c_count());
+}
+
+TEST_CASE("size 2 glyph doubles every pixel", "[ssd1306]")
+{
+    uint8_t expected[2][10] = {{0}};
+
+    display_blank();
+
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(0, 0, '1', 2));
+    flush();
+
+    // Cột c của glyph => cột 2c, 2c+1; dòng r => dòng 2r, 2r+1 (page 0 = dòng glyph 0..3)
+    for (int col = 0; col < 10; col++) {
+        for (int row = 0; row < 8; row++) {
+            if (s_glyph_1[col / 2] & (1 << row)) {
+                uint16_t bits = (uint16_t)(0x3 << (row * 2));
+                expected[0][col] |= (uint8_t)bits;
+                expected[1][col] |= (uint8_t)(bits >> 8);
+            }
+        }
+    }
+    assert_spans(0, 0, &expected[0][0], 2, 10);
+    TEST_ASSERT_EQUAL_UINT32(4, fake_i2c_count());
+}
+
+TEST_CASE("lowercase maps to uppercase and unknown chars draw nothing", "[ssd1306]")
+{
+    display_blank();
+
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(20, 8, 'a', 1));
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(40, 8, '~', 1));    // Ngoài 32..90 => space
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(60, 8, ' ', 1));
+    flush();
+
+    TEST_ASSERT_EQUAL_UINT32(2, fake_i2c_count());
+    assert_window(0, 20, 24, 1, 1);
+    assert_data(1, s_glyph_a, sizeof(s_glyph_a));
+}
+
+TEST_CASE("glyph is clipped at the right edge", "[ssd1306]")
+{
+    display_blank();
+
+    // Chỉ 3 cột đầu của 'A' nằm trong màn hình (x = 125..127)
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_char(OLED_WIDTH - 3, 0, 'A', 1));
+    flush();
+
+    TEST_ASSERT_EQUAL_UINT32(2, fake_i2c_count());
+    assert_window(0, OLED_WIDTH - 3, OLED_WIDTH - 1, 0, 0);
+    assert_data(1, s_glyph_a, 3);
+}
+
+TEST_CASE("string advances 6 columns per char", "[ssd1306]")
+{
+    uint8_t expected[11];
+
+    display_blank();
+
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_draw_string(0, 0, "A1", 1));
+    flush();
+
+    // 'A' ở cột 0..4, cột 5 trống, '1' ở cột 6..10 (cột 6 và 10 của '1' trống)
+    memcpy(expected, s_glyph_a, 5);
+    expected[5] = 0x00;
+    memcpy(&expected[6], s_glyph_1, 5);
+    TEST_ASSERT_EQUAL_UINT32(2, fake_i2c_count());
+    assert_window(0, 0, 9, 0, 0);
+    assert_data(1, expected, 10);
+}
+
+TEST_CASE("full screen change is flushed as one 1024 byte data transaction", "[ssd1306]")
+{
+    static uint8_t expected[SSD1306_BUFFER_SIZE];
+    ssd1306_bus_stats_t stats;
+
+    display_blank();
+    ssd1306_reset_bus_stats();
+
+    // Mọi page đổi => chi phí vi sai vượt 1 lần gửi toàn bộ
+    TEST_ASSERT_EQUAL(ESP_OK, ssd1306_fill_rect(0, 0, OLED_WIDTH, OLED_HEIGHT));
+    flush();
+
+    memset(expected, 0xFF, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT32(2, fake_i2c_count());
+    assert_window(0, 0, OLED_WIDTH - 1, 0, SSD1306_PAGES - 1);
+    assert_data(1, expected, SSD1306_BUFFER_SIZE);
+
+    // 7 byte cửa sổ + (1 + 1024) byte data, mỗi transaction thêm 1 byte địa chỉ
+    ssd1306_get_bus_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.flushes);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32((7 + 1) + (1 + SSD1306_BUFFER_SIZE + 1), stats.last_flush_bytes);
+
+    // Không có gì đổi => không có transaction nào
+    fake_i2c_reset();
+    flush();
+    TEST_ASSERT_EQUAL_UINT32(0, fake_i2c_count());
+    ssd1306_get_bus_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.last_flush_bytes);
+}
+
+TEST_CASE("bench glyph blit", "[ssd1306][bench]")
+{
+    test_bench_t b;
+
+    display_blank();
+
+    test_bench_start(&b, "ssd1306_draw_char");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        ssd1306_draw_char((uint8_t)(i % 120), 0, (char)('0' + i % 43), 1);
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+
+    test_bench_start(&b, "ssd1306_draw_string_x2");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        ssd1306_draw_string(0, 28, "25.3 C", 2);
+    }
+    r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+
+    ssd1306_clear();
+}
@@ -0,0 +1,64 @@
+/**
+ * @file test_system_state.c
+ * @brief Test get_system_state() / get_state_string() với ngưỡng runtime của sampler
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "config.h"
+#include "sampler.h"
+
+TEST_CASE("state follows the default thresholds", "[system_state]")
+{
+    sampler_set_thresholds(TEMP_WARNING, TEMP_OVERHEAT);
+
+    TEST_ASSERT_EQUAL(STATE_NORMAL, get_system_state(-40.0f));
+    TEST_ASSERT_EQUAL(STATE_NORMAL, get_system_state(TEMP_WARNING - 0.1f));
+    TEST_ASSERT_EQUAL(STATE_WARNING, get_system_state(TEMP_WARNING));
+    TEST_ASSERT_EQUAL(STATE_WARNING, get_system_state(TEMP_OVERHEAT - 0.1f));
+    TEST_ASSERT_EQUAL(STATE_OVERHEAT, get_system_state(TEMP_OVERHEAT));
+    TEST_ASSERT_EQUAL(STATE_OVERHEAT, get_system_state(80.0f));
+}
+
+TEST_CASE("state follows thresholds changed at runtime", "[system_state]")
+{
+    sampler_set_thresholds(30.0f, 35.5f);
+
+    TEST_ASSERT_EQUAL(STATE_NORMAL, get_system_state(29.9f));
+    TEST_ASSERT_EQUAL(STATE_WARNING, get_system_state(30.0f));
+    TEST_ASSERT_EQUAL(STATE_WARNING, get_system_state(35.4f));
+    TEST_ASSERT_EQUAL(STATE_OVERHEAT, get_system_state(35.5f));
+
+    // Ngưỡng trùng nhau: không còn vùng WARNING
+    sampler_set_thresholds(25.0f, 25.0f);
+    TEST_ASSERT_EQUAL(STATE_NORMAL, get_system_state(24.9f));
+    TEST_ASSERT_EQUAL(STATE_OVERHEAT, get_system_state(25.0f));
+
+    sampler_set_thresholds(TEMP_WARNING, TEMP_OVERHEAT);
+}
+
+TEST_CASE("state strings match the dashboard and OLED labels", "[system_state]")
+{
+    TEST_ASSERT_EQUAL_STRING("NORMAL", get_state_string(STATE_NORMAL));
+    TEST_ASSERT_EQUAL_STRING("WARNING", get_state_string(STATE_WARNING));
+    TEST_ASSERT_EQUAL_STRING("DANGER!", get_state_string(STATE_OVERHEAT));
+    TEST_ASSERT_EQUAL_STRING("ERROR", get_state_string(STATE_ERROR));
+    TEST_ASSERT_EQUAL_STRING("UNKNOWN", get_state_string((system_state_t)7));
+}
+
+TEST_CASE("bench get_system_state", "[system_state][bench]")
+{
+    test_bench_t b;
+    uint32_t sum = 0;
+
+    sampler_set_thresholds(TEMP_WARNING, TEMP_OVERHEAT);
+    test_bench_start(&b, "get_system_state");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        sum += get_system_state(15.0f + (float)(i % 200) / 10.0f);
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    test_bench_sink = sum;
+
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+}
@@ -0,0 +1,124 @@
+/**
+ * @file test_web_json.c
+ * @brief Test byte-exact JSON của các handler web (cùng hàm webserver.c gọi)
+ */
+
+#include <math.h>
+#include <string.h>
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "test_bench.h"
+#include "web_json.h"
+
+static json_writer_t s_json;
+
+static void begin(void) {
+    json_writer_init(&s_json, NULL, NULL);
+}
+
+/**
+ * @brief So nội dung writer (sink NULL => toàn bộ JSON nằm trong buf) với chuỗi mong đợi
+ */
+static void assert_json(const char *expected) {
+    TEST_ASSERT_EQUAL(ESP_OK, json_writer_flush(&s_json));
+    TEST_ASSERT_EQUAL_UINT32(strlen(expected), s_json.len);
+    TEST_ASSERT_EQUAL_STRING_LEN(expected, s_json.buf, s_json.len);
+}
+
+static const sensor_data_t s_data = {
+    .temperature = 25.3f,
+    .humidity = 65.0f,
+    .timestamp = 123456789,
+    .is_valid = true,
+};
+
+TEST_CASE("sensor json matches /api/sensor", "[web_json]")
+{
+    begin();
+    web_json_sensor(&s_json, NULL, 42, &s_data, STATE_NORMAL);
+    assert_json("{\"seq\":42,\"temperature\":25.3,\"humidity\":65.0,\"status\":\"NORMAL\","
+                "\"is_valid\":true,\"timestamp\":123456789}");
+}
+
+TEST_CASE("typed sensor json matches the live stream sample", "[web_json]")
+{
+    sensor_data_t data = s_data;
+    data.temperature = -0.04f;
+    data.humidity = 99.96f;
+
+    begin();
+    web_json_sensor(&s_json, "sample", 7, &data, STATE_WARNING);
+    assert_json("{\"type\":\"sample\",\"seq\":7,\"temperature\":0.0,\"humidity\":100.0,"
+                "\"status\":\"WARNING\",\"is_valid\":true,\"timestamp\":123456789}");
+}
+
+TEST_CASE("invalid reading writes null values", "[web_json]")
+{
+    sensor_data_t data = { .temperature = NAN, .humidity = INFINITY, .timestamp = 5, .is_valid = false };
+
+    begin();
+    web_json_sensor(&s_json, NULL, 0, &data, STATE_ERROR);
+    assert_json("{\"seq\":0,\"temperature\":null,\"humidity\":null,\"status\":\"ERROR\","
+                "\"is_valid\":false,\"timestamp\":5}");
+}
+
+TEST_CASE("status json matches /api/status", "[web_json]")
+{
+    sensor_data_t data = s_data;
+    data.temperature = 31.25f;
+
+    begin();
+    web_json_status(&s_json, &data, STATE_OVERHEAT);
+    assert_json("{\"temperature\":31.3,\"humidity\":65.0,\"status\":\"DANGER!\"}");
+}
+
+TEST_CASE("history sample json uses deci units without float", "[web_json]")
+{
+    history_sample_t s = {
+        .timestamp_ms = 1700000000123LL,
+        .seq = 4000000000u,
+        .temp_deci = -5,
+        .hum_deci = 1000,
+        .state = STATE_NORMAL,
+        .is_valid = true,
+    };
+
+    begin();
+    web_json_history_sample(&s_json, &s);
+    assert_json("{\"seq\":4000000000,\"temperature\":-0.5,\"humidity\":100.0,\"status\":\"NORMAL\","
+                "\"timestamp\":1700000000123000}");
+
+    s.temp_deci = -400;
+    s.hum_deci = 0;
+    s.state = STATE_OVERHEAT;
+    begin();
+    web_json_history_sample(&s_json, &s);
+    assert_json("{\"seq\":4000000000,\"temperature\":-40.0,\"humidity\":0.0,\"status\":\"DANGER!\","
+                "\"timestamp\":1700000000123000}");
+}
+
+TEST_CASE("buzzer json typed and untyped", "[web_json]")
+{
+    begin();
+    web_json_buzzer(&s_json, true, false);
+    assert_json("{\"buzzer_status\":\"ON\",\"is_active\":true}");
+
+    begin();
+    web_json_buzzer(&s_json, false, true);
+    assert_json("{\"type\":\"buzzer\",\"buzzer_status\":\"OFF\",\"is_active\":false}");
+}
+
+TEST_CASE("bench web_json_sensor", "[web_json][bench]")
+{
+    test_bench_t b;
+
+    test_bench_start(&b, "web_json_sensor");
+    for (uint32_t i = 0; i < TEST_BENCH_ITERATIONS; i++) {
+        begin();
+        web_json_sensor(&s_json, NULL, i, &s_data, STATE_NORMAL);
+        json_writer_flush(&s_json);
+        test_bench_sink += (uint32_t)s_json.len;
+    }
+    test_bench_result_t r = test_bench_end(&b, TEST_BENCH_ITERATIONS);
+    TEST_ASSERT_EQUAL(0, r.alloc_bytes);
+}
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+Nén các file dashboard (main/www) thành .gz lúc build để nhúng vào firmware.
+
+- Nén gzip mức 9, mtime = 0 => cùng nội dung cho ra cùng byte (ETag ổn định)
+- Token {{hash:<file>}} trong file text được thay bằng hash nội dung của <file>,
+  nên index.html tự đổi URL của CSS/JS khi chúng thay đổi (cache-busting)
+
+Dùng: gzip_assets.py --out <dir> <file> [<file> ...]
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+TOKEN = re.compile(rb"\{\{hash:([A-Za-z0-9_.\-]+)\}\}")
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:8]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--out", required=True, help="thư mục chứa file .gz")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args()
+
+    sources = {}
+    for path in args.files:
+        with open(path, "rb") as f:
+            sources[os.path.basename(path)] = f.read()
+
+    hashes = {name: content_hash(data) for name, data in sources.items()}
+
+    def substitute(match):
+        name = match.group(1).decode()
+        if name not in hashes:
+            sys.exit("gzip_assets: unknown asset in token: %s" % name)
+        return hashes[name].encode()
+
+    os.makedirs(args.out, exist_ok=True)
+    for name, data in sources.items():
+        data = TOKEN.sub(substitute, data)
+        out_path = os.path.join(args.out, name + ".gz")
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        with open(out_path, "wb") as f:
+            f.write(packed)
+        print("gzip_assets: %s %d -> %d bytes" % (name, len(data), len(packed)))
+
+
+if __name__ == "__main__":
+    main()
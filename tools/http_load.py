@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""
+Tải HTTP đồng thời lên webserver (board hoặc bản host linux) và đo ảnh hưởng lên sensor_task.
+
+- N client keep-alive chạy song song, mỗi client lần lượt gọi các endpoint (lệch pha theo client)
+- Báo cáo theo endpoint: số request, lỗi, throughput, độ trễ p50/p99/max phía client
+- Độ lệch chu kỳ lấy mẫu (stage "jitter" của /api/latency) khi rảnh so với khi có tải:
+  /api/latency?reset=1 mở cửa sổ đo mới ở đầu mỗi pha
+- Lỗi kết nối (server chỉ giữ max_open_sockets = 4) được đếm và client kết nối lại
+
+Dùng: http_load.py [--host localhost:8080] [--clients 4] [--duration 30] [--idle 30] [--json out.json]
+"""
+
+import argparse
+import http.client
+import json
+import sys
+import threading
+import time
+
+DEFAULT_ENDPOINTS = ["/api/sensor", "/api/history", "/api/config", "/"]
+JITTER_STAGES = ("jitter", "wake", "web")
+
+
+class Stats:
+    def __init__(self):
+        self.latencies = []
+        self.errors = 0
+        self.bytes = 0
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100.0))]
+
+
+def connect(host, timeout):
+    return http.client.HTTPConnection(host, timeout=timeout)
+
+
+def client(index, args, deadline, stats, lock, reconnects):
+    conn = connect(args.host, args.timeout)
+    endpoints = args.endpoints
+    i = index
+    while time.monotonic() < deadline:
+        path = endpoints[i % len(endpoints)]
+        i += 1
+        start = time.monotonic()
+        try:
+            # gzip: giống trình duyệt, "/" được phục vụ dạng nén sẵn
+            conn.request("GET", path, headers={"Accept-Encoding": "gzip"})
+            resp = conn.getresponse()
+            body = resp.read()
+            elapsed_ms = (time.monotonic() - start) * 1000.0
+            ok = resp.status == 200
+            if resp.getheader("Connection", "").lower() == "close":
+                conn.close()
+                conn = connect(args.host, args.timeout)
+        except (OSError, http.client.HTTPException):
+            ok = False
+            body = b""
+            elapsed_ms = (time.monotonic() - start) * 1000.0
+            conn.close()
+            conn = connect(args.host, args.timeout)
+            with lock:
+                reconnects[0] += 1
+
+        with lock:
+            s = stats[path]
+            if ok:
+                s.latencies.append(elapsed_ms)
+                s.bytes += len(body)
+            else:
+                s.errors += 1
+    conn.close()
+
+
+def fetch_latency(host, timeout):
+    """Đọc histogram pipeline rồi xóa (mở cửa sổ đo mới)."""
+    conn = connect(host, timeout)
+    try:
+        conn.request("GET", "/api/latency?reset=1")
+        resp = conn.getresponse()
+        data = json.loads(resp.read())
+    finally:
+        conn.close()
+    return {s["stage"]: s for s in data.get("stages", [])}
+
+
+def run_load(args):
+    stats = {path: Stats() for path in args.endpoints}
+    lock = threading.Lock()
+    reconnects = [0]
+    deadline = time.monotonic() + args.duration
+    threads = [threading.Thread(target=client, args=(i, args, deadline, stats, lock, reconnects), daemon=True)
+               for i in range(args.clients)]
+    start = time.monotonic()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return stats, reconnects[0], time.monotonic() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--host", default="localhost:8080", help="host:port (bản host linux dùng cổng 8080)")
+    parser.add_argument("--clients", type=int, default=4, help="số client keep-alive đồng thời")
+    parser.add_argument("--duration", type=float, default=30.0, help="thời gian chạy tải (giây)")
+    parser.add_argument("--idle", type=float, default=30.0,
+                        help="thời gian đo jitter khi không có tải trước đó (giây, 0 = bỏ qua)")
+    parser.add_argument("--endpoints", default=",".join(DEFAULT_ENDPOINTS),
+                        help="danh sách path cách nhau bởi dấu phẩy (có thể kèm query)")
+    parser.add_argument("--timeout", type=float, default=10.0, help="timeout mỗi request (giây)")
+    parser.add_argument("--json", help="ghi kết quả ra file JSON (để so sánh giữa các lần chạy)")
+    args = parser.parse_args()
+    args.endpoints = [e for e in args.endpoints.split(",") if e]
+    if args.host.startswith("http://"):
+        args.host = args.host[len("http://"):]
+
+    try:
+        fetch_latency(args.host, args.timeout)
+    except (OSError, http.client.HTTPException, ValueError) as e:
+        sys.exit("http_load: cannot reach %s/api/latency: %s" % (args.host, e))
+
+    idle = {}
+    if args.idle > 0:
+        print("http_load: idle %.0f s (baseline jitter)" % args.idle)
+        time.sleep(args.idle)
+        idle = fetch_latency(args.host, args.timeout)
+
+    print("http_load: %d clients x %.0f s on %s" % (args.clients, args.duration, ", ".join(args.endpoints)))
+    stats, reconnects, wall_s = run_load(args)
+    loaded = fetch_latency(args.host, args.timeout)
+
+    print()
+    print("%-16s %8s %7s %7s %9s %9s %9s %9s" % ("endpoint", "requests", "errors", "err%", "req/s",
+                                                 "p50_ms", "p99_ms", "max_ms"))
+    total_ok = total_err = 0
+    report = {"clients": args.clients, "duration_s": wall_s, "reconnects": reconnects,
+              "endpoints": {}, "pipeline": {}}
+    all_latencies = []
+    for path in args.endpoints:
+        s = stats[path]
+        n = len(s.latencies) + s.errors
+        row = {
+            "requests": n,
+            "errors": s.errors,
+            "error_pct": 100.0 * s.errors / n if n else 0.0,
+            "rps": len(s.latencies) / wall_s,
+            "p50_ms": percentile(s.latencies, 50),
+            "p99_ms": percentile(s.latencies, 99),
+            "max_ms": max(s.latencies) if s.latencies else 0.0,
+            "bytes": s.bytes,
+        }
+        report["endpoints"][path] = row
+        total_ok += len(s.latencies)
+        total_err += s.errors
+        all_latencies.extend(s.latencies)
+        print("%-16s %8d %7d %7.1f %9.1f %9.1f %9.1f %9.1f" % (path[:16], n, s.errors, row["error_pct"],
+                                                              row["rps"], row["p50_ms"], row["p99_ms"],
+                                                              row["max_ms"]))
+    total = total_ok + total_err
+    print("%-16s %8d %7d %7.1f %9.1f %9.1f %9.1f %9.1f" % ("total", total, total_err,
+                                                          100.0 * total_err / total if total else 0.0,
+                                                          total_ok / wall_s, percentile(all_latencies, 50),
+                                                          percentile(all_latencies, 99),
+                                                          max(all_latencies) if all_latencies else 0.0))
+    print("reconnects: %d" % reconnects)
+
+    print()
+    print("%-8s %10s %10s %10s %10s %10s %10s" % ("stage", "idle_n", "idle_p99", "idle_max",
+                                                  "load_n", "load_p99", "load_max"))
+    for stage in JITTER_STAGES:
+        a = idle.get(stage, {})
+        b = loaded.get(stage, {})
+        report["pipeline"][stage] = {"idle": a, "load": b}
+        print("%-8s %10s %10s %10s %10d %10d %10d" % (stage,
+                                                      a.get("count", "-"), a.get("p99_us", "-"),
+                                                      a.get("max_us", "-"), b.get("count", 0),
+                                                      b.get("p99_us", 0), b.get("max_us", 0)))
+    print("(pipeline us; p99 là cận trên của bucket histogram)")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+        print("http_load: wrote %s" % args.json)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+Ghi trace mẫu cảm biến từ board thành 1 file THB1 để phát lại trên host (SIM_REPLAY).
+
+- Lấy GET /api/history.bin (bản ghi 24 byte: seq, timestamp_ms, boot, nhiệt độ/độ ẩm x10, trạng thái)
+- --follow: hỏi lại theo ?since=<id cuối> mỗi --interval giây tới khi Ctrl+C, ghi nối tiếp
+- Trường count trong header được sửa lại theo số bản ghi thực tế khi kết thúc
+
+Dùng: trace_capture.py --host 192.168.1.50 --out trace.bin [--source flash] [--last 3600] [--follow]
+"""
+
+import argparse
+import struct
+import sys
+import time
+import urllib.request
+
+HEADER = struct.Struct("<4sHHIHH")     # magic, header_size, record_size, count, flags, schema_len
+
+
+def fetch(base, params):
+    query = "&".join("%s=%s" % kv for kv in params.items() if kv[1] is not None)
+    with urllib.request.urlopen("%s/api/history.bin?%s" % (base, query), timeout=30) as resp:
+        data = resp.read()
+    magic, header_size, record_size, _, _, _ = HEADER.unpack_from(data)
+    if magic != b"THB1":
+        sys.exit("trace_capture: not a THB1 response")
+    return data[:header_size], record_size, data[header_size:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--host", required=True, help="IP hoặc host:port của board")
+    parser.add_argument("--out", required=True, help="file .bin đầu ra")
+    parser.add_argument("--source", choices=["ram", "flash"], default="ram",
+                        help="flash = nhật ký trên flash (giữ qua reboot, dài hơn)")
+    parser.add_argument("--last", type=int, help="chỉ lấy S giây gần nhất (nguồn ram)")
+    parser.add_argument("--follow", action="store_true", help="tiếp tục ghi mẫu mới tới khi Ctrl+C")
+    parser.add_argument("--interval", type=float, default=10.0, help="chu kỳ hỏi khi --follow (giây)")
+    args = parser.parse_args()
+
+    base = args.host if args.host.startswith("http") else "http://" + args.host
+    params = {"source": "flash" if args.source == "flash" else None, "last": args.last}
+
+    header, record_size, body = fetch(base, params)
+    count = len(body) // record_size
+    with open(args.out, "wb") as out:
+        out.write(header)
+        out.write(body[:count * record_size])
+        last_id = struct.unpack_from("<I", body, (count - 1) * record_size)[0] if count else None
+        print("trace_capture: %d records" % count)
+
+        try:
+            while args.follow:
+                time.sleep(args.interval)
+                since = {"since": last_id} if last_id is not None else {}
+                _, _, body = fetch(base, dict(params, last=None, **since))
+                n = len(body) // record_size
+                if n:
+                    out.write(body[:n * record_size])
+                    out.flush()
+                    last_id = struct.unpack_from("<I", body, (n - 1) * record_size)[0]
+                    count += n
+                    print("trace_capture: +%d (%d records)" % (n, count))
+        except KeyboardInterrupt:
+            pass
+
+        # Header của response đầu tiên chỉ đếm lần tải đầu => ghi lại tổng
+        out.seek(8)
+        out.write(struct.pack("<I", count))
+    print("trace_capture: wrote %s (%d records)" % (args.out, count))
+
+
+if __name__ == "__main__":
+    main()
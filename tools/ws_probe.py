@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+Mở N client WebSocket tới /ws (board hoặc bản host linux) và kiểm tra live stream.
+
+- Mỗi client phải nhận mỗi mẫu đúng 1 lần, seq tăng dần, không thiếu seq nào giữa mẫu đầu và mẫu cuối
+- Độ trễ đẩy phía thiết bị: stage "push" của /api/latency (timer fire -> frame đã gửi),
+  /api/latency?reset=1 mở cửa sổ đo mới lúc bắt đầu
+- Phía client: độ lệch thời điểm nhận cùng 1 seq giữa các client (fan-out) và độ trễ tương đối
+  (thời điểm nhận - timestamp của mẫu, trừ giá trị nhỏ nhất => không cần đồng bộ đồng hồ)
+- Mã thoát 1 khi có mẫu trùng, sai thứ tự, thiếu, hoặc client không nhận được mẫu nào
+
+Chỉ dùng thư viện chuẩn (client RFC 6455 tối giản, chỉ đọc).
+
+Dùng: ws_probe.py [--host localhost:8080] [--clients 3] [--duration 30] [--json out.json]
+"""
+
+import argparse
+import base64
+import http.client
+import json
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+
+OP_TEXT = 0x1
+OP_CLOSE = 0x8
+OP_PING = 0x9
+OP_PONG = 0xA
+
+
+class ClientResult:
+    def __init__(self, index):
+        self.index = index
+        self.error = None
+        self.messages = 0
+        self.samples = []           # (seq, recv_s, device_us)
+        self.duplicates = 0
+        self.out_of_order = 0
+        self.missing = 0
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100.0))]
+
+
+def recv_exact(sock, n):
+    data = b""
+    while len(data) < n:
+        chunk = sock.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("connection closed")
+        data += chunk
+    return data
+
+
+def send_frame(sock, opcode, payload=b""):
+    # Frame của client bắt buộc có mask
+    mask = os.urandom(4)
+    header = bytes([0x80 | opcode, 0x80 | len(payload)]) + mask
+    sock.sendall(header + bytes(b ^ mask[i % 4] for i, b in enumerate(payload)))
+
+
+def recv_frame(sock):
+    b0, b1 = recv_exact(sock, 2)
+    length = b1 & 0x7F
+    if length == 126:
+        length = struct.unpack(">H", recv_exact(sock, 2))[0]
+    elif length == 127:
+        length = struct.unpack(">Q", recv_exact(sock, 8))[0]
+    mask = recv_exact(sock, 4) if b1 & 0x80 else None
+    payload = recv_exact(sock, length)
+    if mask:
+        payload = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+    return b0 & 0x0F, payload
+
+
+def ws_connect(host, timeout):
+    name, _, port = host.partition(":")
+    sock = socket.create_connection((name, int(port or 80)), timeout=timeout)
+    key = base64.b64encode(os.urandom(16)).decode()
+    sock.sendall(("GET /ws HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n" % (host, key)).encode())
+    response = b""
+    while b"\r\n\r\n" not in response:
+        chunk = sock.recv(1)
+        if not chunk:
+            raise ConnectionError("handshake: connection closed")
+        response += chunk
+    status = response.split(b"\r\n", 1)[0]
+    if b" 101 " not in status:
+        raise ConnectionError("handshake: %s" % status.decode(errors="replace"))
+    return sock
+
+
+def client(result, args, deadline):
+    try:
+        sock = ws_connect(args.host, args.timeout)
+    except (OSError, ConnectionError) as e:
+        result.error = str(e)
+        return
+    sock.settimeout(0.5)
+    last_seq = None
+    try:
+        while time.monotonic() < deadline:
+            try:
+                opcode, payload = recv_frame(sock)
+            except socket.timeout:
+                continue
+            now = time.monotonic()
+            if opcode == OP_PING:
+                send_frame(sock, OP_PONG, payload)
+                continue
+            if opcode == OP_CLOSE:
+                result.error = "closed by server"
+                break
+            if opcode != OP_TEXT:
+                continue
+            result.messages += 1
+            msg = json.loads(payload)
+            if msg.get("type") != "sample":
+                continue
+            seq = msg["seq"]
+            if last_seq is not None:
+                if seq == last_seq:
+                    result.duplicates += 1
+                    continue
+                if seq < last_seq:
+                    result.out_of_order += 1
+                    continue
+                result.missing += seq - last_seq - 1
+            last_seq = seq
+            result.samples.append((seq, now, msg.get("timestamp", 0)))
+        send_frame(sock, OP_CLOSE, struct.pack(">H", 1000))
+    except (OSError, ConnectionError, ValueError) as e:
+        result.error = str(e)
+    finally:
+        sock.close()
+
+
+def fetch_push_latency(host, timeout):
+    """Đọc stage push của /api/latency rồi xóa histogram."""
+    conn = http.client.HTTPConnection(host, timeout=timeout)
+    try:
+        conn.request("GET", "/api/latency?reset=1")
+        data = json.loads(conn.getresponse().read())
+    finally:
+        conn.close()
+    for stage in data.get("stages", []):
+        if stage.get("stage") == "push":
+            return stage
+    return {}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--host", default="localhost:8080", help="host:port (bản host linux dùng cổng 8080)")
+    parser.add_argument("--clients", type=int, default=3, help="số client WebSocket (LIVE_STREAM_MAX_CLIENTS = 3)")
+    parser.add_argument("--duration", type=float, default=30.0, help="thời gian nghe (giây)")
+    parser.add_argument("--timeout", type=float, default=10.0, help="timeout kết nối (giây)")
+    parser.add_argument("--json", help="ghi kết quả ra file JSON")
+    args = parser.parse_args()
+    if args.host.startswith("http://"):
+        args.host = args.host[len("http://"):]
+
+    try:
+        fetch_push_latency(args.host, args.timeout)
+    except (OSError, http.client.HTTPException, ValueError) as e:
+        sys.exit("ws_probe: cannot reach %s/api/latency: %s" % (args.host, e))
+
+    print("ws_probe: %d clients x %.0f s on ws://%s/ws" % (args.clients, args.duration, args.host))
+    results = [ClientResult(i) for i in range(args.clients)]
+    deadline = time.monotonic() + args.duration
+    threads = [threading.Thread(target=client, args=(r, args, deadline), daemon=True) for r in results]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    push = fetch_push_latency(args.host, args.timeout)
+
+    print()
+    print("%-6s %8s %8s %9s %9s %5s %6s %8s %11s %11s" % ("client", "messages", "samples", "first_seq",
+                                                         "last_seq", "dup", "order", "missing",
+                                                         "rel_p99_ms", "rel_max_ms"))
+    report = {"clients": args.clients, "duration_s": args.duration, "per_client": [], "push": push}
+    failed = False
+    for r in results:
+        rel_ms = []
+        if r.samples:
+            # Độ trễ tương đối: (nhận - timestamp thiết bị) trừ giá trị nhỏ nhất của chính client đó
+            offsets = [recv_s * 1000.0 - device_us / 1000.0 for _, recv_s, device_us in r.samples]
+            base = min(offsets)
+            rel_ms = [o - base for o in offsets]
+        row = {
+            "error": r.error,
+            "messages": r.messages,
+            "samples": len(r.samples),
+            "first_seq": r.samples[0][0] if r.samples else None,
+            "last_seq": r.samples[-1][0] if r.samples else None,
+            "duplicates": r.duplicates,
+            "out_of_order": r.out_of_order,
+            "missing": r.missing,
+            "rel_p99_ms": percentile(rel_ms, 99),
+            "rel_max_ms": max(rel_ms) if rel_ms else 0.0,
+        }
+        report["per_client"].append(row)
+        print("%-6d %8d %8d %9s %9s %5d %6d %8d %11.1f %11.1f%s" % (
+            r.index, r.messages, len(r.samples), row["first_seq"], row["last_seq"], r.duplicates,
+            r.out_of_order, r.missing, row["rel_p99_ms"], row["rel_max_ms"],
+            "  error: %s" % r.error if r.error else ""))
+        if r.error or not r.samples or r.duplicates or r.out_of_order or r.missing:
+            failed = True
+
+    # Fan-out: chênh lệch thời điểm nhận cùng 1 seq giữa client nhận sớm nhất và muộn nhất
+    arrivals = {}
+    for r in results:
+        for seq, recv_s, _ in r.samples:
+            arrivals.setdefault(seq, []).append(recv_s)
+    skew_ms = [(max(t) - min(t)) * 1000.0 for t in arrivals.values() if len(t) == args.clients]
+    report["fanout_skew_ms"] = {"samples": len(skew_ms), "p50": percentile(skew_ms, 50),
+                                "p99": percentile(skew_ms, 99), "max": max(skew_ms) if skew_ms else 0.0}
+    print()
+    print("fan-out skew: %d samples, p50 %.2f ms, p99 %.2f ms, max %.2f ms" % (
+        len(skew_ms), report["fanout_skew_ms"]["p50"], report["fanout_skew_ms"]["p99"],
+        report["fanout_skew_ms"]["max"]))
+    print("push (device, fire -> frame sent): count %s, p50 %s us, p99 %s us, max %s us" % (
+        push.get("count", "-"), push.get("p50_us", "-"), push.get("p99_us", "-"), push.get("max_us", "-")))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+        print("ws_probe: wrote %s" % args.json)
+
+    if failed:
+        sys.exit("ws_probe: FAILED (duplicate, out-of-order or missing samples, or a client error)")
+    print("ws_probe: OK")
+
+
+if __name__ == "__main__":
+    main()